@@ -36,36 +36,36 @@
 #define RGBA_LIGHTGRAY   211,    211,    211,    255
 #define RGBA_SILVER      192,    192,    192,    255
 
-#define HEX32_BLACK       0x000000FF
-#define HEX32_WHITE       0xFFFFFFFF
-#define HEX32_RED         0xFF0000FF
-#define HEX32_GREEN       0x00FF00FF
-#define HEX32_BLUE        0x0000FFFF
-#define HEX32_YELLOW      0xFFFF00FF
-#define HEX32_CYAN        0x00FFFFFF
-#define HEX32_MAGENTA     0xFF00FFFF
-#define HEX32_ORANGE      0xFFA500FF
-#define HEX32_LIME        0x32CD32FF
-#define HEX32_PINK        0xFFC0CBFF
-#define HEX32_PURPLE      0x800080FF
-#define HEX32_VIOLET      0xEE82EEFF
-#define HEX32_BROWN       0xA52A2AFF
-#define HEX32_MAROON      0x800000FF
-#define HEX32_NAVY        0x000080FF
-#define HEX32_TEAL        0x008080FF
-#define HEX32_OLIVE       0x808000FF
-#define HEX32_INDIGO      0x4B0082FF
-#define HEX32_CRIMSON     0xDC143CFF
-#define HEX32_SKYBLUE     0x87CEEBFF
-#define HEX32_TURQUOISE   0x40E0D0FF
-#define HEX32_CORAL       0xFF7F50FF
-#define HEX32_GOLD        0xFFD700FF
-#define HEX32_KHAKI       0xF0E68CFF
-#define HEX32_BEIGE       0xF5F5DCFF
-#define HEX32_GRAY        0x808080FF
-#define HEX32_DARKGRAY    0xA9A9A9FF
-#define HEX32_LIGHTGRAY   0xD3D3D3FF
-#define HEX32_SILVER      0xC0C0C0FF
+#define HEX32_BLACK       __hexRGBA(0x000000FF)
+#define HEX32_WHITE       __hexRGBA(0xFFFFFFFF)
+#define HEX32_RED         __hexRGBA(0xFF0000FF)
+#define HEX32_GREEN       __hexRGBA(0x00FF00FF)
+#define HEX32_BLUE        __hexRGBA(0x0000FFFF)
+#define HEX32_YELLOW      __hexRGBA(0xFFFF00FF)
+#define HEX32_CYAN        __hexRGBA(0x00FFFFFF)
+#define HEX32_MAGENTA     __hexRGBA(0xFF00FFFF)
+#define HEX32_ORANGE      __hexRGBA(0xFFA500FF)
+#define HEX32_LIME        __hexRGBA(0x32CD32FF)
+#define HEX32_PINK        __hexRGBA(0xFFC0CBFF)
+#define HEX32_PURPLE      __hexRGBA(0x800080FF)
+#define HEX32_VIOLET      __hexRGBA(0xEE82EEFF)
+#define HEX32_BROWN       __hexRGBA(0xA52A2AFF)
+#define HEX32_MAROON      __hexRGBA(0x800000FF)
+#define HEX32_NAVY        __hexRGBA(0x000080FF)
+#define HEX32_TEAL        __hexRGBA(0x008080FF)
+#define HEX32_OLIVE       __hexRGBA(0x808000FF)
+#define HEX32_INDIGO      __hexRGBA(0x4B0082FF)
+#define HEX32_CRIMSON     __hexRGBA(0xDC143CFF)
+#define HEX32_SKYBLUE     __hexRGBA(0x87CEEBFF)
+#define HEX32_TURQUOISE   __hexRGBA(0x40E0D0FF)
+#define HEX32_CORAL       __hexRGBA(0xFF7F50FF)
+#define HEX32_GOLD        __hexRGBA(0xFFD700FF)
+#define HEX32_KHAKI       __hexRGBA(0xF0E68CFF)
+#define HEX32_BEIGE       __hexRGBA(0xF5F5DCFF)
+#define HEX32_GRAY        __hexRGBA(0x808080FF)
+#define HEX32_DARKGRAY    __hexRGBA(0xA9A9A9FF)
+#define HEX32_LIGHTGRAY   __hexRGBA(0xD3D3D3FF)
+#define HEX32_SILVER      __hexRGBA(0xC0C0C0FF)
 
 #define RBGA(r,g,b,a) (r), (g), (b), (a)
 #define HEX2RGB(hex)  ((hex)>>16), (((hex)>>8)&0xFF), ((hex)&0xFF), 255
@@ -23,14 +23,40 @@
 #include "helper.h"
 #include "../lib/log/log.h"
 #include "../lib/windowContext/windowContext.h"
+#include "../lib/memPool/memPool.h"
+#include "../lib/mathChannel/mathChannel.h"
+#include "../lib/sampleStore/sampleStore.h"
+#include "../lib/decimator/decimator.h"
+#include "../lib/raster/raster.h"
+#include "../lib/interp/interp.h"
+#include "../lib/bitStream/bitStream.h"
+#include "../lib/protoDecode/protoDecode.h"
+#include "../lib/logicStore/logicStore.h"
+#include "../lib/segStore/segStore.h"
+#include "../lib/geomBatch/geomBatch.h"
+#include "../lib/compositor/compositor.h"
+#include "../lib/config/config.h"
+#include "../lib/scpiServer/scpiServer.h"
+#include "../lib/latency/latency.h"
+#include "../lib/maskTest/maskTest.h"
+#include "../lib/workerPool/workerPool.h"
+#include "../lib/average/average.h"
+#include "../lib/density/density.h"
+#include "../lib/search/search.h"
+#include "../lib/eye/eye.h"
+#include "../lib/blockCodec/blockCodec.h"
+#include "../lib/pixelFormat/pixelFormat.h"
+#include "../lib/timing/timing.h"
+#include "../lib/fontAtlas/fontAtlas.h"
+#include "../lib/acquire/acquire.h"
 
 /// GLOBL VARS ///////////////////////////////////////////////////////////////////////////////////
-#define FONT_PATH       "/usr/share/fonts/TTF/DejaVuSans.ttf"
-#define FONT_SIZE       12
+#define FONT_PATH       "/usr/share/fonts/TTF/DejaVuSans.ttf"        /// Default, see --font
+#define FONT_SIZE       12                                           /// Default, see --font-size
 
 typedef int (*pThreadFunc_t)(void*);
 typedef int32_t             xy_t;                       /// Size type, x for horizontal (0...H), y for vertical (0...W)
-typedef int32_t             color_t;                    /// Color type (RGBA)
+typedef uint32_t            color_t;                    /// Color type, channel order set by COLOR_LAYOUT_* (helper.h)
 typedef uint64_t            flag_t;                     /// Flag type, 64-bit
 
 #define fMask(f)            __mask64(f)
@@ -42,8 +68,9 @@ typedef uint64_t            flag_t;                     /// Flag type, 64-bit
 extern windowContext_t *    mainWindow;
 extern pthread_mutex_t      sdlMutex;                   /// Mutex lock for SDL operations (thread-safety)
 extern pthread_mutex_t      scrBufMutex;                /// Mutex lock for screen buffer
-extern const xy_t           screenW;                    /// Y
-extern const xy_t           screenH;                    /// X
+extern oscConfig_t          oscConf;                    /// Runtime configuration (command line / presets)
+extern xy_t                 screenW;                    /// Y, from oscConf.windowW
+extern xy_t                 screenH;                    /// X, from oscConf.windowH
 extern color_t *            screenBuffer;
 
 #define bufferPixel(x, y)   screenBuffer[(x) * screenW + (y)]
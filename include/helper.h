@@ -142,53 +142,86 @@
 /// COLORS ////////////////////////////////////////////////////////////////////////////////////////
 
 /**
- * @brief Combine RGB values into a 32-bit RGBA color (alpha defaults to 255).
+ * @brief Bit position of each channel in a packed 32-bit color.
+ *
+ * The layout is fixed at compile time: build with -DCOLOR_LAYOUT_ARGB8888,
+ * _ABGR8888 or _BGRA8888 to compose directly in the display's native format
+ * (see pfNegotiate()); the default is RGBA8888, i.e. 0xRRGGBBAA.
+ */
+#if defined(COLOR_LAYOUT_ARGB8888)
+#define COLOR_R_SHIFT   16
+#define COLOR_G_SHIFT   8
+#define COLOR_B_SHIFT   0
+#define COLOR_A_SHIFT   24
+#elif defined(COLOR_LAYOUT_ABGR8888)
+#define COLOR_R_SHIFT   0
+#define COLOR_G_SHIFT   8
+#define COLOR_B_SHIFT   16
+#define COLOR_A_SHIFT   24
+#elif defined(COLOR_LAYOUT_BGRA8888)
+#define COLOR_R_SHIFT   8
+#define COLOR_G_SHIFT   16
+#define COLOR_B_SHIFT   24
+#define COLOR_A_SHIFT   0
+#else
+#define COLOR_R_SHIFT   24
+#define COLOR_G_SHIFT   16
+#define COLOR_B_SHIFT   8
+#define COLOR_A_SHIFT   0
+#endif
+
+/**
+ * @brief Combine RGB values into a 32-bit color (alpha defaults to 255).
  * @param R Red channel (0-255).
  * @param G Green channel (0-255).
  * @param B Blue channel (0-255).
- * @return A 32-bit RGBA value.
- * @note Assumes simColor_t is defined (e.g., uint32_t in global.h).
+ * @return A 32-bit color in the compile-time layout.
  */
-#define __combiRGB(R, G, B) ((((simColor_t)R)<<24) | (((simColor_t)G)<<16) | (((simColor_t)B)<<8) | ((simColor_t)0xFF))
+#define __combiRGB(R, G, B)     __combiRGBA(R, G, B, 0xFF)
 
 /**
- * @brief Combine RGBA values into a 32-bit RGBA color.
+ * @brief Combine RGBA values into a 32-bit color.
  * @param R Red channel (0-255).
  * @param G Green channel (0-255).
  * @param B Blue channel (0-255).
  * @param A Alpha channel (0-255).
- * @return A 32-bit RGBA value.
- * @note Assumes simColor_t is defined (e.g., uint32_t in global.h).
+ * @return A 32-bit color in the compile-time layout.
+ */
+#define __combiRGBA(R, G, B, A) ((((uint32_t)(R) & 0xFF) << COLOR_R_SHIFT) | (((uint32_t)(G) & 0xFF) << COLOR_G_SHIFT) | \
+                                 (((uint32_t)(B) & 0xFF) << COLOR_B_SHIFT) | (((uint32_t)(A) & 0xFF) << COLOR_A_SHIFT))
+
+/**
+ * @brief A color written as 0xRRGGBBAA, in the compile-time layout (a constant for constant input).
  */
-#define __combiRGBA(R, G, B, A) ((((simColor_t)R)<<24) | (((simColor_t)G)<<16) | (((simColor_t)B)<<8) | ((simColor_t)A))
+#define __hexRGBA(HEX)          __combiRGBA((uint32_t)(HEX) >> 24, (uint32_t)(HEX) >> 16, (uint32_t)(HEX) >> 8, (uint32_t)(HEX))
 
 /**
- * @brief Extract the red channel from a 32-bit RGBA color.
- * @param RGBA The 32-bit RGBA color value.
+ * @brief Extract the red channel from a 32-bit color.
+ * @param RGBA The 32-bit color value.
  * @return The 8-bit red channel value (0-255).
  */
-#define __getRFromRGBA(RGBA)    (((simColor_t)(RGBA) >> 24) & 0xFF)
+#define __getRFromRGBA(RGBA)    (((uint32_t)(RGBA) >> COLOR_R_SHIFT) & 0xFF)
 
 /**
- * @brief Extract the green channel from a 32-bit RGBA color.
- * @param RGBA The 32-bit RGBA color value.
+ * @brief Extract the green channel from a 32-bit color.
+ * @param RGBA The 32-bit color value.
  * @return The 8-bit green channel value (0-255).
  */
-#define __getGFromRGBA(RGBA)    (((simColor_t)(RGBA) >> 16) & 0xFF)
+#define __getGFromRGBA(RGBA)    (((uint32_t)(RGBA) >> COLOR_G_SHIFT) & 0xFF)
 
 /**
- * @brief Extract the blue channel from a 32-bit RGBA color.
- * @param RGBA The 32-bit RGBA color value.
+ * @brief Extract the blue channel from a 32-bit color.
+ * @param RGBA The 32-bit color value.
  * @return The 8-bit blue channel value (0-255).
  */
-#define __getBFromRGBA(RGBA)    (((simColor_t)(RGBA) >>  8) & 0xFF)
+#define __getBFromRGBA(RGBA)    (((uint32_t)(RGBA) >> COLOR_B_SHIFT) & 0xFF)
 
 /**
- * @brief Extract the alpha channel from a 32-bit RGBA color.
- * @param RGBA The 32-bit RGBA color value.
+ * @brief Extract the alpha channel from a 32-bit color.
+ * @param RGBA The 32-bit color value.
  * @return The 8-bit alpha channel value (0-255).
  */
-#define __getAFromRGBA(RGBA)    (((simColor_t)(RGBA) >>  0) & 0xFF)
+#define __getAFromRGBA(RGBA)    (((uint32_t)(RGBA) >> COLOR_A_SHIFT) & 0xFF)
 
 /// OTHERS ////////////////////////////////////////////////////////////////////////////////////////
 
@@ -4,6 +4,8 @@ using namespace std;
 
 /// HEADERS ///////////////////////////////////////////////////////////////////////////////////////
 
+#include <sys/stat.h>
+
 #include "global.h"
 
 /// VARS //////////////////////////////////////////////////////////////////////////////////////////
@@ -21,45 +23,1343 @@ enum ENUM_STATUS_FLAG_BITORDER{
 
 enum ENUM_SCREEN_FLAG_BITORDER{
     BUFFER_FLUSH = 0,
+    ZERO_COPY = 1,                              /// Compose straight into the locked streaming texture
+    GEOMETRY = 2,                               /// Batched SDL_RenderGeometry backend instead of pixels
+    XY = 3,                                     /// Density plot of channel 0 (x) against channel 1 (y)
+    EYE = 4,                                    /// Eye diagram of channel 0
+    ROLL = 5,                                   /// Trace scrolls as samples arrive
+    TIMING = 6,                                 /// Edge timing of channel 0: histogram over trend
+    MASK = 7,                                   /// Pass/fail mask test of channel 0's records
+    AVERAGE = 8,                                /// Channel 0 shown as the average of its last --average records
+    SEGMENTS = 9,                               /// Overlay of the newest segments captured from channel 0
+    LOGIC = 10,                                 /// Channels as logic lines, one record from the bit-plane store
+};
+
+/// Latency stages, ingest stamp (ssCommit) to SDL_RenderPresent
+enum ENUM_LATENCY_STAGE{
+    LAT_QUEUE = 0,                               /// Newest sample's ingest -> frame start
+    LAT_REDUCE,                                  /// Decimation / interpolation, per channel
+    LAT_COMPOSE,                                 /// Whole compose pass (includes LAT_REDUCE)
+    LAT_UPLOAD,                                  /// Texture unlock / update and copy, or geometry submit
+    LAT_PRESENT,                                 /// SDL_RenderPresent
+    LAT_TOTAL,                                   /// Ingest -> present returned
+    LAT_N_STAGES,
+};
+
+static const char *oscLatencyNames[LAT_N_STAGES] = { "queue", "reduce", "compose", "upload", "present", "total" };
+
+/// Horizontal/vertical mapping of a channel onto the screen
+typedef struct oscView_t {
+    double          start;                      /// Sample index at column 0
+    double          samplesPerCol;              /// < 1 means zoomed in past one sample per column
+    float           yMin;                       /// Value at the bottom row
+    float           yMax;                       /// Value at the top row
+} oscView_t;
+
+#define OSC_MAX_CHANNELS    8
+#define OSC_GRID_DIV_X      10
+#define OSC_GRID_DIV_Y      8
+#define OSC_GRID_COLOR      __hexRGBA(0x404040FF)
+#define OSC_SINC_TAPS       16                  /// Interpolator length for views zoomed in past one sample per column
+#define OSC_RECORD_SLOTS    17                  /// Segment slots for the mask and average records without --segments
+#define OSC_MASK_COLOR      __hexRGBA(0x501010FF)
+#define OSC_ACQ_FRAMES      4096                /// Frames per acquisition block
+#define OSC_DECIMATE_CUTOFF 0.8f                /// --decimate low-pass edge, fraction of the stored Nyquist rate
+#define OSC_LOGIC_CHUNK     4096                /// Samples thresholded into logic lines per pass, a multiple of 64
+#define OSC_DECODE_ROW_H    16                  /// Height of one decoder annotation row
+#define OSC_MAX_OVERLAY     64                  /// Segments drawn on top of each other in segments mode
+#define OSC_LOG_EYE         0x01                /// oscRequestLog(): eye measurements
+#define OSC_LOG_TIMING      0x02                /// Timing statistics
+#define OSC_LOG_MASK        0x04                /// Mask test counters
+#define OSC_FULL_SCALE      1.0f                /// Default view is +-OSC_FULL_SCALE; the averager's resolution is relative to it
+
+static const color_t oscPalette[OSC_MAX_CHANNELS] = {
+    HEX32_YELLOW, HEX32_CYAN, HEX32_MAGENTA, HEX32_LIME, HEX32_ORANGE, HEX32_SKYBLUE, HEX32_PINK, HEX32_GOLD,
 };
 
+/// A channel on screen; ss == NULL means the slot is off
+typedef struct oscChannel_t {
+    const sampleStore_t *   ss;
+    oscView_t               view;
+    interpolator_t *        ip;
+    color_t                 color;
+    blockStore_t *          history;            /// Compressed samples older than ss holds, NULL = off
+} oscChannel_t;
+
+float *         colMin;                         /// Per-column scratch, screenW entries
+float *         colMax;
+oscChannel_t    oscChannels[OSC_MAX_CHANNELS];
+sampleStore_t * oscStores[OSC_MAX_CHANNELS];    /// Producer side of oscChannels[i].ss, owned here
+color_t         oscBackground = __hexRGBA(0x000000FF);
+geomLayer_t *   geomTraces;                     /// Rebuilt every frame, buffers kept
+compositor_t *  compositor;                     /// Static layers cached, traces drawn per frame
+SDL_Texture *   staticTexture;                  /// The static cache for the geometry backend
+pfLayout_t      textureLayout;                  /// Channel order of mainWindow->format, when it needs converting
+uint64_t        staticTextureRev;               /// compositor->rebuilds it was uploaded at
+scpiServer_t *  scpiServer;                     /// Remote control, NULL unless --socket is given
+scSettings_t    oscRemote;                      /// Last settings taken from scpiServer
+latency_t *     latency;                        /// Per-stage latency histograms
+workerPool_t *  workers;                        /// Data-parallel pool (averaging, hi-res), --threads / --cpus
+density_t *     xyDensity;                      /// XY mode histogram, screenW x screenH
+uint64_t        xyNext;                         /// Next sample index to bin in XY mode
+volatile uint8_t xyReset;                       /// Set by the input thread: clear the histogram
+search_t *      oscSearch;                      /// Event index over channel 0, 'n' / 'p' and SEARch commands
+volatile int8_t oscJump;                        /// Set by the input thread: +1 next / -1 previous event, 0 = none
+volatile int8_t oscPacketJump;                  /// The same for decoded packets ('.' / ',')
+eyeDiagram_t *  eye;                            /// Eye mode, NULL if --bit-rate leaves < 2 samples per UI
+volatile uint8_t eyeRestart;                    /// Set by the input thread: re-read the source and threshold
+SDL_Texture *   rollTexture;                    /// Roll mode: a ring of columns, rollHead is the oldest
+color_t *       rollStrip;                      /// New roll columns are drawn here, then uploaded
+xy_t            rollHead;                       /// Ring column written next
+double          rollPos;                        /// First sample of the column at rollHead
+volatile uint8_t rollRestart;                   /// Set by the input thread: redraw the ring from history
+timing_t *      oscTiming;                      /// Timing mode analyzer, published by the memory loader, NULL until then
+volatile uint8_t timingSeries;                  /// Sequence shown: TIE, period or width, stored by the input thread
+volatile uint8_t timingRestart;                 /// Set by the input thread: analyze again
+uint64_t        timingAt;                       /// ssWritten() at the last analysis
+volatile uint8_t oscLogRequest;                 /// Set by the input thread: OSC_LOG_* bits to log on the render thread
+fontAtlas_t *   oscFont;                        /// Label glyphs, published by the font loader, NULL until then
+uint8_t         oscFontShown;                   /// The static layers were redrawn with oscFont
+float *         oscRecord;                      /// Channel 0's last triggered record, recordLength samples
+float *         oscHiRes;                       /// The record boxcar-averaged by --hires, NULL if off
+uint64_t        oscMaskNext;                    /// Next segment (oscSegments->total numbering) for the mask test
+uint64_t        oscAvNext;                      /// Next segment for the averager
+maskTest_t *    oscMask;                        /// Mask mode tester, screenW columns
+uint8_t         oscMaskArmed;                   /// oscMask has limits
+volatile uint8_t maskRestart;                   /// Set by the input thread: the next record becomes the golden one
+averager_t *    oscAverager;                    /// Average mode, published by the memory loader, NULL until then
+float *         oscAverage;                     /// oscAverager's output, recordLength samples
+volatile uint8_t avRestart;                     /// Set by the input thread: forget the averaged records
+segStore_t *    oscSegments;                    /// Triggered records of channel 0, published by the memory loader
+uint64_t        oscSegNext;                     /// Next sample of channel 0 to feed to oscSegments
+volatile uint8_t segRetrigger;                  /// Set by the input thread: take the trigger level from the view again
+acquire_t *     frontEnd;                       /// --source -> oscStores, NULL without a source
+uint8_t         oscMath = OSC_MAX_CHANNELS;     /// Slot of the --math channel, OSC_MAX_CHANNELS = none
+pdDecoder_t *   oscDecoder;                     /// --decode over the logic lines, NULL = off
+uint8_t         oscLogicLines;                  /// Channels 1 ... oscLogicLines are thresholded into logic lines
+uint64_t        oscLogicNext;                   /// Next sample to threshold
+uint8_t         oscLogicLevel[OSC_MAX_CHANNELS];    /// Hysteresis state of each line
+float *         oscLogicIn;                     /// One chunk of a channel, OSC_LOGIC_CHUNK samples
+uint64_t *      oscLogicBits;                   /// [line][OSC_LOGIC_CHUNK / 64] the chunk packed
+uint64_t *      oscLogicWords;                  /// The chunk as sample words, bit l = line l
+logicStore_t *  oscLogic[2];                    /// Logic mode records: oscLogicFill is being filled, the other is shown
+uint64_t        oscLogicBase[2];                /// Absolute sample of each record's first sample
+uint8_t         oscLogicFill;
+uint8_t         oscLogicDone;                   /// oscLogic[oscLogicFill ^ 1] holds a complete record
+volatile uint8_t logicRestart;                  /// Set by the input thread: start a new record
+SDL_Thread *    acqThread;                      /// acquisitionService(), joined in oscExit()
+SDL_Thread *    fontLoader;                     /// Startup work off the render thread, joined in oscExit()
+SDL_Thread *    memoryLoader;
+
+void oscLayerBackground(rsTarget_t *t, void *ctx);
+void oscLayerLabels(rsTarget_t *t, void *ctx);
+void oscLayerTraces(rsTarget_t *t, void *ctx);
+void oscDefaultSearch();
+int  acquisitionService(void *pv);
+
+/**
+ * @brief Rate of the stored samples: the source rate divided by --decimate.
+ */
+double oscStoreRate(){
+    return oscConf.sampleRate / oscConf.decimate;
+}
+
+/**
+ * @brief Samples per --hires box, at most one record.
+ */
+uint32_t oscHiResBox(){
+    return __min(oscConf.hires, oscConf.recordLength);
+}
+
 /// INIT & EXIT ///////////////////////////////////////////////////////////////////////////////////
 
 
 /// OSC INIT & EXIT ///////////////////////////////////////////////////////////////////////////////
 
+/**
+ * @brief Font loader thread: the label atlas from the cache, or rasterized and cached.
+ */
+int oscLoadFont(void *arg){
+    fontAtlas_t *fa = NULL;
+    uint64_t     t0 = ltNow();
+    if(createFontAtlas(&fa, oscConf.fontPath, (uint8_t)oscConf.fontSize, oscConf.fontCache) != STATUS_OK) return -1;
+    __log("[oscLoadFont] %s %u pt %s in %.1f ms", oscConf.fontPath, oscConf.fontSize,
+          fa->cached ? "from cache" : "rasterized", (ltNow() - t0) / 1e6);
+    __atomic_store_n(&oscFont, fa, __ATOMIC_RELEASE);
+    return 0;
+}
+
+/**
+ * @brief Memory loader thread: the XY and eye histograms, the timing
+ * analyzer, the averager, the segment store and the history stores, mapped
+ * and prefaulted while the window opens.
+ */
+int oscLoadMemory(void *arg){
+    density_t    *dn = NULL;
+    eyeDiagram_t *ey = NULL;
+    timing_t     *tm = NULL;
+    averager_t   *av = NULL;
+    segStore_t   *sg = NULL;
+    if(createDensity(&dn, screenW, screenH, workers) == STATUS_OK) __atomic_store_n(&xyDensity, dn, __ATOMIC_RELEASE);
+    if(createEyeDiagram(&ey, screenW, screenH, oscStoreRate() / oscConf.bitRate, workers) == STATUS_OK){
+        __atomic_store_n(&eye, ey, __ATOMIC_RELEASE);
+    }
+    /// Sized for one record: timing mode analyzes the newest one
+    if(createTiming(&tm, __min(oscConf.recordLength, oscConf.ringSize), workers) == STATUS_OK) __atomic_store_n(&oscTiming, tm, __ATOMIC_RELEASE);
+    /// Averages hi-res records when --hires boxes them
+    if(createAverager(&av, AV_RUNNING, oscConf.averages, oscConf.recordLength / oscHiResBox(), OSC_FULL_SCALE, workers) == STATUS_OK){
+        __atomic_store_n(&oscAverager, av, __ATOMIC_RELEASE);
+    }
+    /// One record per segment, trigger in the middle, oldest overwritten. The
+    /// mask and average records come from here too, so it exists without --segments
+    uint32_t nSeg = oscConf.segments > 0 ? oscConf.segments : OSC_RECORD_SLOTS;
+    if(createSegStore(&sg, nSeg, oscConf.recordLength / 2,
+            oscConf.recordLength - oscConf.recordLength / 2, 1.0 / oscStoreRate()) == STATUS_OK){
+        segSetWrap(sg, 1);
+        __atomic_store_n(&oscSegments, sg, __ATOMIC_RELEASE);
+    }
+    if(oscConf.historyMiB == 0) return 0;
+    /// Bounded by memory, and by 16:1 compression in samples
+    size_t bytes = (size_t)oscConf.historyMiB << 20;
+    REPTT(uint8_t, i, 0, OSC_MAX_CHANNELS){
+        blockStore_t *bc = NULL;
+        if(__is_null(oscChannels[i].ss)) continue;
+        if(createBlockStore(&bc, bytes, (uint64_t)bytes * 4) == STATUS_OK) __atomic_store_n(&oscChannels[i].history, bc, __ATOMIC_RELEASE);
+    }
+    return 0;
+}
+
+/**
+ * @brief Channels 1 ... --channels: a sample store of --ring-size samples
+ * each, a default view of one record across the screen, and an --interp
+ * interpolator. With --math, the slot after the last channel is set up the
+ * same way for the math channel, which the front end fills (see oscInit()).
+ *
+ * Runs on the render thread, which consumes the stores (see createSampleStore()).
+ */
+void oscCreateChannels(){
+    uint8_t  n = (uint8_t)__min(oscConf.channels, (uint32_t)OSC_MAX_CHANNELS);
+    ipMode_t mode = IP_SINC;
+    if(strcmp(oscConf.interp, "linear") == 0) mode = IP_LINEAR;
+    else if(strcmp(oscConf.interp, "sinc") != 0) __err("[oscCreateChannels] Unknown interpolation '%s', using sinc", oscConf.interp);
+    if(oscConf.math[0]){
+        if(n < OSC_MAX_CHANNELS) oscMath = n++;
+        else __err("[oscCreateChannels] --math: all %d slots are channels", OSC_MAX_CHANNELS);
+    }
+    REPTT(uint8_t, i, 0, n){
+        oscChannel_t *ch = &oscChannels[i];
+        if(createSampleStore(&oscStores[i], oscConf.ringSize) != STATUS_OK){
+            __err("[oscCreateChannels] channel %u: no sample store, left off", i + 1);
+            continue;
+        }
+        createInterpolator(&ch->ip, mode, OSC_SINC_TAPS);
+        ch->ss                 = oscStores[i];
+        ch->color              = oscPalette[i];
+        ch->view.start         = 0.0;
+        ch->view.samplesPerCol = (double)oscConf.recordLength / screenW;
+        ch->view.yMin          = -OSC_FULL_SCALE;
+        ch->view.yMax          = OSC_FULL_SCALE;
+    }
+}
+
+/**
+ * @brief --decode: a decoder over the logic lines (channels 1 ... --channels).
+ *
+ * UART runs at --bit-rate, 8N1; SPI is mode 0, 8 bits MSB first, with CH4 as
+ * chip select when there are four channels; I2C takes SCL on CH1, SDA on CH2.
+ */
+void oscCreateDecoder(){
+    oscLogicLines = (uint8_t)__min(oscConf.channels, (uint32_t)OSC_MAX_CHANNELS);
+    if(!oscConf.decode[0]) return;
+    const pdDecoderOps_t *ops = pdFindDecoder(oscConf.decode);
+    if(__is_null(ops)){
+        __err("[oscCreateDecoder] Unknown decoder '%s'", oscConf.decode);
+        return;
+    }
+    pdConfig_t c;
+    memset(&c, 0, sizeof(c));
+    if(ops == &pdUartOps){
+        c.uart.samplesPerBit = (float)(oscStoreRate() / oscConf.bitRate);
+        c.uart.dataBits      = 8;
+        c.uart.stopBits      = 1;
+    }else if(ops == &pdSpiOps){
+        c.spi.bits  = 8;
+        c.spi.useCs = oscLogicLines > 3;
+    }
+    if(createDecoder(&oscDecoder, ops, &c) != STATUS_OK) return;
+    if(oscDecoder->nLines > oscLogicLines){
+        __err("[oscCreateDecoder] %s needs %u channels, %u enabled", ops->name, oscDecoder->nLines, oscLogicLines);
+        destroyDecoder(&oscDecoder);
+    }
+}
+
+/**
+ * @brief Startup, ordered for time to first frame.
+ *
+ * The font atlas and the large buffers are built on two threads started
+ * first; the window opens meanwhile. Until they are published, frames are
+ * drawn without labels (see oscPollStartup()), XY / eye / timing modes draw
+ * nothing and there is no history.
+ */
 void oscInit(){
     __entry("oscInit()");
     statusFlag setFlag (STARTUP);
-    screenBuffer = (color_t *) malloc(sizeof(color_t) * screenH * screenW);
+    createWorkerPool(&workers, oscConf.threads, &oscConf);
+    /// Before the memory loader, which gives history only to channels with a store
+    oscCreateChannels();
+    fontLoader   = SDL_CreateThread(oscLoadFont, "oscLoadFont", NULL);
+    memoryLoader = SDL_CreateThread(oscLoadMemory, "oscLoadMemory", NULL);
+    if(__is_null(fontLoader))   oscLoadFont(NULL);
+    if(__is_null(memoryLoader)) oscLoadMemory(NULL);
+    screenBuffer = (color_t *) mpAlloc(sizeof(color_t) * screenH * screenW);
+    colMin = (float *) mpAlloc(sizeof(float) * screenW);
+    colMax = (float *) mpAlloc(sizeof(float) * screenW);
+    rollStrip = (color_t *) mpAlloc(sizeof(color_t) * screenH * screenW);
+    oscRecord = (float *) mpAlloc(sizeof(float) * oscConf.recordLength);
+    oscAverage = (float *) mpAlloc(sizeof(float) * oscConf.recordLength);
+    if(oscHiResBox() > 1) oscHiRes = (float *) mpAlloc(sizeof(float) * (oscConf.recordLength / oscHiResBox()));
+    createMaskTest(&oscMask, screenW);
+    oscCreateDecoder();
+    oscLogicIn   = (float *) mpAlloc(sizeof(float) * OSC_LOGIC_CHUNK);
+    oscLogicBits = (uint64_t *) mpAlloc(sizeof(uint64_t) * OSC_MAX_CHANNELS * (OSC_LOGIC_CHUNK / 64));
+    oscLogicWords = (uint64_t *) mpAlloc(sizeof(uint64_t) * OSC_LOGIC_CHUNK);
+    if(oscLogicLines > 0){
+        REPTT(uint8_t, k, 0, 2) createLogicStore(&oscLogic[k], oscLogicLines, __min(oscConf.recordLength, oscConf.ringSize));
+    }
+    createGeomLayer(&geomTraces, OSC_MAX_CHANNELS * screenW);
+    createCompositor(&compositor, screenW, screenH);
+    createLatency(&latency, oscLatencyNames, LAT_N_STAGES);
+    createSearch(&oscSearch, workers);
+    oscDefaultSearch();
+    cmpAddStatic(compositor, oscLayerBackground, NULL);
+    cmpAddStatic(compositor, oscLayerLabels, NULL);
+    cmpAddDynamic(compositor, oscLayerTraces, NULL);
     if (SDL_Init(SDL_INIT_VIDEO) < 0) {
         __err("[oscInit] SDL_Init failed: %s\n", SDL_GetError());
         return;
     }
-    if (TTF_Init() < 0) {
-        __err("[oscInit] TTF_Init failed: %s\n", TTF_GetError());
-        return ;
+    /// No TTF font here: labels come from oscFont
+    if(createWindowContext(&mainWindow, screenW, screenH, "ngxxfus' osc", NULL, 0) != STATUS_OK){
+        __err("[oscInit] createWindowContext failed: %s\n", SDL_GetError());
+        return;
+    }
+    pfLayoutOf(mainWindow->format, &textureLayout);
+    /// Converted uploads write through SDL_LockTexture, which needs streaming access
+    staticTexture = SDL_CreateTexture(mainWindow->renderer, mainWindow->format,
+        mainWindow->convert ? SDL_TEXTUREACCESS_STREAMING : SDL_TEXTUREACCESS_STATIC, screenW, screenH);
+    if(__is_null(staticTexture)){
+        __err("[oscInit] SDL_CreateTexture failed: %s\n", SDL_GetError());
+        return;
     }
-    createWindowContext(
-        &mainWindow, screenW, screenH, "ngxxfus' osc", 
-        FONT_PATH, FONT_SIZE
-    );
+    rollTexture = SDL_CreateTexture(mainWindow->renderer, mainWindow->format,
+        SDL_TEXTUREACCESS_STREAMING, screenW, screenH);
+    if(__is_not_null(rollTexture)) SDL_SetTextureBlendMode(rollTexture, SDL_BLENDMODE_BLEND);
     screenFlag  setFlag (BUFFER_FLUSH);
+    if(oscConf.backend == CFG_BACKEND_ZERO_COPY) screenFlag setFlag (ZERO_COPY);
+    if(oscConf.backend == CFG_BACKEND_GEOMETRY)  screenFlag setFlag (GEOMETRY);
     statusFlag setFlag (RUNNING);
+    if(oscConf.socketPath[0] && createScpiServer(&scpiServer, oscConf.socketPath, oscStoreRate(), oscConf.recordLength) == STATUS_OK){
+        /// oscCreateChannels() has run: channels without a store stay "off"
+        REPTT(uint8_t, i, 0, OSC_MAX_CHANNELS){
+            if(__is_not_null(oscChannels[i].ss)) scAttach(scpiServer, i, oscChannels[i].ss);
+        }
+        scAttachSearch(scpiServer, oscSearch);
+    }
+    decimatorConfig_t dec;
+    memset(&dec, 0, sizeof(dec));
+    dec.ratio    = (uint16_t)oscConf.decimate;
+    dec.response = DF_LOWPASS;
+    dec.cutoff   = OSC_DECIMATE_CUTOFF;
+    if(oscConf.source[0] && createAcquire(&frontEnd, (uint8_t)oscConf.channels, oscStores, OSC_ACQ_FRAMES, &dec) == STATUS_OK){
+        if(oscMath < OSC_MAX_CHANNELS && __is_not_null(oscStores[oscMath])
+        && (acqAttachMath(frontEnd, oscStores[oscMath]) != STATUS_OK
+         || acqSetMath(frontEnd, oscConf.math, (float)(1.0 / oscStoreRate())) != STATUS_OK)){
+            __err("[oscInit] --math \"%s\" left off", oscConf.math);
+        }
+        acqThread = SDL_CreateThread(acquisitionService, "acquisitionService", NULL);
+        if(__is_null(acqThread)) __err("[oscInit] Create acquisitionService failed: %s", SDL_GetError());
+    }
     __exit("oscInit()");
 }
 
 void oscExit(){
     __entry("oscInit()");
+    /// The acquisition thread writes the stores: stop it before anything is freed
+    if(__is_not_null(acqThread))    SDL_WaitThread(acqThread, NULL);
+    acqThread = NULL;
+    destroyAcquire(&frontEnd);
+    if(__is_not_null(fontLoader))   SDL_WaitThread(fontLoader, NULL);
+    if(__is_not_null(memoryLoader)) SDL_WaitThread(memoryLoader, NULL);
+    fontLoader = memoryLoader = NULL;
+    destroyScpiServer(&scpiServer);
+    if(__is_not_null(staticTexture)) SDL_DestroyTexture(staticTexture);
+    if(__is_not_null(rollTexture)) SDL_DestroyTexture(rollTexture);
     destroyWindowContext(&mainWindow);
     SDL_Quit();
     
-    free(screenBuffer);
+    mpFree(screenBuffer);
+    mpFree(colMin);
+    mpFree(colMax);
+    mpFree(rollStrip);
+    mpFree(oscRecord);
+    mpFree(oscAverage);
+    mpFree(oscHiRes);
+    mpFree(oscLogicIn);
+    mpFree(oscLogicBits);
+    mpFree(oscLogicWords);
+    destroyLogicStore(&oscLogic[0]);
+    destroyLogicStore(&oscLogic[1]);
+    destroyDecoder(&oscDecoder);
+    destroyAverager(&oscAverager);
+    destroySegStore(&oscSegments);
+    destroyMaskTest(&oscMask);
+    destroyGeomLayer(&geomTraces);
+    destroyCompositor(&compositor);
+    if(oscConf.latencyFile[0]) ltDump(latency, oscConf.latencyFile);
+    destroyLatency(&latency);
+    destroyDensity(&xyDensity);
+    destroySearch(&oscSearch);
+    destroyEyeDiagram(&eye);
+    destroyTiming(&oscTiming);
+    destroyFontAtlas(&oscFont);
+    REPTT(uint8_t, i, 0, OSC_MAX_CHANNELS){
+        oscChannels[i].ss = NULL;
+        destroyInterpolator(&oscChannels[i].ip);
+        destroySampleStore(&oscStores[i]);
+        destroyBlockStore(&oscChannels[i].history);
+    }
+    destroyWorkerPool(&workers);
+    mpThreadArenaFree();
+    mpLogStats();
     __exit("oscInit()");
 }
 
+/// VIEW //////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief Reduce one channel to per-column values in colMin/colMax.
+ *
+ * Zoomed out, every column is the min/max envelope of its samples. Zoomed in
+ * (samplesPerCol < 1) and with an interpolator, only the visible span is
+ * resampled to one value per column, left in colMin and colMax; columns
+ * outside the stored samples are blank (colMin > colMax). Columns older than the
+ * store's oldest sample come from the compressed history, if there is one:
+ * whole blocks from their min / max headers, only the ends decoded.
+ *
+ * @return 1 if colMin holds a trace, 0 if colMin/colMax hold an envelope.
+ */
+uint8_t oscReduceChannel(const sampleStore_t *ss, blockStore_t *history, const oscView_t *view, interpolator_t *ip, xy_t cols){
+    if(view->samplesPerCol < 1.0 && __is_not_null(ip)){
+        if(ipResampleStore(ip, ss, view->start, view->samplesPerCol, colMin, colMax, cols) == STATUS_OK) return 1;
+        REPTT(xy_t, x, 0, cols){
+            colMin[x] = 1.0f;
+            colMax[x] = 0.0f;
+        }
+        return 0;
+    }
+
+    const uint64_t oldest = ssOldest(ss);
+    REPTT(xy_t, x, 0, cols){
+        double   a = view->start + x * view->samplesPerCol;
+        double   b = a + view->samplesPerCol;
+        uint32_t n = (uint32_t)__max(1.0, floor(b) - floor(a));
+        ssSpan_t span;
+        if(a >= 0.0 && (uint64_t)a < oldest && __is_not_null(history)){
+            if(!bcMinMax(history, (uint64_t)a, n, &colMin[x], &colMax[x])){
+                colMin[x] = 1.0f;
+                colMax[x] = 0.0f;
+            }
+            continue;
+        }
+        if(a < 0.0 || ssGetSpan(ss, (uint64_t)a, n, &span) == 0){
+            colMin[x] = 1.0f;
+            colMax[x] = 0.0f;
+            continue;
+        }
+        rsDecimateMinMax(span.p[0], span.n[0], &colMin[x], &colMax[x], 1);
+        if(span.n[1]){
+            float lo, hi;
+            rsDecimateMinMax(span.p[1], span.n[1], &lo, &hi, 1);
+            colMin[x] = __min(colMin[x], lo);
+            colMax[x] = __max(colMax[x], hi);
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief The columns of a trace left by oscReduceChannel() that hold data.
+ *
+ * Blank columns only pad the ends (the view runs past the stored samples),
+ * so the data is one run.
+ *
+ * @return Columns in the run, starting at *first; 0 if all are blank.
+ */
+xy_t oscTraceRun(xy_t cols, xy_t *first){
+    xy_t a = 0, b = cols;
+    while(a < b && colMin[a] > colMax[a]) ++a;
+    while(b > a && colMin[b - 1] > colMax[b - 1]) --b;
+    *first = a;
+    return b - a;
+}
+
+/**
+ * @brief Draw one channel into a target.
+ */
+void oscDrawChannel(rsTarget_t *target, const sampleStore_t *ss, blockStore_t *history, const oscView_t *view, interpolator_t *ip, color_t color){
+    const xy_t cols = __min(target->w, screenW);
+    uint64_t   t0 = ltNow();
+    uint8_t    trace = oscReduceChannel(ss, history, view, ip, cols);
+    ltRecordSince(latency, LAT_REDUCE, t0);
+    if(trace){
+        xy_t first, n = oscTraceRun(cols, &first);
+        rsDrawTrace(target, first, colMin + first, n, view->yMin, view->yMax, color);
+    }else{
+        rsDrawEnvelope(target, 0, colMin, colMax, cols, view->yMin, view->yMax, color);
+    }
+}
+
+/// REMOTE ////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief Pick up settings changed over the control socket.
+ *
+ * Only reads the server's sequence-locked snapshot, so it never waits on a
+ * client. The timebase becomes every channel's samples per column; a new
+ * MATH:DEFine is compiled here and handed to the front end's math slot.
+ */
+void oscApplyRemote(){
+    if(__is_null(scpiServer)) return;
+    scSettings_t s;
+    scGetSettings(scpiServer, &s);
+    if(s.revision == oscRemote.revision) return;
+    if(s.mathRevision != oscRemote.mathRevision && acqSetMath(frontEnd, s.math, (float)(1.0 / oscStoreRate())) != STATUS_OK){
+        __err("[oscApplyRemote] MATH:DEFine \"%s\" ignored (no --math slot, or it does not compile)", s.math);
+    }
+    oscRemote = s;
+    double samplesPerCol = s.timebase * OSC_GRID_DIV_X * oscStoreRate() / screenW;
+    REPTT(uint8_t, i, 0, OSC_MAX_CHANNELS) oscChannels[i].view.samplesPerCol = samplesPerCol;
+    screenFlag setFlag (BUFFER_FLUSH);
+}
+
+/// SEARCH ////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief Rising edges of channel 0 through the middle of its view, 5% hysteresis.
+ */
+void oscDefaultSearch(){
+    const oscView_t *v = &oscChannels[0].view;
+    float     mid = (v->yMin + v->yMax) / 2, hys = (v->yMax - v->yMin) / 20;
+    srQuery_t q;
+    memset(&q, 0, sizeof(q));
+    q.kind     = SR_EDGE;
+    q.polarity = SR_POSITIVE;
+    q.lo       = mid - hys;
+    q.hi       = mid + hys;
+    srSetQuery(oscSearch, oscChannels[0].ss, &q);
+}
+
+/**
+ * @brief Ask for a jump to the next (dir > 0) or previous search event. Any thread.
+ *
+ * Views belong to the render thread: the request is applied there by
+ * oscApplyJump(), like remote settings by oscApplyRemote().
+ */
+void oscRequestJump(int dir){
+    __atomic_store_n(&oscJump, (int8_t)(dir > 0 ? 1 : -1), __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Ask for a jump to the next (dir > 0) or previous decoded packet. Any thread.
+ */
+void oscRequestPacketJump(int dir){
+    __atomic_store_n(&oscPacketJump, (int8_t)(dir > 0 ? 1 : -1), __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Centre every channel on the requested search event or decoded packet. Render thread.
+ *
+ * Only looks the position up in the index (or the decoder's annotation
+ * ring); the scan itself runs once per frame in the main loop (srUpdate,
+ * oscFeedLogic), however often the key is pressed.
+ */
+void oscApplyJump(){
+    int8_t dir    = __atomic_exchange_n(&oscJump, 0, __ATOMIC_ACQUIRE);
+    int8_t packet = __atomic_exchange_n(&oscPacketJump, 0, __ATOMIC_ACQUIRE);
+    if(dir == 0 && (packet == 0 || __is_null(oscDecoder))) return;
+    const oscView_t *v = &oscChannels[0].view;
+    double    centre = v->start + v->samplesPerCol * screenW / 2;
+    uint64_t  at = (uint64_t)__max(0.0, floor(centre + 0.5));
+    srEvent_t ev;
+    if(dir == 0){
+        /// Any annotation of the decoder
+        const srPacketQuery_t any = {-1, -1, 0, 0};
+        dir = packet;
+        if(!(dir > 0 ? srNextPacket(oscDecoder, &any, at, &ev) : srPrevPacket(oscDecoder, &any, at, &ev))){
+            __log("[oscApplyJump] no %s packet", dir > 0 ? "next" : "previous");
+            return;
+        }
+        __log("[oscApplyJump] packet %llu at sample %llu", (unsigned long long)ev.index + 1, (unsigned long long)ev.pos);
+    }else{
+        if(!(dir > 0 ? srNext(oscSearch, at, &ev) : srPrev(oscSearch, at, &ev))){
+            __log("[oscApplyJump] no %s event", dir > 0 ? "next" : "previous");
+            return;
+        }
+        __log("[oscApplyJump] event %llu of %llu at sample %llu", (unsigned long long)ev.index + 1,
+            (unsigned long long)srCount(oscSearch), (unsigned long long)ev.pos);
+    }
+    REPTT(uint8_t, i, 0, OSC_MAX_CHANNELS){
+        oscView_t *w = &oscChannels[i].view;
+        w->start = (double)ev.pos - w->samplesPerCol * screenW / 2;
+    }
+    screenFlag setFlag (BUFFER_FLUSH);
+}
+
+/// RECORDS ///////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief Log the mask test counters.
+ */
+void oscLogMask(){
+    if(__is_null(oscMask)) return;
+    __log("[mask] %llu tests, %llu passed, %llu failed, %llu columns refined", (unsigned long long)oscMask->tests,
+          (unsigned long long)oscMask->passes, (unsigned long long)oscMask->fails, (unsigned long long)oscMask->nearCols);
+}
+
+/**
+ * @brief Take channel 0's new triggered records from oscSegments. Render thread.
+ *
+ * A record is one segment, trigger in the middle, copied out of its slot
+ * into oscRecord. The mask test and the averager keep their own cursor in
+ * segments completed, so a restart of one leaves the other alone; segments
+ * already overwritten are skipped. In mask mode the first record after a
+ * restart becomes the golden waveform (+- --mask-tol, one column either
+ * side), every later one is tested against it. In average mode every record,
+ * boxcar-averaged by --hires first, goes into oscAverager and oscAverage is
+ * read back once.
+ */
+void oscAcquire(){
+    segStore_t *sg = __atomic_load_n(&oscSegments, __ATOMIC_ACQUIRE);
+    if(__is_null(sg) || __is_null(oscRecord) || !(screenFlag & (fMask(MASK) | fMask(AVERAGE)))) return;
+    const uint32_t len = oscConf.recordLength;
+    const uint64_t total = sg->total, first = total - sg->count;
+    averager_t    *av  = (screenFlag hasFlag (AVERAGE)) ? __atomic_load_n(&oscAverager, __ATOMIC_ACQUIRE) : NULL;
+    const uint8_t  mask = (screenFlag hasFlag (MASK)) != 0;
+    if(maskRestart){
+        maskRestart  = 0;
+        oscMaskArmed = 0;
+        oscMaskNext  = total;
+        mtResetStats(oscMask);
+    }
+    if(avRestart && __is_not_null(av)){
+        avRestart = 0;
+        oscAvNext = total;
+        avReset(av);
+    }
+    oscMaskNext = __max(oscMaskNext, first);
+    oscAvNext   = __max(oscAvNext, first);
+    uint64_t k = total;
+    if(mask)               k = oscMaskNext;
+    if(__is_not_null(av))  k = __min(k, oscAvNext);
+    uint32_t taken = 0;
+    for(; k < total; ++k){
+        if(segRead(sg, (uint32_t)(k - first), oscRecord) != len) continue;
+        ++taken;
+        if(__is_not_null(av) && k >= oscAvNext){
+            if(__is_not_null(oscHiRes)){
+                avBoxcar(workers, oscRecord, len, oscHiResBox(), OSC_FULL_SCALE, oscHiRes);
+                avAdd(av, oscHiRes);
+            }else avAdd(av, oscRecord);
+        }
+        if(!mask || k < oscMaskNext) continue;
+        if(!oscMaskArmed){
+            oscMaskArmed = mtFromGolden(oscMask, oscRecord, len, (float)oscConf.maskTol, 1) == STATUS_OK;
+            continue;
+        }
+        mtResult_t res;
+        mtRun(oscMask, oscRecord, len, &res);
+    }
+    if(mask)              oscMaskNext = total;
+    if(__is_not_null(av)) oscAvNext   = total;
+    if(taken == 0) return;
+    if(__is_not_null(av)) avRead(av, oscAverage);
+    screenFlag setFlag (BUFFER_FLUSH);
+}
+
+/**
+ * @brief Mask mode: the mask, channel 0's last record across the screen, and the counters.
+ */
+void oscDrawMask(rsTarget_t *t){
+    const oscChannel_t *ch = &oscChannels[0];
+    if(__is_null(ch->ss) || !oscMaskArmed) return;
+    const xy_t cols = __min(t->w, screenW);
+    mtDraw(t, oscMask, ch->view.yMin, ch->view.yMax, OSC_MASK_COLOR);
+    rsDecimateMinMax(oscRecord, oscConf.recordLength, colMin, colMax, cols);
+    rsDrawEnvelope(t, 0, colMin, colMax, cols, ch->view.yMin, ch->view.yMax, ch->color);
+
+    const fontAtlas_t *fa = __atomic_load_n(&oscFont, __ATOMIC_ACQUIRE);
+    if(__is_null(fa)) return;
+    char text[64];
+    snprintf(text, sizeof(text), "%s  pass %llu  fail %llu", oscMask->stopped ? "STOPPED" : "MASK",
+             (unsigned long long)oscMask->passes, (unsigned long long)oscMask->fails);
+    xy_t tw, th;
+    faTextSize(fa, text, &tw, &th);
+    faDrawText(fa, t, t->w - tw - 3, 3, text, oscMask->fails ? HEX32_RED : HEX32_LIME);
+}
+
+/**
+ * @brief Feed channel 0's new samples to the segment store. Render thread.
+ *
+ * Runs whatever the display mode, like the acquisition memory of a scope.
+ * Samples the store has already dropped are skipped; the segment store's
+ * sample count jumps with them so trigger indices stay absolute.
+ */
+void oscFeedSegments(){
+    segStore_t          *sg = __atomic_load_n(&oscSegments, __ATOMIC_ACQUIRE);
+    const oscChannel_t  *ch = &oscChannels[0];
+    if(__is_null(sg) || __is_null(ch->ss)) return;
+    if(segRetrigger){
+        segRetrigger = 0;
+        segSetTrigger(sg, (ch->view.yMin + ch->view.yMax) / 2, 1);
+    }
+    const uint64_t written = ssWritten(ch->ss), oldest = ssOldest(ch->ss);
+    if(oscSegNext < oldest){
+        oscSegNext = oldest;
+        sg->seen   = oldest;
+    }
+    uint32_t done = 0;
+    while(oscSegNext < written){
+        ssSpan_t span;
+        uint32_t n = ssGetSpan(ch->ss, oscSegNext, (uint32_t)__min(written - oscSegNext, (uint64_t)UINT32_MAX), &span);
+        if(n == 0) break;
+        done += segFeed(sg, span.p[0], span.n[0]);
+        if(span.n[1]) done += segFeed(sg, span.p[1], span.n[1]);
+        oscSegNext += n;
+    }
+    if(done && (screenFlag hasFlag (SEGMENTS))) screenFlag setFlag (BUFFER_FLUSH);
+}
+
+/**
+ * @brief Segments mode: the newest OSC_MAX_OVERLAY segments on top of each other, and the count.
+ */
+void oscDrawSegments(rsTarget_t *t){
+    const segStore_t   *sg = __atomic_load_n(&oscSegments, __ATOMIC_ACQUIRE);
+    const oscChannel_t *ch = &oscChannels[0];
+    if(__is_null(sg) || sg->count == 0) return;
+    uint32_t n = __min(sg->count, (uint32_t)OSC_MAX_OVERLAY);
+    segRenderOverlay(t, sg, sg->count - n, n, ch->view.yMin, ch->view.yMax, ch->color);
+
+    const fontAtlas_t *fa = __atomic_load_n(&oscFont, __ATOMIC_ACQUIRE);
+    if(__is_null(fa)) return;
+    char text[64];
+    snprintf(text, sizeof(text), "%u of %llu segments", sg->count, (unsigned long long)sg->total);
+    xy_t tw, th;
+    faTextSize(fa, text, &tw, &th);
+    faDrawText(fa, t, t->w - tw - 3, 3, text, ch->color | __combiRGBA(0, 0, 0, 255));
+}
+
+/// LOGIC /////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief Start the logic mode records over at sample `at`.
+ */
+void oscLogicRestart(uint64_t at){
+    laClear(oscLogic[0]);
+    laClear(oscLogic[1]);
+    oscLogicFill    = 0;
+    oscLogicDone    = 0;
+    oscLogicBase[0] = at;
+}
+
+/**
+ * @brief Append a packed chunk starting at oscLogicNext to the record being
+ * filled; a full record becomes the shown one and the other is refilled.
+ */
+void oscLogicRecord(const uint64_t * const *lines, uint32_t n){
+    uint32_t done = 0;
+    while(done < n){
+        logicStore_t *ls = oscLogic[oscLogicFill];
+        uint32_t      m  = (uint32_t)__min((uint64_t)(n - done), ls->depth - ls->written);
+        REPTT(uint32_t, i, 0, m){
+            uint64_t w = 0;
+            REPTT(uint8_t, l, 0, oscLogicLines) w |= (uint64_t)bsGet(lines[l], done + i) << l;
+            oscLogicWords[i] = w;
+        }
+        laWriteSamples(ls, oscLogicWords, m);
+        done += m;
+        if(ls->written < ls->depth) continue;
+        oscLogicFill ^= 1;
+        oscLogicDone  = 1;
+        laClear(oscLogic[oscLogicFill]);
+        oscLogicBase[oscLogicFill] = oscLogicNext + done;
+    }
+}
+
+/**
+ * @brief Threshold the new samples of the logic lines for the decoder and the logic records. Render thread.
+ *
+ * Each channel is packed 64 samples per word at the middle of its view with
+ * 5% hysteresis either side, one OSC_LOGIC_CHUNK at a time. The packed lines
+ * go to pdFeed() and, in logic mode, into the bit-plane records. When the
+ * stores have dropped samples not yet consumed, both restart at the oldest
+ * one; with neither consumer the cursor just follows the newest sample.
+ */
+void oscFeedLogic(){
+    const uint8_t show = (screenFlag hasFlag (LOGIC)) && __is_not_null(oscLogic[0]) && __is_not_null(oscLogic[1]);
+    if(oscLogicLines == 0 || __is_null(oscLogicIn) || __is_null(oscLogicBits) || __is_null(oscLogicWords)) return;
+    uint64_t written = UINT64_MAX, oldest = 0;
+    REPTT(uint8_t, l, 0, oscLogicLines){
+        const sampleStore_t *ss = oscChannels[l].ss;
+        if(__is_null(ss)) return;
+        written = __min(written, ssWritten(ss));
+        oldest  = __max(oldest, ssOldest(ss));
+    }
+    if(__is_null(oscDecoder) && !show){
+        oscLogicNext = written;
+        return;
+    }
+    if(logicRestart){
+        logicRestart = 0;
+        oscLogicRestart(__max(oscLogicNext, oldest));
+    }
+    if(oscLogicNext < oldest){
+        oscLogicNext = oldest;
+        if(__is_not_null(oscDecoder)) pdReset(oscDecoder, oldest, 1);
+        if(show) oscLogicRestart(oldest);
+    }
+    const uint64_t *lines[OSC_MAX_CHANNELS];
+    const uint64_t  before = __is_not_null(oscDecoder) ? oscDecoder->packets : 0;
+    const uint8_t   done   = oscLogicDone;
+    const uint64_t  base   = oscLogicBase[oscLogicFill ^ 1];
+    while(oscLogicNext < written){
+        uint32_t n = (uint32_t)__min(written - oscLogicNext, (uint64_t)OSC_LOGIC_CHUNK);
+        REPTT(uint8_t, l, 0, oscLogicLines){
+            const oscView_t *v = &oscChannels[l].view;
+            uint64_t *bits = oscLogicBits + (size_t)l * (OSC_LOGIC_CHUNK / 64);
+            if(ssRead(oscChannels[l].ss, oscLogicNext, n, oscLogicIn) != n) memset(oscLogicIn, 0, sizeof(float) * n);
+            bsPack(oscLogicIn, n, (v->yMin + v->yMax) / 2, (v->yMax - v->yMin) / 10, bits, &oscLogicLevel[l]);
+            lines[l] = bits;
+        }
+        if(__is_not_null(oscDecoder)) pdFeed(oscDecoder, lines, n);
+        if(show) oscLogicRecord(lines, n);
+        oscLogicNext += n;
+    }
+    if(__is_not_null(oscDecoder) && oscDecoder->packets != before) screenFlag setFlag (BUFFER_FLUSH);
+    if(show && (oscLogicDone != done || oscLogicBase[oscLogicFill ^ 1] != base)) screenFlag setFlag (BUFFER_FLUSH);
+}
+
+/**
+ * @brief Logic mode: the last complete record (the one filling until there is
+ * one), one lane per line, with the decoder's bars under it.
+ */
+void oscDrawLogic(rsTarget_t *t){
+    const uint8_t       k  = oscLogicDone ? oscLogicFill ^ 1 : oscLogicFill;
+    const logicStore_t *ls = oscLogic[k];
+    if(__is_null(ls) || oscLogicLines == 0) return;
+    const xy_t   bars = __is_not_null(oscDecoder) ? oscDecoder->ops->nRows * OSC_DECODE_ROW_H : 0;
+    const xy_t   lane = (t->h - bars) / oscLogicLines;
+    const double spc  = (double)ls->depth / t->w;
+    if(lane < 4) return;
+    REPTT(uint8_t, l, 0, oscLogicLines){
+        laRender(t, ls, l, 0.0, spc, l * lane + lane / 4, lane / 2, oscChannels[l].color);
+    }
+    if(__is_not_null(oscDecoder)){
+        pdRender(t, oscDecoder, __atomic_load_n(&oscFont, __ATOMIC_ACQUIRE), oscLogicBase[k], spc, t->h - bars, OSC_DECODE_ROW_H);
+    }
+}
+
+/**
+ * @brief The decoder's annotation bars along the bottom, under channel 0's view.
+ */
+void oscDrawDecode(rsTarget_t *t){
+    if(__is_null(oscDecoder)) return;
+    const oscView_t *v = &oscChannels[0].view;
+    const xy_t       y = t->h - oscDecoder->ops->nRows * OSC_DECODE_ROW_H;
+    pdRender(t, oscDecoder, __atomic_load_n(&oscFont, __ATOMIC_ACQUIRE), (uint64_t)__max(0.0, v->start),
+             __max(v->samplesPerCol, 1e-3), __max(0, y), OSC_DECODE_ROW_H);
+}
+
+/// LAYERS ////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief Static: background and graticule.
+ */
+void oscLayerBackground(rsTarget_t *t, void *ctx){
+    rsClear(t, oscBackground);
+    rsDrawGrid(t, OSC_GRID_DIV_X, OSC_GRID_DIV_Y, OSC_GRID_COLOR);
+}
+
+/**
+ * @brief Static: value labels of the first enabled channel on the horizontal grid lines.
+ *
+ * Glyphs are blended into the cache from oscFont; none until it is loaded.
+ */
+void oscLayerLabels(rsTarget_t *t, void *ctx){
+    const fontAtlas_t *fa = __atomic_load_n(&oscFont, __ATOMIC_ACQUIRE);
+    if(__is_null(fa)) return;
+    const oscChannel_t *ch = NULL;
+    REPTT(uint8_t, i, 0, OSC_MAX_CHANNELS){
+        if(__is_not_null(oscChannels[i].ss)){
+            ch = &oscChannels[i];
+            break;
+        }
+    }
+    if(__is_null(ch)) return;
+
+    const color_t fg = ch->color | __combiRGBA(0, 0, 0, 255);
+    REPTT(xy_t, j, 0, OSC_GRID_DIV_Y + 1){
+        char  text[16];
+        float v = ch->view.yMax - (ch->view.yMax - ch->view.yMin) * j / OSC_GRID_DIV_Y;
+        snprintf(text, sizeof(text), "%.3g", v);
+        xy_t y = (t->h - 1) * j / OSC_GRID_DIV_Y;
+        faDrawText(fa, t, 3, __max(0, __min(t->h - fa->h, y - fa->h / 2)), text, fg);
+    }
+}
+
+/**
+ * @brief XY mode: bin the samples of channel 0 against channel 1 that arrived
+ * since the last frame, halve the older counts, and colormap the histogram.
+ *
+ * Axis ranges come from the two channels' views. Only new points are binned,
+ * so the cost follows the sample rate and not the persistence.
+ */
+void oscDrawXY(rsTarget_t *t){
+    const oscChannel_t *cx = &oscChannels[0], *cy = &oscChannels[1];
+    density_t          *dn = __atomic_load_n(&xyDensity, __ATOMIC_ACQUIRE);
+    if(__is_null(dn) || __is_null(cx->ss) || __is_null(cy->ss)) return;
+    if(xyReset){
+        xyReset = 0;
+        xyNext  = 0;
+        dnFade(dn, 0);
+    }
+    dnSetRange(dn, cx->view.yMin, cx->view.yMax, cy->view.yMin, cy->view.yMax);
+    uint64_t end = __min(ssWritten(cx->ss), ssWritten(cy->ss));
+    if(end > xyNext){
+        uint64_t t0 = ltNow();
+        dnFade(dn, 1);
+        dnAccumulateStores(dn, cx->ss, cy->ss, xyNext, end - xyNext);
+        xyNext = end;
+        ltRecordSince(latency, LAT_REDUCE, t0);
+    }
+    dnRender(dn, t);
+}
+
+/**
+ * @brief Eye mode: fold the new samples of channel 0 and draw the eye.
+ *
+ * The decision threshold is the middle of the channel's view with 5%
+ * hysteresis, and the view's range is the vertical range.
+ */
+void oscDrawEye(rsTarget_t *t){
+    const oscChannel_t *ch = &oscChannels[0];
+    eyeDiagram_t       *ey = __atomic_load_n(&eye, __ATOMIC_ACQUIRE);
+    if(__is_null(ey) || __is_null(ch->ss)) return;
+    if(eyeRestart){
+        eyeRestart = 0;
+        float mid = (ch->view.yMin + ch->view.yMax) / 2, hys = (ch->view.yMax - ch->view.yMin) / 20;
+        eySetSource(ey, ch->ss, mid, hys, ch->view.yMin, ch->view.yMax);
+    }
+    uint64_t t0 = ltNow();
+    eyUpdate(ey);
+    ltRecordSince(latency, LAT_REDUCE, t0);
+    eyRender(ey, t);
+}
+
+/**
+ * @brief Log the eye measurements.
+ */
+void oscLogEye(){
+    eyStats_t           st;
+    const eyeDiagram_t *ey = __atomic_load_n(&eye, __ATOMIC_ACQUIRE);
+    if(__is_null(ey)) return;
+    eyGetStats(ey, &st);
+    __log("[eye] %llu UI, %llu edges, UI = %.4f samples", (unsigned long long)st.uis, (unsigned long long)st.edges, st.ui);
+    __log("[eye] height %.4g V (levels %.4g / %.4g), width %.3f UI", st.height, st.level0, st.level1, st.width);
+    __log("[eye] jitter (TIE) %.4f UI rms, %.4f UI pk-pk", st.tieRms, st.tiePkPk);
+}
+
+/**
+ * @brief Timing mode: every edge of channel 0's record, the chosen sequence's
+ * histogram in the top half and its trend against edge number in the bottom half.
+ *
+ * The record is the newest recordLength samples, so the analysis costs one
+ * record per frame however deep the ring is. Thresholds are the middle of
+ * the channel's view with 5% hysteresis, as in eye mode. The record is
+ * analyzed again only when it has new samples.
+ */
+void oscDrawTiming(rsTarget_t *t){
+    const oscChannel_t *ch = &oscChannels[0];
+    timing_t           *tm = __atomic_load_n(&oscTiming, __ATOMIC_ACQUIRE);
+    if(__is_null(ch->ss) || __is_null(tm)) return;
+    uint64_t written = ssWritten(ch->ss);
+    tmSeries_t series = (tmSeries_t) __atomic_load_n(&timingSeries, __ATOMIC_ACQUIRE);
+    if(__atomic_exchange_n(&timingRestart, 0, __ATOMIC_ACQUIRE) || written != timingAt){
+        float mid = (ch->view.yMin + ch->view.yMax) / 2, hys = (ch->view.yMax - ch->view.yMin) / 20;
+        uint64_t t0 = ltNow();
+        tmSetLevels(tm, mid - hys, mid + hys);
+        uint64_t start = __max(ssOldest(ch->ss), written - __min(written, (uint64_t)oscConf.recordLength));
+        tmAnalyze(tm, ch->ss, start, written - start);
+        ltRecordSince(latency, LAT_REDUCE, t0);
+        timingAt = written;
+    }
+    xy_t       half   = t->h / 2;
+    rsTarget_t top    = {t->px, t->w, half, t->pitch};
+    rsTarget_t bottom = {t->px + (size_t)half * t->pitch, t->w, t->h - half, t->pitch};
+    tmRenderHistogram(tm, series, &top, ch->color);
+    rsHSpan(t, half, 0, t->w - 1, OSC_GRID_COLOR);
+    tmRenderTrend(tm, series, &bottom, ch->color);
+}
+
+/**
+ * @brief Log the timing statistics of the last analysis, in seconds.
+ */
+void oscLogTiming(){
+    static const char *names[TM_N_SERIES] = {"TIE", "period", "width"};
+    const double dt = 1.0 / oscStoreRate();
+    tmStats_t       st;
+    const timing_t *tm = __atomic_load_n(&oscTiming, __ATOMIC_ACQUIRE);
+    if(__is_null(tm)) return;
+    __log("[timing] %llu edges, clock %.6g s", (unsigned long long)tm->nEdges, tm->clockPeriod * dt);
+    REPTT(uint8_t, s, 0, TM_N_SERIES){
+        tmGetStats(tm, (tmSeries_t) s, &st);
+        __log("[timing] %-6s n %llu, mean %.6g s, sdev %.4g s, min %.6g s, max %.6g s", names[s],
+              (unsigned long long)st.n, st.mean * dt, st.sdev * dt, st.min * dt, st.max * dt);
+    }
+}
+
+/**
+ * @brief Ask for OSC_LOG_* measurements to be logged. Any thread.
+ *
+ * The eye, the timing analyzer and the mask tester belong to the render
+ * thread: the request is applied there by oscApplyLog(), like jumps.
+ */
+void oscRequestLog(uint8_t what){
+    __atomic_fetch_or(&oscLogRequest, what, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Log what was requested since the last frame. Render thread, before
+ * the records and plots that the log describes move on.
+ */
+void oscApplyLog(){
+    uint8_t what = __atomic_exchange_n(&oscLogRequest, 0, __ATOMIC_ACQUIRE);
+    if(what & OSC_LOG_EYE)    oscLogEye();
+    if(what & OSC_LOG_TIMING) oscLogTiming();
+    if(what & OSC_LOG_MASK)   oscLogMask();
+}
+
+/**
+ * @brief Dynamic: every enabled channel (channel 0 averaged in average mode)
+ * and the decoder's annotation bars, or the XY histogram / the eye / the
+ * timing / the mask / the segment / the logic plots in those modes.
+ */
+void oscLayerTraces(rsTarget_t *t, void *ctx){
+    if(screenFlag hasFlag (XY)){
+        oscDrawXY(t);
+        return;
+    }
+    if(screenFlag hasFlag (EYE)){
+        oscDrawEye(t);
+        return;
+    }
+    if(screenFlag hasFlag (TIMING)){
+        oscDrawTiming(t);
+        return;
+    }
+    if(screenFlag hasFlag (MASK)){
+        oscDrawMask(t);
+        return;
+    }
+    if(screenFlag hasFlag (SEGMENTS)){
+        oscDrawSegments(t);
+        return;
+    }
+    if(screenFlag hasFlag (LOGIC)){
+        oscDrawLogic(t);
+        return;
+    }
+    const averager_t *av = (screenFlag hasFlag (AVERAGE)) ? __atomic_load_n(&oscAverager, __ATOMIC_ACQUIRE) : NULL;
+    REPTT(uint8_t, i, 0, OSC_MAX_CHANNELS){
+        const oscChannel_t *ch = &oscChannels[i];
+        if(__is_null(ch->ss)) continue;
+        if(i == 0 && __is_not_null(av) && av->records > 0){
+            /// One averaged record across the screen in place of the live trace
+            const xy_t cols = __min(t->w, screenW);
+            rsDecimateMinMax(oscAverage, av->length, colMin, colMax, cols);
+            rsDrawEnvelope(t, 0, colMin, colMax, cols, ch->view.yMin, ch->view.yMax, ch->color);
+            continue;
+        }
+        oscDrawChannel(t, ch->ss, __atomic_load_n(&ch->history, __ATOMIC_ACQUIRE), &ch->view, ch->ip, ch->color);
+    }
+    oscDrawDecode(t);
+}
+
+/**
+ * @brief Static layers are stale: call after a resize or a change of
+ * oscBackground or of a channel's view, color or enable state.
+ */
+void oscInvalidateStatic(){
+    cmpInvalidate(compositor);
+    screenFlag setFlag (BUFFER_FLUSH);
+}
+
+/**
+ * @brief Once the font loader is done, redraw the static layers with labels. Render thread.
+ */
+void oscPollStartup(){
+    if(oscFontShown || __is_null(__atomic_load_n(&oscFont, __ATOMIC_ACQUIRE))) return;
+    oscFontShown = 1;
+    oscInvalidateStatic();
+}
+
+/**
+ * @brief The compose pass: the cached static layers, then the traces, drawn into t.
+ */
+void oscComposeFrame(rsTarget_t *t){
+    uint64_t t0 = ltNow();
+    cmpCompose(compositor, t);
+    ltRecordSince(latency, LAT_COMPOSE, t0);
+}
+
+/**
+ * @brief Upload color_t pixels to a texture (all of it when rect is NULL).
+ *
+ * If the renderer's format is color_t's this is SDL_UpdateTexture(). If not,
+ * pfConvert() reorders the channels straight into the locked texture, so SDL
+ * has nothing left to convert. Pitch in pixels.
+ */
+void oscUpload(SDL_Texture *tex, const SDL_Rect *rect, const color_t *px, xy_t pitch){
+    if(!mainWindow->convert){
+        SDL_UpdateTexture(tex, rect, px, pitch * sizeof(color_t));
+        return;
+    }
+    void *pixels;
+    int   texPitch;
+    if(SDL_LockTexture(tex, rect, &pixels, &texPitch) != 0){
+        __err("[oscUpload] SDL_LockTexture failed: %s", SDL_GetError());
+        return;
+    }
+    pfConvertRect(px, pitch, (uint32_t *) pixels, (xy_t)(texPitch / (int)sizeof(uint32_t)),
+                  __is_null(rect) ? screenW : rect->w, __is_null(rect) ? screenH : rect->h, &pfColorLayout, &textureLayout);
+    SDL_UnlockTexture(tex);
+}
+
+/**
+ * @brief Upload the static cache to staticTexture, only when the compositor redrew it.
+ */
+void oscUploadStatic(){
+    cmpRefresh(compositor);
+    if(__is_not_null(staticTexture) && staticTextureRev != compositor->rebuilds){
+        oscUpload(staticTexture, NULL, compositor->cache.px, compositor->cache.pitch);
+        staticTextureRev = compositor->rebuilds;
+    }
+}
+
+/**
+ * @brief Submit the static cache and the trace layer through the renderer.
+ *
+ * The static cache is uploaded only when the compositor redrew it; the
+ * trace layer is rebuilt every frame into the same vertex buffers.
+ */
+void oscRenderGeometry(){
+    oscUploadStatic();
+    uint64_t t0 = ltNow();
+    gbClear(geomTraces);
+    REPTT(uint8_t, i, 0, OSC_MAX_CHANNELS){
+        const oscChannel_t *ch = &oscChannels[i];
+        if(__is_null(ch->ss)) continue;
+        uint64_t t1 = ltNow();
+        uint8_t  trace = oscReduceChannel(ch->ss, __atomic_load_n(&ch->history, __ATOMIC_ACQUIRE), &ch->view, ch->ip, screenW);
+        ltRecordSince(latency, LAT_REDUCE, t1);
+        if(trace){
+            xy_t first, n = oscTraceRun(screenW, &first);
+            gbTrace(geomTraces, (float)first, colMin + first, n, ch->view.yMin, ch->view.yMax, screenH, 1.0f, ch->color);
+        }else{
+            gbEnvelope(geomTraces, 0, colMin, colMax, screenW, ch->view.yMin, ch->view.yMax, screenH, ch->color);
+        }
+    }
+    t0 = ltRecordSince(latency, LAT_COMPOSE, t0);
+    SDL_RenderCopy(mainWindow->renderer, staticTexture, NULL, NULL);
+    gbSubmit(geomTraces, mainWindow->renderer);
+    ltRecordSince(latency, LAT_UPLOAD, t0);
+}
+
+/**
+ * @brief Roll mode: draw the columns completed since the last frame into the ring.
+ *
+ * Columns are min/max envelopes of samplesPerCol samples (channel 0's
+ * timebase, at least one sample per column). Only the new columns are drawn,
+ * into rollStrip on a transparent background, and uploaded as one or two
+ * rectangles at rollHead; nothing already on screen is touched. On restart
+ * the ring is refilled from the store's history once.
+ */
+void oscRollAdvance(){
+    const double spc = __max(1.0, oscChannels[0].view.samplesPerCol);
+    uint64_t     written = UINT64_MAX;
+    REPTT(uint8_t, i, 0, OSC_MAX_CHANNELS){
+        if(__is_not_null(oscChannels[i].ss)) written = __min(written, ssWritten(oscChannels[i].ss));
+    }
+    if(written == UINT64_MAX || __is_null(rollTexture)) return;
+    if(rollRestart){
+        rollRestart = 0;
+        rollHead    = 0;
+        rollPos     = __max(0.0, floor((double)written - screenW * spc));
+        memset(rollStrip, 0, sizeof(color_t) * screenW * screenH);
+        oscUpload(rollTexture, NULL, rollStrip, screenW);
+    }
+    if((double)written < rollPos + spc) return;
+    uint64_t cols = (uint64_t)(((double)written - rollPos) / spc);
+    if(cols > (uint64_t)screenW){
+        /// More than a screen behind: skip what would scroll straight out
+        uint64_t skip = cols - screenW;
+        rollHead = (xy_t)((rollHead + skip) % screenW);
+        rollPos += skip * spc;
+        cols     = screenW;
+    }
+    while(cols > 0){
+        xy_t       k = (xy_t)__min(cols, (uint64_t)(screenW - rollHead));
+        rsTarget_t strip = {rollStrip, k, screenH, k};
+        rsClear(&strip, 0x00000000);
+        REPTT(uint8_t, i, 0, OSC_MAX_CHANNELS){
+            const oscChannel_t *ch = &oscChannels[i];
+            if(__is_null(ch->ss)) continue;
+            oscView_t v = ch->view;
+            v.start         = rollPos;
+            v.samplesPerCol = spc;
+            oscReduceChannel(ch->ss, __atomic_load_n(&ch->history, __ATOMIC_ACQUIRE), &v, NULL, k);
+            rsDrawEnvelope(&strip, 0, colMin, colMax, k, v.yMin, v.yMax, ch->color);
+        }
+        SDL_Rect r = {rollHead, 0, k, screenH};
+        oscUpload(rollTexture, &r, rollStrip, k);
+        rollHead = (rollHead + k) % screenW;
+        rollPos += k * spc;
+        cols    -= k;
+    }
+}
+
+/**
+ * @brief Roll mode frame: the static cache, then the ring in two copies.
+ *
+ * The scroll costs no pixel moves: the oldest column (rollHead) goes to the
+ * left edge with one SDL_RenderCopy, the columns before it wrap to the right.
+ */
+void oscRenderRoll(){
+    oscUploadStatic();
+    uint64_t t0 = ltNow();
+    oscRollAdvance();
+    t0 = ltRecordSince(latency, LAT_COMPOSE, t0);
+    SDL_RenderCopy(mainWindow->renderer, staticTexture, NULL, NULL);
+    SDL_Rect src0 = {rollHead, 0, screenW - rollHead, screenH}, dst0 = {0, 0, screenW - rollHead, screenH};
+    SDL_RenderCopy(mainWindow->renderer, rollTexture, &src0, &dst0);
+    if(rollHead > 0){
+        SDL_Rect src1 = {0, 0, rollHead, screenH}, dst1 = {screenW - rollHead, 0, rollHead, screenH};
+        SDL_RenderCopy(mainWindow->renderer, rollTexture, &src1, &dst1);
+    }
+    ltRecordSince(latency, LAT_UPLOAD, t0);
+}
+
+/**
+ * @brief Render a frame into the back buffer with the selected backend.
+ *
+ * GEOMETRY submits batched triangles through the renderer. Otherwise the
+ * compose pass runs on the CPU: with ZERO_COPY it writes through the
+ * pointer returned by SDL_LockTexture, honouring its pitch, so no
+ * full-frame copy is made; without it (or if the lock fails) it goes
+ * through screenBuffer and oscUpload(). When the texture format is not
+ * color_t's, ZERO_COPY is skipped: the frame is composed in screenBuffer and
+ * converted once, into the locked texture. Call with sdlMutex held.
+ */
+void oscRenderFrame(){
+    if(screenFlag hasFlag (ROLL)){
+        oscRenderRoll();
+        return;
+    }
+    /// The XY, eye, timing, mask, average, segment, logic plots and decoder bars are pixel layers: always composed on the CPU
+    if((screenFlag hasFlag (GEOMETRY)) && __is_null(oscDecoder)
+    && !(screenFlag & (fMask(XY) | fMask(EYE) | fMask(TIMING) | fMask(MASK) | fMask(AVERAGE) | fMask(SEGMENTS) | fMask(LOGIC)))){
+        oscRenderGeometry();
+        return;
+    }
+    if((screenFlag hasFlag (ZERO_COPY)) && !mainWindow->convert){
+        void *pixels;
+        int   pitch;
+        if(SDL_LockTexture(mainWindow->texture, NULL, &pixels, &pitch) == 0){
+            rsTarget_t target = {(color_t *) pixels, screenW, screenH, (xy_t)(pitch / (int)sizeof(color_t))};
+            oscComposeFrame(&target);
+            uint64_t t0 = ltNow();
+            SDL_UnlockTexture(mainWindow->texture);
+            SDL_RenderCopy(mainWindow->renderer, mainWindow->texture, NULL, NULL);
+            ltRecordSince(latency, LAT_UPLOAD, t0);
+            return;
+        }
+        __err("[oscRenderFrame] SDL_LockTexture failed: %s, falling back to copy", SDL_GetError());
+        screenFlag clrFlag (ZERO_COPY);
+    }
+    rsTarget_t target = {screenBuffer, screenW, screenH, screenW};
+    __entryCriticalSection(&scrBufMutex);
+    oscComposeFrame(&target);
+    uint64_t t0 = ltNow();
+    oscUpload(mainWindow->texture, NULL, screenBuffer, screenW);
+    __exitCriticalSection(&scrBufMutex);
+    SDL_RenderCopy(mainWindow->renderer, mainWindow->texture, NULL, NULL);
+    ltRecordSince(latency, LAT_UPLOAD, t0);
+}
+
+/**
+ * @brief Ingest stamp of the stalest channel's newest sample (0 = no data).
+ */
+uint64_t oscIngestStamp(){
+    uint64_t stamp = 0;
+    REPTT(uint8_t, i, 0, OSC_MAX_CHANNELS){
+        uint64_t s = ssStamp(oscChannels[i].ss);
+        if(s != 0 && (stamp == 0 || s < stamp)) stamp = s;
+    }
+    return stamp;
+}
+
 /// THREADS ///////////////////////////////////////////////////////////////////////////////////////
 
+/**
+ * @brief Acquisition thread: --source frames into pool blocks, ingested into the channel stores.
+ *
+ * The only producer of oscStores, through the --decimate filters. Frames
+ * are paced at --sample-rate (the source rate); a
+ * regular file is replayed from the start when it ends, any other source
+ * (FIFO, pipe) ends the acquisition.
+ */
+int acquisitionService(void *pv){
+    __entry("acquisitionService()");
+    FILE *f = fopen(oscConf.source, "rb");
+    if(__is_null(f)){
+        __err("[acquisitionService] Cannot open %s: %s", oscConf.source, strerror(errno));
+        return -1;
+    }
+    struct stat st;
+    const uint8_t  replay = fstat(fileno(f), &st) == 0 && S_ISREG(st.st_mode);
+    const size_t   frame  = sizeof(float) * frontEnd->nChannels;
+    const uint64_t t0     = ltNow();
+    uint64_t       frames = 0;
+    while(statusFlag hasFlag (RUNNING)){
+        float *block = acqGetBlock(frontEnd);
+        if(__is_null(block)) break;
+        size_t got = fread(block, frame, frontEnd->blockFrames, f);
+        if(got > 0) acqIngest(frontEnd, block, (uint32_t)got);
+        acqPutBlock(frontEnd, block);
+        frames += got;
+        if(got < frontEnd->blockFrames){
+            if(!replay || ferror(f) || frames == 0) break;
+            rewind(f);
+        }
+        /// Ahead of the sample rate: wait for the wall clock
+        double ahead = frames / oscConf.sampleRate - (ltNow() - t0) / 1e9;
+        if(ahead > 1e-3) SDL_Delay((uint32_t)(ahead * 1e3));
+    }
+    fclose(f);
+    __log("[acquisitionService] %llu frames from %s", (unsigned long long)frames, oscConf.source);
+    __exit("acquisitionService()");
+    return 0;
+}
+
 int inputService(void * pv){
     __entry("inputService()");
     SDL_Event e;
@@ -67,6 +1367,11 @@ int inputService(void * pv){
         while (SDL_PollEvent(&e)) {
             switch (e.type)
             {
+                case SDL_WINDOWEVENT:
+                    if(e.window.event == SDL_WINDOWEVENT_SIZE_CHANGED){
+                        oscInvalidateStatic();
+                    }
+                    break;
                 case SDL_QUIT:
                     __log("Event <SDL_QUIT> occured!");
                     statusFlag = statusFlag & fInvMask(RUNNING) | fMask(STOPPED);
@@ -79,6 +1384,128 @@ int inputService(void * pv){
                     if(e.key.keysym.sym == SDLK_c){
                         __log("Event <SDL_KEYDOWN | SDLK_c> occured!");
                     }else 
+                    if(e.key.keysym.sym == SDLK_s){
+                        mpLogStats();
+                    }else 
+                    if(e.key.keysym.sym == SDLK_l){
+                        ltLog(latency);
+                        if(oscConf.latencyFile[0]) ltDump(latency, oscConf.latencyFile);
+                    }else 
+                    if(e.key.keysym.sym == SDLK_g){
+                        screenFlag ^= fMask(GEOMETRY);
+                        screenFlag setFlag (BUFFER_FLUSH);
+                        __log("Backend: %s", (screenFlag hasFlag (GEOMETRY)) ? "geometry" : "raster");
+                    }else 
+                    if(e.key.keysym.sym == SDLK_n || e.key.keysym.sym == SDLK_p){
+                        oscRequestJump(e.key.keysym.sym == SDLK_n ? 1 : -1);
+                    }else 
+                    if(e.key.keysym.sym == SDLK_PERIOD || e.key.keysym.sym == SDLK_COMMA){
+                        oscRequestPacketJump(e.key.keysym.sym == SDLK_PERIOD ? 1 : -1);
+                    }else 
+                    if(e.key.keysym.sym == SDLK_e){
+                        if(screenFlag hasFlag (EYE)) oscRequestLog(OSC_LOG_EYE);
+                        eyeRestart = 1;
+                        screenFlag ^= fMask(EYE);
+                        screenFlag clrFlag (XY);
+                        screenFlag clrFlag (ROLL);
+                        screenFlag clrFlag (TIMING);
+                        screenFlag clrFlag (MASK);
+                        screenFlag clrFlag (SEGMENTS);
+                        screenFlag clrFlag (LOGIC);
+                        screenFlag setFlag (BUFFER_FLUSH);
+                        __log("Display: %s", (screenFlag hasFlag (EYE)) ? "eye" : "YT");
+                    }else 
+                    if(e.key.keysym.sym == SDLK_r){
+                        rollRestart = 1;
+                        screenFlag ^= fMask(ROLL);
+                        screenFlag clrFlag (XY);
+                        screenFlag clrFlag (EYE);
+                        screenFlag clrFlag (TIMING);
+                        screenFlag clrFlag (MASK);
+                        screenFlag clrFlag (SEGMENTS);
+                        screenFlag clrFlag (LOGIC);
+                        screenFlag setFlag (BUFFER_FLUSH);
+                        __log("Display: %s", (screenFlag hasFlag (ROLL)) ? "roll" : "YT");
+                    }else 
+                    if(e.key.keysym.sym == SDLK_x){
+                        xyReset = 1;
+                        screenFlag ^= fMask(XY);
+                        screenFlag clrFlag (EYE);
+                        screenFlag clrFlag (ROLL);
+                        screenFlag clrFlag (TIMING);
+                        screenFlag clrFlag (MASK);
+                        screenFlag clrFlag (SEGMENTS);
+                        screenFlag clrFlag (LOGIC);
+                        screenFlag setFlag (BUFFER_FLUSH);
+                        __log("Display: %s", (screenFlag hasFlag (XY)) ? "XY" : "YT");
+                    }else 
+                    if(e.key.keysym.sym == SDLK_t){
+                        /// TIE -> period -> width -> off
+                        static const char *names[TM_N_SERIES] = {"TIE", "period", "width"};
+                        uint8_t series = TM_TIE;
+                        if(!(screenFlag hasFlag (TIMING))){
+                            screenFlag setFlag (TIMING);
+                        }else{
+                            oscRequestLog(OSC_LOG_TIMING);
+                            series = timingSeries + 1;
+                            if(series >= TM_N_SERIES) screenFlag clrFlag (TIMING);
+                        }
+                        if(series < TM_N_SERIES) __atomic_store_n(&timingSeries, series, __ATOMIC_RELEASE);
+                        timingRestart = 1;
+                        screenFlag clrFlag (XY);
+                        screenFlag clrFlag (EYE);
+                        screenFlag clrFlag (ROLL);
+                        screenFlag clrFlag (MASK);
+                        screenFlag clrFlag (SEGMENTS);
+                        screenFlag clrFlag (LOGIC);
+                        screenFlag setFlag (BUFFER_FLUSH);
+                        __log("Display: %s", (screenFlag hasFlag (TIMING)) ? names[series] : "YT");
+                    }else 
+                    if(e.key.keysym.sym == SDLK_m){
+                        if(screenFlag hasFlag (MASK)) oscRequestLog(OSC_LOG_MASK);
+                        maskRestart  = 1;
+                        segRetrigger = 1;
+                        screenFlag ^= fMask(MASK);
+                        screenFlag clrFlag (XY);
+                        screenFlag clrFlag (EYE);
+                        screenFlag clrFlag (ROLL);
+                        screenFlag clrFlag (TIMING);
+                        screenFlag clrFlag (SEGMENTS);
+                        screenFlag clrFlag (LOGIC);
+                        screenFlag setFlag (BUFFER_FLUSH);
+                        __log("Display: %s", (screenFlag hasFlag (MASK)) ? "mask" : "YT");
+                    }else 
+                    if(e.key.keysym.sym == SDLK_o){
+                        segRetrigger = 1;
+                        screenFlag ^= fMask(SEGMENTS);
+                        screenFlag clrFlag (XY);
+                        screenFlag clrFlag (EYE);
+                        screenFlag clrFlag (ROLL);
+                        screenFlag clrFlag (TIMING);
+                        screenFlag clrFlag (MASK);
+                        screenFlag clrFlag (LOGIC);
+                        screenFlag setFlag (BUFFER_FLUSH);
+                        __log("Display: %s", (screenFlag hasFlag (SEGMENTS)) ? "segments" : "YT");
+                    }else 
+                    if(e.key.keysym.sym == SDLK_d){
+                        logicRestart = 1;
+                        screenFlag ^= fMask(LOGIC);
+                        screenFlag clrFlag (XY);
+                        screenFlag clrFlag (EYE);
+                        screenFlag clrFlag (ROLL);
+                        screenFlag clrFlag (TIMING);
+                        screenFlag clrFlag (MASK);
+                        screenFlag clrFlag (SEGMENTS);
+                        screenFlag setFlag (BUFFER_FLUSH);
+                        __log("Display: %s", (screenFlag hasFlag (LOGIC)) ? "logic" : "YT");
+                    }else 
+                    if(e.key.keysym.sym == SDLK_a){
+                        avRestart    = 1;
+                        segRetrigger = 1;
+                        screenFlag ^= fMask(AVERAGE);
+                        screenFlag setFlag (BUFFER_FLUSH);
+                        __log("Average: %s (%u records)", (screenFlag hasFlag (AVERAGE)) ? "on" : "off", oscConf.averages);
+                    }else 
                     if(SDLK_0 <= e.key.keysym.sym && e.key.keysym.sym <= SDLK_9){
                         uint8_t i = e.key.keysym.sym - SDLK_0;
                     }
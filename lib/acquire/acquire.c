@@ -0,0 +1,170 @@
+#include "acquire.h"
+
+#include "../../include/global.h"
+
+status_t createAcquire(acquire_t **aq, uint8_t nChannels, sampleStore_t * const *stores, uint32_t blockFrames,
+                       const decimatorConfig_t *dec){
+    __entry("createAcquire(%p, %u, %p, %u, %p)", aq, nChannels, stores, blockFrames, dec);
+    if(__is_null(aq) || __is_null(stores) || nChannels == 0 || nChannels > ACQ_MAX_CHANNELS || blockFrames == 0){
+        __err("[createAcquire] Invalid params!");
+        return ERROR_INVALID_PARAMS;
+    }
+    *aq = (acquire_t *) mpCalloc(1, sizeof(acquire_t));
+    if(__is_null(*aq)){
+        __err("[createAcquire] malloc failed!");
+        return ERROR_UNKNOWN;
+    }
+    (*aq)->nChannels   = nChannels;
+    (*aq)->blockFrames = blockFrames;
+    REPTT(uint8_t, c, 0, nChannels) (*aq)->ss[c] = stores[c];
+    createPool(&(*aq)->blocks, sizeof(float) * (size_t)blockFrames * nChannels, ACQ_BLOCKS);
+    (*aq)->lane = (float *) mpAlloc(sizeof(float) * blockFrames);
+    if(__is_null((*aq)->blocks) || __is_null((*aq)->lane)){
+        __err("[createAcquire] malloc(%u frames) failed!", blockFrames);
+        destroyAcquire(aq);
+        return ERROR_UNKNOWN;
+    }
+    if(__is_not_null(dec) && dec->ratio > 1){
+        REPTT(uint8_t, c, 0, nChannels){
+            if(__is_null(stores[c])) continue;
+            status_t st = createDecimator(&(*aq)->df[c], dec);
+            if(st != STATUS_OK){
+                destroyAcquire(aq);
+                return st;
+            }
+        }
+    }
+    __exit("createAcquire()");
+    return STATUS_OK;
+}
+
+void destroyAcquire(acquire_t **aq){
+    if(__is_null(aq) || __is_null(*aq)) return;
+    REPTT(uint8_t, c, 0, ACQ_MAX_CHANNELS) destroyDecimator(&(*aq)->df[c]);
+    destroyMathChannel(&(*aq)->math);
+    destroyMathChannel(&(*aq)->mathNew);
+    mpFree((*aq)->mathSrc);
+    destroyPool(&(*aq)->blocks);
+    mpFree((*aq)->lane);
+    mpFree(*aq);
+    *aq = NULL;
+}
+
+float *acqGetBlock(acquire_t *aq){
+    return __is_null(aq) ? NULL : (float *) mpPoolGet(aq->blocks);
+}
+
+void acqPutBlock(acquire_t *aq, float *block){
+    if(__is_not_null(aq)) mpPoolPut(aq->blocks, block);
+}
+
+/// Newest index every channel the math reads has reached
+static uint64_t acqMathHead(const acquire_t *aq){
+    uint64_t head = UINT64_MAX, any = 0;
+    REPTT(uint8_t, c, 0, aq->nChannels){
+        if(__is_null(aq->ss[c])) continue;
+        uint64_t w = ssWritten(aq->ss[c]);
+        any = __max(any, w);
+        if(aq->math->srcMask & (1U << c)) head = __min(head, w);
+    }
+    return head == UINT64_MAX ? any : head;
+}
+
+/// Take a new expression: the math store skips ahead to the sources, zero filled
+static void acqMathSwitch(acquire_t *aq, mathChannel_t *mc){
+    destroyMathChannel(&aq->math);
+    aq->math     = mc;
+    aq->mathNext = acqMathHead(aq);
+    uint64_t w   = ssWritten(aq->mathSs), filled = 0;
+    while(w < aq->mathNext){
+        uint32_t n;
+        float *p = ssReserve(aq->mathSs, &n);
+        n = (uint32_t)__min((uint64_t)n, aq->mathNext - w);
+        /// Once the whole ring is zero, committing is enough
+        if(filled < aq->mathSs->size) memset(p, 0, sizeof(float) * n);
+        ssCommit(aq->mathSs, n);
+        filled += n;
+        w      += n;
+    }
+}
+
+static void acqMath(acquire_t *aq){
+    if(__is_null(aq->math)) return;
+
+    const uint64_t head = acqMathHead(aq);
+    const float   *src[ACQ_MAX_CHANNELS];
+    while(aq->mathNext < head){
+        uint32_t n;
+        float *out = ssReserve(aq->mathSs, &n);
+        n = (uint32_t)__min((uint64_t)__min(n, aq->blockFrames), head - aq->mathNext);
+        REPTT(uint8_t, c, 0, aq->nChannels){
+            src[c] = NULL;
+            if(!(aq->math->srcMask & (1U << c))) continue;
+            float *lane = aq->mathSrc + (size_t)c * aq->blockFrames;
+            if(ssRead(aq->ss[c], aq->mathNext, n, lane) != n) memset(lane, 0, sizeof(float) * n);
+            src[c] = lane;
+        }
+        mcEvaluate(aq->math, src, aq->nChannels, out, n);
+        ssCommit(aq->mathSs, n);
+        aq->mathNext += n;
+    }
+}
+
+void acqIngest(acquire_t *aq, const float *frames, uint32_t nFrames){
+    if(__is_null(aq) || __is_null(frames)) return;
+    nFrames = __min(nFrames, aq->blockFrames);
+    /// A new expression starts with this block
+    mathChannel_t *mc = __atomic_exchange_n(&aq->mathNew, NULL, __ATOMIC_ACQ_REL);
+    if(__is_not_null(mc)) acqMathSwitch(aq, mc);
+    REPTT(uint8_t, c, 0, aq->nChannels){
+        sampleStore_t *ss = aq->ss[c];
+        if(__is_null(ss)) continue;
+        const float *in = frames;
+        if(aq->nChannels > 1){
+            REPTT(uint32_t, i, 0, nFrames) aq->lane[i] = frames[(size_t)i * aq->nChannels + c];
+            in = aq->lane;
+        }
+        if(__is_not_null(aq->df[c])) dfPush(aq->df[c], in, nFrames, ss);
+        else                         ssWrite(ss, in, nFrames);
+    }
+    aq->frames += nFrames;
+    acqMath(aq);
+}
+
+status_t acqAttachMath(acquire_t *aq, sampleStore_t *ss){
+    __entry("acqAttachMath(%p, %p)", aq, ss);
+    if(__is_null(aq) || __is_null(ss) || __is_not_null(aq->mathSs)){
+        __err("[acqAttachMath] Invalid params!");
+        return ERROR_INVALID_PARAMS;
+    }
+    aq->mathSrc = (float *) mpAlloc(sizeof(float) * (size_t)aq->nChannels * aq->blockFrames);
+    if(__is_null(aq->mathSrc)){
+        __err("[acqAttachMath] malloc failed!");
+        return ERROR_UNKNOWN;
+    }
+    aq->mathSs = ss;
+    __exit("acqAttachMath()");
+    return STATUS_OK;
+}
+
+status_t acqSetMath(acquire_t *aq, const char *expr, float dt){
+    __entry("acqSetMath(%p, %s, %g)", aq, expr, dt);
+    if(__is_null(aq) || __is_null(aq->mathSs) || __is_null(expr)){
+        __err("[acqSetMath] Invalid params!");
+        return ERROR_INVALID_PARAMS;
+    }
+    mathChannel_t *mc = NULL;
+    status_t st = createMathChannel(&mc, expr, dt);
+    if(st != STATUS_OK) return st;
+    REPTT(uint8_t, c, 0, MC_MAX_SOURCES){
+        if((mc->srcMask & (1U << c)) && (c >= aq->nChannels || __is_null(aq->ss[c]))){
+            __err("[acqSetMath] '%s' reads CH%u, which has no store", expr, c + 1);
+            destroyMathChannel(&mc);
+            return ERROR_INVALID_PARAMS;
+        }
+    }
+    mc = __atomic_exchange_n(&aq->mathNew, mc, __ATOMIC_ACQ_REL);
+    destroyMathChannel(&mc);
+    __exit("acqSetMath()");
+    return STATUS_OK;
+}
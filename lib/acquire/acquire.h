@@ -0,0 +1,115 @@
+#ifndef __ACQUIRE_H__
+#define __ACQUIRE_H__
+
+#ifdef LOG_HEADER_INCLUDE
+#pragma message("INCLUDE: acquire.h")
+#endif
+
+#include <stdint.h>
+
+#include "../windowContext/windowContext.h"
+#include "../memPool/memPool.h"
+#include "../sampleStore/sampleStore.h"
+#include "../decimator/decimator.h"
+#include "../mathChannel/mathChannel.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ACQ_MAX_CHANNELS    8
+#define ACQ_BLOCKS          4                   /// Acquisition blocks in the pool
+
+/**
+ * @brief Acquisition front end: source blocks in, one sample store per channel out.
+ *
+ * A source fills blocks of interleaved frames (one float per channel) taken
+ * from a fixed pool, hands them to acqIngest() and puts them back. Ingest
+ * splits each block into its channels and appends them to their stores,
+ * through a decimator per channel when one is configured (source ->
+ * decimator -> store), so every later stage runs at the reduced rate.
+ * Everything runs on the calling (producer) thread; the stores are the only
+ * thing shared with readers.
+ *
+ * An optional math slot evaluates an expression over the stored channels
+ * right after each ingest, block by block, into its own store. Math sample
+ * k is computed from source samples k, so all stores share one index.
+ */
+typedef struct acquire_t {
+    uint8_t         nChannels;                  /// Samples per frame
+    uint32_t        blockFrames;                /// Frames per pool block
+    sampleStore_t * ss[ACQ_MAX_CHANNELS];       /// Destination per channel, NULL = dropped (not owned)
+    mpPool_t *      blocks;                     /// blockFrames * nChannels floats each
+    float *         lane;                       /// One channel of a block, deinterleaved
+    decimator_t *   df[ACQ_MAX_CHANNELS];       /// Per channel, NULL = stored at the source rate
+    uint64_t        frames;                     /// Frames ingested
+
+    /// Math slot
+    sampleStore_t * mathSs;                     /// Destination of the math channel, NULL = no slot (not owned)
+    mathChannel_t * math;                       /// Expression being evaluated (producer thread only)
+    mathChannel_t * mathNew;                    /// Handed over by acqSetMath(), taken by the producer
+    float *         mathSrc;                    /// [nChannels][blockFrames] referenced channels read back
+    uint64_t        mathNext;                   /// Absolute index of the next math sample
+} acquire_t;
+
+/**
+ * @brief Create a front end.
+ *
+ * @param[out] aq           Pointer to a front end pointer. Will be allocated inside.
+ * @param[in]  nChannels    Samples per frame, 1 ... ACQ_MAX_CHANNELS.
+ * @param[in]  stores       nChannels destination stores, entries may be NULL.
+ * @param[in]  blockFrames  Frames per acquisition block.
+ * @param[in]  dec          Decimation applied to every channel, NULL or ratio 1 = none.
+ *
+ * @return STATUS_OK on success, ERROR_INVALID_PARAMS or ERROR_UNKNOWN on failure.
+ */
+status_t createAcquire(acquire_t **aq, uint8_t nChannels, sampleStore_t * const *stores, uint32_t blockFrames,
+                       const decimatorConfig_t *dec);
+
+/**
+ * @brief Destroy a front end and set the pointer to NULL. The stores are left alone.
+ */
+void destroyAcquire(acquire_t **aq);
+
+/**
+ * @brief Take an empty block of blockFrames frames from the pool, NULL if all are in use.
+ */
+float *acqGetBlock(acquire_t *aq);
+
+/**
+ * @brief Return a block taken with acqGetBlock().
+ */
+void acqPutBlock(acquire_t *aq, float *block);
+
+/**
+ * @brief Append nFrames interleaved frames (at most blockFrames) to the channel stores.
+ */
+void acqIngest(acquire_t *aq, const float *frames, uint32_t nFrames);
+
+/**
+ * @brief Give the front end a math slot writing into ss. Call before the first acqIngest().
+ *
+ * @return STATUS_OK on success, ERROR_INVALID_PARAMS or ERROR_UNKNOWN on failure.
+ */
+status_t acqAttachMath(acquire_t *aq, sampleStore_t *ss);
+
+/**
+ * @brief Compile expr and hand it to the math slot; may be called from any thread.
+ *
+ * The producer switches over at its next acqIngest() and resets the
+ * expression state; samples stored before the switch read as 0 in the math
+ * store. A pending expression not yet picked up is replaced.
+ *
+ * @param[in] aq    Front end with a math slot.
+ * @param[in] expr  Expression, see createMathChannel(); channels without a store are rejected.
+ * @param[in] dt    Interval of the stored samples, seconds.
+ *
+ * @return STATUS_OK on success, ERROR_INVALID_PARAMS if there is no slot or expr does not compile.
+ */
+status_t acqSetMath(acquire_t *aq, const char *expr, float dt);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,226 @@
+#include "average.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "../../include/global.h"
+
+#define AV_CODE_LIMIT       1073741824.0f       /// 2^30: averaging clamp, int64 sums cannot overflow
+#define AV_BOX_LIMIT        2097152.0f          /// 2^21 = 2x full scale: a box of AV_MAX_BOXCAR fits int32
+
+typedef enum avOp_t {
+    AV_OP_SUM = 0,                              /// S += x
+    AV_OP_DECAY,                                /// S += x - S >> k
+    AV_OP_EXP_INIT,                             /// E = x << F
+    AV_OP_EXP,                                  /// E += (x << F - E) >> k
+    AV_OP_RESCALE,                              /// S = S * 2^k / n (running: linear -> exponential)
+} avOp_t;
+
+typedef struct avJob_t {
+    averager_t *    av;
+    const float *   in;
+    avOp_t          op;
+} avJob_t;
+
+static inline int32_t avCode(float v, float toCode, float lim){
+    float c = v * toCode;
+    c = __max(-lim, __min(lim, c));
+    return (int32_t)lrintf(c);
+}
+
+#if defined(__SSE2__)
+/// Four samples to four int32 codes, same rounding as avCode()
+static inline __m128i avCodes4(const float *p, __m128 toCode, __m128 lim){
+    __m128 c = _mm_mul_ps(_mm_loadu_ps(p), toCode);
+    c = _mm_max_ps(_mm_sub_ps(_mm_setzero_ps(), lim), _mm_min_ps(lim, c));
+    return _mm_cvtps_epi32(c);
+}
+
+/// Arithmetic right shift of two int64 (SSE2 only has the logical one)
+static inline __m128i avSrai64(__m128i v, __m128i k){
+    __m128i s = _mm_shuffle_epi32(_mm_srai_epi32(v, 31), _MM_SHUFFLE(3, 3, 1, 1));
+    return _mm_xor_si128(_mm_srl_epi64(_mm_xor_si128(v, s), k), s);
+}
+#endif
+
+static void avChunk(void *ctx, uint32_t chunk){
+    const avJob_t *job = (const avJob_t *)ctx;
+    averager_t    *av  = job->av;
+    const uint32_t a = chunk * AV_CHUNK, b = __min(av->length, a + AV_CHUNK);
+    int64_t       *s   = av->acc;
+    const float   *x   = job->in;
+    uint32_t       i   = a;
+
+    if(job->op == AV_OP_RESCALE){
+        for(; i < b; ++i) s[i] = s[i] * ((int64_t)1 << av->shift) / av->n;
+        return;
+    }
+#if defined(__SSE2__)
+    const __m128  toCode = _mm_set1_ps(av->toCode), lim = _mm_set1_ps(AV_CODE_LIMIT);
+    const __m128i k      = _mm_cvtsi32_si128((int)av->shift);
+    const __m128i f      = _mm_cvtsi32_si128(AV_FRAC_BITS);
+    for(; i + 4 <= b; i += 4){
+        __m128i c    = avCodes4(x + i, toCode, lim);
+        __m128i sign = _mm_srai_epi32(c, 31);
+        __m128i c0   = _mm_unpacklo_epi32(c, sign), c1 = _mm_unpackhi_epi32(c, sign);
+        __m128i s0   = _mm_loadu_si128((const __m128i *)(s + i));
+        __m128i s1   = _mm_loadu_si128((const __m128i *)(s + i + 2));
+        switch(job->op){
+            case AV_OP_SUM:
+                s0 = _mm_add_epi64(s0, c0);
+                s1 = _mm_add_epi64(s1, c1);
+                break;
+            case AV_OP_DECAY:
+                s0 = _mm_add_epi64(_mm_sub_epi64(s0, avSrai64(s0, k)), c0);
+                s1 = _mm_add_epi64(_mm_sub_epi64(s1, avSrai64(s1, k)), c1);
+                break;
+            case AV_OP_EXP_INIT:
+                s0 = _mm_sll_epi64(c0, f);
+                s1 = _mm_sll_epi64(c1, f);
+                break;
+            default:
+                s0 = _mm_add_epi64(s0, avSrai64(_mm_sub_epi64(_mm_sll_epi64(c0, f), s0), k));
+                s1 = _mm_add_epi64(s1, avSrai64(_mm_sub_epi64(_mm_sll_epi64(c1, f), s1), k));
+                break;
+        }
+        _mm_storeu_si128((__m128i *)(s + i), s0);
+        _mm_storeu_si128((__m128i *)(s + i + 2), s1);
+    }
+#endif
+    for(; i < b; ++i){
+        int64_t c = avCode(x[i], av->toCode, AV_CODE_LIMIT);
+        switch(job->op){
+            case AV_OP_SUM:      s[i] += c; break;
+            case AV_OP_DECAY:    s[i] += c - (s[i] >> av->shift); break;
+            case AV_OP_EXP_INIT: s[i]  = c * ((int64_t)1 << AV_FRAC_BITS); break;
+            default:             s[i] += (c * ((int64_t)1 << AV_FRAC_BITS) - s[i]) >> av->shift; break;
+        }
+    }
+}
+
+static void avApply(averager_t *av, const float *in, avOp_t op){
+    avJob_t job = {av, in, op};
+    wpRun(av->wp, avChunk, &job, (av->length + AV_CHUNK - 1) / AV_CHUNK);
+}
+
+status_t createAverager(averager_t **av, avMode_t mode, uint32_t n, uint32_t length, float fullScale, workerPool_t *wp){
+    __entry("createAverager(%p, %d, %u, %u, %g, %p)", av, mode, n, length, fullScale, wp);
+    if(__is_null(av) || n < AV_MIN_N || n > AV_MAX_N || length == 0 || !(fullScale > 0.0f)){
+        __err("[createAverager] Invalid params!");
+        return ERROR_INVALID_PARAMS;
+    }
+    *av = (averager_t *) mpCalloc(1, sizeof(averager_t));
+    if(__is_null(*av)){
+        __err("[createAverager] malloc failed!");
+        return ERROR_UNKNOWN;
+    }
+    if(mpLargeAlloc(&(*av)->mem, sizeof(int64_t) * (size_t)length, MP_NODE_LOCAL) != STATUS_OK){
+        __err("[createAverager] mpLargeAlloc(%u samples) failed!", length);
+        mpFree(*av);
+        *av = NULL;
+        return ERROR_UNKNOWN;
+    }
+    averager_t *a = *av;
+    a->mode   = mode;
+    a->n      = n;
+    a->length = length;
+    a->toCode = (float)(1U << AV_CODE_BITS) / fullScale;
+    a->acc    = (int64_t *) a->mem.p;
+    a->wp     = wp;
+    /// Running: largest power of two <= n; exponential: nearest power of two
+    a->shift  = 31 - __builtin_clz(n);
+    if(mode == AV_EXPONENTIAL && n - (1U << a->shift) > (1U << a->shift) / 2) a->shift++;
+    avReset(a);
+    __exit("createAverager()");
+    return STATUS_OK;
+}
+
+void destroyAverager(averager_t **av){
+    if(__is_null(av) || __is_null(*av)) return;
+    mpLargeFree(&(*av)->mem);
+    mpFree(*av);
+    *av = NULL;
+}
+
+void avReset(averager_t *av){
+    if(__is_null(av)) return;
+    memset(av->acc, 0, sizeof(int64_t) * (size_t)av->length);
+    av->count   = 0;
+    av->records = 0;
+}
+
+void avAdd(averager_t *av, const float *record){
+    if(__is_null(av) || __is_null(record)) return;
+    if(av->mode == AV_EXPONENTIAL){
+        avApply(av, record, av->records == 0 ? AV_OP_EXP_INIT : AV_OP_EXP);
+    }else if(av->count < av->n){
+        avApply(av, record, AV_OP_SUM);
+        if(++av->count == av->n && av->n != (1U << av->shift)) avApply(av, NULL, AV_OP_RESCALE);
+    }else{
+        avApply(av, record, AV_OP_DECAY);
+    }
+    av->records++;
+}
+
+void avRead(const averager_t *av, float *out){
+    if(__is_null(av) || __is_null(out)) return;
+    if(av->records == 0){
+        memset(out, 0, sizeof(float) * av->length);
+        return;
+    }
+    double div;
+    if(av->mode == AV_EXPONENTIAL) div = (double)(1ULL << AV_FRAC_BITS);
+    else if(av->count < av->n)     div = (double)av->count;
+    else                           div = (double)(1ULL << av->shift);
+    const double scale = 1.0 / (div * av->toCode);
+    REPTT(uint32_t, i, 0, av->length) out[i] = (float)((double)av->acc[i] * scale);
+}
+
+/// HI-RES ////////////////////////////////////////////////////////////////////////////////////////
+
+typedef struct avBoxJob_t {
+    const float *   in;
+    float *         out;
+    uint64_t        nOut;
+    uint32_t        m;
+    uint32_t        perChunk;                   /// Outputs per chunk
+    float           toCode;
+} avBoxJob_t;
+
+static void avBoxChunk(void *ctx, uint32_t chunk){
+    const avBoxJob_t *job = (const avBoxJob_t *)ctx;
+    const uint64_t    a = (uint64_t)chunk * job->perChunk, b = __min(job->nOut, a + job->perChunk);
+    const float       scale = 1.0f / ((float)job->m * job->toCode);
+#if defined(__SSE2__)
+    const __m128 toCode = _mm_set1_ps(job->toCode), lim = _mm_set1_ps(AV_BOX_LIMIT);
+#endif
+    for(uint64_t o = a; o < b; ++o){
+        const float *p = job->in + o * job->m;
+        int32_t      sum = 0;
+        uint32_t     i = 0;
+#if defined(__SSE2__)
+        __m128i v = _mm_setzero_si128();
+        for(; i + 4 <= job->m; i += 4) v = _mm_add_epi32(v, avCodes4(p + i, toCode, lim));
+        v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)));
+        v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)));
+        sum = _mm_cvtsi128_si32(v);
+#endif
+        for(; i < job->m; ++i) sum += avCode(p[i], job->toCode, AV_BOX_LIMIT);
+        job->out[o] = (float)sum * scale;
+    }
+}
+
+uint64_t avBoxcar(workerPool_t *wp, const float *in, uint64_t n, uint32_t m, float fullScale, float *out){
+    if(__is_null(in) || __is_null(out) || m == 0 || m > AV_MAX_BOXCAR || !(fullScale > 0.0f)) return 0;
+    avBoxJob_t job;
+    job.in       = in;
+    job.out      = out;
+    job.nOut     = n / m;
+    job.m        = m;
+    job.perChunk = __max(1U, AV_CHUNK / m);
+    job.toCode   = (float)(1U << AV_CODE_BITS) / fullScale;
+    if(job.nOut == 0) return 0;
+    wpRun(wp, avBoxChunk, &job, (uint32_t)((job.nOut + job.perChunk - 1) / job.perChunk));
+    return job.nOut;
+}
@@ -0,0 +1,107 @@
+#ifndef __AVERAGE_H__
+#define __AVERAGE_H__
+
+#ifdef LOG_HEADER_INCLUDE
+#pragma message("INCLUDE: average.h")
+#endif
+
+#include <stdint.h>
+
+#include "../windowContext/windowContext.h"
+#include "../memPool/memPool.h"
+#include "../workerPool/workerPool.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define AV_MIN_N            2
+#define AV_MAX_N            65536
+#define AV_CODE_BITS        20                  /// Integer codes per full scale: 2^AV_CODE_BITS
+#define AV_FRAC_BITS        20                  /// Fraction bits of the exponential accumulator
+#define AV_CHUNK            16384               /// Samples per worker chunk
+#define AV_MAX_BOXCAR       512                 /// Keeps a box sum inside int32
+
+typedef enum avMode_t {
+    AV_RUNNING = 0,                             /// Linear mean of the first N records, then exponential
+    AV_EXPONENTIAL,                             /// Exponential from the first record, weight 2^-round(log2 N)
+} avMode_t;
+
+/**
+ * @brief Record averager with wide integer accumulators.
+ *
+ * Samples are scaled to integer codes (2^AV_CODE_BITS per full scale) and
+ * summed into one int64 per sample, four samples per SSE2 step, with the
+ * record split into AV_CHUNK pieces across the worker pool. Memory is one
+ * accumulator per sample whatever N is:
+ *
+ *  - AV_RUNNING sums records until N have been added (mean = sum / count),
+ *    then carries on as S = S - S / 2^k + x with 2^k the largest power of
+ *    two <= N, so the average keeps following the signal;
+ *  - AV_EXPONENTIAL keeps E += (x - E) / 2^k in fixed point, k = round(log2 N).
+ */
+typedef struct averager_t {
+    avMode_t        mode;
+    uint32_t        n;
+    uint32_t        shift;                      /// k
+    uint32_t        length;                     /// Samples per record
+    float           toCode;                     /// 2^AV_CODE_BITS / fullScale
+    int64_t *       acc;
+    mpLarge_t       mem;                        /// Backing of acc
+    uint32_t        count;                      /// Records in the linear sum (AV_RUNNING, <= n)
+    uint64_t        records;                    /// Records added since the last reset
+    workerPool_t *  wp;                         /// May be NULL
+} averager_t;
+
+/**
+ * @brief Create an averager.
+ *
+ * @param[out] av         Pointer to an averager pointer. Will be allocated inside.
+ * @param[in]  mode       AV_RUNNING or AV_EXPONENTIAL.
+ * @param[in]  n          Records to average, AV_MIN_N ... AV_MAX_N.
+ * @param[in]  length     Samples per record.
+ * @param[in]  fullScale  Largest expected |sample|; resolution is fullScale / 2^AV_CODE_BITS.
+ * @param[in]  wp         Worker pool for the per-record work, NULL = calling thread only.
+ *
+ * @return STATUS_OK on success, ERROR_INVALID_PARAMS or ERROR_UNKNOWN on failure.
+ */
+status_t createAverager(averager_t **av, avMode_t mode, uint32_t n, uint32_t length, float fullScale, workerPool_t *wp);
+
+/**
+ * @brief Destroy an averager and set the pointer to NULL.
+ */
+void destroyAverager(averager_t **av);
+
+/**
+ * @brief Forget every record.
+ */
+void avReset(averager_t *av);
+
+/**
+ * @brief Add one triggered record of av->length samples.
+ */
+void avAdd(averager_t *av, const float *record);
+
+/**
+ * @brief Current average, av->length samples (zeros before the first record).
+ */
+void avRead(const averager_t *av, float *out);
+
+/**
+ * @brief Hi-res mode: boxcar-average every m consecutive samples.
+ *
+ * Each output is the mean of m input codes, for up to log2(m) / 2 extra
+ * effective bits on uncorrelated noise. Inputs are clamped to twice
+ * fullScale. The output is split across wp.
+ *
+ * @param[in]  m    Box length, 1 ... AV_MAX_BOXCAR.
+ *
+ * @return Number of outputs written, n / m.
+ */
+uint64_t avBoxcar(workerPool_t *wp, const float *in, uint64_t n, uint32_t m, float fullScale, float *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,82 @@
+#include "bitStream.h"
+
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+
+#include "../../include/global.h"
+
+/// Transition mask of word k: bit i set when bit i differs from the bit before it
+static inline uint64_t bsTransitions(const uint64_t *w, uint64_t k, uint8_t prev){
+    uint64_t carry = (k == 0) ? prev : (w[k - 1] >> 63);
+    return w[k] ^ ((w[k] << 1) | carry);
+}
+
+static inline uint64_t bsValidMask(uint64_t nBits, uint64_t k){
+    uint64_t end = nBits - k * BS_WORD_BITS;
+    return (end >= BS_WORD_BITS) ? ~0ULL : ((1ULL << end) - 1);
+}
+
+void bsPack(const float *src, uint32_t n, float threshold, float hysteresis, uint64_t *dst, uint8_t *level){
+    if(__is_null(src) || __is_null(dst)) return;
+    uint8_t  lvl = level ? *level : 0;
+    const float hi = threshold + 0.5f * hysteresis;
+    const float lo = threshold - 0.5f * hysteresis;
+
+    for(uint32_t base = 0; base < n; base += BS_WORD_BITS){
+        const uint32_t m = __min(n - base, (uint32_t)BS_WORD_BITS);
+        const float *s = src + base;
+        /// above = certainly high, below = certainly low; in between keeps the previous level
+        uint64_t above = 0, below = 0;
+        uint32_t i = 0;
+#if defined(__SSE__)
+        const __m128 vhi = _mm_set1_ps(hi), vlo = _mm_set1_ps(lo);
+        for(; i + 4 <= m; i += 4){
+            __m128 x = _mm_loadu_ps(s + i);
+            above |= (uint64_t)_mm_movemask_ps(_mm_cmpgt_ps(x, vhi)) << i;
+            below |= (uint64_t)_mm_movemask_ps(_mm_cmplt_ps(x, vlo)) << i;
+        }
+#endif
+        for(; i < m; ++i){
+            above |= (uint64_t)(s[i] > hi) << i;
+            below |= (uint64_t)(s[i] < lo) << i;
+        }
+
+        uint64_t word;
+        if((above | below) == bsValidMask(m, 0)){
+            word = above;                       /// No sample inside the band: no carrying needed
+        }else{
+            word = 0;
+            REPTT(uint32_t, b, 0, m){
+                if(above & (1ULL << b))      lvl = 1;
+                else if(below & (1ULL << b)) lvl = 0;
+                word |= (uint64_t)lvl << b;
+            }
+        }
+        dst[base / BS_WORD_BITS] = word;
+        if(m > 0) lvl = (uint8_t)((word >> (m - 1)) & 1U);
+    }
+    if(level) *level = lvl;
+}
+
+uint64_t bsNextEdge(const uint64_t *w, uint64_t nBits, uint64_t from, uint8_t prev){
+    if(__is_null(w) || from >= nBits) return nBits;
+    const uint64_t nWords = bsWords(nBits);
+    uint64_t k = from / BS_WORD_BITS;
+    uint64_t t = bsTransitions(w, k, prev) & (~0ULL << (from % BS_WORD_BITS));
+    for(;;){
+        t &= bsValidMask(nBits, k);
+        if(t) return k * BS_WORD_BITS + (uint64_t)__builtin_ctzll(t);
+        if(++k >= nWords) return nBits;
+        t = bsTransitions(w, k, prev);
+    }
+}
+
+uint64_t bsCountEdges(const uint64_t *w, uint64_t nBits, uint8_t prev){
+    if(__is_null(w)) return 0;
+    uint64_t count = 0;
+    REPTT(uint64_t, k, 0, bsWords(nBits)){
+        count += (uint64_t)__builtin_popcountll(bsTransitions(w, k, prev) & bsValidMask(nBits, k));
+    }
+    return count;
+}
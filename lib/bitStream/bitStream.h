@@ -0,0 +1,62 @@
+#ifndef __BIT_STREAM_H__
+#define __BIT_STREAM_H__
+
+#ifdef LOG_HEADER_INCLUDE
+#pragma message("INCLUDE: bitStream.h")
+#endif
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BS_WORD_BITS        64
+#define bsWords(nBits)      (((nBits) + BS_WORD_BITS - 1) / BS_WORD_BITS)
+#define bsGet(w, i)         ((uint8_t)(((w)[(i) >> 6] >> ((i) & 63)) & 1U))
+#define bsSet(w, i)         ((w)[(i) >> 6] |= (1ULL << ((i) & 63)))
+#define bsClr(w, i)         ((w)[(i) >> 6] &= ~(1ULL << ((i) & 63)))
+
+/**
+ * @brief Threshold analog samples into a packed digital stream, 64 samples per word.
+ *
+ * Bit i of the output (word i / 64, bit i % 64) is 1 when src[i] > threshold.
+ * Hysteresis is applied around the threshold: a bit only changes once the
+ * sample crosses threshold +- hysteresis / 2. `level` carries the current
+ * state across blocks (in: level before src[0], out: level after the last).
+ *
+ * @param[in]     src        Analog samples.
+ * @param[in]     n          Number of samples.
+ * @param[in]     threshold  Logic threshold.
+ * @param[in]     hysteresis Band width around the threshold (0 for none).
+ * @param[out]    dst        bsWords(n) words; bits past n are cleared.
+ * @param[in,out] level      Carried logic level.
+ */
+void bsPack(const float *src, uint32_t n, float threshold, float hysteresis, uint64_t *dst, uint8_t *level);
+
+/**
+ * @brief Find the next transition at or after bit `from`.
+ *
+ * Whole words without a transition are skipped in one compare, and
+ * transitions inside a word are found with a shift/xor and a count of
+ * trailing zeros rather than a per-sample loop.
+ *
+ * @param[in] w      Packed stream.
+ * @param[in] nBits  Valid bits in w.
+ * @param[in] from   First bit position to consider.
+ * @param[in] prev   Level of the bit just before position 0 of w.
+ *
+ * @return Position of the first bit that differs from its predecessor, or nBits if none.
+ */
+uint64_t bsNextEdge(const uint64_t *w, uint64_t nBits, uint64_t from, uint8_t prev);
+
+/**
+ * @brief Count transitions in [0, nBits).
+ */
+uint64_t bsCountEdges(const uint64_t *w, uint64_t nBits, uint8_t prev);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,509 @@
+#include "blockCodec.h"
+
+#include <math.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "../../include/global.h"
+
+typedef struct bcFileHeader_t {
+    char            magic[4];
+    uint32_t        block;                      /// BC_BLOCK of the writer
+    uint64_t        start;                      /// Index of the first sample
+    uint64_t        nBlocks;
+} bcFileHeader_t;
+
+/// CODEC /////////////////////////////////////////////////////////////////////////////////////////
+
+/// Float bits -> unsigned integer with the same order as the floats
+static inline uint32_t bcOrder(float v){
+    uint32_t u;
+    memcpy(&u, &v, sizeof(u));
+    return (u & 0x80000000U) ? ~u : (u | 0x80000000U);
+}
+
+static inline float bcUnorder(uint32_t o){
+    uint32_t u = (o & 0x80000000U) ? (o & 0x7FFFFFFFU) : ~o;
+    float    v;
+    memcpy(&v, &u, sizeof(v));
+    return v;
+}
+
+/// Fractional bits v needs to be an integer, -1 if it cannot be one (NaN, inf, -0)
+static inline int32_t bcFracBits(float v){
+    uint32_t u;
+    memcpy(&u, &v, sizeof(u));
+    uint32_t e = (u >> 23) & 0xFF, m = u & 0x7FFFFFU;
+    if(e == 0xFF || u == 0x80000000U) return -1;
+    if(u == 0) return 0;
+    if(e == 0) e = 1;                           /// Subnormal: no implicit bit
+    else m |= 0x800000U;
+    return __max(0, 150 - (int32_t)e - (int32_t)__builtin_ctz(m));
+}
+
+/// Power-of-two scale that turns every sample into an integer below 2^30, BC_FLOAT_MODE if none
+static int8_t bcScale(const float *src, uint32_t n, float *vMin, float *vMax){
+    float   lo = INFINITY, hi = -INFINITY;
+    int32_t s = 0;
+    REPTT(uint32_t, x, 0, n){
+        int32_t f = bcFracBits(src[x]);
+        s = f < 0 ? INT32_MAX : __max(s, f);
+        if(src[x] < lo) lo = src[x];
+        if(src[x] > hi) hi = src[x];
+    }
+    *vMin = lo;
+    *vMax = hi;
+    if(s > BC_MAX_SCALE || lo > hi) return BC_FLOAT_MODE;
+    if(ldexpf(__max(fabsf(lo), fabsf(hi)), s) >= 1073741824.0f) return BC_FLOAT_MODE;
+    return (int8_t)s;
+}
+
+/// Zigzagged deltas of the codes into zz[1 ... n - 1]; returns their OR
+static uint32_t bcDeltas(const float *src, uint32_t n, int8_t scale, uint32_t *zz, uint32_t *first){
+    const float mul = scale == BC_FLOAT_MODE ? 1.0f : ldexpf(1.0f, scale);
+    uint32_t    acc = 0, x = 1;
+    *first = scale == BC_FLOAT_MODE ? bcOrder(src[0]) : (uint32_t)(int32_t)(src[0] * mul);
+#if defined(__SSE2__)
+    const __m128i top = _mm_set1_epi32((int)0x80000000U);
+    const __m128  m4  = _mm_set1_ps(mul);
+    __m128i       orr = _mm_setzero_si128();
+    for(; x + 4 <= n; x += 4){
+        __m128i o, op;
+        if(scale == BC_FLOAT_MODE){
+            __m128i u = _mm_castps_si128(_mm_loadu_ps(src + x));
+            __m128i p = _mm_castps_si128(_mm_loadu_ps(src + x - 1));
+            o  = _mm_xor_si128(u, _mm_or_si128(_mm_srai_epi32(u, 31), top));
+            op = _mm_xor_si128(p, _mm_or_si128(_mm_srai_epi32(p, 31), top));
+        }else{
+            o  = _mm_cvttps_epi32(_mm_mul_ps(_mm_loadu_ps(src + x), m4));
+            op = _mm_cvttps_epi32(_mm_mul_ps(_mm_loadu_ps(src + x - 1), m4));
+        }
+        __m128i d = _mm_sub_epi32(o, op);
+        __m128i z = _mm_xor_si128(_mm_slli_epi32(d, 1), _mm_srai_epi32(d, 31));
+        _mm_storeu_si128((__m128i *)(zz + x), z);
+        orr = _mm_or_si128(orr, z);
+    }
+    uint32_t o4[4];
+    _mm_storeu_si128((__m128i *)o4, orr);
+    acc = o4[0] | o4[1] | o4[2] | o4[3];
+#endif
+    for(; x < n; ++x){
+        int32_t d = scale == BC_FLOAT_MODE ? (int32_t)(bcOrder(src[x]) - bcOrder(src[x - 1])) :
+                    (int32_t)(src[x] * mul) - (int32_t)(src[x - 1] * mul);
+        zz[x] = ((uint32_t)d << 1) ^ (uint32_t)(d >> 31);
+        acc  |= zz[x];
+    }
+    return acc;
+}
+
+uint32_t bcPayloadBytes(const bcHeader_t *h){
+    return (uint32_t)(((uint64_t)(h->n - 1) * h->width + 7) / 8);
+}
+
+uint32_t bcEncode(const float *src, uint32_t n, bcHeader_t *h, uint8_t *dst, uint32_t *zz){
+    if(n == 0 || n > BC_BLOCK) return 0;
+    h->scale = bcScale(src, n, &h->vMin, &h->vMax);
+    uint32_t acc = bcDeltas(src, n, h->scale, zz, &h->first);
+    uint8_t  w   = 0;
+    while(w < 32 && (acc >> w)) ++w;
+    h->n     = (uint16_t)n;
+    h->width = w;
+    if(w == 0) return 0;
+
+    /// Little-endian bit stream, flushed 32 bits at a time
+    uint64_t bits = 0;
+    uint32_t nBits = 0, out = 0;
+    REPTT(uint32_t, x, 1, n){
+        bits  |= (uint64_t)zz[x] << nBits;
+        nBits += w;
+        if(nBits >= 32){
+            uint32_t word = (uint32_t)bits;
+            memcpy(dst + out, &word, sizeof(word));
+            out   += 4;
+            bits >>= 32;
+            nBits -= 32;
+        }
+    }
+    for(; nBits > 0; nBits = nBits > 8 ? nBits - 8 : 0){
+        dst[out++] = (uint8_t)bits;
+        bits     >>= 8;
+    }
+    return out;
+}
+
+static inline float bcValue(const bcHeader_t *h, uint32_t o, float div){
+    return h->scale == BC_FLOAT_MODE ? bcUnorder(o) : (float)(int32_t)o * div;
+}
+
+void bcDecode(const bcHeader_t *h, const uint8_t *src, float *dst){
+    const uint8_t  w    = h->width;
+    const uint64_t mask = (1ULL << w) - 1;
+    const float    div  = h->scale == BC_FLOAT_MODE ? 1.0f : ldexpf(1.0f, -h->scale);
+    uint32_t       o    = h->first;
+    dst[0] = bcValue(h, o, div);
+    if(w == 0){
+        REPTT(uint32_t, x, 1, h->n) dst[x] = dst[0];
+        return;
+    }
+    uint64_t bits = 0;
+    uint32_t nBits = 0;
+    REPTT(uint32_t, x, 1, h->n){
+        while(nBits < w){
+            bits  |= (uint64_t)*src++ << nBits;
+            nBits += 8;
+        }
+        uint32_t z = (uint32_t)(bits & mask);
+        bits  >>= w;
+        nBits  -= w;
+        o      += (z >> 1) ^ (0U - (z & 1));
+        dst[x]  = bcValue(h, o, div);
+    }
+}
+
+/// STORE /////////////////////////////////////////////////////////////////////////////////////////
+
+status_t createBlockStore(blockStore_t **bc, size_t capBytes, uint64_t capSamples){
+    __entry("createBlockStore(%p, %zu, %llu)", bc, capBytes, (unsigned long long)capSamples);
+    if(__is_null(bc) || capBytes < 2 * BC_MAX_BYTES || capSamples < 2 * BC_BLOCK ||
+       capSamples / BC_BLOCK > UINT32_MAX){
+        __err("[createBlockStore] Invalid params!");
+        return ERROR_INVALID_PARAMS;
+    }
+    *bc = (blockStore_t *) mpCalloc(1, sizeof(blockStore_t));
+    if(__is_null(*bc)){
+        __err("[createBlockStore] malloc failed!");
+        return ERROR_UNKNOWN;
+    }
+    (*bc)->capBlocks = (uint32_t)(capSamples / BC_BLOCK);
+    (*bc)->blocks    = (bcBlock_t *) mpAlloc(sizeof(bcBlock_t) * (*bc)->capBlocks);
+    if(__is_null((*bc)->blocks) || mpLargeAlloc(&(*bc)->mem, capBytes, MP_NODE_LOCAL) != STATUS_OK){
+        __err("[createBlockStore] malloc failed!");
+        mpFree((*bc)->blocks);
+        mpFree(*bc);
+        *bc = NULL;
+        return ERROR_UNKNOWN;
+    }
+    (*bc)->data     = (uint8_t *) (*bc)->mem.p;
+    (*bc)->capBytes = capBytes;
+    (*bc)->cached   = -1;
+
+    __exit("createBlockStore()");
+    return STATUS_OK;
+}
+
+void destroyBlockStore(blockStore_t **bc){
+    if(__is_null(bc) || __is_null(*bc)) return;
+    mpLargeFree(&(*bc)->mem);
+    mpFree((*bc)->blocks);
+    mpFree(*bc);
+    *bc = NULL;
+}
+
+void bcReset(blockStore_t *bc, uint64_t start){
+    if(__is_null(bc)) return;
+    bc->base    = start;
+    bc->first   = 0;
+    bc->count   = 0;
+    bc->tail    = 0;
+    bc->nPend   = 0;
+    bc->cached  = -1;
+    bc->started = 1;
+}
+
+/// Store one encoded block as block count, dropping the oldest ones to make room
+static void bcPush(blockStore_t *bc, const bcHeader_t *h, const uint8_t *payload, uint32_t bytes){
+    /// A payload never wraps: skip the end of the ring instead
+    size_t pos = (size_t)(bc->tail % bc->capBytes);
+    if(pos + bytes > bc->capBytes) bc->tail += bc->capBytes - pos;
+    while(bc->first < bc->count && (bc->count - bc->first >= bc->capBlocks ||
+          bc->tail + bytes - bc->blocks[bc->first % bc->capBlocks].offset > bc->capBytes)){
+        bc->first++;
+    }
+    bcBlock_t *b = &bc->blocks[bc->count % bc->capBlocks];
+    b->h      = *h;
+    b->offset = bc->tail;
+    memcpy(bc->data + bc->tail % bc->capBytes, payload, bytes);
+    bc->tail += bytes;
+    bc->count++;
+    bc->rawBytes    += sizeof(float) * h->n;
+    bc->packedBytes += bytes + sizeof(bcHeader_t);
+}
+
+void bcAppend(blockStore_t *bc, const float *src, uint64_t n){
+    if(__is_null(bc) || __is_null(src)) return;
+    bc->started = 1;
+    while(n > 0){
+        uint32_t k = (uint32_t)__min(n, (uint64_t)(BC_BLOCK - bc->nPend));
+        memcpy(bc->pend + bc->nPend, src, sizeof(float) * k);
+        bc->nPend += k;
+        src       += k;
+        n         -= k;
+        if(bc->nPend < BC_BLOCK) break;
+        bcHeader_t h;
+        uint32_t   bytes = bcEncode(bc->pend, BC_BLOCK, &h, bc->scratch, bc->zz);
+        bcPush(bc, &h, bc->scratch, bytes);
+        bc->nPend = 0;
+    }
+}
+
+uint64_t bcFollow(blockStore_t *bc, const sampleStore_t *ss){
+    if(__is_null(bc) || __is_null(ss)) return 0;
+    uint64_t written = ssWritten(ss), oldest = ssOldest(ss);
+    uint64_t at      = bcWritten(bc);
+    if(!bc->started || at < oldest || at > written){
+        bcReset(bc, oldest);
+        at = oldest;
+    }
+    uint64_t done = 0;
+    while(at < written){
+        ssSpan_t span;
+        uint32_t n = ssGetSpan(ss, at, (uint32_t)__min(written - at, (uint64_t)(1U << 20)), &span);
+        if(n == 0) break;
+        bcAppend(bc, span.p[0], span.n[0]);
+        if(span.n[1]) bcAppend(bc, span.p[1], span.n[1]);
+        at   += n;
+        done += n;
+    }
+    return done;
+}
+
+uint64_t bcWritten(const blockStore_t *bc){
+    if(__is_null(bc)) return 0;
+    return bc->base + bc->count * BC_BLOCK + bc->nPend;
+}
+
+uint64_t bcOldest(const blockStore_t *bc){
+    if(__is_null(bc)) return 0;
+    return bc->base + bc->first * BC_BLOCK;
+}
+
+/// Samples of block b (count = the pending one), decoding at most once in a row
+static const float *bcSamples(blockStore_t *bc, uint64_t b){
+    if(b == bc->count) return bc->pend;
+    if(bc->cached != (int64_t)b){
+        const bcBlock_t *k = &bc->blocks[b % bc->capBlocks];
+        bcDecode(&k->h, bc->data + k->offset % bc->capBytes, bc->cache);
+        bc->cached = (int64_t)b;
+    }
+    return bc->cache;
+}
+
+/// Clip [start, start + n) to the store; 0 if nothing is left
+static uint8_t bcClip(const blockStore_t *bc, uint64_t *start, uint64_t *n){
+    uint64_t lo = __max(*start, bcOldest(bc));
+    uint64_t hi = *start + __min(*n, UINT64_MAX - *start);
+    hi = __min(hi, bcWritten(bc));
+    if(lo >= hi) return 0;
+    *start = lo;
+    *n     = hi - lo;
+    return 1;
+}
+
+uint64_t bcRead(blockStore_t *bc, uint64_t start, uint64_t n, float *dst){
+    if(__is_null(bc) || __is_null(dst) || !bcClip(bc, &start, &n)) return 0;
+    uint64_t done = 0;
+    while(done < n){
+        uint64_t rel = start + done - bc->base;
+        uint32_t off = (uint32_t)(rel % BC_BLOCK);
+        uint32_t k   = (uint32_t)__min(n - done, (uint64_t)(BC_BLOCK - off));
+        memcpy(dst + done, bcSamples(bc, rel / BC_BLOCK) + off, sizeof(float) * k);
+        done += k;
+    }
+    return n;
+}
+
+uint8_t bcMinMax(blockStore_t *bc, uint64_t start, uint64_t n, float *vMin, float *vMax){
+    if(__is_null(bc) || __is_null(vMin) || __is_null(vMax) || !bcClip(bc, &start, &n)) return 0;
+    float    lo = INFINITY, hi = -INFINITY;
+    uint64_t at = start, end = start + n;
+    while(at < end){
+        uint64_t b   = (at - bc->base) / BC_BLOCK;
+        uint32_t off = (uint32_t)((at - bc->base) % BC_BLOCK);
+        uint32_t k   = (uint32_t)__min(end - at, (uint64_t)(BC_BLOCK - off));
+        if(b < bc->count && k == BC_BLOCK){
+            /// Whole block: the header has the answer
+            const bcHeader_t *h = &bc->blocks[b % bc->capBlocks].h;
+            if(h->vMin < lo) lo = h->vMin;
+            if(h->vMax > hi) hi = h->vMax;
+        }else{
+            const float *p = bcSamples(bc, b) + off;
+            REPTT(uint32_t, x, 0, k){
+                if(p[x] < lo) lo = p[x];
+                if(p[x] > hi) hi = p[x];
+            }
+        }
+        at += k;
+    }
+    if(lo > hi) return 0;
+    *vMin = lo;
+    *vMax = hi;
+    return 1;
+}
+
+uint8_t bcNextCross(blockStore_t *bc, uint64_t from, float level, int8_t dir, uint64_t *pos){
+    if(__is_null(bc) || __is_null(pos)) return 0;
+    uint64_t end = bcWritten(bc);
+    uint64_t at  = __max(from, bcOldest(bc));
+    uint8_t  above = 0, known = 0;
+    if(at > bcOldest(bc)){
+        /// Side of the last number before from
+        uint64_t back = at;
+        while(back > bcOldest(bc) && !known){
+            float v;
+            bcRead(bc, --back, 1, &v);
+            if(v == v){
+                above = v >= level;
+                known = 1;
+            }
+        }
+    }
+    while(at < end){
+        uint64_t b   = (at - bc->base) / BC_BLOCK;
+        uint32_t off = (uint32_t)((at - bc->base) % BC_BLOCK);
+        uint32_t k   = (uint32_t)__min(end - at, (uint64_t)(BC_BLOCK - off));
+        if(known && b < bc->count){
+            /// All numbers of the block on the side we are on: nothing to decode
+            const bcHeader_t *h = &bc->blocks[b % bc->capBlocks].h;
+            if(above ? h->vMin >= level : h->vMax < level){
+                at += k;
+                continue;
+            }
+        }
+        const float *p = bcSamples(bc, b) + off;
+        REPTT(uint32_t, x, 0, k){
+            if(p[x] != p[x]) continue;
+            uint8_t side = p[x] >= level;
+            if(known && side != above && (dir == 0 || (dir > 0) == side)){
+                *pos = at + x;
+                return 1;
+            }
+            above = side;
+            known = 1;
+        }
+        at += k;
+    }
+    return 0;
+}
+
+/// FILES /////////////////////////////////////////////////////////////////////////////////////////
+
+static uint8_t bcWriteBlock(FILE *f, const bcHeader_t *h, const uint8_t *payload, uint32_t bytes){
+    return fwrite(h, sizeof(bcHeader_t), 1, f) == 1 && (bytes == 0 || fwrite(payload, bytes, 1, f) == 1);
+}
+
+static status_t bcWriteHeader(FILE *f, uint64_t start, uint64_t nBlocks){
+    bcFileHeader_t fh;
+    memcpy(fh.magic, BC_MAGIC, 4);
+    fh.block   = BC_BLOCK;
+    fh.start   = start;
+    fh.nBlocks = nBlocks;
+    return fwrite(&fh, sizeof(fh), 1, f) == 1 ? STATUS_OK : ERROR_UNKNOWN;
+}
+
+status_t bcSaveFile(const blockStore_t *bc, const char *path){
+    if(__is_null(bc) || __is_null(path)) return ERROR_INVALID_PARAMS;
+    FILE *f = fopen(path, "wb");
+    if(__is_null(f)){
+        __err("[bcSaveFile] Cannot open %s: %s", path, strerror(errno));
+        return ERROR_UNKNOWN;
+    }
+    status_t st = bcWriteHeader(f, bcOldest(bc), bc->count - bc->first + (bc->nPend > 0));
+    for(uint64_t b = bc->first; b < bc->count && st == STATUS_OK; ++b){
+        const bcBlock_t *k = &bc->blocks[b % bc->capBlocks];
+        if(!bcWriteBlock(f, &k->h, bc->data + k->offset % bc->capBytes, bcPayloadBytes(&k->h))) st = ERROR_UNKNOWN;
+    }
+    if(bc->nPend > 0 && st == STATUS_OK){
+        bcHeader_t h;
+        uint8_t   *payload = (uint8_t *) mpAlloc(BC_MAX_BYTES);
+        uint32_t  *zz      = (uint32_t *) mpAlloc(sizeof(uint32_t) * BC_BLOCK);
+        if(__is_null(payload) || __is_null(zz)){
+            st = ERROR_UNKNOWN;
+        }else{
+            uint32_t bytes = bcEncode(bc->pend, bc->nPend, &h, payload, zz);
+            if(!bcWriteBlock(f, &h, payload, bytes)) st = ERROR_UNKNOWN;
+        }
+        mpFree(payload);
+        mpFree(zz);
+    }
+    if(fclose(f) != 0) st = ERROR_UNKNOWN;
+    if(st != STATUS_OK) __err("[bcSaveFile] Short write to %s", path);
+    return st;
+}
+
+status_t bcWriteFile(const char *path, const float *src, uint64_t n){
+    if(__is_null(path) || __is_null(src)) return ERROR_INVALID_PARAMS;
+    FILE *f = fopen(path, "wb");
+    if(__is_null(f)){
+        __err("[bcWriteFile] Cannot open %s: %s", path, strerror(errno));
+        return ERROR_UNKNOWN;
+    }
+    uint8_t  *payload = (uint8_t *) mpAlloc(BC_MAX_BYTES);
+    uint32_t *zz      = (uint32_t *) mpAlloc(sizeof(uint32_t) * BC_BLOCK);
+    status_t  st      = (__is_null(payload) || __is_null(zz)) ? ERROR_UNKNOWN :
+                        bcWriteHeader(f, 0, (n + BC_BLOCK - 1) / BC_BLOCK);
+    for(uint64_t at = 0; at < n && st == STATUS_OK; at += BC_BLOCK){
+        bcHeader_t h;
+        uint32_t   bytes = bcEncode(src + at, (uint32_t)__min(n - at, (uint64_t)BC_BLOCK), &h, payload, zz);
+        if(!bcWriteBlock(f, &h, payload, bytes)) st = ERROR_UNKNOWN;
+    }
+    mpFree(payload);
+    mpFree(zz);
+    if(fclose(f) != 0) st = ERROR_UNKNOWN;
+    if(st != STATUS_OK) __err("[bcWriteFile] Short write to %s", path);
+    return st;
+}
+
+status_t bcLoadFile(blockStore_t **bc, const char *path){
+    if(__is_null(bc) || __is_null(path)) return ERROR_INVALID_PARAMS;
+    FILE *f = fopen(path, "rb");
+    if(__is_null(f)){
+        __err("[bcLoadFile] Cannot open %s: %s", path, strerror(errno));
+        return ERROR_UNKNOWN;
+    }
+    bcFileHeader_t fh;
+    if(fread(&fh, sizeof(fh), 1, f) != 1 || memcmp(fh.magic, BC_MAGIC, 4) != 0 || fh.block != BC_BLOCK ||
+       fh.nBlocks > UINT32_MAX / 2){
+        __err("[bcLoadFile] %s: not a block file", path);
+        fclose(f);
+        return ERROR_INVALID_PARAMS;
+    }
+    fseek(f, 0, SEEK_END);
+    size_t size = (size_t)ftell(f);
+    fseek(f, sizeof(fh), SEEK_SET);
+
+    status_t st = createBlockStore(bc, __max(size, (size_t)2 * BC_MAX_BYTES),
+                                   __max(fh.nBlocks + 1, (uint64_t)2) * BC_BLOCK);
+    if(st != STATUS_OK){
+        fclose(f);
+        return st;
+    }
+    bcReset(*bc, fh.start);
+    REPTT(uint64_t, b, 0, fh.nBlocks){
+        bcHeader_t h;
+        if(fread(&h, sizeof(h), 1, f) != 1 || h.n == 0 || h.n > BC_BLOCK || h.width > 32 ||
+           (h.n < BC_BLOCK && b + 1 < fh.nBlocks) || h.scale < BC_FLOAT_MODE || h.scale > BC_MAX_SCALE){
+            st = ERROR_INVALID_PARAMS;
+            break;
+        }
+        uint32_t bytes = bcPayloadBytes(&h);
+        if(bytes && fread((*bc)->scratch, bytes, 1, f) != 1){
+            st = ERROR_INVALID_PARAMS;
+            break;
+        }
+        if(h.n == BC_BLOCK){
+            bcPush(*bc, &h, (*bc)->scratch, bytes);
+        }else{
+            /// Short last block: back to the pending samples
+            bcDecode(&h, (*bc)->scratch, (*bc)->pend);
+            (*bc)->nPend = h.n;
+        }
+    }
+    fclose(f);
+    if(st != STATUS_OK){
+        __err("[bcLoadFile] %s: truncated or corrupt", path);
+        destroyBlockStore(bc);
+    }
+    return st;
+}
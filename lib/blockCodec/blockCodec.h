@@ -0,0 +1,203 @@
+#ifndef __BLOCK_CODEC_H__
+#define __BLOCK_CODEC_H__
+
+#ifdef LOG_HEADER_INCLUDE
+#pragma message("INCLUDE: blockCodec.h")
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "../windowContext/windowContext.h"
+#include "../memPool/memPool.h"
+#include "../sampleStore/sampleStore.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BC_BLOCK            1024                /// Samples per block
+#define BC_MAX_BYTES        (4 * BC_BLOCK)      /// Largest block payload
+#define BC_MAX_SCALE        100                 /// Largest power-of-two scale of the integer mode
+#define BC_FLOAT_MODE       (-1)                /// bcHeader_t.scale: order-mapped float bits
+#define BC_MAGIC            "BCZ1"
+
+/**
+ * @brief Block header, kept apart from the payload so scans can skip blocks.
+ */
+typedef struct bcHeader_t {
+    float           vMin;                       /// Sample range, NaNs ignored (vMin > vMax: all NaN)
+    float           vMax;
+    uint32_t        first;                      /// First sample's code
+    uint16_t        n;                          /// Samples, 1 ... BC_BLOCK
+    uint8_t         width;                      /// Bits per packed delta, 0 ... 32
+    int8_t          scale;                      /// Codes are samples * 2^scale, or BC_FLOAT_MODE
+} bcHeader_t;
+
+typedef struct bcBlock_t {
+    bcHeader_t      h;
+    uint64_t        offset;                     /// Absolute payload position, data[offset % capBytes]
+} bcBlock_t;
+
+/**
+ * @brief Losslessly compressed sample history.
+ *
+ * Samples are cut into blocks of BC_BLOCK and each sample becomes an integer
+ * code: when every sample of the block is a multiple of one power of two
+ * (ADC data: the LSB) the code is the sample in those steps, otherwise the
+ * float's bits mapped to an unsigned integer of the same order. Consecutive
+ * codes are differenced, zigzag-encoded and bit-packed at the width of the
+ * block's largest delta, so a slowly varying signal takes a few bits per
+ * sample instead of 32. Any float, NaN and -0 included, comes back bit-exact.
+ *
+ * Payloads go to a byte ring of capBytes, headers to a ring of capSamples /
+ * BC_BLOCK entries; the oldest blocks are dropped when either is full. The
+ * block holding the newest samples stays uncompressed until it is full.
+ * Range reads decode only the blocks they overlap; min / max and crossing
+ * scans answer whole blocks from the headers and decode only the ends.
+ *
+ * Not thread-safe: append and read from one thread.
+ */
+typedef struct blockStore_t {
+    uint8_t *       data;
+    mpLarge_t       mem;                        /// Backing of data
+    size_t          capBytes;
+    bcBlock_t *     blocks;                     /// Block b at blocks[b % capBlocks]
+    uint32_t        capBlocks;
+    uint64_t        base;                       /// Sample index of block 0
+    uint64_t        first;                      /// Oldest block held
+    uint64_t        count;                      /// Blocks encoded
+    uint64_t        tail;                       /// Absolute payload write position
+    uint8_t         started;                    /// Base is set
+    float           pend[BC_BLOCK];             /// Block count, still being filled
+    uint32_t        nPend;
+    int64_t         cached;                     /// Block decoded into cache, -1 = none
+    float           cache[BC_BLOCK];
+    uint32_t        zz[BC_BLOCK];               /// Encoder scratch
+    uint8_t         scratch[BC_MAX_BYTES];
+    uint64_t        rawBytes;                   /// Encoded so far: input / output (headers included)
+    uint64_t        packedBytes;
+} blockStore_t;
+
+/**
+ * @brief Encode n (1 ... BC_BLOCK) samples as one block.
+ *
+ * @param[in]  src   Samples.
+ * @param[in]  n     Number of samples.
+ * @param[out] h     Block header.
+ * @param[out] dst   Payload, BC_MAX_BYTES at most.
+ * @param[out] zz    Scratch of BC_BLOCK entries.
+ *
+ * @return Payload bytes.
+ */
+uint32_t bcEncode(const float *src, uint32_t n, bcHeader_t *h, uint8_t *dst, uint32_t *zz);
+
+/**
+ * @brief Decode one block into h->n samples.
+ */
+void bcDecode(const bcHeader_t *h, const uint8_t *src, float *dst);
+
+/**
+ * @brief Payload bytes of a block.
+ */
+uint32_t bcPayloadBytes(const bcHeader_t *h);
+
+/**
+ * @brief Create an empty store.
+ *
+ * @param[out] bc          Pointer to a block store pointer. Will be allocated inside.
+ * @param[in]  capBytes    Payload memory, >= 2 * BC_MAX_BYTES.
+ * @param[in]  capSamples  Most samples to keep, >= 2 * BC_BLOCK.
+ *
+ * @return STATUS_OK on success, ERROR_INVALID_PARAMS or ERROR_UNKNOWN on failure.
+ */
+status_t createBlockStore(blockStore_t **bc, size_t capBytes, uint64_t capSamples);
+
+/**
+ * @brief Destroy a block store and set the pointer to NULL.
+ */
+void destroyBlockStore(blockStore_t **bc);
+
+/**
+ * @brief Drop everything; the next sample appended gets index start.
+ */
+void bcReset(blockStore_t *bc, uint64_t start);
+
+/**
+ * @brief Append n samples.
+ */
+void bcAppend(blockStore_t *bc, const float *src, uint64_t n);
+
+/**
+ * @brief Append what ss wrote since the last call.
+ *
+ * The store takes ss's sample indices. On the first call, or if the store
+ * fell behind ss's oldest sample, it restarts from ss's oldest sample.
+ *
+ * @return Samples appended.
+ */
+uint64_t bcFollow(blockStore_t *bc, const sampleStore_t *ss);
+
+/**
+ * @brief Index of the next sample to be appended.
+ */
+uint64_t bcWritten(const blockStore_t *bc);
+
+/**
+ * @brief Index of the oldest sample held.
+ */
+uint64_t bcOldest(const blockStore_t *bc);
+
+/**
+ * @brief Copy samples [start, start + n) into dst, clipped to what the store holds.
+ *
+ * @return Number of samples copied, from max(start, bcOldest()).
+ */
+uint64_t bcRead(blockStore_t *bc, uint64_t start, uint64_t n, float *dst);
+
+/**
+ * @brief Min / max of samples [start, start + n), NaNs ignored.
+ *
+ * @return 1 if the range held a number, 0 otherwise.
+ */
+uint8_t bcMinMax(blockStore_t *bc, uint64_t start, uint64_t n, float *vMin, float *vMax);
+
+/**
+ * @brief Find the first crossing of level at or after sample from.
+ *
+ * A crossing at i means samples i - 1 and i (NaNs skipped) are on different
+ * sides; a sample equal to level counts as above.
+ *
+ * @param[in]  dir   1 rising, -1 falling, 0 either.
+ * @param[out] pos   Index of the sample after the crossing.
+ *
+ * @return 1 if found.
+ */
+uint8_t bcNextCross(blockStore_t *bc, uint64_t from, float level, int8_t dir, uint64_t *pos);
+
+/**
+ * @brief Write everything held to a file (BC_MAGIC, then header + payload per block).
+ *
+ * @return STATUS_OK, ERROR_UNKNOWN on I/O errors.
+ */
+status_t bcSaveFile(const blockStore_t *bc, const char *path);
+
+/**
+ * @brief Compress a flat recording of n samples into a file in the bcSaveFile() format.
+ *
+ * @return STATUS_OK, ERROR_INVALID_PARAMS or ERROR_UNKNOWN.
+ */
+status_t bcWriteFile(const char *path, const float *src, uint64_t n);
+
+/**
+ * @brief Load a file written by bcSaveFile() or bcWriteFile() into a new store just big enough.
+ *
+ * @return STATUS_OK, ERROR_INVALID_PARAMS for a bad file, ERROR_UNKNOWN on I/O errors.
+ */
+status_t bcLoadFile(blockStore_t **bc, const char *path);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,89 @@
+#include "compositor.h"
+
+#include "../../include/global.h"
+
+status_t createCompositor(compositor_t **c, xy_t w, xy_t h){
+    __entry("createCompositor(%p, %d, %d)", c, w, h);
+    if(__is_null(c) || w <= 0 || h <= 0){
+        __err("[createCompositor] Invalid params!");
+        return ERROR_INVALID_PARAMS;
+    }
+    *c = (compositor_t *) mpCalloc(1, sizeof(compositor_t));
+    if(__is_null(*c)){
+        __err("[createCompositor] malloc failed!");
+        return ERROR_UNKNOWN;
+    }
+    if(cmpResize(*c, w, h) != STATUS_OK){
+        mpFree(*c);
+        *c = NULL;
+        return ERROR_UNKNOWN;
+    }
+    __exit("createCompositor()");
+    return STATUS_OK;
+}
+
+void destroyCompositor(compositor_t **c){
+    if(__is_null(c) || __is_null(*c)) return;
+    mpFree((*c)->cache.px);
+    mpFree(*c);
+    *c = NULL;
+}
+
+static status_t cmpAdd(cmpLayer_t *list, uint8_t *n, cmpDrawFunc_t draw, void *ctx){
+    if(__is_null(draw) || *n >= CMP_MAX_LAYERS){
+        __err("[cmpAdd] draw = %p, %d layers", draw, *n);
+        return ERROR_INVALID_PARAMS;
+    }
+    list[*n].draw = draw;
+    list[*n].ctx  = ctx;
+    ++*n;
+    return STATUS_OK;
+}
+
+status_t cmpAddStatic(compositor_t *c, cmpDrawFunc_t draw, void *ctx){
+    if(__is_null(c)) return ERROR_INVALID_PARAMS;
+    c->dirty = 1;
+    return cmpAdd(c->statics, &c->nStatic, draw, ctx);
+}
+
+status_t cmpAddDynamic(compositor_t *c, cmpDrawFunc_t draw, void *ctx){
+    if(__is_null(c)) return ERROR_INVALID_PARAMS;
+    return cmpAdd(c->dynamics, &c->nDynamic, draw, ctx);
+}
+
+void cmpInvalidate(compositor_t *c){
+    if(__is_not_null(c)) c->dirty = 1;
+}
+
+status_t cmpResize(compositor_t *c, xy_t w, xy_t h){
+    if(__is_null(c) || w <= 0 || h <= 0) return ERROR_INVALID_PARAMS;
+    if(__is_not_null(c->cache.px) && c->cache.w == w && c->cache.h == h) return STATUS_OK;
+    color_t *px = (color_t *) mpAlloc(sizeof(color_t) * (size_t)w * h);
+    if(__is_null(px)){
+        __err("[cmpResize] malloc(%d x %d) failed!", w, h);
+        return ERROR_UNKNOWN;
+    }
+    mpFree(c->cache.px);
+    c->cache.px    = px;
+    c->cache.w     = w;
+    c->cache.h     = h;
+    c->cache.pitch = w;
+    c->dirty       = 1;
+    return STATUS_OK;
+}
+
+uint8_t cmpRefresh(compositor_t *c){
+    if(__is_null(c) || !c->dirty) return 0;
+    REPTT(uint8_t, i, 0, c->nStatic) c->statics[i].draw(&c->cache, c->statics[i].ctx);
+    c->dirty = 0;
+    c->rebuilds++;
+    return 1;
+}
+
+void cmpCompose(compositor_t *c, rsTarget_t *t){
+    if(__is_null(c) || __is_null(t)) return;
+    cmpRefresh(c);
+    rsBlit(t, &c->cache);
+    REPTT(uint8_t, i, 0, c->nDynamic) c->dynamics[i].draw(t, c->dynamics[i].ctx);
+    c->frames++;
+}
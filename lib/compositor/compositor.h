@@ -0,0 +1,93 @@
+#ifndef __COMPOSITOR_H__
+#define __COMPOSITOR_H__
+
+#ifdef LOG_HEADER_INCLUDE
+#pragma message("INCLUDE: compositor.h")
+#endif
+
+#include <stdint.h>
+
+#include "../windowContext/windowContext.h"
+#include "../raster/raster.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CMP_MAX_LAYERS      8
+
+typedef void (*cmpDrawFunc_t)(rsTarget_t *t, void *ctx);
+
+typedef struct cmpLayer_t {
+    cmpDrawFunc_t   draw;
+    void *          ctx;
+} cmpLayer_t;
+
+/**
+ * @brief Layered frame compositor.
+ *
+ * Static layers (graticule, labels, chrome) are drawn in order into one
+ * cache only when it has been invalidated. Each frame is the cache copied
+ * into the target with rsBlit() plus the dynamic layers drawn on top, so
+ * nothing static is redrawn per frame.
+ */
+typedef struct compositor_t {
+    rsTarget_t      cache;                      /// All static layers flattened, owned
+    uint8_t         dirty;
+    cmpLayer_t      statics[CMP_MAX_LAYERS];
+    uint8_t         nStatic;
+    cmpLayer_t      dynamics[CMP_MAX_LAYERS];
+    uint8_t         nDynamic;
+    uint64_t        rebuilds;                   /// Times the cache was redrawn
+    uint64_t        frames;
+} compositor_t;
+
+/**
+ * @brief Create a compositor for a w x h frame.
+ *
+ * @return STATUS_OK on success, ERROR_INVALID_PARAMS or ERROR_UNKNOWN on failure.
+ */
+status_t createCompositor(compositor_t **c, xy_t w, xy_t h);
+
+/**
+ * @brief Destroy a compositor and set the pointer to NULL.
+ */
+void destroyCompositor(compositor_t **c);
+
+/**
+ * @brief Append a static layer (drawn bottom to top in the order added).
+ */
+status_t cmpAddStatic(compositor_t *c, cmpDrawFunc_t draw, void *ctx);
+
+/**
+ * @brief Append a dynamic layer, drawn every frame over the static cache.
+ */
+status_t cmpAddDynamic(compositor_t *c, cmpDrawFunc_t draw, void *ctx);
+
+/**
+ * @brief Mark the static cache stale (resize, settings or label change).
+ */
+void cmpInvalidate(compositor_t *c);
+
+/**
+ * @brief Change the frame size; reallocates the cache and invalidates it.
+ */
+status_t cmpResize(compositor_t *c, xy_t w, xy_t h);
+
+/**
+ * @brief Redraw the static cache if it is stale.
+ *
+ * @return 1 if it was redrawn, 0 if it was still valid.
+ */
+uint8_t cmpRefresh(compositor_t *c);
+
+/**
+ * @brief Compose a frame: refresh, copy the cache into t, draw the dynamic layers.
+ */
+void cmpCompose(compositor_t *c, rsTarget_t *t);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
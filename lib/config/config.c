@@ -0,0 +1,379 @@
+#define _GNU_SOURCE
+#include "config.h"
+
+#include <stddef.h>
+#include <ctype.h>
+#include <sched.h>
+#include <sys/stat.h>
+
+#include "../../include/global.h"
+
+typedef enum cfgType_t {
+    CFG_INT = 0,
+    CFG_UINT,
+    CFG_DOUBLE,
+    CFG_STR,
+    CFG_BACKEND,
+    CFG_CPULIST,
+} cfgType_t;
+
+typedef struct cfgOption_t {
+    const char *    key;
+    cfgType_t       type;
+    size_t          offset;
+    double          min;
+    double          max;
+    const char *    help;
+} cfgOption_t;
+
+static const cfgOption_t cfgOptions[] = {
+    { "width",         CFG_INT,     offsetof(oscConfig_t, windowW),      64, 16384, "window width in pixels" },
+    { "height",        CFG_INT,     offsetof(oscConfig_t, windowH),      64, 16384, "window height in pixels" },
+    { "fps",           CFG_UINT,    offsetof(oscConfig_t, fps),          1,  1000,  "target frame rate" },
+    { "backend",       CFG_BACKEND, offsetof(oscConfig_t, backend),      0,  0,     "raster | zero-copy | geometry" },
+    { "font",          CFG_STR,     offsetof(oscConfig_t, fontPath),     0,  0,     "TTF font file" },
+    { "font-size",     CFG_UINT,    offsetof(oscConfig_t, fontSize),     4,  255,   "font size in points" },
+    { "font-cache",    CFG_STR,     offsetof(oscConfig_t, fontCache),    0,  0,     "glyph atlas cache directory (empty = off)" },
+    { "sample-rate",   CFG_DOUBLE,  offsetof(oscConfig_t, sampleRate),   1,  1e12,  "acquisition rate, samples/s" },
+    { "decimate",      CFG_UINT,    offsetof(oscConfig_t, decimate),     1,  1024,  "decimation between source and stores, 1 = off" },
+    { "record-length", CFG_UINT,    offsetof(oscConfig_t, recordLength), 1,  4294967295.0, "samples per acquisition" },
+    { "channels",      CFG_UINT,    offsetof(oscConfig_t, channels),     1,  CFG_MAX_CHANNELS, "enabled channels" },
+    { "ring-size",     CFG_UINT,    offsetof(oscConfig_t, ringSize),     1,  2147483648.0, "sample store depth per channel" },
+    { "segments",      CFG_UINT,    offsetof(oscConfig_t, segments),     0,  1048576, "segmented memory slots of one record, 0 = only enough for the mask and average records" },
+    { "threads",       CFG_UINT,    offsetof(oscConfig_t, threads),      0,  256,   "worker threads, 0 = one per core" },
+    { "cpus",          CFG_CPULIST, offsetof(oscConfig_t, cpus),         0,  0,     "core pinning, e.g. 2-5,8 (empty = none)" },
+    { "source",        CFG_STR,     offsetof(oscConfig_t, source),       0,  0,     "file or FIFO of interleaved float32 frames, one sample per channel (empty = none)" },
+    { "math",          CFG_STR,     offsetof(oscConfig_t, math),         0,  0,     "math channel after the last channel, e.g. (CH1-CH2)*0.5 (empty = none)" },
+    { "interp",        CFG_STR,     offsetof(oscConfig_t, interp),       0,  0,     "zoomed-in interpolation: sinc or linear" },
+    { "decode",        CFG_STR,     offsetof(oscConfig_t, decode),       0,  0,     "protocol decoder on channels 1 ...: uart, spi or i2c (empty = off)" },
+    { "socket",        CFG_STR,     offsetof(oscConfig_t, socketPath),   0,  0,     "SCPI control socket path (empty = off)" },
+    { "latency-file",  CFG_STR,     offsetof(oscConfig_t, latencyFile),  0,  0,     "latency histogram dump file (empty = off)" },
+    { "bit-rate",      CFG_DOUBLE,  offsetof(oscConfig_t, bitRate),      1,  1e12,  "eye diagram data rate, bits/s" },
+    { "history",       CFG_UINT,    offsetof(oscConfig_t, historyMiB),   0,  1048576, "compressed history per channel, MiB, 0 = off" },
+    { "mask-tol",      CFG_DOUBLE,  offsetof(oscConfig_t, maskTol),      0,  1e12,  "mask test margin around the golden record" },
+    { "average",       CFG_UINT,    offsetof(oscConfig_t, averages),     2,  65536, "records averaged in average mode" },
+    { "hires",         CFG_UINT,    offsetof(oscConfig_t, hires),        1,  512,   "samples boxcar-averaged per point in average mode, 1 = off" },
+};
+
+#define CFG_N_OPTIONS       (sizeof(cfgOptions) / sizeof(cfgOptions[0]))
+
+static const char *cfgBackendNames[] = { "raster", "zero-copy", "geometry" };
+
+void cfgDefaults(oscConfig_t *cfg){
+    if(__is_null(cfg)) return;
+    memset(cfg, 0, sizeof(oscConfig_t));
+    cfg->windowW      = 640;
+    cfg->windowH      = 480;
+    cfg->fps          = 20;
+    cfg->backend      = CFG_BACKEND_ZERO_COPY;
+    strncpy(cfg->fontPath, FONT_PATH, CFG_PATH_SIZE - 1);
+    cfg->fontSize     = FONT_SIZE;
+    /// XDG cache, else ~/.cache; neither set leaves the cache off
+    const char *xdg = getenv("XDG_CACHE_HOME"), *home = getenv("HOME");
+    if(__is_not_null(xdg) && xdg[0])        snprintf(cfg->fontCache, CFG_PATH_SIZE, "%s/osc", xdg);
+    else if(__is_not_null(home) && home[0]) snprintf(cfg->fontCache, CFG_PATH_SIZE, "%s/.cache/osc", home);
+    strncpy(cfg->interp, "sinc", CFG_PATH_SIZE - 1);
+    cfg->sampleRate   = 1e6;
+    cfg->bitRate      = 1e5;
+    cfg->maskTol      = 0.1;
+    cfg->averages     = 16;
+    cfg->hires        = 1;
+    cfg->decimate     = 1;
+    cfg->recordLength = 1U << 16;
+    cfg->channels     = 2;
+    cfg->ringSize     = 1U << 22;
+    cfg->segments     = 0;
+    cfg->threads      = 0;
+    cfg->nCpus        = 0;
+}
+
+static const cfgOption_t *cfgFind(const char *key){
+    REPTT(size_t, i, 0, CFG_N_OPTIONS){
+        if(strcmp(cfgOptions[i].key, key) == 0) return &cfgOptions[i];
+    }
+    return NULL;
+}
+
+/// "2-5,8" -> {2, 3, 4, 5, 8}
+static status_t cfgParseCpus(oscConfig_t *cfg, const char *s){
+    uint32_t n = 0;
+    while(*s){
+        char *end;
+        long a = strtol(s, &end, 10), b;
+        if(end == s || a < 0) return ERROR_INVALID_PARAMS;
+        b = a;
+        s = end;
+        if(*s == '-'){
+            b = strtol(s + 1, &end, 10);
+            if(end == s + 1 || b < a) return ERROR_INVALID_PARAMS;
+            s = end;
+        }
+        for(long c = a; c <= b; ++c){
+            if(n >= CFG_MAX_CPUS) return ERROR_INVALID_PARAMS;
+            cfg->cpus[n++] = (int32_t)c;
+        }
+        if(*s == ',') ++s;
+        else if(*s) return ERROR_INVALID_PARAMS;
+    }
+    cfg->nCpus = n;
+    return STATUS_OK;
+}
+
+status_t cfgSet(oscConfig_t *cfg, const char *key, const char *value){
+    if(__is_null(cfg) || __is_null(key) || __is_null(value)) return ERROR_INVALID_PARAMS;
+    const cfgOption_t *o = cfgFind(key);
+    if(__is_null(o)){
+        __err("[cfgSet] Unknown option '%s'", key);
+        return ERROR_INVALID_PARAMS;
+    }
+    uint8_t *field = (uint8_t *)cfg + o->offset;
+    char    *end;
+
+    switch(o->type){
+        case CFG_INT:
+        case CFG_UINT:
+        case CFG_DOUBLE: {
+            double v = strtod(value, &end);
+            if(end == value || *end != '\0' || v < o->min || v > o->max){
+                __err("[cfgSet] %s = '%s': expected a number in [%g, %g]", key, value, o->min, o->max);
+                return ERROR_INVALID_PARAMS;
+            }
+            if(o->type == CFG_INT)       *(int32_t *)field  = (int32_t)v;
+            else if(o->type == CFG_UINT) *(uint32_t *)field = (uint32_t)v;
+            else                         *(double *)field   = v;
+            return STATUS_OK;
+        }
+        case CFG_STR:
+            if(strlen(value) >= CFG_PATH_SIZE){
+                __err("[cfgSet] %s: value too long", key);
+                return ERROR_INVALID_PARAMS;
+            }
+            strcpy((char *)field, value);
+            return STATUS_OK;
+        case CFG_BACKEND:
+            REPTT(size_t, i, 0, sizeof(cfgBackendNames) / sizeof(cfgBackendNames[0])){
+                if(strcmp(cfgBackendNames[i], value) == 0){
+                    *(cfgBackend_t *)field = (cfgBackend_t)i;
+                    return STATUS_OK;
+                }
+            }
+            __err("[cfgSet] backend = '%s': expected raster, zero-copy or geometry", value);
+            return ERROR_INVALID_PARAMS;
+        case CFG_CPULIST:
+            if(cfgParseCpus(cfg, value) != STATUS_OK){
+                __err("[cfgSet] cpus = '%s': expected a list like 0-3,6", value);
+                cfg->nCpus = 0;
+                return ERROR_INVALID_PARAMS;
+            }
+            return STATUS_OK;
+    }
+    return ERROR_INVALID_PARAMS;
+}
+
+/// Text form of one option, as cfgSet() accepts it
+static void cfgFormat(const oscConfig_t *cfg, const cfgOption_t *o, char *buf, size_t size){
+    const uint8_t *field = (const uint8_t *)cfg + o->offset;
+    switch(o->type){
+        case CFG_INT:     snprintf(buf, size, "%d", *(const int32_t *)field); break;
+        case CFG_UINT:    snprintf(buf, size, "%u", *(const uint32_t *)field); break;
+        case CFG_DOUBLE:  snprintf(buf, size, "%.17g", *(const double *)field); break;
+        case CFG_STR:     snprintf(buf, size, "%s", (const char *)field); break;
+        case CFG_BACKEND: snprintf(buf, size, "%s", cfgBackendNames[*(const cfgBackend_t *)field]); break;
+        case CFG_CPULIST: {
+            size_t len = 0;
+            buf[0] = '\0';
+            REPTT(uint32_t, i, 0, cfg->nCpus){
+                if(len + 1 >= size) break;
+                len += snprintf(buf + len, size - len, i ? ",%d" : "%d", cfg->cpus[i]);
+            }
+            break;
+        }
+    }
+}
+
+static char *cfgTrim(char *s){
+    while(isspace((unsigned char)*s)) ++s;
+    char *e = s + strlen(s);
+    while(e > s && isspace((unsigned char)e[-1])) *--e = '\0';
+    return s;
+}
+
+status_t cfgLoadFile(oscConfig_t *cfg, const char *path){
+    __entry("cfgLoadFile(%p, %s)", cfg, path);
+    if(__is_null(cfg) || __is_null(path)) return ERROR_INVALID_PARAMS;
+    FILE *f = fopen(path, "r");
+    if(__is_null(f)){
+        __err("[cfgLoadFile] Cannot open %s: %s", path, strerror(errno));
+        return ERROR_UNKNOWN;
+    }
+    char     line[CFG_PATH_SIZE + CFG_NAME_SIZE];
+    uint32_t lineNo = 0;
+    status_t status = STATUS_OK;
+    while(status == STATUS_OK && fgets(line, sizeof(line), f)){
+        ++lineNo;
+        char *s = cfgTrim(line);
+        if(*s == '\0' || *s == '#') continue;
+        char *eq = strchr(s, '=');
+        if(__is_null(eq)){
+            __err("[cfgLoadFile] %s:%u: expected key = value", path, lineNo);
+            status = ERROR_INVALID_PARAMS;
+            break;
+        }
+        *eq = '\0';
+        if(cfgSet(cfg, cfgTrim(s), cfgTrim(eq + 1)) != STATUS_OK){
+            __err("[cfgLoadFile] %s:%u: rejected", path, lineNo);
+            status = ERROR_INVALID_PARAMS;
+        }
+    }
+    fclose(f);
+    __exit("cfgLoadFile()");
+    return status;
+}
+
+status_t cfgSaveFile(const oscConfig_t *cfg, const char *path){
+    if(__is_null(cfg) || __is_null(path)) return ERROR_INVALID_PARAMS;
+    FILE *f = fopen(path, "w");
+    if(__is_null(f)){
+        __err("[cfgSaveFile] Cannot open %s: %s", path, strerror(errno));
+        return ERROR_UNKNOWN;
+    }
+    char value[CFG_PATH_SIZE];
+    REPTT(size_t, i, 0, CFG_N_OPTIONS){
+        cfgFormat(cfg, &cfgOptions[i], value, sizeof(value));
+        fprintf(f, "# %s\n%s = %s\n", cfgOptions[i].help, cfgOptions[i].key, value);
+    }
+    status_t status = (fclose(f) == 0) ? STATUS_OK : ERROR_UNKNOWN;
+    __log("[cfgSaveFile] %s", path);
+    return status;
+}
+
+/// $XDG_CONFIG_HOME/osc/presets, or ~/.config/osc/presets
+static status_t cfgPresetDir(char *dir, size_t size){
+    const char *base = getenv("XDG_CONFIG_HOME");
+    int n;
+    if(__is_not_null(base) && *base){
+        n = snprintf(dir, size, "%s/osc/presets", base);
+    }else{
+        const char *home = getenv("HOME");
+        if(__is_null(home) || !*home) return ERROR_UNKNOWN;
+        n = snprintf(dir, size, "%s/.config/osc/presets", home);
+    }
+    return (n > 0 && (size_t)n < size) ? STATUS_OK : ERROR_UNKNOWN;
+}
+
+status_t cfgPresetPath(const char *name, char *path, size_t size){
+    if(__is_null(name) || !*name || strchr(name, '/') || strlen(name) >= CFG_NAME_SIZE){
+        __err("[cfgPresetPath] Invalid preset name '%s'", name ? name : "(null)");
+        return ERROR_INVALID_PARAMS;
+    }
+    char dir[CFG_PATH_SIZE];
+    if(cfgPresetDir(dir, sizeof(dir)) != STATUS_OK) return ERROR_UNKNOWN;
+    int n = snprintf(path, size, "%s/%s.conf", dir, name);
+    return (n > 0 && (size_t)n < size) ? STATUS_OK : ERROR_UNKNOWN;
+}
+
+status_t cfgLoadPreset(oscConfig_t *cfg, const char *name){
+    char path[CFG_PATH_SIZE + CFG_NAME_SIZE];
+    status_t status = cfgPresetPath(name, path, sizeof(path));
+    if(status != STATUS_OK) return status;
+    return cfgLoadFile(cfg, path);
+}
+
+status_t cfgSavePreset(const oscConfig_t *cfg, const char *name){
+    char path[CFG_PATH_SIZE + CFG_NAME_SIZE], dir[CFG_PATH_SIZE];
+    status_t status = cfgPresetPath(name, path, sizeof(path));
+    if(status != STATUS_OK) return status;
+    cfgPresetDir(dir, sizeof(dir));
+    /// mkdir -p
+    for(char *p = dir + 1; *p; ++p){
+        if(*p != '/') continue;
+        *p = '\0';
+        mkdir(dir, 0755);
+        *p = '/';
+    }
+    if(mkdir(dir, 0755) != 0 && errno != EEXIST){
+        __err("[cfgSavePreset] mkdir %s: %s", dir, strerror(errno));
+        return ERROR_UNKNOWN;
+    }
+    return cfgSaveFile(cfg, path);
+}
+
+void cfgPrintUsage(const char *prog){
+    oscConfig_t def;
+    char        value[CFG_PATH_SIZE];
+    cfgDefaults(&def);
+    printf("Usage: %s [options]\n\n", prog);
+    printf("  --config <file>         load options from a key = value file\n");
+    printf("  --preset <name>         load a saved preset\n");
+    printf("  --save-preset <name>    save the options given so far as a preset\n");
+    printf("  --help                  this text\n\n");
+    REPTT(size_t, i, 0, CFG_N_OPTIONS){
+        cfgFormat(&def, &cfgOptions[i], value, sizeof(value));
+        printf("  --%-14s <v>      %s (default: %s)\n", cfgOptions[i].key, cfgOptions[i].help, value);
+    }
+}
+
+status_t cfgParseArgs(oscConfig_t *cfg, int argc, char **argv){
+    if(__is_null(cfg) || __is_null(argv)) return ERROR_INVALID_PARAMS;
+    REPTT(int, i, 1, argc){
+        const char *arg = argv[i];
+        if(strncmp(arg, "--", 2) != 0){
+            __err("[cfgParseArgs] Unexpected argument '%s'", arg);
+            return ERROR_INVALID_PARAMS;
+        }
+        if(strcmp(arg, "--help") == 0){
+            cfgPrintUsage(argv[0]);
+            return 1;
+        }
+        char        key[CFG_NAME_SIZE];
+        const char *value;
+        const char *eq = strchr(arg, '=');
+        size_t      len = eq ? (size_t)(eq - arg - 2) : strlen(arg + 2);
+        if(len == 0 || len >= sizeof(key)){
+            __err("[cfgParseArgs] Bad option '%s'", arg);
+            return ERROR_INVALID_PARAMS;
+        }
+        memcpy(key, arg + 2, len);
+        key[len] = '\0';
+        if(eq){
+            value = eq + 1;
+        }else if(i + 1 < argc){
+            value = argv[++i];
+        }else{
+            __err("[cfgParseArgs] --%s needs a value", key);
+            return ERROR_INVALID_PARAMS;
+        }
+
+        status_t status;
+        if(strcmp(key, "config") == 0)           status = cfgLoadFile(cfg, value);
+        else if(strcmp(key, "preset") == 0)      status = cfgLoadPreset(cfg, value);
+        else if(strcmp(key, "save-preset") == 0) status = cfgSavePreset(cfg, value);
+        else                                     status = cfgSet(cfg, key, value);
+        if(status != STATUS_OK) return ERROR_INVALID_PARAMS;
+    }
+    return STATUS_OK;
+}
+
+void cfgLog(const oscConfig_t *cfg){
+    if(__is_null(cfg)) return;
+    char value[CFG_PATH_SIZE];
+    REPTT(size_t, i, 0, CFG_N_OPTIONS){
+        cfgFormat(cfg, &cfgOptions[i], value, sizeof(value));
+        __log("[config] %s = %s", cfgOptions[i].key, value);
+    }
+}
+
+status_t cfgPinThread(const oscConfig_t *cfg, uint32_t slot){
+    if(__is_null(cfg)) return ERROR_INVALID_PARAMS;
+    if(cfg->nCpus == 0) return STATUS_OK;
+    int32_t   cpu = cfg->cpus[slot % cfg->nCpus];
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    int rc = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    if(rc != 0){
+        __err("[cfgPinThread] cpu %d: %s", cpu, strerror(rc));
+        return ERROR_UNKNOWN;
+    }
+    return STATUS_OK;
+}
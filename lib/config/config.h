@@ -0,0 +1,134 @@
+#ifndef __CONFIG_H__
+#define __CONFIG_H__
+
+#ifdef LOG_HEADER_INCLUDE
+#pragma message("INCLUDE: config.h")
+#endif
+
+#include <stdint.h>
+
+#include "../windowContext/windowContext.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CFG_PATH_SIZE       256
+#define CFG_NAME_SIZE       64
+#define CFG_MAX_CPUS        64
+#define CFG_MAX_CHANNELS    8                   /// OSC_MAX_CHANNELS, SC_MAX_CHANNELS
+
+typedef enum cfgBackend_t {
+    CFG_BACKEND_RASTER = 0,                     /// CPU compose into screenBuffer + SDL_UpdateTexture
+    CFG_BACKEND_ZERO_COPY,                      /// CPU compose into the locked texture
+    CFG_BACKEND_GEOMETRY,                       /// SDL_RenderGeometry batches
+} cfgBackend_t;
+
+/**
+ * @brief Everything that used to be a compile-time constant.
+ */
+typedef struct oscConfig_t {
+    int32_t         windowW;
+    int32_t         windowH;
+    uint32_t        fps;                        /// Target frame rate
+    cfgBackend_t    backend;
+    char            fontPath[CFG_PATH_SIZE];
+    uint32_t        fontSize;
+    char            fontCache[CFG_PATH_SIZE];   /// Glyph atlas cache directory, empty = off
+    double          sampleRate;                 /// Acquisition (source) rate, samples/s
+    uint32_t        decimate;                   /// Source samples per stored sample (1 = no decimator)
+    uint32_t        recordLength;               /// Samples per acquisition
+    uint32_t        channels;                   /// Channels 1 ... channels get a sample store
+    uint32_t        ringSize;                   /// Sample store depth per channel
+    uint32_t        segments;                   /// Segmented memory slots of one record each (0 = just the mask / average records)
+    uint32_t        threads;                    /// Worker pool size (0 = one per online core)
+    int32_t         cpus[CFG_MAX_CPUS];         /// Core pinning, in thread order
+    uint32_t        nCpus;                      /// 0 = no pinning
+    char            source[CFG_PATH_SIZE];      /// Interleaved float32 frames to acquire from, empty = none
+    char            math[CFG_PATH_SIZE];        /// Math channel expression over the stored channels, empty = no math slot
+    char            interp[CFG_PATH_SIZE];      /// Interpolation for views zoomed in past one sample per column: sinc or linear
+    char            decode[CFG_PATH_SIZE];      /// Protocol decoder over channels 1 ..., empty = off
+    char            socketPath[CFG_PATH_SIZE];  /// SCPI control socket, empty = off
+    char            latencyFile[CFG_PATH_SIZE]; /// Latency histogram dump ('l' key and exit), empty = off
+    double          bitRate;                    /// Serial data rate for the eye diagram, bits/s
+    uint32_t        historyMiB;                 /// Compressed history per channel behind the sample store (0 = off)
+    double          maskTol;                    /// Mask test margin around the golden record, signal units
+    uint32_t        averages;                   /// Records averaged in average mode
+    uint32_t        hires;                      /// Hi-res boxcar length in average mode (1 = off)
+} oscConfig_t;
+
+/**
+ * @brief Fill in the built-in defaults.
+ */
+void cfgDefaults(oscConfig_t *cfg);
+
+/**
+ * @brief Set one option from text, e.g. ("fps", "120") or ("cpus", "2-5,8").
+ *
+ * @return STATUS_OK, or ERROR_INVALID_PARAMS for an unknown key or a bad / out-of-range value.
+ */
+status_t cfgSet(oscConfig_t *cfg, const char *key, const char *value);
+
+/**
+ * @brief Read `key = value` lines; blank lines and lines starting with '#' are skipped.
+ *
+ * @return STATUS_OK, ERROR_UNKNOWN if the file cannot be opened, or
+ *         ERROR_INVALID_PARAMS on the first bad line (later lines are not applied).
+ */
+status_t cfgLoadFile(oscConfig_t *cfg, const char *path);
+
+/**
+ * @brief Write every option as `key = value`.
+ */
+status_t cfgSaveFile(const oscConfig_t *cfg, const char *path);
+
+/**
+ * @brief Path of a named preset: $XDG_CONFIG_HOME/osc/presets/<name>.conf (or ~/.config/...).
+ *
+ * @return STATUS_OK, ERROR_INVALID_PARAMS for an empty name or one containing '/'.
+ */
+status_t cfgPresetPath(const char *name, char *path, size_t size);
+
+/**
+ * @brief Load a named preset on top of cfg.
+ */
+status_t cfgLoadPreset(oscConfig_t *cfg, const char *name);
+
+/**
+ * @brief Save cfg as a named preset, creating the preset directory if needed.
+ */
+status_t cfgSavePreset(const oscConfig_t *cfg, const char *name);
+
+/**
+ * @brief Apply the command line in order on top of cfg.
+ *
+ * Every option is accepted as `--key=value` or `--key value`. Besides the
+ * option keys: `--config <file>`, `--preset <name>`, `--save-preset <name>`
+ * and `--help`. Later arguments override earlier ones, so
+ * `--preset lab --fps 60` starts from the preset.
+ *
+ * @return STATUS_OK, ERROR_INVALID_PARAMS on a bad argument, or 1 if --help
+ *         was given (usage has been printed).
+ */
+status_t cfgParseArgs(oscConfig_t *cfg, int argc, char **argv);
+
+/**
+ * @brief Print the options with their defaults.
+ */
+void cfgPrintUsage(const char *prog);
+
+/**
+ * @brief Log the effective configuration.
+ */
+void cfgLog(const oscConfig_t *cfg);
+
+/**
+ * @brief Pin the calling thread to cpus[slot % nCpus]; no-op without a cpu list.
+ */
+status_t cfgPinThread(const oscConfig_t *cfg, uint32_t slot);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,261 @@
+#include "decimator.h"
+
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+
+#include "../../include/global.h"
+
+#define DF_DESIGN_GRID      2048
+#define DF_MAX_COMP_GAIN    8.0
+
+/// DESIGN ////////////////////////////////////////////////////////////////////////////////////////
+
+/// Inverse of the CIC magnitude at f (cycles per CIC output sample), clamped
+static double dfCicCompensation(const decimator_t *df, double f){
+    if(df->rCic == 1 || f <= 0.0) return 1.0;
+    double r = df->rCic;
+    double h = fabs(sin(M_PI * f) / (r * sin(M_PI * f / r)));
+    h = pow(h, DF_CIC_STAGES);
+    return (h * DF_MAX_COMP_GAIN < 1.0) ? DF_MAX_COMP_GAIN : 1.0 / h;
+}
+
+static double dfResponseAt(const double *h, uint16_t n, double f){
+    double re = 0.0, im = 0.0;
+    REPTT(uint16_t, i, 0, n){
+        re += h[i] * cos(2.0 * M_PI * f * i);
+        im -= h[i] * sin(2.0 * M_PI * f * i);
+    }
+    return sqrt(re * re + im * im);
+}
+
+/// Frequency-sampling design of the (CIC-compensated) target, Blackman windowed
+static void dfDesign(decimator_t *df){
+    const uint16_t L = df->nTaps;
+    const double   c = 0.5 * (L - 1);
+    const double   scale = 0.5 / df->rFir;          /// Output Nyquist in FIR input cycles/sample
+    double lo, hi, ref;
+    if(df->conf.response == DF_BANDPASS){
+        lo  = __max(0.0, (df->conf.center - df->conf.cutoff) * scale);
+        hi  = __min(0.5, (df->conf.center + df->conf.cutoff) * scale);
+        ref = df->conf.center * scale;
+    }else{
+        lo  = 0.0;
+        hi  = df->conf.cutoff * scale;
+        ref = 0.0;
+    }
+
+    double h[DF_MAX_TAPS];
+    const double step = 0.5 / DF_DESIGN_GRID;
+    REPTT(uint16_t, i, 0, L){
+        double acc = 0.0;
+        REPTT(uint32_t, k, 0, DF_DESIGN_GRID){
+            double f = (k + 0.5) * step;
+            if(f < lo || f > hi) continue;
+            acc += 2.0 * dfCicCompensation(df, f) * cos(2.0 * M_PI * f * (i - c)) * step;
+        }
+        double w = (L > 1) ? 0.42 - 0.5 * cos(2.0 * M_PI * i / (L - 1)) + 0.08 * cos(4.0 * M_PI * i / (L - 1)) : 1.0;
+        h[i] = acc * w;
+    }
+
+    /// Unity gain at DC (lowpass) or at the band centre, after the CIC
+    double g = dfResponseAt(h, L, ref) / dfCicCompensation(df, ref);
+    if(g > 0.0) REPTT(uint16_t, i, 0, L) h[i] /= g;
+
+    /// Polyphase split: sub[p][j] = h[j * rFir + p]
+    REPTT(uint16_t, p, 0, df->rFir){
+        REPTT(uint16_t, j, 0, df->subTaps){
+            uint32_t k = (uint32_t)j * df->rFir + p;
+            df->sub[p * df->subTaps + j] = (k < L) ? (float)h[k] : 0.0f;
+        }
+    }
+}
+
+/// CIC ///////////////////////////////////////////////////////////////////////////////////////////
+
+/// Runs the CIC until `cap` outputs are produced or input runs out; returns inputs consumed
+static uint32_t dfCic(decimator_t *df, const float *in, uint32_t n, float *out, uint32_t cap, uint32_t *nOut){
+    uint64_t *I = df->integ, *C = df->comb;
+    uint32_t i = 0, o = 0;
+    while(i < n && o < cap){
+        uint64_t v = (uint64_t)(int64_t)llrint(in[i++] * df->cicScale);
+        REPTT(uint8_t, s, 0, DF_CIC_STAGES){
+            I[s] += v;
+            v = I[s];
+        }
+        if(++df->cicPhase < df->rCic) continue;
+        df->cicPhase = 0;
+        REPTT(uint8_t, s, 0, DF_CIC_STAGES){
+            uint64_t d = v - C[s];
+            C[s] = v;
+            v = d;
+        }
+        out[o++] = (float)((double)(int64_t)v * df->cicGain);
+    }
+    *nOut = o;
+    return i;
+}
+
+/// POLYPHASE FIR /////////////////////////////////////////////////////////////////////////////////
+
+#define dfRow(df, p)    ((df)->rows + (size_t)(p) * (df)->rowSize)
+
+/// Commutate n inputs into the phase rows, then emit every output whose phase-0 sample arrived
+static uint32_t dfFir(decimator_t *df, const float *in, uint32_t n, float *out){
+    const uint16_t D = df->rFir, T = df->subTaps, H = T - 1;
+
+    REPTT(uint32_t, i, 0, n){
+        uint16_t p = df->firPhase;
+        dfRow(df, p)[H + df->rowCount[p]++] = in[i];
+        df->firPhase = (p == 0) ? D - 1 : p - 1;
+    }
+
+    const uint32_t K = df->rowCount[0];
+    uint32_t m = 0;
+#if defined(__SSE__)
+    for(; m + 4 <= K; m += 4){
+        __m128 acc = _mm_setzero_ps();
+        REPTT(uint16_t, p, 0, D){
+            const float *row = dfRow(df, p) + H + m;
+            const float *e   = df->sub + p * T;
+            REPTT(uint16_t, j, 0, T)
+                acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(e[j]), _mm_loadu_ps(row - j)));
+        }
+        _mm_storeu_ps(out + m, acc);
+    }
+#endif
+    for(; m < K; ++m){
+        float acc = 0.0f;
+        REPTT(uint16_t, p, 0, D){
+            const float *row = dfRow(df, p) + H + m;
+            const float *e   = df->sub + p * T;
+            REPTT(uint16_t, j, 0, T) acc += e[j] * row[-(int32_t)j];
+        }
+        out[m] = acc;
+    }
+
+    /// Keep the history plus any phase samples that belong to the next output
+    REPTT(uint16_t, p, 0, D){
+        float *row = dfRow(df, p);
+        memmove(row, row + K, sizeof(float) * (H + df->rowCount[p] - K));
+        df->rowCount[p] -= K;
+    }
+    return K;
+}
+
+/// API ///////////////////////////////////////////////////////////////////////////////////////////
+
+status_t createDecimator(decimator_t **df, const decimatorConfig_t *conf){
+    __entry("createDecimator(%p, %p)", df, conf);
+    if(__is_null(df) || __is_null(conf)){
+        __err("[createDecimator] df = %p, conf = %p", df, conf);
+        return ERROR_INVALID_PARAMS;
+    }
+    if(conf->ratio < DF_MIN_RATIO || conf->ratio > DF_MAX_RATIO || !(conf->cutoff > 0.0f) || conf->cutoff > 1.0f
+        || (conf->response == DF_BANDPASS && (conf->center <= 0.0f || conf->center >= 1.0f))
+        || conf->taps > DF_MAX_TAPS){
+        __err("[createDecimator] Unsupported config: ratio = %u, cutoff = %g, center = %g, taps = %u",
+            conf->ratio, conf->cutoff, conf->center, conf->taps);
+        return ERROR_INVALID_PARAMS;
+    }
+
+    *df = (decimator_t *) mpAlloc(sizeof(decimator_t));
+    if(__is_null(*df)){
+        __err("[createDecimator] malloc failed!");
+        return ERROR_UNKNOWN;
+    }
+    memset(*df, 0, sizeof(decimator_t));
+    (*df)->conf = *conf;
+
+    /// Small ratios: FIR only. Even ratios: CIC then a half-band-ish FIR by 2. Odd: CIC + compensator.
+    if(conf->ratio <= DF_MAX_FIR_RATIO)     (*df)->rFir = conf->ratio;
+    else if(conf->ratio % 2 == 0)           (*df)->rFir = 2;
+    else                                    (*df)->rFir = 1;
+    (*df)->rCic = conf->ratio / (*df)->rFir;
+
+    uint16_t L = conf->taps ? conf->taps : (uint16_t)__min(DF_MAX_TAPS, 32 * (*df)->rFir + 1);
+    (*df)->nTaps   = L;
+    (*df)->subTaps = (uint16_t)((L + (*df)->rFir - 1) / (*df)->rFir);
+    (*df)->rowSize = (*df)->subTaps + DF_BLOCK_SIZE + 1;
+
+    /// Give the CIC all the headroom that the R^N growth leaves in 63 bits
+    double growth = DF_CIC_STAGES * ceil(log2((double)(*df)->rCic));
+    (*df)->cicScale = ldexp(1.0, (int)(62 - growth)) / DF_CIC_RANGE;
+    (*df)->cicGain  = 1.0 / (pow((double)(*df)->rCic, DF_CIC_STAGES) * (*df)->cicScale);
+
+    (*df)->sub    = (float *) mpAlloc(sizeof(float) * (*df)->rFir * (*df)->subTaps);
+    (*df)->rows   = (float *) mpAlloc(sizeof(float) * (*df)->rFir * (*df)->rowSize);
+    (*df)->cicOut = (float *) mpAlloc(sizeof(float) * DF_BLOCK_SIZE * (*df)->rFir);
+    if(__is_null((*df)->sub) || __is_null((*df)->rows) || __is_null((*df)->cicOut)){
+        __err("[createDecimator] malloc failed!");
+        destroyDecimator(df);
+        return ERROR_UNKNOWN;
+    }
+
+    dfDesign(*df);
+    dfReset(*df);
+
+    __log("[createDecimator] ratio %u = CIC %u x FIR %u (%u taps, %u per phase)",
+        conf->ratio, (*df)->rCic, (*df)->rFir, (*df)->nTaps, (*df)->subTaps);
+    __exit("createDecimator()");
+    return STATUS_OK;
+}
+
+void destroyDecimator(decimator_t **df){
+    if(__is_null(df) || __is_null(*df)) return;
+    mpFree((*df)->sub);
+    mpFree((*df)->rows);
+    mpFree((*df)->cicOut);
+    mpFree(*df);
+    *df = NULL;
+}
+
+void dfReset(decimator_t *df){
+    if(__is_null(df)) return;
+    memset(df->integ, 0, sizeof(df->integ));
+    memset(df->comb,  0, sizeof(df->comb));
+    df->cicPhase = 0;
+    memset(df->rows, 0, sizeof(float) * df->rFir * df->rowSize);
+    /// Phases 1...D-1 of output 0 are samples before time 0
+    REPTT(uint16_t, p, 0, df->rFir) df->rowCount[p] = (p == 0) ? 0 : 1;
+    df->firPhase = 0;
+}
+
+uint32_t dfProcess(decimator_t *df, const float *in, uint32_t n, float *out){
+    if(__is_null(df) || __is_null(in) || __is_null(out)) return 0;
+    const uint32_t chunk = DF_BLOCK_SIZE * df->rFir;
+    uint32_t nOut = 0;
+    while(n > 0){
+        const float *firIn = in;
+        uint32_t     firN;
+        if(df->rCic == 1){
+            firN = __min(n, chunk);
+            in += firN;
+            n  -= firN;
+        }else{
+            uint32_t used = dfCic(df, in, n, df->cicOut, chunk, &firN);
+            firIn = df->cicOut;
+            in += used;
+            n  -= used;
+        }
+        nOut += dfFir(df, firIn, firN, out + nOut);
+    }
+    return nOut;
+}
+
+uint32_t dfPush(decimator_t *df, const float *in, uint32_t n, sampleStore_t *store){
+    if(__is_null(df) || __is_null(store)) return 0;
+    float    out[DF_BLOCK_SIZE];
+    uint32_t total = 0;
+    /// Bounded input slices keep the output within the stack block
+    const uint32_t slice = (uint32_t)DF_BLOCK_SIZE * df->conf.ratio - df->conf.ratio;
+    while(n > 0){
+        uint32_t m = __min(n, slice);
+        uint32_t k = dfProcess(df, in, m, out);
+        ssWrite(store, out, k);
+        total += k;
+        in += m;
+        n  -= m;
+    }
+    return total;
+}
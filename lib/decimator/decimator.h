@@ -0,0 +1,120 @@
+#ifndef __DECIMATOR_H__
+#define __DECIMATOR_H__
+
+#ifdef LOG_HEADER_INCLUDE
+#pragma message("INCLUDE: decimator.h")
+#endif
+
+#include <stdint.h>
+
+#include "../windowContext/windowContext.h"
+#include "../sampleStore/sampleStore.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DF_MIN_RATIO        2
+#define DF_MAX_RATIO        1024
+#define DF_CIC_STAGES       4
+#define DF_CIC_RANGE        128.0               /// CIC input must stay within +-DF_CIC_RANGE
+#define DF_MAX_FIR_RATIO    4                   /// Larger ratios go through the CIC
+#define DF_MAX_TAPS         256
+#define DF_BLOCK_SIZE       256                 /// Outputs produced per FIR pass
+
+typedef enum dfResponse_t {
+    DF_LOWPASS = 0,
+    DF_BANDPASS,
+} dfResponse_t;
+
+/**
+ * @brief Decimating filter configuration.
+ *
+ * Frequencies are fractions of the output Nyquist rate (0...1).
+ */
+typedef struct decimatorConfig_t {
+    uint16_t        ratio;                      /// Total decimation, DF_MIN_RATIO ... DF_MAX_RATIO
+    dfResponse_t    response;
+    float           cutoff;                     /// Lowpass: passband edge. Bandpass: half bandwidth
+    float           center;                     /// Bandpass centre (ignored for lowpass)
+    uint16_t        taps;                       /// FIR length, 0 = pick from the FIR ratio
+} decimatorConfig_t;
+
+/**
+ * @brief Streaming CIC + compensating polyphase FIR decimator.
+ *
+ * Large ratios are split into a CIC stage (integer, multiplier-free) and a
+ * final FIR stage of ratio rFir that also flattens the CIC droop. The FIR is
+ * split into rFir polyphase sub-filters, each run only at the output rate.
+ */
+typedef struct decimator_t {
+    decimatorConfig_t conf;
+    uint16_t        rCic;
+    uint16_t        rFir;
+
+    /// CIC
+    uint64_t        integ[DF_CIC_STAGES];       /// Wrap-around arithmetic is intentional
+    uint64_t        comb[DF_CIC_STAGES];
+    uint16_t        cicPhase;
+    double          cicScale;                   /// float -> fixed point, sized so R^N growth fits 63 bits
+    double          cicGain;
+    float *         cicOut;                     /// One block of CIC output (FIR input)
+
+    /// Polyphase FIR
+    uint16_t        nTaps;
+    uint16_t        subTaps;                    /// Taps per phase
+    float *         sub;                        /// [rFir][subTaps] phase sub-filters
+    float *         rows;                       /// [rFir][rowSize] commutated input per phase
+    uint32_t        rowSize;
+    uint32_t        rowCount[DF_MAX_FIR_RATIO]; /// New entries per phase row (after history)
+    uint16_t        firPhase;                   /// Next phase to be written
+} decimator_t;
+
+/**
+ * @brief Create a decimator.
+ *
+ * @param[out] df    Pointer to a decimator pointer. Will be allocated inside.
+ * @param[in]  conf  Configuration.
+ *
+ * @return STATUS_OK on success, ERROR_INVALID_PARAMS for an unsupported configuration.
+ */
+status_t createDecimator(decimator_t **df, const decimatorConfig_t *conf);
+
+/**
+ * @brief Destroy a decimator and set the pointer to NULL.
+ */
+void destroyDecimator(decimator_t **df);
+
+/**
+ * @brief Clear all filter state.
+ */
+void dfReset(decimator_t *df);
+
+/**
+ * @brief Filter and decimate a block of input.
+ *
+ * State carries across calls so input may arrive in any block size.
+ *
+ * @param[in,out] df   Decimator.
+ * @param[in]     in   Input samples.
+ * @param[in]     n    Number of input samples.
+ * @param[out]    out  Output, room for at least n / ratio + 1 samples.
+ *
+ * @return Number of output samples written.
+ */
+uint32_t dfProcess(decimator_t *df, const float *in, uint32_t n, float *out);
+
+/**
+ * @brief Filter and decimate a block straight into a sample store.
+ *
+ * This is the acquisition-path entry point: source -> decimator -> store.
+ *
+ * @return Number of samples appended to the store.
+ */
+uint32_t dfPush(decimator_t *df, const float *in, uint32_t n, sampleStore_t *store);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,277 @@
+#include "density.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "../../include/global.h"
+
+#define DN_PARALLEL_MIN     16384               /// Fewer points are binned on the calling thread
+#define DN_BANDS            32                  /// Row bands for merge / render jobs
+
+typedef struct dnBinJob_t {
+    density_t *     dn;
+    const float *   x;
+    const float *   y;
+    uint64_t        n;
+} dnBinJob_t;
+
+/// Four colour stops of a phosphor-like ramp
+static const color_t dnRamp[4] = { __hexRGBA(0x004010FF), __hexRGBA(0x00C040FF), __hexRGBA(0xE0FF40FF), __hexRGBA(0xFFFFFFFF) };
+
+static void dnDefaultColormap(density_t *dn){
+    REPTT(int, i, 0, 256){
+        float   t = i / 255.0f * 3.0f;
+        int     s = __min(2, (int)t);
+        float   f = t - s;
+        uint32_t a = (uint32_t)dnRamp[s], b = (uint32_t)dnRamp[s + 1], c = 0;
+        REPTT(int, k, 0, 4){                    /// Every byte, whatever the layout: the stops are opaque
+            float ca = (float)((a >> (8 * k)) & 0xFF), cb = (float)((b >> (8 * k)) & 0xFF);
+            c |= (uint32_t)lrintf(ca + (cb - ca) * f) << (8 * k);
+        }
+        dn->colormap[i] = (color_t)c;
+    }
+}
+
+status_t createDensity(density_t **dn, xy_t w, xy_t h, workerPool_t *wp){
+    __entry("createDensity(%p, %d, %d, %p)", dn, w, h, wp);
+    /// Cell indices are formed in float, exact below 2^24
+    if(__is_null(dn) || w <= 0 || h <= 0 || (int64_t)w * h > (1 << 24)){
+        __err("[createDensity] Invalid params!");
+        return ERROR_INVALID_PARAMS;
+    }
+    *dn = (density_t *) mpCalloc(1, sizeof(density_t));
+    if(__is_null(*dn)){
+        __err("[createDensity] malloc failed!");
+        return ERROR_UNKNOWN;
+    }
+    density_t *d = *dn;
+    const size_t cells = (size_t)w * h;
+    d->w      = w;
+    d->h      = h;
+    d->wp     = wp;
+    d->nGrids = (wp && wp->nThreads) ? wp->nThreads + 1 : 0;
+    d->grid   = (uint32_t *) mpCalloc(cells, sizeof(uint32_t));
+    uint8_t ok = __is_not_null(d->grid);
+    REPTT(uint32_t, g, 0, d->nGrids){
+        d->local[g] = (uint32_t *) mpCalloc(cells, sizeof(uint32_t));
+        ok = ok && __is_not_null(d->local[g]);
+    }
+    if(!ok){
+        __err("[createDensity] malloc(%u x %zu cells) failed!", d->nGrids + 1, cells);
+        destroyDensity(dn);
+        return ERROR_UNKNOWN;
+    }
+    dnSetRange(d, -1.0f, 1.0f, -1.0f, 1.0f);
+    dnDefaultColormap(d);
+    __exit("createDensity()");
+    return STATUS_OK;
+}
+
+void destroyDensity(density_t **dn){
+    if(__is_null(dn) || __is_null(*dn)) return;
+    REPTT(uint32_t, g, 0, (*dn)->nGrids) mpFree((*dn)->local[g]);
+    mpFree((*dn)->grid);
+    mpFree(*dn);
+    *dn = NULL;
+}
+
+void dnSetRange(density_t *dn, float xMin, float xMax, float yMin, float yMax){
+    if(__is_null(dn) || !(xMax > xMin) || !(yMax > yMin)) return;
+    dn->xMin = xMin;
+    dn->xMax = xMax;
+    dn->yMin = yMin;
+    dn->yMax = yMax;
+}
+
+void dnSetColormap(density_t *dn, const color_t *map){
+    if(__is_null(dn) || __is_null(map)) return;
+    memcpy(dn->colormap, map, sizeof(dn->colormap));
+}
+
+void dnFade(density_t *dn, uint8_t shift){
+    if(__is_null(dn)) return;
+    const size_t cells = (size_t)dn->w * dn->h;
+    if(shift == 0 || shift >= 32){
+        memset(dn->grid, 0, sizeof(uint32_t) * cells);
+        dn->points = 0;
+        return;
+    }
+    size_t i = 0;
+#if defined(__SSE2__)
+    const __m128i s = _mm_cvtsi32_si128(shift);
+    for(; i + 4 <= cells; i += 4){
+        __m128i *p = (__m128i *)(dn->grid + i);
+        _mm_storeu_si128(p, _mm_srl_epi32(_mm_loadu_si128(p), s));
+    }
+#endif
+    for(; i < cells; ++i) dn->grid[i] >>= shift;
+}
+
+/// Bin points into one grid
+static void dnBinInto(const density_t *dn, uint32_t *grid, const float *x, const float *y, uint64_t n){
+    const float sx = dn->w / (dn->xMax - dn->xMin), sy = dn->h / (dn->yMax - dn->yMin);
+    const float wF = (float)dn->w, hF = (float)dn->h;
+    uint64_t i = 0;
+#if defined(__SSE2__)
+    const __m128 vxMin = _mm_set1_ps(dn->xMin), vyMax = _mm_set1_ps(dn->yMax);
+    const __m128 vsx = _mm_set1_ps(sx), vsy = _mm_set1_ps(sy), vw = _mm_set1_ps(wF), vh = _mm_set1_ps(hF);
+    const __m128 zero = _mm_setzero_ps();
+    int32_t idx[4];
+    for(; i + 4 <= n; i += 4){
+        __m128 fx = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(x + i), vxMin), vsx);
+        __m128 fy = _mm_mul_ps(_mm_sub_ps(vyMax, _mm_loadu_ps(y + i)), vsy);
+        /// NaN compares false, so it is dropped with the out-of-range points
+        __m128 ok = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(fx, zero), _mm_cmplt_ps(fx, vw)),
+                               _mm_and_ps(_mm_cmpge_ps(fy, zero), _mm_cmplt_ps(fy, vh)));
+        int mask = _mm_movemask_ps(ok);
+        if(mask == 0) continue;
+        __m128 col = _mm_cvtepi32_ps(_mm_cvttps_epi32(_mm_and_ps(fx, ok)));
+        __m128 row = _mm_cvtepi32_ps(_mm_cvttps_epi32(_mm_and_ps(fy, ok)));
+        _mm_storeu_si128((__m128i *)idx, _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(row, vw), col)));
+        if(mask & 1) grid[idx[0]]++;
+        if(mask & 2) grid[idx[1]]++;
+        if(mask & 4) grid[idx[2]]++;
+        if(mask & 8) grid[idx[3]]++;
+    }
+#endif
+    for(; i < n; ++i){
+        float fx = (x[i] - dn->xMin) * sx, fy = (dn->yMax - y[i]) * sy;
+        if(!(fx >= 0.0f && fx < wF && fy >= 0.0f && fy < hF)) continue;
+        grid[(size_t)fy * dn->w + (size_t)fx]++;
+    }
+}
+
+static void dnBinChunk(void *ctx, uint32_t chunk){
+    const dnBinJob_t *job = (const dnBinJob_t *)ctx;
+    const density_t  *dn  = job->dn;
+    uint64_t a = job->n * chunk / dn->nGrids, b = job->n * (chunk + 1) / dn->nGrids;
+    dnBinInto(dn, dn->local[chunk], job->x + a, job->y + a, b - a);
+}
+
+/// Sum the per-thread grids into the main one and zero them, one band of rows per chunk
+static void dnMergeChunk(void *ctx, uint32_t chunk){
+    density_t *dn = (density_t *)ctx;
+    const size_t cells = (size_t)dn->w * dn->h;
+    size_t i = cells * chunk / DN_BANDS, end = cells * (chunk + 1) / DN_BANDS;
+    uint32_t *dst = dn->grid;
+#if defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    for(; i + 4 <= end; i += 4){
+        __m128i acc = _mm_loadu_si128((const __m128i *)(dst + i));
+        REPTT(uint32_t, g, 0, dn->nGrids){
+            __m128i *p = (__m128i *)(dn->local[g] + i);
+            acc = _mm_add_epi32(acc, _mm_loadu_si128(p));
+            _mm_storeu_si128(p, zero);
+        }
+        _mm_storeu_si128((__m128i *)(dst + i), acc);
+    }
+#endif
+    for(; i < end; ++i){
+        REPTT(uint32_t, g, 0, dn->nGrids){
+            dst[i] += dn->local[g][i];
+            dn->local[g][i] = 0;
+        }
+    }
+}
+
+/// @return 1 if the points went to the per-thread grids (a merge is due)
+static uint8_t dnBin(density_t *dn, const float *x, const float *y, uint64_t n){
+    dn->points += n;
+    if(dn->nGrids == 0 || n < DN_PARALLEL_MIN){
+        dnBinInto(dn, dn->grid, x, y, n);
+        return 0;
+    }
+    dnBinJob_t job = {dn, x, y, n};
+    wpRun(dn->wp, dnBinChunk, &job, dn->nGrids);
+    return 1;
+}
+
+void dnAccumulate(density_t *dn, const float *x, const float *y, uint64_t n){
+    if(__is_null(dn) || __is_null(x) || __is_null(y) || n == 0) return;
+    if(dnBin(dn, x, y, n)) wpRun(dn->wp, dnMergeChunk, dn, DN_BANDS);
+}
+
+uint64_t dnAccumulateStores(density_t *dn, const sampleStore_t *a, const sampleStore_t *b, uint64_t start, uint64_t n){
+    if(__is_null(dn) || __is_null(a) || __is_null(b) || n == 0) return 0;
+    /// Both stores must still hold the range
+    uint64_t oldest = __max(ssOldest(a), ssOldest(b));
+    uint64_t end    = __min(start + n, __min(ssWritten(a), ssWritten(b)));
+    start = __max(start, oldest);
+    if(start >= end) return 0;
+    n = __min(end - start, (uint64_t)UINT32_MAX);
+
+    ssSpan_t sa, sb;
+    ssGetSpan(a, start, (uint32_t)n, &sa);
+    ssGetSpan(b, start, (uint32_t)n, &sb);
+    /// The two rings wrap at different places: walk the common pieces
+    uint8_t  ka = 0, kb = 0, merge = 0;
+    uint32_t oa = 0, ob = 0;
+    uint64_t done = 0;
+    while(done < n && ka < 2 && kb < 2){
+        uint32_t len = __min(sa.n[ka] - oa, sb.n[kb] - ob);
+        if(len > 0) merge |= dnBin(dn, sa.p[ka] + oa, sb.p[kb] + ob, len);
+        done += len;
+        oa   += len;
+        ob   += len;
+        if(oa == sa.n[ka]){ ++ka; oa = 0; }
+        if(ob == sb.n[kb]){ ++kb; ob = 0; }
+    }
+    if(merge) wpRun(dn->wp, dnMergeChunk, dn, DN_BANDS);
+    return done;
+}
+
+uint32_t dnSlots(const density_t *dn){
+    if(__is_null(dn)) return 0;
+    return dn->nGrids ? dn->nGrids : 1;
+}
+
+uint32_t *dnSlotGrid(density_t *dn, uint32_t slot){
+    if(__is_null(dn)) return NULL;
+    if(dn->nGrids == 0) return (slot == 0) ? dn->grid : NULL;
+    return (slot < dn->nGrids) ? dn->local[slot] : NULL;
+}
+
+void dnMerge(density_t *dn, uint64_t points){
+    if(__is_null(dn)) return;
+    dn->points += points;
+    if(dn->nGrids) wpRun(dn->wp, dnMergeChunk, dn, DN_BANDS);
+}
+
+/// Fixed-point log2: DN_LOG_STEPS steps per doubling, 1 for a single hit
+static inline uint32_t dnLog(uint32_t c){
+    uint32_t m = 31 - __builtin_clz(c);
+    uint32_t f = (m >= 4) ? (c >> (m - 4)) & 15 : (c << (4 - m)) & 15;
+    return m * DN_LOG_STEPS + f + 1;
+}
+
+typedef struct dnRenderJob_t {
+    const density_t *   dn;
+    rsTarget_t *        t;
+    uint32_t            lMax;
+} dnRenderJob_t;
+
+static void dnRenderChunk(void *ctx, uint32_t chunk){
+    const dnRenderJob_t *job = (const dnRenderJob_t *)ctx;
+    const density_t     *dn  = job->dn;
+    const xy_t h = __min(dn->h, job->t->h), w = __min(dn->w, job->t->w);
+    const xy_t y0 = h * chunk / DN_BANDS, y1 = h * (chunk + 1) / DN_BANDS;
+    for(xy_t y = y0; y < y1; ++y){
+        const uint32_t *src = dn->grid + (size_t)y * dn->w;
+        color_t        *dst = job->t->px + (size_t)y * job->t->pitch;
+        REPTT(xy_t, x, 0, w){
+            if(src[x] == 0) continue;
+            dst[x] = dn->colormap[(dnLog(src[x]) * 255) / job->lMax];
+        }
+    }
+}
+
+void dnRender(const density_t *dn, rsTarget_t *t){
+    if(__is_null(dn) || __is_null(t) || __is_null(t->px)) return;
+    const size_t cells = (size_t)dn->w * dn->h;
+    uint32_t     max = 0;
+    REPTT(size_t, i, 0, cells) max = __max(max, dn->grid[i]);
+    if(max == 0) return;
+    dnRenderJob_t job = {dn, t, dnLog(max)};
+    wpRun(dn->wp, dnRenderChunk, &job, DN_BANDS);
+}
@@ -0,0 +1,109 @@
+#ifndef __DENSITY_H__
+#define __DENSITY_H__
+
+#ifdef LOG_HEADER_INCLUDE
+#pragma message("INCLUDE: density.h")
+#endif
+
+#include <stdint.h>
+
+#include "../windowContext/windowContext.h"
+#include "../raster/raster.h"
+#include "../sampleStore/sampleStore.h"
+#include "../workerPool/workerPool.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DN_MAX_GRIDS        (WP_MAX_THREADS + 1)
+#define DN_LOG_STEPS        16                  /// Colormap steps per doubling of the count
+
+/**
+ * @brief XY density histogram (Lissajous, phase and IQ constellation views).
+ *
+ * Points (x[i], y[i]) are binned into a uint32 grid the size of the target,
+ * four at a time with SSE. With a worker pool every thread bins its share
+ * into a private grid (no atomics, no false sharing), and the private grids
+ * are summed into the main one at the end. Rendering maps log2(count)
+ * through a 256-entry colormap; empty cells leave the target untouched, so
+ * the static layers show through.
+ */
+typedef struct density_t {
+    xy_t            w;
+    xy_t            h;
+    uint32_t *      grid;                       /// w * h, accumulated counts
+    uint32_t *      local[DN_MAX_GRIDS];        /// Per-thread grids, zero between accumulations
+    uint32_t        nGrids;                     /// Entries of local, 0 without a worker pool
+    float           xMin, xMax;                 /// Value range mapped onto columns
+    float           yMin, yMax;                 /// Value range mapped onto rows (yMax at the top)
+    color_t         colormap[256];
+    workerPool_t *  wp;
+    uint64_t        points;                     /// Points binned since the last dnFade(.., 0)
+} density_t;
+
+/**
+ * @brief Create a w x h density grid.
+ *
+ * @param[in] wp   Worker pool to bin and render with, NULL = calling thread only.
+ *
+ * @return STATUS_OK on success, ERROR_INVALID_PARAMS or ERROR_UNKNOWN on failure.
+ */
+status_t createDensity(density_t **dn, xy_t w, xy_t h, workerPool_t *wp);
+
+/**
+ * @brief Destroy a density grid and set the pointer to NULL.
+ */
+void destroyDensity(density_t **dn);
+
+/**
+ * @brief Value ranges of the two axes.
+ */
+void dnSetRange(density_t *dn, float xMin, float xMax, float yMin, float yMax);
+
+/**
+ * @brief Replace the colormap (index 0 = one hit, 255 = the densest cell).
+ */
+void dnSetColormap(density_t *dn, const color_t *map);
+
+/**
+ * @brief Persistence: divide every count by 2^shift; shift 0 clears the grid.
+ */
+void dnFade(density_t *dn, uint8_t shift);
+
+/**
+ * @brief Bin n points; points outside the ranges are dropped.
+ */
+void dnAccumulate(density_t *dn, const float *x, const float *y, uint64_t n);
+
+/**
+ * @brief Bin samples [start, start + n) of two stores against each other, zero-copy.
+ *
+ * @return Number of points binned (the range is clipped to what both stores hold).
+ */
+uint64_t dnAccumulateStores(density_t *dn, const sampleStore_t *a, const sampleStore_t *b, uint64_t start, uint64_t n);
+
+/**
+ * @brief Producers that compute coordinates on the fly (eye diagram) bin
+ * straight into the grids: job chunk `slot` < dnSlots() owns dnSlotGrid(slot),
+ * and dnMerge() folds them into the main grid once every chunk is done.
+ */
+uint32_t dnSlots(const density_t *dn);
+
+uint32_t *dnSlotGrid(density_t *dn, uint32_t slot);
+
+/**
+ * @brief Sum the slot grids into the main one; points is the number binned.
+ */
+void dnMerge(density_t *dn, uint64_t points);
+
+/**
+ * @brief Colormap the grid into a target of at least w x h.
+ */
+void dnRender(const density_t *dn, rsTarget_t *t);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
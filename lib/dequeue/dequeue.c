@@ -9,12 +9,12 @@ void createDequeue(dequeue_t **dq, dequeueIndex_t size) {
     __entry("createDequeue(%p, %d)", dq, size);
     if (!dq || size == 0) return;
 
-    *dq = (dequeue_t *)malloc(sizeof(dequeue_t));
+    *dq = (dequeue_t *)mpAlloc(sizeof(dequeue_t));
     if (!(*dq)) return;
 
-    (*dq)->dequeueBuff = (data_t *)malloc(size * sizeof(data_t));
+    (*dq)->dequeueBuff = (data_t *)mpAlloc(size * sizeof(data_t));
     if (!(*dq)->dequeueBuff) {
-        free(*dq);
+        mpFree(*dq);
         *dq = NULL;
         return;
     }
@@ -29,8 +29,8 @@ void createDequeue(dequeue_t **dq, dequeueIndex_t size) {
 
 void destroyDequeue(dequeue_t **dq) {
     if (!dq || !*dq) return;
-    free((*dq)->dequeueBuff);
-    free(*dq);
+    mpFree((*dq)->dequeueBuff);
+    mpFree(*dq);
     *dq = NULL;
 }
 
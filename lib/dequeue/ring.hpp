@@ -0,0 +1,261 @@
+#ifndef __RING_HPP__
+#define __RING_HPP__
+
+#ifdef LOG_HEADER_INCLUDE
+#pragma message("INCLUDE: ring.hpp")
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+#include <new>
+#include <utility>
+#include <iterator>
+#include <type_traits>
+
+#include "dequeue.h"
+
+/**
+ * @brief A view over a ring's elements in order: at most two contiguous regions, like ssSpan_t.
+ */
+template<typename T>
+struct ringSpan_t {
+    T *             p[2];
+    uint32_t        n[2];
+};
+
+/**
+ * @brief Double-ended ring of Capacity values of type T, for C++ callers.
+ *
+ * The typed counterpart of dequeue_t: elements live in the ring itself
+ * (no void * to allocate and chase), are constructed in place and moved in
+ * and out, and Capacity is a compile-time power of two, so every index is
+ * an add and a constant mask. head and tail run freely; their difference is
+ * the count, so full and empty need no extra state.
+ *
+ * Overwrite when full follows dqSetConfig(): HEAD_OVERWRITE_WHEN_FULL lets
+ * pushBack() drop the oldest element, TAIL_OVERWRITE_WHEN_FULL lets
+ * pushFront() drop the newest. Pops report an empty ring by their return
+ * value instead of DQ_INVALID_VALUE.
+ *
+ * Not thread-safe.
+ */
+template<typename T, uint32_t Capacity>
+class ring_t {
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "ring_t: Capacity must be a power of two");
+
+public:
+    static constexpr uint32_t mask = Capacity - 1;
+
+    /// ITERATOR //////////////////////////////////////////////////////////////////////////////////
+
+    template<bool Const>
+    class iter_t {
+    public:
+        typedef std::random_access_iterator_tag                                    iterator_category;
+        typedef T                                                                  value_type;
+        typedef ptrdiff_t                                                          difference_type;
+        typedef typename std::conditional<Const, const T *, T *>::type             pointer;
+        typedef typename std::conditional<Const, const T &, T &>::type             reference;
+        typedef typename std::conditional<Const, const ring_t *, ring_t *>::type   owner_t;
+
+        iter_t() : r(NULL), i(0) {}
+        iter_t(owner_t r, uint32_t i) : r(r), i(i) {}
+        operator iter_t<true>() const { return iter_t<true>(r, i); }
+
+        reference operator*() const                         { return r->slot(i); }
+        pointer   operator->() const                        { return &r->slot(i); }
+        reference operator[](difference_type k) const       { return r->slot(i + (uint32_t)k); }
+        iter_t &  operator++()                              { ++i; return *this; }
+        iter_t &  operator--()                              { --i; return *this; }
+        iter_t    operator++(int)                           { iter_t t = *this; ++i; return t; }
+        iter_t    operator--(int)                           { iter_t t = *this; --i; return t; }
+        iter_t &  operator+=(difference_type k)             { i += (uint32_t)k; return *this; }
+        iter_t &  operator-=(difference_type k)             { i -= (uint32_t)k; return *this; }
+        iter_t    operator+(difference_type k) const        { return iter_t(r, i + (uint32_t)k); }
+        iter_t    operator-(difference_type k) const        { return iter_t(r, i - (uint32_t)k); }
+        difference_type operator-(const iter_t &o) const    { return (difference_type)(int32_t)(i - o.i); }
+        bool operator==(const iter_t &o) const              { return i == o.i; }
+        bool operator!=(const iter_t &o) const              { return i != o.i; }
+        bool operator<(const iter_t &o) const               { return (int32_t)(i - o.i) < 0; }
+        bool operator>(const iter_t &o) const               { return o < *this; }
+        bool operator<=(const iter_t &o) const              { return !(o < *this); }
+        bool operator>=(const iter_t &o) const              { return !(*this < o); }
+
+    private:
+        owner_t         r;
+        uint32_t        i;                      /// Free-running position, like head and tail
+    };
+
+    typedef iter_t<false>   iterator;
+    typedef iter_t<true>    const_iterator;
+
+    /// LIFETIME //////////////////////////////////////////////////////////////////////////////////
+
+    ring_t() : head(0), tail(0), conf(0) {}
+    ring_t(const ring_t &o) : head(0), tail(0), conf(o.conf) {
+        for(const T &v : o) pushBack(v);
+    }
+    /// Moves the elements one by one (storage is inline), so only as noexcept as T's move
+    ring_t(ring_t &&o) noexcept(std::is_nothrow_move_constructible<T>::value) : head(0), tail(0), conf(o.conf) {
+        for(T &v : o) pushBack(std::move(v));
+        o.clear();
+    }
+    ring_t &operator=(const ring_t &o){
+        if(this == &o) return *this;
+        clear();
+        conf = o.conf;
+        for(const T &v : o) pushBack(v);
+        return *this;
+    }
+    ring_t &operator=(ring_t &&o) noexcept(std::is_nothrow_move_constructible<T>::value){
+        if(this == &o) return *this;
+        clear();
+        conf = o.conf;
+        for(T &v : o) pushBack(std::move(v));
+        o.clear();
+        return *this;
+    }
+    ~ring_t(){ clear(); }
+
+    /**
+     * @brief HEAD_OVERWRITE_WHEN_FULL / TAIL_OVERWRITE_WHEN_FULL, as dqSetConfig().
+     */
+    void setConfig(dqConfig_t config){ conf = config; }
+
+    /// STATE /////////////////////////////////////////////////////////////////////////////////////
+
+    static constexpr uint32_t capacity(){ return Capacity; }
+    uint32_t count() const      { return tail - head; }
+    bool     isEmpty() const    { return tail == head; }
+    bool     isFull() const     { return tail - head == Capacity; }
+
+    /// PUSH & POP ////////////////////////////////////////////////////////////////////////////////
+
+    /**
+     * @brief Construct an element after the newest one.
+     *
+     * @return false if the ring is full and HEAD_OVERWRITE_WHEN_FULL is not set.
+     */
+    template<typename... Args>
+    bool emplaceBack(Args &&... args){
+        if(isFull()){
+            if(!(conf & HEAD_OVERWRITE_WHEN_FULL)) return false;
+            slot(head++).~T();
+        }
+        new (&slot(tail)) T(std::forward<Args>(args)...);
+        ++tail;
+        return true;
+    }
+
+    /**
+     * @brief Construct an element before the oldest one.
+     *
+     * @return false if the ring is full and TAIL_OVERWRITE_WHEN_FULL is not set.
+     */
+    template<typename... Args>
+    bool emplaceFront(Args &&... args){
+        if(isFull()){
+            if(!(conf & TAIL_OVERWRITE_WHEN_FULL)) return false;
+            slot(--tail).~T();
+        }
+        new (&slot(head - 1)) T(std::forward<Args>(args)...);
+        --head;
+        return true;
+    }
+
+    bool pushBack(const T &v)   { return emplaceBack(v); }
+    bool pushBack(T &&v)        { return emplaceBack(std::move(v)); }
+    bool pushFront(const T &v)  { return emplaceFront(v); }
+    bool pushFront(T &&v)       { return emplaceFront(std::move(v)); }
+
+    /**
+     * @brief Move the oldest element out.
+     *
+     * @return false if the ring is empty (out untouched).
+     */
+    bool popFront(T &out){
+        if(isEmpty()) return false;
+        T &s = slot(head++);
+        out = std::move(s);
+        s.~T();
+        return true;
+    }
+
+    /**
+     * @brief Move the newest element out.
+     *
+     * @return false if the ring is empty (out untouched).
+     */
+    bool popBack(T &out){
+        if(isEmpty()) return false;
+        T &s = slot(--tail);
+        out = std::move(s);
+        s.~T();
+        return true;
+    }
+
+    /**
+     * @brief Destroy the oldest n elements (fewer if the ring holds fewer).
+     */
+    void dropFront(uint32_t n){
+        n = (n < count()) ? n : count();
+        for(; n; --n) slot(head++).~T();
+    }
+
+    void clear(){
+        while(head != tail) slot(head++).~T();
+        head = tail = 0;
+    }
+
+    /// ACCESS ////////////////////////////////////////////////////////////////////////////////////
+
+    /// i-th element from the oldest, unchecked (i < count())
+    T &       operator[](uint32_t i)        { return slot(head + i); }
+    const T & operator[](uint32_t i) const  { return slot(head + i); }
+    T &       front()                       { return slot(head); }
+    const T & front() const                 { return slot(head); }
+    T &       back()                        { return slot(tail - 1); }
+    const T & back() const                  { return slot(tail - 1); }
+
+    /**
+     * @brief Pointer to the i-th element from the oldest, NULL if i >= count().
+     */
+    T *at(uint32_t i){ return (i < count()) ? &slot(head + i) : NULL; }
+    const T *at(uint32_t i) const { return (i < count()) ? &slot(head + i) : NULL; }
+
+    iterator       begin()          { return iterator(this, head); }
+    iterator       end()            { return iterator(this, tail); }
+    const_iterator begin() const    { return const_iterator(this, head); }
+    const_iterator end() const      { return const_iterator(this, tail); }
+
+    /**
+     * @brief Elements in order as (up to) two contiguous regions, oldest first.
+     */
+    ringSpan_t<T> spans(){
+        ringSpan_t<T> s;
+        uint32_t      n = count(), a = head & mask, first = (n < Capacity - a) ? n : Capacity - a;
+        s.p[0] = data() + a;
+        s.n[0] = first;
+        s.p[1] = data();
+        s.n[1] = n - first;
+        return s;
+    }
+    ringSpan_t<const T> spans() const {
+        ringSpan_t<T>       s = const_cast<ring_t *>(this)->spans();
+        ringSpan_t<const T> c = {{s.p[0], s.p[1]}, {s.n[0], s.n[1]}};
+        return c;
+    }
+
+private:
+    T *       data()                        { return reinterpret_cast<T *>(storage); }
+    const T * data() const                  { return reinterpret_cast<const T *>(storage); }
+    T &       slot(uint32_t i)              { return data()[i & mask]; }
+    const T & slot(uint32_t i) const        { return data()[i & mask]; }
+
+    alignas(T) unsigned char storage[sizeof(T) * Capacity];   /// Raw: slots hold a T only between head and tail
+    uint32_t        head;                       /// Oldest element
+    uint32_t        tail;                       /// Next free slot after the newest
+    dqConfig_t      conf;
+};
+
+#endif
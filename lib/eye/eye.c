@@ -0,0 +1,503 @@
+#include "eye.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "../../include/global.h"
+
+#define EY_CROSS_PER_SLOT   (3 * EY_CHUNK)
+
+typedef enum eyZone_t {
+    EY_ZONE_UNKNOWN = 0,
+    EY_ZONE_LOW,
+    EY_ZONE_HIGH,
+} eyZone_t;
+
+typedef struct eyJob_t {
+    eyeDiagram_t *      ey;
+    /// Fold: chunks [0, nFold) over [foldStart, foldEnd)
+    uint32_t            nFold;
+    uint64_t            foldStart;
+    uint64_t            foldEnd;
+    const eyAnchor_t *  anchors;
+    uint32_t            nAnchors;
+    uint64_t            folded[EY_MAX_SLOTS];
+    double              uis[EY_MAX_SLOTS];
+    /// Detect: the following chunks over [detStart, detEnd)
+    uint64_t            detStart;
+    uint64_t            detEnd;
+    float               prevV;                  /// Sample detStart - 1
+    float               lastV[EY_MAX_SLOTS];
+} eyJob_t;
+
+static inline uint8_t eyBits(float v, float lo, float mid, float hi){
+    return (uint8_t)((v >= lo) | ((v >= mid) << 1) | ((v >= hi) << 2));
+}
+
+/// DETECT ////////////////////////////////////////////////////////////////////////////////////////
+
+/// Crossings from pv to v at sample pos, lowest level first when rising
+static inline void eyEmit(eyCross_t *out, uint32_t *n, uint64_t pos, float pv, float v, uint8_t was, uint8_t cur, float mid){
+    uint8_t ch = was ^ cur, up = (cur & ch) != 0;
+    REPTT(int, k, 0, 3){
+        int level = up ? k : 2 - k;
+        if(!(ch & (1 << level))) continue;
+        eyCross_t *c = &out[(*n)++];
+        c->level = (uint8_t)level;
+        c->up    = up;
+        c->t     = (double)pos;
+        if(level == 1 && v != pv) c->t = (double)(pos - 1) + (double)((mid - pv) / (v - pv));
+    }
+}
+
+static void eyDetectRegion(const eyeDiagram_t *ey, const float *p, uint32_t n, uint64_t pos, float *prevV, eyCross_t *out, uint32_t *nOut){
+    const float lo = ey->mid - ey->hys, mid = ey->mid, hi = ey->mid + ey->hys;
+    float    pv   = *prevV;
+    uint8_t  last = eyBits(pv, lo, mid, hi);
+    uint32_t i = 0;
+#if defined(__SSE2__)
+    const __m128 vlo = _mm_set1_ps(lo), vmid = _mm_set1_ps(mid), vhi = _mm_set1_ps(hi);
+    for(; i + 4 <= n; i += 4){
+        __m128   v  = _mm_loadu_ps(p + i);
+        uint32_t m0 = (uint32_t)_mm_movemask_ps(_mm_cmpge_ps(v, vlo));
+        uint32_t m1 = (uint32_t)_mm_movemask_ps(_mm_cmpge_ps(v, vmid));
+        uint32_t m2 = (uint32_t)_mm_movemask_ps(_mm_cmpge_ps(v, vhi));
+        uint32_t p0 = ((m0 << 1) | (last & 1)) & 15;
+        uint32_t p1 = ((m1 << 1) | ((last >> 1) & 1)) & 15;
+        uint32_t p2 = ((m2 << 1) | (last >> 2)) & 15;
+        uint32_t ch = (m0 ^ p0) | (m1 ^ p1) | (m2 ^ p2);
+        while(ch){
+            uint32_t j   = __builtin_ctz(ch);
+            uint8_t  was = (uint8_t)(((p0 >> j) & 1) | (((p1 >> j) & 1) << 1) | (((p2 >> j) & 1) << 2));
+            uint8_t  cur = (uint8_t)(((m0 >> j) & 1) | (((m1 >> j) & 1) << 1) | (((m2 >> j) & 1) << 2));
+            eyEmit(out, nOut, pos + i + j, (i + j) ? p[i + j - 1] : pv, p[i + j], was, cur, mid);
+            ch &= ch - 1;
+        }
+        last = (uint8_t)(((m0 >> 3) & 1) | (((m1 >> 3) & 1) << 1) | (((m2 >> 3) & 1) << 2));
+    }
+    if(i) pv = p[i - 1];
+#endif
+    for(; i < n; ++i){
+        uint8_t cur = eyBits(p[i], lo, mid, hi);
+        if(cur != last) eyEmit(out, nOut, pos + i, pv, p[i], last, cur, mid);
+        last = cur;
+        pv   = p[i];
+    }
+    if(n) *prevV = p[n - 1];
+}
+
+static void eyDetectChunk(eyJob_t *job, uint32_t d){
+    eyeDiagram_t *ey  = job->ey;
+    eyCross_t    *out = ey->cross + (size_t)d * EY_CROSS_PER_SLOT;
+    uint64_t      len = job->detEnd - job->detStart;
+    uint64_t      a   = job->detStart + len * d / ey->nSlots, b = job->detStart + len * (d + 1) / ey->nSlots;
+    float         pv  = job->prevV;
+    uint32_t      n   = 0;
+    ssSpan_t      span;
+    ey->nCross[d] = 0;
+    if(a >= b) return;
+    /// Later chunks start one sample early for their predecessor's value
+    uint64_t from = (d == 0) ? a : a - 1;
+    uint32_t got  = ssGetSpan(ey->ss, from, (uint32_t)(b - from), &span);
+    uint64_t pos  = b - got;
+    uint8_t  seed = (d != 0);
+    REPTT(uint8_t, k, 0, 2){
+        const float *p = span.p[k];
+        uint32_t     m = span.n[k];
+        if(m == 0) continue;
+        if(seed){
+            seed = 0;
+            pv = p[0];
+            ++p;
+            --m;
+            ++pos;
+        }
+        eyDetectRegion(ey, p, m, pos, &pv, out, &n);
+        pos += m;
+    }
+    ey->nCross[d]   = n;
+    job->lastV[d]   = pv;
+}
+
+/// FOLD //////////////////////////////////////////////////////////////////////////////////////////
+
+/// Bin n contiguous samples; phase0 (UI, in [0, 1)) belongs to p[0]
+static void eyFoldRun(const eyeDiagram_t *ey, uint32_t *grid, eyLevel_t *lv, const float *p, uint32_t n, double phase0, double ui){
+    const density_t *dn = ey->dn;
+    const float inv = (float)(1.0 / ui), ph = (float)phase0;
+    const float halfW = dn->w * 0.5f, wMax = (float)(dn->w - 1), hF = (float)dn->h;
+    const float sy = dn->h / (ey->vMax - ey->vMin);
+    uint32_t i = 0;
+#if defined(__SSE2__)
+    const __m128 vInv = _mm_set1_ps(inv), vPh = _mm_set1_ps(ph), vHalfW = _mm_set1_ps(halfW);
+    const __m128 vW = _mm_set1_ps((float)dn->w), vWMax = _mm_set1_ps(wMax), vH = _mm_set1_ps(hF);
+    const __m128 vSy = _mm_set1_ps(sy), vTop = _mm_set1_ps(ey->vMax), vCentre = _mm_set1_ps(EY_CENTRE);
+    const __m128 half = _mm_set1_ps(0.5f), one = _mm_set1_ps(1.0f), zero = _mm_setzero_ps();
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+    __m128  k = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+    const __m128 four = _mm_set1_ps(4.0f);
+    int32_t i1[4], i2[4];
+    for(; i + 4 <= n; i += 4, k = _mm_add_ps(k, four)){
+        __m128 v  = _mm_loadu_ps(p + i);
+        __m128 u  = _mm_add_ps(vPh, _mm_mul_ps(k, vInv));
+        u = _mm_sub_ps(u, _mm_cvtepi32_ps(_mm_cvttps_epi32(u)));
+        /// Second copy one UI to the left or right, whichever stays in the window
+        __m128 lower = _mm_cmplt_ps(u, half);
+        __m128 u2 = _mm_add_ps(u, _mm_or_ps(_mm_and_ps(lower, one), _mm_andnot_ps(lower, _mm_sub_ps(zero, one))));
+        __m128 fx1 = _mm_min_ps(vWMax, _mm_max_ps(zero, _mm_mul_ps(_mm_add_ps(u, half), vHalfW)));
+        __m128 fx2 = _mm_min_ps(vWMax, _mm_max_ps(zero, _mm_mul_ps(_mm_add_ps(u2, half), vHalfW)));
+        __m128 fy  = _mm_mul_ps(_mm_sub_ps(vTop, v), vSy);
+        __m128 ok  = _mm_and_ps(_mm_cmpge_ps(fy, zero), _mm_cmplt_ps(fy, vH));
+        int    mask = _mm_movemask_ps(ok);
+        int    mc   = _mm_movemask_ps(_mm_cmplt_ps(_mm_and_ps(absMask, _mm_sub_ps(u, half)), vCentre));
+        if(mask){
+            __m128 row = _mm_mul_ps(_mm_cvtepi32_ps(_mm_cvttps_epi32(_mm_and_ps(fy, ok))), vW);
+            _mm_storeu_si128((__m128i *)i1, _mm_cvttps_epi32(_mm_add_ps(row, _mm_cvtepi32_ps(_mm_cvttps_epi32(fx1)))));
+            _mm_storeu_si128((__m128i *)i2, _mm_cvttps_epi32(_mm_add_ps(row, _mm_cvtepi32_ps(_mm_cvttps_epi32(fx2)))));
+            REPTT(int, j, 0, 4){
+                if(!(mask & (1 << j))) continue;
+                grid[i1[j]]++;
+                grid[i2[j]]++;
+            }
+        }
+        while(mc){
+            int   j = __builtin_ctz(mc);
+            float x = p[i + j];
+            int   b = x >= ey->mid;
+            lv->n[b]++;
+            lv->sum[b]  += x;
+            lv->sum2[b] += (double)x * x;
+            mc &= mc - 1;
+        }
+    }
+#endif
+    for(; i < n; ++i){
+        float u = ph + (float)i * inv;
+        u -= (float)(int32_t)u;
+        float x = p[i];
+        if(fabsf(u - 0.5f) < EY_CENTRE){
+            int b = x >= ey->mid;
+            lv->n[b]++;
+            lv->sum[b]  += x;
+            lv->sum2[b] += (double)x * x;
+        }
+        float fy = (ey->vMax - x) * sy;
+        if(!(fy >= 0.0f && fy < hF)) continue;
+        float u2  = (u < 0.5f) ? u + 1.0f : u - 1.0f;
+        float fx1 = __min(wMax, __max(0.0f, (u + 0.5f) * halfW));
+        float fx2 = __min(wMax, __max(0.0f, (u2 + 0.5f) * halfW));
+        size_t row = (size_t)fy * dn->w;
+        grid[row + (size_t)fx1]++;
+        grid[row + (size_t)fx2]++;
+    }
+}
+
+static void eyFoldChunk(eyJob_t *job, uint32_t f){
+    eyeDiagram_t *ey   = job->ey;
+    uint32_t     *grid = dnSlotGrid(ey->dn, f);
+    eyLevel_t    *lv   = &ey->level[f];
+    uint64_t      len  = job->foldEnd - job->foldStart;
+    uint64_t      a    = job->foldStart + len * f / ey->nSlots, b = job->foldStart + len * (f + 1) / ey->nSlots;
+    ssSpan_t      span;
+    job->folded[f] = 0;
+    job->uis[f]    = 0.0;
+    if(a >= b || __is_null(grid)) return;
+    uint32_t got = ssGetSpan(ey->ss, a, (uint32_t)(b - a), &span);
+    uint64_t pos = b - got;
+
+    /// Last anchor at or before pos
+    uint32_t lo = 0, hi = job->nAnchors;
+    while(hi - lo > 1){
+        uint32_t mid = (lo + hi) / 2;
+        if(job->anchors[mid].start <= pos) lo = mid;
+        else hi = mid;
+    }
+    uint32_t k = lo;
+    REPTT(uint8_t, r, 0, 2){
+        const float *p = span.p[r];
+        uint32_t     m = span.n[r];
+        while(m > 0){
+            while(k + 1 < job->nAnchors && job->anchors[k + 1].start <= pos) ++k;
+            uint64_t stop = (k + 1 < job->nAnchors) ? job->anchors[k + 1].start : UINT64_MAX;
+            uint32_t run  = (uint32_t)__min((uint64_t)m, stop - pos);
+            const eyAnchor_t *A = &job->anchors[k];
+            if(A->ui > 0.0){
+                double phase = ((double)pos - A->tRef) / A->ui;
+                eyFoldRun(ey, grid, lv, p, run, phase - floor(phase), A->ui);
+                job->folded[f] += run;
+                job->uis[f]    += run / A->ui;
+            }
+            p   += run;
+            m   -= run;
+            pos += run;
+        }
+    }
+}
+
+static void eyChunk(void *ctx, uint32_t chunk){
+    eyJob_t *job = (eyJob_t *)ctx;
+    if(chunk < job->nFold) eyFoldChunk(job, chunk);
+    else eyDetectChunk(job, chunk - job->nFold);
+}
+
+/// RECOVER ///////////////////////////////////////////////////////////////////////////////////////
+
+static uint8_t eyAddAnchor(eyeDiagram_t *ey, uint8_t set, uint64_t start){
+    if(ey->nAnchors[set] == ey->capAnchors[set]){
+        size_t      cap = __max((size_t)256, ey->capAnchors[set] * 2);
+        eyAnchor_t *a   = (eyAnchor_t *) mpAlloc(sizeof(eyAnchor_t) * cap);
+        if(__is_null(a)) return 0;
+        if(ey->nAnchors[set]) memcpy(a, ey->anchors[set], sizeof(eyAnchor_t) * ey->nAnchors[set]);
+        mpFree(ey->anchors[set]);
+        ey->anchors[set]    = a;
+        ey->capAnchors[set] = cap;
+    }
+    eyAnchor_t *a = &ey->anchors[set][ey->nAnchors[set]++];
+    a->start = start;
+    a->tRef  = ey->tRef;
+    a->ui    = ey->ui;
+    return 1;
+}
+
+/// One data edge through the PLL
+static void eyEdge(eyeDiagram_t *ey, uint8_t set, double e){
+    ey->edges++;
+    if(ey->ui <= 0.0){
+        ey->tRef      = e;
+        ey->ui        = ey->uiNominal;
+        ey->lockEdges = 0;
+    }else{
+        double n    = floor((e - ey->tRef) / ey->ui + 0.5);
+        double pred = ey->tRef + n * ey->ui;
+        double err  = e - pred;
+        /// Gear shift: a wide loop to pull in, the set one once locked
+        uint8_t  acq = ey->lockEdges < EY_LOCK_EDGES;
+        ey->tRef = pred + (acq ? __min(1.0, 4 * ey->kp) : ey->kp) * err;
+        ey->ui  += (acq ? __min(1.0, 16 * ey->ki) : ey->ki) * err;
+        if(fabs(ey->ui / ey->uiNominal - 1.0) > 0.25){
+            /// Lost: start over from this edge
+            ey->tRef      = e;
+            ey->ui        = ey->uiNominal;
+            ey->lockEdges = 0;
+        }else if(++ey->lockEdges > EY_LOCK_EDGES){
+            double tie = err / ey->ui;
+            ey->tieN++;
+            ey->tieSum  += tie;
+            ey->tieSum2 += tie * tie;
+            ey->tieMin   = __min(ey->tieMin, tie);
+            ey->tieMax   = __max(ey->tieMax, tie);
+        }
+    }
+    eyAddAnchor(ey, set, (uint64_t)floor(e) + 1);
+}
+
+static void eyRecover(eyeDiagram_t *ey, uint8_t set, uint64_t start){
+    ey->nAnchors[set] = 0;
+    eyAddAnchor(ey, set, start);
+    REPTT(uint32_t, d, 0, ey->nSlots){
+        const eyCross_t *c = ey->cross + (size_t)d * EY_CROSS_PER_SLOT;
+        REPTT(uint32_t, i, 0, ey->nCross[d]){
+            switch(c[i].level){
+                case 1:
+                    if(c[i].up) ey->lastUp = c[i].t;
+                    else ey->lastDown = c[i].t;
+                    break;
+                case 2:
+                    if(!c[i].up) break;
+                    if(ey->zone == EY_ZONE_LOW) eyEdge(ey, set, ey->lastUp);
+                    ey->zone = EY_ZONE_HIGH;
+                    break;
+                default:
+                    if(c[i].up) break;
+                    if(ey->zone == EY_ZONE_HIGH) eyEdge(ey, set, ey->lastDown);
+                    ey->zone = EY_ZONE_LOW;
+                    break;
+            }
+        }
+    }
+}
+
+/// API ///////////////////////////////////////////////////////////////////////////////////////////
+
+status_t createEyeDiagram(eyeDiagram_t **ey, xy_t w, xy_t h, double uiSamples, workerPool_t *wp){
+    __entry("createEyeDiagram(%p, %d, %d, %g, %p)", ey, w, h, uiSamples, wp);
+    if(__is_null(ey) || !(uiSamples >= 2.0)){
+        __err("[createEyeDiagram] Invalid params!");
+        return ERROR_INVALID_PARAMS;
+    }
+    *ey = (eyeDiagram_t *) mpCalloc(1, sizeof(eyeDiagram_t));
+    if(__is_null(*ey)){
+        __err("[createEyeDiagram] malloc failed!");
+        return ERROR_UNKNOWN;
+    }
+    eyeDiagram_t *e = *ey;
+    status_t      status = createDensity(&e->dn, w, h, wp);
+    if(status != STATUS_OK){
+        mpFree(e);
+        *ey = NULL;
+        return status;
+    }
+    e->wp        = wp;
+    e->nSlots    = __min(dnSlots(e->dn), (uint32_t)EY_MAX_SLOTS);
+    e->uiNominal = uiSamples;
+    e->kp        = EY_KP;
+    e->ki        = EY_KI;
+    if(mpLargeAlloc(&e->crossMem, sizeof(eyCross_t) * EY_CROSS_PER_SLOT * e->nSlots, MP_NODE_LOCAL) != STATUS_OK){
+        __err("[createEyeDiagram] mpLargeAlloc(%u slots) failed!", e->nSlots);
+        destroyDensity(&e->dn);
+        mpFree(e);
+        *ey = NULL;
+        return ERROR_UNKNOWN;
+    }
+    e->cross = (eyCross_t *) e->crossMem.p;
+    eySetSource(e, NULL, 0.0f, 0.0f, -1.0f, 1.0f);
+    __exit("createEyeDiagram()");
+    return STATUS_OK;
+}
+
+void destroyEyeDiagram(eyeDiagram_t **ey){
+    if(__is_null(ey) || __is_null(*ey)) return;
+    eyeDiagram_t *e = *ey;
+    mpLargeFree(&e->crossMem);
+    mpFree(e->anchors[0]);
+    mpFree(e->anchors[1]);
+    destroyDensity(&e->dn);
+    mpFree(e);
+    *ey = NULL;
+}
+
+void eySetSource(eyeDiagram_t *ey, const sampleStore_t *ss, float mid, float hys, float vMin, float vMax){
+    if(__is_null(ey)) return;
+    ey->ss       = ss;
+    ey->mid      = mid;
+    ey->hys      = fabsf(hys);
+    if(vMax > vMin){
+        ey->vMin = vMin;
+        ey->vMax = vMax;
+    }
+    ey->next     = 0;
+    ey->havePrev = 0;
+    ey->havePend = 0;
+    ey->zone     = EY_ZONE_UNKNOWN;
+    ey->ui       = 0.0;
+    eyReset(ey);
+}
+
+void eySetLoop(eyeDiagram_t *ey, double kp, double ki){
+    if(__is_null(ey) || !(kp > 0.0 && kp <= 1.0) || !(ki >= 0.0 && ki <= kp)) return;
+    ey->kp = kp;
+    ey->ki = ki;
+}
+
+void eyReset(eyeDiagram_t *ey){
+    if(__is_null(ey)) return;
+    dnFade(ey->dn, 0);
+    memset(ey->level, 0, sizeof(ey->level));
+    ey->edges   = 0;
+    ey->tieN    = 0;
+    ey->tieSum  = 0.0;
+    ey->tieSum2 = 0.0;
+    ey->tieMin  = INFINITY;
+    ey->tieMax  = -INFINITY;
+    ey->samples = 0;
+    ey->uiSum   = 0.0;
+}
+
+uint64_t eyUpdate(eyeDiagram_t *ey){
+    if(__is_null(ey) || __is_null(ey->ss)) return 0;
+    const uint64_t end    = ssWritten(ey->ss);
+    const uint64_t oldest = ssOldest(ey->ss);
+    const uint64_t before = ey->samples;
+    if(ey->next < oldest){
+        /// First call or lapped: the clock has to lock again
+        ey->next     = oldest;
+        ey->havePrev = 0;
+        ey->zone     = EY_ZONE_UNKNOWN;
+        ey->ui       = 0.0;
+    }
+    if(!ey->havePrev && ey->next < end){
+        float    v;
+        if(ssRead(ey->ss, ey->next, 1, &v) != 1) return 0;
+        uint8_t  bits = eyBits(v, ey->mid - ey->hys, ey->mid, ey->mid + ey->hys);
+        ey->zone     = (bits == 7) ? EY_ZONE_HIGH : (bits == 0) ? EY_ZONE_LOW : EY_ZONE_UNKNOWN;
+        ey->prevV    = v;
+        ey->havePrev = 1;
+        ey->next++;
+    }
+
+    eyJob_t job;
+    job.ey = ey;
+    while(1){
+        uint8_t detect = ey->next < end;
+        if(!detect && !ey->havePend) break;
+        job.nFold     = ey->havePend ? ey->nSlots : 0;
+        job.foldStart = ey->pendStart;
+        job.foldEnd   = ey->pendEnd;
+        job.anchors   = ey->anchors[ey->pend];
+        job.nAnchors  = ey->nAnchors[ey->pend];
+        job.detStart  = ey->next;
+        job.detEnd    = detect ? __min(end, ey->next + (uint64_t)ey->nSlots * EY_CHUNK) : ey->next;
+        job.prevV     = ey->prevV;
+        /// Fold round k - 1 and detect round k in one job
+        wpRun(ey->wp, eyChunk, &job, job.nFold + (detect ? ey->nSlots : 0));
+
+        if(ey->havePend){
+            uint64_t folded = 0;
+            REPTT(uint32_t, f, 0, job.nFold){
+                folded    += job.folded[f];
+                ey->uiSum += job.uis[f];
+            }
+            ey->samples += folded;
+            dnMerge(ey->dn, 2 * folded);
+            ey->havePend = 0;
+        }
+        if(detect){
+            uint8_t set = ey->pend ^ 1;
+            eyRecover(ey, set, job.detStart);
+            ey->prevV     = job.lastV[ey->nSlots - 1];
+            ey->pendStart = job.detStart;
+            ey->pendEnd   = job.detEnd;
+            ey->pend      = set;
+            ey->havePend  = 1;
+            ey->next      = job.detEnd;
+        }
+    }
+    return ey->samples - before;
+}
+
+void eyGetStats(const eyeDiagram_t *ey, eyStats_t *st){
+    if(__is_null(ey) || __is_null(st)) return;
+    memset(st, 0, sizeof(eyStats_t));
+    st->samples = ey->samples;
+    st->uis     = (uint64_t)ey->uiSum;
+    st->edges   = ey->edges;
+    st->ui      = ey->ui;
+    if(ey->tieN){
+        double mean = ey->tieSum / ey->tieN;
+        st->tieRms  = sqrt(__max(0.0, ey->tieSum2 / ey->tieN - mean * mean));
+        st->tiePkPk = ey->tieMax - ey->tieMin;
+        st->width   = __max(0.0, 1.0 - st->tiePkPk);
+    }
+    uint64_t n[2] = {0, 0};
+    double   sum[2] = {0.0, 0.0}, sum2[2] = {0.0, 0.0};
+    REPTT(uint32_t, s, 0, ey->nSlots){
+        REPTT(int, b, 0, 2){
+            n[b]    += ey->level[s].n[b];
+            sum[b]  += ey->level[s].sum[b];
+            sum2[b] += ey->level[s].sum2[b];
+        }
+    }
+    if(n[0] && n[1]){
+        double sd0 = sqrt(__max(0.0, sum2[0] / n[0] - (sum[0] / n[0]) * (sum[0] / n[0])));
+        double sd1 = sqrt(__max(0.0, sum2[1] / n[1] - (sum[1] / n[1]) * (sum[1] / n[1])));
+        st->level0 = sum[0] / n[0];
+        st->level1 = sum[1] / n[1];
+        st->height = (st->level1 - 3.0 * sd1) - (st->level0 + 3.0 * sd0);
+    }
+}
+
+void eyRender(const eyeDiagram_t *ey, rsTarget_t *t){
+    if(__is_null(ey)) return;
+    dnRender(ey->dn, t);
+}
@@ -0,0 +1,181 @@
+#ifndef __EYE_H__
+#define __EYE_H__
+
+#ifdef LOG_HEADER_INCLUDE
+#pragma message("INCLUDE: eye.h")
+#endif
+
+#include <stdint.h>
+
+#include "../windowContext/windowContext.h"
+#include "../memPool/memPool.h"
+#include "../raster/raster.h"
+#include "../sampleStore/sampleStore.h"
+#include "../workerPool/workerPool.h"
+#include "../density/density.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define EY_CHUNK            16384               /// Samples per pipeline chunk
+#define EY_MAX_SLOTS        64                  /// Chunks per pipeline round, at most
+#define EY_LOCK_EDGES       64                  /// Edges with wide loop gains (x4, x16) before jitter is counted
+#define EY_CENTRE           0.05f               /// Half width of the eye-height window, UI
+#define EY_KP               (1.0 / 16)          /// Default PLL phase gain
+#define EY_KI               (1.0 / 1024)        /// Default PLL frequency gain
+
+/**
+ * @brief Clock state from one recovered edge on, in sample units.
+ */
+typedef struct eyAnchor_t {
+    uint64_t        start;                      /// First sample it applies to
+    double          tRef;                       /// A UI boundary
+    double          ui;                         /// Samples per UI, 0 = no clock yet
+} eyAnchor_t;
+
+/**
+ * @brief Threshold crossing found by the parallel pass.
+ */
+typedef struct eyCross_t {
+    double          t;                          /// Sample time; interpolated for the mid level
+    uint8_t         level;                      /// 0 = lo, 1 = mid, 2 = hi
+    uint8_t         up;
+} eyCross_t;
+
+/**
+ * @brief Per-slot sums of the samples in the eye centre, split by logic level.
+ */
+typedef struct eyLevel_t {
+    uint64_t        n[2];
+    double          sum[2];
+    double          sum2[2];
+} eyLevel_t;
+
+typedef struct eyStats_t {
+    uint64_t        samples;                    /// Samples folded into the histogram
+    uint64_t        uis;                        /// Unit intervals folded
+    uint64_t        edges;                      /// Data edges recovered
+    double          ui;                         /// Recovered samples per UI
+    double          tieRms;                     /// Time interval error vs. the recovered clock, UI
+    double          tiePkPk;                    /// UI
+    double          level0;                     /// Mean low / high level at the eye centre
+    double          level1;
+    double          height;                     /// (level1 - 3 sigma1) - (level0 + 3 sigma0), volts
+    double          width;                      /// 1 - tiePkPk, UI
+} eyStats_t;
+
+/**
+ * @brief Eye diagram with software clock recovery.
+ *
+ * eyUpdate() streams the samples written since its last call through a
+ * pipeline of rounds, each round being one chunk per histogram slot:
+ *
+ *  1. detect (parallel): four samples per SSE compare against lo / mid / hi,
+ *     mid crossings interpolated to sub-sample time;
+ *  2. recover (sequential, edges only): a hysteresis state machine turns the
+ *     crossings into data edges, and a second-order PLL follows them; every
+ *     edge leaves an anchor (clock phase and period from there on) and its
+ *     phase error, the TIE;
+ *  3. fold (parallel): each sample's phase comes from its anchor, and the
+ *     sample is binned twice into a 2-UI window (-0.5 ... 1.5 UI) of the
+ *     density grid; nothing is copied per UI.
+ *
+ * Detection of round k and folding of round k - 1 run in the same worker pool
+ * job, so the pool never waits on the sequential step for a whole round.
+ */
+typedef struct eyeDiagram_t {
+    density_t *             dn;                 /// The histogram, owned
+    workerPool_t *          wp;
+    const sampleStore_t *   ss;
+    float                   mid;                /// Decision threshold
+    float                   hys;                /// Hysteresis: edges need mid +- hys
+    float                   vMin, vMax;         /// Vertical range
+    double                  uiNominal;          /// Samples per UI to lock on to
+    double                  kp, ki;             /// PLL gains
+
+    /// Pipeline
+    uint32_t                nSlots;
+    eyCross_t *             cross;              /// nSlots x 3 * EY_CHUNK
+    mpLarge_t               crossMem;
+    uint32_t                nCross[EY_MAX_SLOTS];
+    eyAnchor_t *            anchors[2];         /// Ping-pong: built for round k, folded in round k + 1
+    uint32_t                nAnchors[2];
+    size_t                  capAnchors[2];
+    uint64_t                pendStart;          /// Round waiting to be folded, [pendStart, pendEnd)
+    uint64_t                pendEnd;
+    uint8_t                 pend;               /// Anchor set of the pending round
+    uint8_t                 havePend;
+    uint64_t                next;               /// Next sample to detect
+    uint8_t                 havePrev;
+    float                   prevV;              /// Sample next - 1
+
+    /// Recovery
+    uint8_t                 zone;
+    double                  lastUp, lastDown;   /// Latest mid crossings
+    double                  tRef, ui;           /// PLL state, ui = 0 until the first edge
+    uint64_t                lockEdges;
+
+    /// Statistics
+    uint64_t                edges;
+    uint64_t                tieN;
+    double                  tieSum, tieSum2, tieMin, tieMax;
+    eyLevel_t               level[EY_MAX_SLOTS];
+    uint64_t                samples;
+    double                  uiSum;              /// Samples folded / ui, summed
+} eyeDiagram_t;
+
+/**
+ * @brief Create an eye diagram.
+ *
+ * @param[out] ey         Pointer to an eye diagram pointer. Will be allocated inside.
+ * @param[in]  w, h       Histogram size (the display target).
+ * @param[in]  uiSamples  Nominal samples per unit interval (sample rate / bit rate), >= 2.
+ * @param[in]  wp         Worker pool, NULL = calling thread only.
+ *
+ * @return STATUS_OK on success, ERROR_INVALID_PARAMS or ERROR_UNKNOWN on failure.
+ */
+status_t createEyeDiagram(eyeDiagram_t **ey, xy_t w, xy_t h, double uiSamples, workerPool_t *wp);
+
+/**
+ * @brief Destroy an eye diagram and set the pointer to NULL.
+ */
+void destroyEyeDiagram(eyeDiagram_t **ey);
+
+/**
+ * @brief Source, threshold and vertical range. Restarts recovery and clears the histogram.
+ */
+void eySetSource(eyeDiagram_t *ey, const sampleStore_t *ss, float mid, float hys, float vMin, float vMax);
+
+/**
+ * @brief PLL gains (phase, frequency); defaults EY_KP, EY_KI.
+ */
+void eySetLoop(eyeDiagram_t *ey, double kp, double ki);
+
+/**
+ * @brief Clear the histogram and the statistics, keep the clock.
+ */
+void eyReset(eyeDiagram_t *ey);
+
+/**
+ * @brief Fold everything written since the last call.
+ *
+ * @return Samples folded.
+ */
+uint64_t eyUpdate(eyeDiagram_t *ey);
+
+/**
+ * @brief Measurements so far.
+ */
+void eyGetStats(const eyeDiagram_t *ey, eyStats_t *st);
+
+/**
+ * @brief Render the histogram (see dnRender()).
+ */
+void eyRender(const eyeDiagram_t *ey, rsTarget_t *t);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
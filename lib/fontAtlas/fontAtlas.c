@@ -0,0 +1,258 @@
+#include "fontAtlas.h"
+
+#include <sys/stat.h>
+#include <errno.h>
+
+#include "../../include/global.h"
+
+/// Identifies the font a cache file was built from
+typedef struct faKey_t {
+    uint64_t        fileSize;
+    int64_t         mtimeSec;
+    int64_t         mtimeNsec;
+    uint32_t        fontSize;
+    uint32_t        pathLen;
+    char            path[CFG_PATH_SIZE];
+} faKey_t;
+
+static status_t faMakeKey(faKey_t *k, const char *fontPath, uint8_t fontSize){
+    struct stat st;
+    memset(k, 0, sizeof(faKey_t));
+    if(__is_null(realpath(fontPath, k->path)) || stat(k->path, &st) != 0) return ERROR_UNKNOWN;
+    k->fileSize  = (uint64_t)st.st_size;
+    k->mtimeSec  = (int64_t)st.st_mtim.tv_sec;
+    k->mtimeNsec = (int64_t)st.st_mtim.tv_nsec;
+    k->fontSize  = fontSize;
+    k->pathLen   = (uint32_t)strlen(k->path);
+    return STATUS_OK;
+}
+
+/// FNV-1a over the key, for the file name
+static uint64_t faHash(const faKey_t *k){
+    uint64_t h = 14695981039346656037ULL;
+    const uint8_t *p = (const uint8_t *) k;
+    REPTT(size_t, i, 0, offsetof(faKey_t, path) + k->pathLen){
+        h ^= p[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+static void faCachePath(char *out, size_t size, const char *cacheDir, const faKey_t *k){
+    snprintf(out, size, "%s/%016llx.fat", cacheDir, (unsigned long long)faHash(k));
+}
+
+/// mkdir -p
+static status_t faMakeDir(const char *dir){
+    char path[CFG_PATH_SIZE];
+    size_t n = strlen(dir);
+    if(n == 0 || n >= sizeof(path)) return ERROR_INVALID_PARAMS;
+    memcpy(path, dir, n + 1);
+    for(size_t i = 1; i <= n; ++i){
+        if(path[i] != '/' && path[i] != '\0') continue;
+        char c = path[i];
+        path[i] = '\0';
+        if(mkdir(path, 0755) != 0 && errno != EEXIST) return ERROR_UNKNOWN;
+        path[i] = c;
+    }
+    return STATUS_OK;
+}
+
+/// CACHE /////////////////////////////////////////////////////////////////////////////////////////
+
+static status_t faLoadCache(fontAtlas_t *a, const char *file, const faKey_t *k){
+    FILE *f = fopen(file, "rb");
+    if(__is_null(f)) return ERROR_UNKNOWN;
+    char     magic[4];
+    faKey_t  got;
+    int32_t  wh[2];
+    status_t status = ERROR_UNKNOWN;
+    memset(&got, 0, sizeof(got));
+    if(fread(magic, 1, 4, f) != 4 || memcmp(magic, FA_MAGIC, 4) != 0)                       goto __done__;
+    if(fread(&got, offsetof(faKey_t, path), 1, f) != 1 || got.pathLen != k->pathLen)         goto __done__;
+    if(fread(got.path, 1, got.pathLen, f) != got.pathLen)                                   goto __done__;
+    /// A hash match is not enough: same file, same size, same point size
+    if(memcmp(&got, k, offsetof(faKey_t, path)) != 0 || memcmp(got.path, k->path, k->pathLen) != 0) goto __done__;
+    if(fread(wh, sizeof(wh), 1, f) != 1 || wh[0] <= 0 || wh[1] <= 0 || wh[0] > (1 << 20) || wh[1] > 1024) goto __done__;
+    if(fread(a->glyph, sizeof(a->glyph), 1, f) != 1)                                         goto __done__;
+    a->alpha = (uint8_t *) mpAlloc((size_t)wh[0] * wh[1]);
+    if(__is_null(a->alpha))                                                                  goto __done__;
+    if(fread(a->alpha, (size_t)wh[0] * wh[1], 1, f) != 1){
+        mpFree(a->alpha);
+        a->alpha = NULL;
+        goto __done__;
+    }
+    REPTT(uint32_t, g, 0, FA_GLYPHS){
+        if(a->glyph[g].x + a->glyph[g].w > (uint32_t)wh[0]){
+            mpFree(a->alpha);
+            a->alpha = NULL;
+            goto __done__;
+        }
+    }
+    a->w      = wh[0];
+    a->h      = wh[1];
+    a->cached = 1;
+    status    = STATUS_OK;
+__done__:
+    fclose(f);
+    return status;
+}
+
+static void faSaveCache(const fontAtlas_t *a, const char *cacheDir, const char *file, const faKey_t *k){
+    char tmp[CFG_PATH_SIZE + 64];
+    if(faMakeDir(cacheDir) != STATUS_OK){
+        __err("[faSaveCache] cannot create %s: %s", cacheDir, strerror(errno));
+        return;
+    }
+    /// Unique per process; rename() makes the finished file appear at once
+    snprintf(tmp, sizeof(tmp), "%s.%ld.tmp", file, (long)getpid());
+    FILE *f = fopen(tmp, "wb");
+    if(__is_null(f)){
+        __err("[faSaveCache] fopen(%s) failed: %s", tmp, strerror(errno));
+        return;
+    }
+    int32_t wh[2] = { a->w, a->h };
+    int ok = fwrite(FA_MAGIC, 1, 4, f) == 4
+          && fwrite(k, offsetof(faKey_t, path), 1, f) == 1
+          && fwrite(k->path, 1, k->pathLen, f) == k->pathLen
+          && fwrite(wh, sizeof(wh), 1, f) == 1
+          && fwrite(a->glyph, sizeof(a->glyph), 1, f) == 1
+          && fwrite(a->alpha, (size_t)a->w * a->h, 1, f) == 1;
+    if(fclose(f) != 0) ok = 0;
+    if(!ok || rename(tmp, file) != 0){
+        __err("[faSaveCache] writing %s failed: %s", file, strerror(errno));
+        remove(tmp);
+    }
+}
+
+/// RASTERIZE /////////////////////////////////////////////////////////////////////////////////////
+
+static status_t faBuild(fontAtlas_t *a, const char *fontPath, uint8_t fontSize){
+    if(!TTF_WasInit() && TTF_Init() < 0){
+        __err("[faBuild] TTF_Init failed: %s", TTF_GetError());
+        return ERROR_UNKNOWN;
+    }
+    TTF_Font *font = TTF_OpenFont(fontPath, fontSize);
+    if(__is_null(font)){
+        __err("[faBuild] TTF_OpenFont(%s) failed: %s", fontPath, TTF_GetError());
+        return ERROR_UNKNOWN;
+    }
+    const SDL_Color white = {255, 255, 255, 255};
+    SDL_Surface    *surf[FA_GLYPHS];
+    status_t        status = STATUS_OK;
+    a->w = 0;
+    a->h = __max(1, TTF_FontHeight(font));
+    REPTT(uint32_t, g, 0, FA_GLYPHS){
+        int minx, maxx, miny, maxy, advance;
+        surf[g] = TTF_RenderGlyph_Blended(font, (Uint16)(FA_FIRST + g), white);
+        if(TTF_GlyphMetrics(font, (Uint16)(FA_FIRST + g), &minx, &maxx, &miny, &maxy, &advance) != 0) advance = 0;
+        a->glyph[g].x       = (uint32_t)a->w;
+        a->glyph[g].w       = (uint16_t)(__is_not_null(surf[g]) ? surf[g]->w : 0);
+        a->glyph[g].advance = (int16_t)advance;
+        a->w += a->glyph[g].w;
+    }
+    a->w     = __max(1, a->w);
+    a->alpha = (uint8_t *) mpCalloc((size_t)a->w * a->h, 1);
+    if(__is_null(a->alpha)){
+        __err("[faBuild] malloc failed!");
+        status = ERROR_UNKNOWN;
+    }
+    REPTT(uint32_t, g, 0, FA_GLYPHS){
+        SDL_Surface *s = surf[g];
+        if(__is_null(s)) continue;
+        if(status == STATUS_OK && s->format->BytesPerPixel == 4 && SDL_LockSurface(s) == 0){
+            const SDL_PixelFormat *pf = s->format;
+            REPTT(int, y, 0, __min(s->h, a->h)){
+                const uint32_t *row = (const uint32_t *)((const uint8_t *) s->pixels + (size_t)y * s->pitch);
+                uint8_t        *dst = a->alpha + (size_t)y * a->w + a->glyph[g].x;
+                REPTT(int, x, 0, s->w) dst[x] = (uint8_t)((row[x] & pf->Amask) >> pf->Ashift);
+            }
+            SDL_UnlockSurface(s);
+        }
+        SDL_FreeSurface(s);
+    }
+    TTF_CloseFont(font);
+    return status;
+}
+
+/// API ///////////////////////////////////////////////////////////////////////////////////////////
+
+status_t createFontAtlas(fontAtlas_t **fa, const char *fontPath, uint8_t fontSize, const char *cacheDir){
+    __entry("createFontAtlas(%p, %s, %u, %s)", fa, fontPath, fontSize, cacheDir);
+    if(__is_null(fa) || __is_null(fontPath) || fontSize == 0){
+        __err("[createFontAtlas] Invalid params!");
+        return ERROR_INVALID_PARAMS;
+    }
+    *fa = (fontAtlas_t *) mpCalloc(1, sizeof(fontAtlas_t));
+    if(__is_null(*fa)){
+        __err("[createFontAtlas] malloc failed!");
+        return ERROR_UNKNOWN;
+    }
+    fontAtlas_t *a = *fa;
+    faKey_t      key;
+    char         file[CFG_PATH_SIZE + 32];
+    uint8_t      useCache = __is_not_null(cacheDir) && cacheDir[0] && faMakeKey(&key, fontPath, fontSize) == STATUS_OK;
+    if(useCache){
+        faCachePath(file, sizeof(file), cacheDir, &key);
+        if(faLoadCache(a, file, &key) == STATUS_OK){
+            __exit("createFontAtlas() from %s", file);
+            return STATUS_OK;
+        }
+    }
+    if(faBuild(a, fontPath, fontSize) != STATUS_OK){
+        destroyFontAtlas(fa);
+        return ERROR_UNKNOWN;
+    }
+    if(useCache) faSaveCache(a, cacheDir, file, &key);
+    __exit("createFontAtlas()");
+    return STATUS_OK;
+}
+
+void destroyFontAtlas(fontAtlas_t **fa){
+    if(__is_null(fa) || __is_null(*fa)) return;
+    mpFree((*fa)->alpha);
+    mpFree(*fa);
+    *fa = NULL;
+}
+
+static inline const faGlyph_t *faGlyph(const fontAtlas_t *fa, char ch){
+    uint8_t u = (uint8_t) ch;
+    return &fa->glyph[(u >= FA_FIRST && u <= FA_LAST) ? u - FA_FIRST : '?' - FA_FIRST];
+}
+
+void faTextSize(const fontAtlas_t *fa, const char *text, xy_t *w, xy_t *h){
+    xy_t pen = 0, right = 0;
+    if(__is_not_null(fa) && __is_not_null(text)){
+        for(const char *p = text; *p; ++p){
+            const faGlyph_t *g = faGlyph(fa, *p);
+            right = __max(right, pen + g->w);
+            pen  += g->advance;
+        }
+    }
+    if(__is_not_null(w)) *w = __max(pen, right);
+    if(__is_not_null(h)) *h = __is_not_null(fa) ? fa->h : 0;
+}
+
+void faDrawText(const fontAtlas_t *fa, rsTarget_t *t, xy_t x, xy_t y, const char *text, color_t c){
+    if(__is_null(fa) || __is_null(t) || __is_null(t->px) || __is_null(text)) return;
+    const uint32_t ca = __getAFromRGBA(c);
+    const uint32_t cr = __getRFromRGBA(c), cg = __getGFromRGBA(c), cb = __getBFromRGBA(c);
+    const xy_t     y0 = __max(0, y), y1 = __min(t->h, y + fa->h);
+    for(const char *p = text; *p; x += faGlyph(fa, *p)->advance, ++p){
+        const faGlyph_t *g  = faGlyph(fa, *p);
+        const xy_t       x0 = __max(0, x), x1 = __min(t->w, x + (xy_t)g->w);
+        for(xy_t yy = y0; yy < y1; ++yy){
+            const uint8_t *cov = fa->alpha + (size_t)(yy - y) * fa->w + g->x - x;
+            color_t       *d   = t->px + (size_t)yy * t->pitch;
+            for(xy_t xx = x0; xx < x1; ++xx){
+                uint32_t a = cov[xx] * ca;
+                if(a == 0) continue;
+                a = (a + 127) / 255;
+                const uint32_t na = 255 - a, v = d[xx];
+                d[xx] = __combiRGBA((cr * a + __getRFromRGBA(v) * na + 127) / 255,
+                                    (cg * a + __getGFromRGBA(v) * na + 127) / 255,
+                                    (cb * a + __getBFromRGBA(v) * na + 127) / 255, 255);
+            }
+        }
+    }
+}
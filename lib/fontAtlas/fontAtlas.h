@@ -0,0 +1,88 @@
+#ifndef __FONT_ATLAS_H__
+#define __FONT_ATLAS_H__
+
+#ifdef LOG_HEADER_INCLUDE
+#pragma message("INCLUDE: fontAtlas.h")
+#endif
+
+#include <stdint.h>
+
+#include "../windowContext/windowContext.h"
+#include "../memPool/memPool.h"
+#include "../raster/raster.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FA_FIRST            32                  /// Printable ASCII: ' ' ...
+#define FA_LAST             126                 /// ... '~'
+#define FA_GLYPHS           (FA_LAST - FA_FIRST + 1)
+#define FA_MAGIC            "FAT1"
+
+typedef struct faGlyph_t {
+    uint32_t        x;                          /// Left column in the atlas
+    uint16_t        w;                          /// Columns
+    int16_t         advance;                    /// Pen step after the glyph
+} faGlyph_t;
+
+/**
+ * @brief Rasterized glyphs of one font at one size, drawn without SDL_ttf.
+ *
+ * The printable ASCII glyphs sit side by side in one 8-bit coverage image,
+ * one font height tall. Text is drawn by blending coverage straight into an
+ * rsTarget_t, so the draw calls never go back to FreeType or allocate a
+ * surface.
+ *
+ * Building the atlas needs TTF_Init() and TTF_OpenFont(), which dominate
+ * startup. createFontAtlas() first looks in a cache directory for an atlas
+ * saved by an earlier run with the same font file (path, size in bytes,
+ * modification time) and point size, and writes one after a build. Cache
+ * files are written under a temporary name and renamed, so instances
+ * started together never read a partial file.
+ *
+ * Read-only once created: any thread may draw with it.
+ */
+typedef struct fontAtlas_t {
+    uint8_t *       alpha;                      /// Coverage, w x h, row-major
+    xy_t            w;
+    xy_t            h;                          /// Font height: every glyph's rows
+    faGlyph_t       glyph[FA_GLYPHS];
+    uint8_t         cached;                     /// Loaded from the cache, SDL_ttf not touched
+} fontAtlas_t;
+
+/**
+ * @brief Load a font atlas from the cache, or rasterize it with SDL_ttf and cache it.
+ *
+ * Safe to call from a thread other than the one running SDL video; calls
+ * TTF_Init() itself when it has to rasterize.
+ *
+ * @param[out] fa        Pointer to a font atlas pointer. Will be allocated inside.
+ * @param[in]  fontPath  TTF font file.
+ * @param[in]  fontSize  Point size.
+ * @param[in]  cacheDir  Cache directory, created if missing; NULL or "" = no cache.
+ *
+ * @return STATUS_OK on success, ERROR_INVALID_PARAMS or ERROR_UNKNOWN on failure.
+ */
+status_t createFontAtlas(fontAtlas_t **fa, const char *fontPath, uint8_t fontSize, const char *cacheDir);
+
+/**
+ * @brief Destroy a font atlas and set the pointer to NULL.
+ */
+void destroyFontAtlas(fontAtlas_t **fa);
+
+/**
+ * @brief Size of text in pixels; characters outside the atlas count as '?'.
+ */
+void faTextSize(const fontAtlas_t *fa, const char *text, xy_t *w, xy_t *h);
+
+/**
+ * @brief Blend text in color c (its alpha scales the coverage), top-left at (x, y), clipped.
+ */
+void faDrawText(const fontAtlas_t *fa, rsTarget_t *t, xy_t x, xy_t y, const char *text, color_t c);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
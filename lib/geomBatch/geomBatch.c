@@ -0,0 +1,172 @@
+#include "geomBatch.h"
+
+#include "../../include/global.h"
+
+static SDL_Color gbColor(color_t c){
+    SDL_Color s = {(Uint8)__getRFromRGBA(c), (Uint8)__getGFromRGBA(c), (Uint8)__getBFromRGBA(c), (Uint8)__getAFromRGBA(c)};
+    return s;
+}
+
+/// Make room for `quads` more quads, doubling the arrays when needed
+static uint8_t gbReserve(geomLayer_t *l, int quads){
+    if(l->nV + 4 * quads <= l->capV && l->nIdx + 6 * quads <= l->capIdx) return 1;
+    int capV = __max(l->capV, 64), capIdx = __max(l->capIdx, 96);
+    while(l->nV + 4 * quads > capV) capV *= 2;
+    while(l->nIdx + 6 * quads > capIdx) capIdx *= 2;
+
+    SDL_Vertex *v   = (SDL_Vertex *) mpAlloc(sizeof(SDL_Vertex) * capV);
+    int        *idx = (int *) mpAlloc(sizeof(int) * capIdx);
+    if(__is_null(v) || __is_null(idx)){
+        __err("[gbReserve] malloc(%d vertices) failed!", capV);
+        mpFree(v);
+        mpFree(idx);
+        return 0;
+    }
+    memcpy(v, l->v, sizeof(SDL_Vertex) * l->nV);
+    memcpy(idx, l->idx, sizeof(int) * l->nIdx);
+    mpFree(l->v);
+    mpFree(l->idx);
+    l->v      = v;
+    l->idx    = idx;
+    l->capV   = capV;
+    l->capIdx = capIdx;
+    return 1;
+}
+
+/// Quad from four corners in order (a, b, c, d around the edge)
+static void gbQuad(geomLayer_t *l, float ax, float ay, float bx, float by, float cx, float cy, float dx, float dy, SDL_Color c){
+    SDL_Vertex *v = l->v + l->nV;
+    int        *i = l->idx + l->nIdx;
+    v[0].position.x = ax; v[0].position.y = ay;
+    v[1].position.x = bx; v[1].position.y = by;
+    v[2].position.x = cx; v[2].position.y = cy;
+    v[3].position.x = dx; v[3].position.y = dy;
+    REPTT(int, k, 0, 4){
+        v[k].color       = c;
+        v[k].tex_coord.x = 0.0f;
+        v[k].tex_coord.y = 0.0f;
+    }
+    i[0] = l->nV;     i[1] = l->nV + 1; i[2] = l->nV + 2;
+    i[3] = l->nV;     i[4] = l->nV + 2; i[5] = l->nV + 3;
+    l->nV   += 4;
+    l->nIdx += 6;
+}
+
+static float gbValueToY(float v, float yMin, float yMax, int h){
+    float y = (yMax - v) / (yMax - yMin) * (float)(h - 1);
+    return __max(-1.0f, __min((float)h, y));
+}
+
+status_t createGeomLayer(geomLayer_t **l, int quads){
+    __entry("createGeomLayer(%p, %d)", l, quads);
+    if(__is_null(l) || quads < 0){
+        __err("[createGeomLayer] Invalid params!");
+        return ERROR_INVALID_PARAMS;
+    }
+    *l = (geomLayer_t *) mpCalloc(1, sizeof(geomLayer_t));
+    if(__is_null(*l)){
+        __err("[createGeomLayer] malloc failed!");
+        return ERROR_UNKNOWN;
+    }
+    if(quads > 0 && !gbReserve(*l, quads)){
+        mpFree(*l);
+        *l = NULL;
+        return ERROR_UNKNOWN;
+    }
+    __exit("createGeomLayer()");
+    return STATUS_OK;
+}
+
+void destroyGeomLayer(geomLayer_t **l){
+    if(__is_null(l) || __is_null(*l)) return;
+    mpFree((*l)->v);
+    mpFree((*l)->idx);
+    mpFree(*l);
+    *l = NULL;
+}
+
+void gbClear(geomLayer_t *l){
+    if(__is_null(l)) return;
+    l->nV   = 0;
+    l->nIdx = 0;
+}
+
+void gbRect(geomLayer_t *l, float x, float y, float w, float h, color_t c){
+    if(__is_null(l) || !gbReserve(l, 1)) return;
+    gbQuad(l, x, y, x + w, y, x + w, y + h, x, y + h, gbColor(c));
+}
+
+void gbLine(geomLayer_t *l, float x0, float y0, float x1, float y1, float width, color_t c){
+    if(__is_null(l) || !gbReserve(l, 1)) return;
+    float dx = x1 - x0, dy = y1 - y0;
+    float len = sqrtf(dx * dx + dy * dy);
+    if(len < 1e-6f){
+        gbQuad(l, x0 - width / 2, y0 - width / 2, x0 + width / 2, y0 - width / 2,
+                  x0 + width / 2, y0 + width / 2, x0 - width / 2, y0 + width / 2, gbColor(c));
+        return;
+    }
+    /// Offset both ends along the normal
+    float nx = -dy / len * width / 2, ny = dx / len * width / 2;
+    gbQuad(l, x0 + nx, y0 + ny, x1 + nx, y1 + ny, x1 - nx, y1 - ny, x0 - nx, y0 - ny, gbColor(c));
+}
+
+void gbTrace(geomLayer_t *l, float x0, const float *v, int n, float yMin, float yMax, int h, float width, color_t c){
+    if(__is_null(l) || __is_null(v) || n <= 0 || !gbReserve(l, n)) return;
+    SDL_Color col = gbColor(c);
+    const float hw = width / 2;
+    float px = x0 + 0.5f, py = gbValueToY(v[0], yMin, yMax, h) + 0.5f;
+    if(n == 1){
+        gbQuad(l, px - hw, py - hw, px + hw, py - hw, px + hw, py + hw, px - hw, py + hw, col);
+        return;
+    }
+    REPTT(int, i, 1, n){
+        float x = x0 + i + 0.5f, y = gbValueToY(v[i], yMin, yMax, h) + 0.5f;
+        float dx = x - px, dy = y - py;
+        float len = sqrtf(dx * dx + dy * dy);
+        float nx = -dy / len * hw, ny = dx / len * hw;
+        gbQuad(l, px + nx, py + ny, x + nx, y + ny, x - nx, y - ny, px - nx, py - ny, col);
+        px = x;
+        py = y;
+    }
+}
+
+void gbEnvelope(geomLayer_t *l, float x0, const float *vMin, const float *vMax, int n, float yMin, float yMax, int h, color_t c){
+    if(__is_null(l) || __is_null(vMin) || __is_null(vMax) || n <= 0 || !gbReserve(l, n)) return;
+    SDL_Color col = gbColor(c);
+    REPTT(int, i, 0, n){
+        if(vMin[i] > vMax[i]) continue;
+        float top = gbValueToY(vMax[i], yMin, yMax, h);
+        float bot = gbValueToY(vMin[i], yMin, yMax, h) + 1.0f;        /// At least one pixel tall
+        gbQuad(l, x0 + i, top, x0 + i + 1, top, x0 + i + 1, bot, x0 + i, bot, col);
+    }
+}
+
+void gbGrid(geomLayer_t *l, float x, float y, float w, float h, int divX, int divY, color_t c){
+    if(__is_null(l) || divX <= 0 || divY <= 0 || !gbReserve(l, divX + divY + 2)) return;
+    REPTT(int, i, 0, divX + 1){
+        float gx = x + (w - 1) * i / divX;
+        gbRect(l, gx, y, 1.0f, h, c);
+    }
+    REPTT(int, j, 0, divY + 1){
+        float gy = y + (h - 1) * j / divY;
+        gbRect(l, x, gy, w, 1.0f, c);
+    }
+}
+
+status_t gbSubmit(const geomLayer_t *l, SDL_Renderer *renderer){
+    if(__is_null(l) || __is_null(renderer)){
+        __err("[gbSubmit] l = %p, renderer = %p", l, renderer);
+        return ERROR_INVALID_PARAMS;
+    }
+    if(l->nIdx == 0) return STATUS_OK;
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+    if(SDL_RenderGeometry(renderer, NULL, l->v, l->nV, l->idx, l->nIdx) != 0){
+        __err("[gbSubmit] SDL_RenderGeometry failed: %s", SDL_GetError());
+        return ERROR_UNKNOWN;
+    }
+    return STATUS_OK;
+#else
+    __err("[gbSubmit] SDL_RenderGeometry needs SDL 2.0.18");
+    return ERROR_UNKNOWN;
+#endif
+}
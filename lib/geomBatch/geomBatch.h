@@ -0,0 +1,103 @@
+#ifndef __GEOM_BATCH_H__
+#define __GEOM_BATCH_H__
+
+#ifdef LOG_HEADER_INCLUDE
+#pragma message("INCLUDE: geomBatch.h")
+#endif
+
+#include <stdint.h>
+
+#include "../windowContext/windowContext.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef uint32_t            color_t;            /// Same as global.h
+
+/**
+ * @brief One layer of triangles, submitted with a single SDL_RenderGeometry() call.
+ *
+ * The vertex and index arrays only ever grow; gbClear() keeps them, so a
+ * layer rebuilt every frame stops allocating once it has seen its largest
+ * frame.
+ */
+typedef struct geomLayer_t {
+    SDL_Vertex *    v;
+    int *           idx;
+    int             nV;
+    int             nIdx;
+    int             capV;
+    int             capIdx;
+} geomLayer_t;
+
+/**
+ * @brief Create a layer.
+ *
+ * @param[out] l     Pointer to a layer pointer. Will be allocated inside.
+ * @param[in]  quads Initial capacity in quads (4 vertices, 6 indices each).
+ *
+ * @return STATUS_OK on success, ERROR_INVALID_PARAMS or ERROR_UNKNOWN on failure.
+ */
+status_t createGeomLayer(geomLayer_t **l, int quads);
+
+/**
+ * @brief Destroy a layer and set the pointer to NULL.
+ */
+void destroyGeomLayer(geomLayer_t **l);
+
+/**
+ * @brief Empty the layer, keeping its buffers.
+ */
+void gbClear(geomLayer_t *l);
+
+/**
+ * @brief Axis-aligned filled rectangle.
+ */
+void gbRect(geomLayer_t *l, float x, float y, float w, float h, color_t c);
+
+/**
+ * @brief Line segment of the given width.
+ */
+void gbLine(geomLayer_t *l, float x0, float y0, float x1, float y1, float width, color_t c);
+
+/**
+ * @brief One value per column, joined into a polyline.
+ *
+ * @param[in,out] l      Layer.
+ * @param[in]     x0     Column of v[0].
+ * @param[in]     v      Values.
+ * @param[in]     n      Number of columns.
+ * @param[in]     yMin   Value at the bottom row.
+ * @param[in]     yMax   Value at the top row.
+ * @param[in]     h      Height of the area in pixels.
+ * @param[in]     width  Line width.
+ * @param[in]     c      Color.
+ */
+void gbTrace(geomLayer_t *l, float x0, const float *v, int n, float yMin, float yMax, int h, float width, color_t c);
+
+/**
+ * @brief Per-column min/max band; columns with vMin > vMax are skipped.
+ */
+void gbEnvelope(geomLayer_t *l, float x0, const float *vMin, const float *vMax, int n, float yMin, float yMax, int h, color_t c);
+
+/**
+ * @brief Graticule: divX x divY cells inside the rectangle, plus the border.
+ */
+void gbGrid(geomLayer_t *l, float x, float y, float w, float h, int divX, int divY, color_t c);
+
+/**
+ * @brief Draw the whole layer with one SDL_RenderGeometry() call.
+ *
+ * Works on every SDL renderer, the software one included.
+ *
+ * @return STATUS_OK, ERROR_INVALID_PARAMS, or ERROR_UNKNOWN if SDL refused the batch
+ *         (or SDL is older than 2.0.18).
+ */
+status_t gbSubmit(const geomLayer_t *l, SDL_Renderer *renderer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
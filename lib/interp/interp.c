@@ -0,0 +1,149 @@
+#include "interp.h"
+
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+
+#include "../../include/global.h"
+
+/// KERNELS ///////////////////////////////////////////////////////////////////////////////////////
+
+/// Row p is the kernel for fraction p / IP_PHASES; tap k sits at offset k - (taps/2 - 1)
+static void ipBuildSinc(interpolator_t *ip){
+    const int32_t T = ip->taps, half = T / 2;
+    REPTT(int32_t, p, 0, IP_PHASES + 1){
+        float *row = ip->kernels + (size_t)p * T;
+        double frac = (double)p / IP_PHASES, sum = 0.0;
+        REPTT(int32_t, k, 0, T){
+            double x = (k - (half - 1)) - frac;
+            double s = (fabs(x) < 1e-9) ? 1.0 : sin(M_PI * x) / (M_PI * x);
+            double w = 0.42 + 0.5 * cos(M_PI * x / half) + 0.08 * cos(2.0 * M_PI * x / half);
+            row[k] = (float)(s * w);
+            sum   += s * w;
+        }
+        REPTT(int32_t, k, 0, T) row[k] = (float)(row[k] / sum);
+    }
+}
+
+static float ipDot(const float *a, const float *b, uint8_t n){
+    uint8_t k = 0;
+    float   r = 0.0f;
+#if defined(__SSE__)
+    __m128 acc = _mm_setzero_ps();
+    for(; k + 4 <= n; k += 4) acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(a + k), _mm_loadu_ps(b + k)));
+    float s[4];
+    _mm_storeu_ps(s, acc);
+    r = (s[0] + s[1]) + (s[2] + s[3]);
+#endif
+    for(; k < n; ++k) r += a[k] * b[k];
+    return r;
+}
+
+static float ipEdgeAt(const float *src, uint64_t n, int64_t i){
+    if(i < 0) i = 0;
+    if((uint64_t)i >= n) i = (int64_t)n - 1;
+    return src[i];
+}
+
+/// API ///////////////////////////////////////////////////////////////////////////////////////////
+
+status_t createInterpolator(interpolator_t **ip, ipMode_t mode, uint8_t taps){
+    __entry("createInterpolator(%p, %d, %u)", ip, mode, taps);
+    if(__is_null(ip) || (mode == IP_SINC && (taps < IP_MIN_TAPS || taps > IP_MAX_TAPS || taps % 4))){
+        __err("[createInterpolator] Invalid params: mode = %d, taps = %u", mode, taps);
+        return ERROR_INVALID_PARAMS;
+    }
+    *ip = (interpolator_t *) mpAlloc(sizeof(interpolator_t));
+    if(__is_null(*ip)){
+        __err("[createInterpolator] malloc failed!");
+        return ERROR_UNKNOWN;
+    }
+    memset(*ip, 0, sizeof(interpolator_t));
+    (*ip)->mode = mode;
+
+    if(mode == IP_SINC){
+        (*ip)->taps    = taps;
+        (*ip)->kernels = (float *) mpAlloc(sizeof(float) * (IP_PHASES + 1) * taps);
+        if(__is_null((*ip)->kernels)){
+            __err("[createInterpolator] malloc failed!");
+            mpFree(*ip);
+            *ip = NULL;
+            return ERROR_UNKNOWN;
+        }
+        ipBuildSinc(*ip);
+    }else{
+        (*ip)->taps = 2;
+    }
+    __exit("createInterpolator()");
+    return STATUS_OK;
+}
+
+void destroyInterpolator(interpolator_t **ip){
+    if(__is_null(ip) || __is_null(*ip)) return;
+    mpFree((*ip)->kernels);
+    mpFree(*ip);
+    *ip = NULL;
+}
+
+void ipResample(interpolator_t *ip, const float *src, uint64_t n, double start, double step, float *out, uint32_t cols){
+    if(__is_null(ip) || __is_null(src) || __is_null(out) || n == 0) return;
+    const int32_t T = ip->taps, lead = T / 2 - 1;
+
+    REPTT(uint32_t, c, 0, cols){
+        double  pos = start + c * step;
+        double  fl  = floor(pos);
+        int64_t i   = (int64_t)fl;
+        float   f   = (float)(pos - fl);
+
+        if(ip->mode == IP_LINEAR){
+            float a = ipEdgeAt(src, n, i), b = ipEdgeAt(src, n, i + 1);
+            out[c] = a + f * (b - a);
+            continue;
+        }
+
+        const float *k = ip->kernels + (size_t)lrintf(f * IP_PHASES) * T;
+        int64_t first = i - lead;
+        if(first >= 0 && (uint64_t)(first + T) <= n){
+            out[c] = ipDot(k, src + first, (uint8_t)T);
+        }else{
+            float w[IP_MAX_TAPS];
+            REPTT(int32_t, j, 0, T) w[j] = ipEdgeAt(src, n, first + j);
+            out[c] = ipDot(k, w, (uint8_t)T);
+        }
+    }
+}
+
+status_t ipResampleStore(interpolator_t *ip, const sampleStore_t *ss, double start, double step, float *vMin, float *vMax, uint32_t cols){
+    if(__is_null(ip) || __is_null(ss) || __is_null(vMin) || __is_null(vMax)){
+        __err("[ipResampleStore] ip = %p, ss = %p, vMin = %p, vMax = %p", ip, ss, vMin, vMax);
+        return ERROR_INVALID_PARAMS;
+    }
+    const int32_t margin = ip->taps;
+    int64_t first = (int64_t)floor(start) - margin;
+    int64_t last  = (int64_t)ceil(start + (double)cols * step) + margin;
+    int64_t oldest = (int64_t)ssOldest(ss);
+    if(first < oldest) first = oldest;
+    if(last <= first) last = first + 1;
+    uint32_t need = (uint32_t)(last - first);
+
+    mpArena_t *scratch = mpThreadArena();
+    size_t     mark    = mpArenaMark(scratch);
+    float     *window  = (float *) mpArenaAlloc(scratch, sizeof(float) * need);
+    if(__is_null(window)){
+        __err("[ipResampleStore] no scratch for %u samples", need);
+        return ERROR_UNKNOWN;
+    }
+    uint32_t got = ssRead(ss, (uint64_t)first, need, window);
+    if(got > 0) ipResample(ip, window, got, start - (double)first, step, vMin, cols);
+    mpArenaRelease(scratch, mark);
+    /// Only [first, first + got - 1] was read: outside it ipResample repeated an edge sample
+    const double lo = (double)first, hi = (double)first + got - 1;
+    REPTT(uint32_t, c, 0, cols){
+        double p = start + c * step;
+        if(got == 0 || p < lo || p > hi){
+            vMin[c] = 1.0f;
+            vMax[c] = 0.0f;
+        }else vMax[c] = vMin[c];
+    }
+    return STATUS_OK;
+}
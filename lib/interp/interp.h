@@ -0,0 +1,87 @@
+#ifndef __INTERP_H__
+#define __INTERP_H__
+
+#ifdef LOG_HEADER_INCLUDE
+#pragma message("INCLUDE: interp.h")
+#endif
+
+#include <stdint.h>
+
+#include "../windowContext/windowContext.h"
+#include "../sampleStore/sampleStore.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define IP_PHASES           256                 /// Fractional positions with a precomputed kernel
+#define IP_MIN_TAPS         8
+#define IP_MAX_TAPS         32
+
+typedef enum ipMode_t {
+    IP_LINEAR = 0,
+    IP_SINC,                                    /// Blackman-windowed sin(x)/x
+} ipMode_t;
+
+/**
+ * @brief Interpolator for views zoomed in past one sample per column.
+ *
+ * Only the visible span is resampled, to exactly one value per column, so
+ * the cost scales with the column count and the tap count, never with the
+ * record length.
+ */
+typedef struct interpolator_t {
+    ipMode_t        mode;
+    uint8_t         taps;
+    float *         kernels;                    /// [IP_PHASES + 1][taps], each row sums to 1
+} interpolator_t;
+
+/**
+ * @brief Create an interpolator and precompute its kernels.
+ *
+ * @param[out] ip    Pointer to an interpolator pointer. Will be allocated inside.
+ * @param[in]  mode  IP_LINEAR or IP_SINC.
+ * @param[in]  taps  Sinc length, IP_MIN_TAPS ... IP_MAX_TAPS, multiple of 4 (ignored for IP_LINEAR).
+ *
+ * @return STATUS_OK on success, ERROR_INVALID_PARAMS or ERROR_UNKNOWN on failure.
+ */
+status_t createInterpolator(interpolator_t **ip, ipMode_t mode, uint8_t taps);
+
+/**
+ * @brief Destroy an interpolator and set the pointer to NULL.
+ */
+void destroyInterpolator(interpolator_t **ip);
+
+/**
+ * @brief Resample a contiguous record to `cols` values.
+ *
+ * Column i takes the value at fractional sample position start + i * step.
+ * Positions outside [0, n) repeat the edge sample.
+ *
+ * @param[in]  ip     Interpolator.
+ * @param[in]  src    Record.
+ * @param[in]  n      Record length.
+ * @param[in]  start  Sample position of column 0.
+ * @param[in]  step   Samples per column (< 1 when zoomed in).
+ * @param[out] out    cols values.
+ * @param[in]  cols   Number of columns.
+ */
+void ipResample(interpolator_t *ip, const float *src, uint64_t n, double start, double step, float *out, uint32_t cols);
+
+/**
+ * @brief Same as ipResample(), reading the visible span out of a sample store.
+ *
+ * Only the samples under the view (plus the kernel margin) are gathered,
+ * into the calling thread's scratch arena. Each column's value goes to both
+ * vMin and vMax; columns before the oldest or past the newest stored sample
+ * have no data and are left blank (vMin > vMax), as in an envelope.
+ *
+ * @return STATUS_OK, or ERROR_UNKNOWN if the span does not fit in the arena.
+ */
+status_t ipResampleStore(interpolator_t *ip, const sampleStore_t *ss, double start, double step, float *vMin, float *vMax, uint32_t cols);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,138 @@
+#include "latency.h"
+
+#include "../../include/global.h"
+
+static uint32_t ltBucket(uint64_t v){
+    if(v < (1U << LT_SUB_BITS)) return (uint32_t)v;
+    uint32_t shift = (63 - __builtin_clzll(v)) - (LT_SUB_BITS - 1);
+    uint32_t sub   = (uint32_t)(v >> shift);               /// LT_SUB_HALF ... 2 * LT_SUB_HALF - 1
+    return (1U << LT_SUB_BITS) + (shift - 1) * LT_SUB_HALF + (sub - LT_SUB_HALF);
+}
+
+/// Largest value that lands in bucket i
+static uint64_t ltBucketTop(uint32_t i){
+    if(i < (1U << LT_SUB_BITS)) return i;
+    uint32_t k     = i - (1U << LT_SUB_BITS);
+    uint32_t shift = k / LT_SUB_HALF + 1;
+    uint64_t sub   = LT_SUB_HALF + k % LT_SUB_HALF;
+    return ((sub + 1) << shift) - 1;
+}
+
+static void ltHistReset(ltHist_t *h){
+    memset(h, 0, sizeof(ltHist_t));
+    h->min = UINT64_MAX;
+}
+
+status_t createLatency(latency_t **lt, const char * const *names, uint8_t n){
+    __entry("createLatency(%p, %p, %d)", lt, names, n);
+    if(__is_null(lt) || __is_null(names) || n == 0 || n > LT_MAX_STAGES){
+        __err("[createLatency] Invalid params!");
+        return ERROR_INVALID_PARAMS;
+    }
+    *lt = (latency_t *) mpAlloc(sizeof(latency_t));
+    if(__is_null(*lt)){
+        __err("[createLatency] malloc failed!");
+        return ERROR_UNKNOWN;
+    }
+    (*lt)->nStages = n;
+    REPTT(uint8_t, i, 0, n) (*lt)->names[i] = names[i];
+    ltReset(*lt);
+    __exit("createLatency()");
+    return STATUS_OK;
+}
+
+void destroyLatency(latency_t **lt){
+    if(__is_null(lt) || __is_null(*lt)) return;
+    mpFree(*lt);
+    *lt = NULL;
+}
+
+uint64_t ltNow(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+void ltRecord(latency_t *lt, uint8_t stage, uint64_t ns){
+    if(__is_null(lt) || stage >= lt->nStages) return;
+    ltHist_t *h = &lt->stages[stage];
+    __atomic_fetch_add(&h->counts[ltBucket(ns)], 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&h->total, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&h->sum, ns, __ATOMIC_RELAXED);
+    uint64_t cur = __atomic_load_n(&h->min, __ATOMIC_RELAXED);
+    while(ns < cur && !__atomic_compare_exchange_n(&h->min, &cur, ns, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+    cur = __atomic_load_n(&h->max, __ATOMIC_RELAXED);
+    while(ns > cur && !__atomic_compare_exchange_n(&h->max, &cur, ns, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+}
+
+uint64_t ltRecordSince(latency_t *lt, uint8_t stage, uint64_t since){
+    uint64_t now = ltNow();
+    if(since != 0 && now >= since) ltRecord(lt, stage, now - since);
+    return now;
+}
+
+uint64_t ltPercentile(const latency_t *lt, uint8_t stage, double pct){
+    if(__is_null(lt) || stage >= lt->nStages) return 0;
+    const ltHist_t *h = &lt->stages[stage];
+    uint64_t total = __atomic_load_n(&h->total, __ATOMIC_RELAXED);
+    if(total == 0) return 0;
+    pct = __max(0.0, __min(100.0, pct));
+    uint64_t want = (uint64_t)ceil(pct / 100.0 * (double)total), seen = 0;
+    want = __max(want, 1);
+    REPTT(uint32_t, i, 0, LT_BUCKETS){
+        seen += __atomic_load_n(&h->counts[i], __ATOMIC_RELAXED);
+        if(seen >= want) return __min(ltBucketTop(i), __atomic_load_n(&h->max, __ATOMIC_RELAXED));
+    }
+    return __atomic_load_n(&h->max, __ATOMIC_RELAXED);
+}
+
+void ltReset(latency_t *lt){
+    if(__is_null(lt)) return;
+    REPTT(uint8_t, i, 0, lt->nStages) ltHistReset(&lt->stages[i]);
+}
+
+void ltLog(const latency_t *lt){
+    if(__is_null(lt)) return;
+    __log("[latency] %-10s %10s %10s %10s %10s %10s %10s %10s", "stage", "count", "mean us", "p50", "p90", "p99", "p99.9", "max");
+    REPTT(uint8_t, i, 0, lt->nStages){
+        const ltHist_t *h = &lt->stages[i];
+        if(h->total == 0) continue;
+        __log("[latency] %-10s %10llu %10.1f %10.1f %10.1f %10.1f %10.1f %10.1f", lt->names[i],
+            (unsigned long long)h->total, h->sum / 1e3 / h->total,
+            ltPercentile(lt, i, 50.0) / 1e3, ltPercentile(lt, i, 90.0) / 1e3,
+            ltPercentile(lt, i, 99.0) / 1e3, ltPercentile(lt, i, 99.9) / 1e3, h->max / 1e3);
+    }
+}
+
+status_t ltDump(const latency_t *lt, const char *path){
+    if(__is_null(lt) || __is_null(path)) return ERROR_INVALID_PARAMS;
+    FILE *f = fopen(path, "w");
+    if(__is_null(f)){
+        __err("[ltDump] Cannot open %s: %s", path, strerror(errno));
+        return ERROR_UNKNOWN;
+    }
+    REPTT(uint8_t, s, 0, lt->nStages){
+        const ltHist_t *h = &lt->stages[s];
+        fprintf(f, "# stage %s: count %llu", lt->names[s], (unsigned long long)h->total);
+        if(h->total == 0){
+            fprintf(f, "\n\n");
+            continue;
+        }
+        fprintf(f, ", mean %.3f us, min %.3f us, max %.3f us\n",
+            h->sum / 1e3 / h->total, h->min / 1e3, h->max / 1e3);
+        fprintf(f, "%12s %14s %10s %14s\n", "Value", "Percentile", "TotalCount", "1/(1-Percentile)");
+        uint64_t seen = 0;
+        REPTT(uint32_t, i, 0, LT_BUCKETS){
+            if(h->counts[i] == 0) continue;
+            seen += h->counts[i];
+            double p = (double)seen / h->total;
+            uint64_t top = __min(ltBucketTop(i), h->max);
+            if(p < 1.0) fprintf(f, "%12.3f %14.12f %10llu %14.2f\n", top / 1e3, p, (unsigned long long)seen, 1.0 / (1.0 - p));
+            else        fprintf(f, "%12.3f %14.12f %10llu %14s\n", top / 1e3, p, (unsigned long long)seen, "inf");
+        }
+        fprintf(f, "\n");
+    }
+    status_t status = (fclose(f) == 0) ? STATUS_OK : ERROR_UNKNOWN;
+    __log("[ltDump] %s", path);
+    return status;
+}
@@ -0,0 +1,106 @@
+#ifndef __LATENCY_H__
+#define __LATENCY_H__
+
+#ifdef LOG_HEADER_INCLUDE
+#pragma message("INCLUDE: latency.h")
+#endif
+
+#include <stdint.h>
+
+#include "../windowContext/windowContext.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LT_SUB_BITS         7                   /// 64 linear buckets per power of two, < 1.6% error
+#define LT_SUB_HALF         (1U << (LT_SUB_BITS - 1))
+#define LT_BUCKETS          ((1U << LT_SUB_BITS) + (64 - LT_SUB_BITS) * LT_SUB_HALF)
+#define LT_MAX_STAGES       16
+
+/**
+ * @brief Log-linear (HDR-style) histogram of nanosecond values.
+ *
+ * Values below 2^LT_SUB_BITS are exact; above that every power of two is
+ * split into LT_SUB_HALF equal buckets, so the relative error is bounded
+ * over the whole 64-bit range with a fixed-size array. Recording is a
+ * handful of relaxed atomics and may run on any thread.
+ */
+typedef struct ltHist_t {
+    uint64_t        counts[LT_BUCKETS];
+    uint64_t        total;
+    uint64_t        sum;
+    uint64_t        min;
+    uint64_t        max;
+} ltHist_t;
+
+typedef struct latency_t {
+    uint8_t         nStages;
+    const char *    names[LT_MAX_STAGES];
+    ltHist_t        stages[LT_MAX_STAGES];
+} latency_t;
+
+/**
+ * @brief Create one histogram per named stage.
+ *
+ * @param[out] lt      Pointer to a latency pointer. Will be allocated inside.
+ * @param[in]  names   Stage names (kept by pointer, must outlive lt).
+ * @param[in]  n       Number of stages, at most LT_MAX_STAGES.
+ *
+ * @return STATUS_OK on success, ERROR_INVALID_PARAMS or ERROR_UNKNOWN on failure.
+ */
+status_t createLatency(latency_t **lt, const char * const *names, uint8_t n);
+
+/**
+ * @brief Destroy and set the pointer to NULL.
+ */
+void destroyLatency(latency_t **lt);
+
+/**
+ * @brief Monotonic clock in nanoseconds, the time base of every stamp.
+ */
+uint64_t ltNow(void);
+
+/**
+ * @brief Record one value (ns) for a stage; lock-free, safe from any thread.
+ */
+void ltRecord(latency_t *lt, uint8_t stage, uint64_t ns);
+
+/**
+ * @brief Record ltNow() - since, ignoring stamps of 0 (nothing stamped yet).
+ *
+ * @return ltNow(), handy to chain stages.
+ */
+uint64_t ltRecordSince(latency_t *lt, uint8_t stage, uint64_t since);
+
+/**
+ * @brief Value at a percentile (0...100) of a stage, 0 if empty.
+ *
+ * The bucket's upper bound is returned, so the answer never understates.
+ */
+uint64_t ltPercentile(const latency_t *lt, uint8_t stage, double pct);
+
+/**
+ * @brief Clear every stage.
+ */
+void ltReset(latency_t *lt);
+
+/**
+ * @brief Log count, mean, p50 / p90 / p99 / p99.9 and max of every stage.
+ */
+void ltLog(const latency_t *lt);
+
+/**
+ * @brief Write the summary and each stage's percentile distribution to a file.
+ *
+ * The distribution uses the HdrHistogram text layout (value, percentile,
+ * total count, 1 / (1 - percentile)) in microseconds, so existing plotters
+ * can read it.
+ */
+status_t ltDump(const latency_t *lt, const char *path);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
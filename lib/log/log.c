@@ -27,13 +27,17 @@ void __coreLog(const char* tag, const char* format, ...) {
     char __buffer[32];
     strftime(__buffer, sizeof(__buffer), "%H:%M:%S", &__tmBuf);
 
+    /// Format outside the lock; stderr is unbuffered, so one fwrite is one write(2)
+    char    __line[1024];
+    int     n = snprintf(__line, sizeof(__line), "[%s.%06ld] [%s] ", __buffer, (long)__timeVal.tv_usec, tag);
     va_list args;
     va_start(args, format);
+    n += vsnprintf(__line + n, sizeof(__line) - n, format, args);
+    va_end(args);
+    if(n > (int)sizeof(__line) - 2) n = (int)sizeof(__line) - 2;
+    __line[n++] = '\n';
     __entryCriticalSection(&logMutex);
-    fprintf(stderr, "[%s.%06ld] [%s] ", __buffer, __timeVal.tv_usec, tag);
-    vfprintf(stderr, format, args);
-    fprintf(stderr, "\n");
+    fwrite(__line, 1, (size_t)n, stderr);
     __exitCriticalSection(&logMutex);
-    va_end(args);
 }
 
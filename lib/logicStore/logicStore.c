@@ -0,0 +1,337 @@
+#include "logicStore.h"
+
+#include "../../include/global.h"
+#include "../bitStream/bitStream.h"
+
+#define LA_NO_EDGE          UINT64_MAX
+
+/// Read position inside an edge list: `level` holds on [.., next)
+typedef struct laCursor_t {
+    uint64_t        next;                       /// Next edge position, LA_NO_EDGE past the end
+    uint64_t        idx;                        /// Index of that edge
+    uint32_t        off;                        /// Byte offset just after it
+    uint8_t         level;
+} laCursor_t;
+
+/// EDGE LIST /////////////////////////////////////////////////////////////////////////////////////
+
+static uint64_t laVarintGet(const uint8_t *p, uint32_t *off){
+    uint64_t v = 0;
+    uint8_t  shift = 0, b;
+    do {
+        b = p[(*off)++];
+        v |= (uint64_t)(b & 0x7F) << shift;
+        shift += 7;
+    } while(b & 0x80);
+    return v;
+}
+
+static uint8_t laVarintPut(uint8_t *p, uint64_t v){
+    uint8_t n = 0;
+    while(v >= 0x80){
+        p[n++] = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    p[n++] = (uint8_t)v;
+    return n;
+}
+
+/// Decode the edge after cur->next
+static void laCursorStep(const laEdgeList_t *e, laCursor_t *cur){
+    cur->level ^= 1;
+    if(++cur->idx >= e->nEdges){
+        cur->next = LA_NO_EDGE;
+        return;
+    }
+    cur->next += laVarintGet(e->bytes, &cur->off);
+}
+
+/// Position the cursor so that cur->level is the level at pos and cur->next > pos
+static void laCursorSeek(const laEdgeList_t *e, laCursor_t *cur, uint64_t pos){
+    uint64_t lo = 0, hi = e->nSeek;
+    while(lo < hi){
+        uint64_t mid = (lo + hi) / 2;
+        if(e->seekPos[mid] <= pos) lo = mid + 1;
+        else hi = mid;
+    }
+    if(lo == 0){
+        cur->level = e->startLevel;
+        cur->idx   = 0;
+        cur->off   = 0;
+        cur->next  = (e->nEdges > 0) ? laVarintGet(e->bytes, &cur->off) : LA_NO_EDGE;
+    }else{
+        uint64_t s = lo - 1;
+        cur->idx   = s * LA_INDEX_STRIDE;
+        cur->next  = e->seekPos[s];
+        cur->off   = e->seekOff[s];
+        cur->level = e->startLevel ^ (uint8_t)(cur->idx & 1);
+    }
+    while(cur->next <= pos) laCursorStep(e, cur);
+}
+
+/// Advance a cursor that is already at or before pos (cheap for sequential access)
+static void laCursorAdvance(const laEdgeList_t *e, laCursor_t *cur, uint64_t pos){
+    while(cur->next <= pos) laCursorStep(e, cur);
+}
+
+/// Rebuild packed word k of a compressed line
+static uint64_t laEdgeWord(const laEdgeList_t *e, laCursor_t *cur, uint64_t k){
+    const uint64_t base = k * BS_WORD_BITS;
+    laCursorAdvance(e, cur, base);
+    uint64_t w = cur->level ? ~0ULL : 0ULL;
+    while(cur->next < base + BS_WORD_BITS){
+        w ^= ~0ULL << (cur->next - base);       /// Every edge flips all later bits
+        laCursorStep(e, cur);
+    }
+    return w;
+}
+
+static void laFreeEdges(laEdgeList_t **e){
+    if(__is_null(*e)) return;
+    mpFree((*e)->bytes);
+    mpFree((*e)->seekPos);
+    mpFree((*e)->seekOff);
+    mpFree(*e);
+    *e = NULL;
+}
+
+/// API ///////////////////////////////////////////////////////////////////////////////////////////
+
+status_t createLogicStore(logicStore_t **ls, uint8_t nLines, uint64_t depth){
+    __entry("createLogicStore(%p, %u, %llu)", ls, nLines, (unsigned long long)depth);
+    if(__is_null(ls) || nLines == 0 || nLines > LA_MAX_LINES || depth == 0){
+        __err("[createLogicStore] Invalid params!");
+        return ERROR_INVALID_PARAMS;
+    }
+    *ls = (logicStore_t *) mpAlloc(sizeof(logicStore_t));
+    if(__is_null(*ls)){
+        __err("[createLogicStore] malloc failed!");
+        return ERROR_UNKNOWN;
+    }
+    memset(*ls, 0, sizeof(logicStore_t));
+    (*ls)->nLines = nLines;
+    (*ls)->depth  = bsWords(depth) * BS_WORD_BITS;
+
+    REPTT(uint8_t, l, 0, nLines){
+        (*ls)->plane[l] = (uint64_t *) mpCalloc(bsWords(depth), sizeof(uint64_t));
+        if(__is_null((*ls)->plane[l])){
+            __err("[createLogicStore] calloc(%llu words) failed!", (unsigned long long)bsWords(depth));
+            destroyLogicStore(ls);
+            return ERROR_UNKNOWN;
+        }
+    }
+    __log("[createLogicStore] %u lines x %llu samples, %llu MB",
+        nLines, (unsigned long long)(*ls)->depth, (unsigned long long)(laMemoryUsage(*ls) >> 20));
+    __exit("createLogicStore()");
+    return STATUS_OK;
+}
+
+void destroyLogicStore(logicStore_t **ls){
+    if(__is_null(ls) || __is_null(*ls)) return;
+    REPTT(uint8_t, l, 0, LA_MAX_LINES){
+        mpFree((*ls)->plane[l]);
+        laFreeEdges(&(*ls)->edges[l]);
+    }
+    mpFree(*ls);
+    *ls = NULL;
+}
+
+/// 64x64 bit transpose (Hacker's Delight): afterwards bit i of a[l] is bit l of the old a[i]
+static void laTranspose64(uint64_t a[64]){
+    uint64_t m = 0x00000000FFFFFFFFULL;
+    for(uint32_t j = 32; j != 0; j >>= 1, m ^= m << j){
+        for(uint32_t k = 0; k < 64; k = ((k | j) + 1) & ~j){
+            uint64_t t = ((a[k] >> j) ^ a[k | j]) & m;
+            a[k]     ^= t << j;
+            a[k | j] ^= t;
+        }
+    }
+}
+
+uint64_t laWriteSamples(logicStore_t *ls, const uint64_t *samples, uint64_t n){
+    if(__is_null(ls) || __is_null(samples)) return 0;
+    REPTT(uint8_t, l, 0, ls->nLines){
+        if(__is_not_null(ls->edges[l])){
+            __err("[laWriteSamples] line %u is compressed, record is closed", l);
+            return 0;
+        }
+    }
+    n = __min(n, ls->depth - ls->written);
+
+    uint64_t done = 0;
+    while(done < n){
+        uint32_t fill = (uint32_t)(ls->written % BS_WORD_BITS);
+        uint32_t m    = (uint32_t)__min(n - done, (uint64_t)(BS_WORD_BITS - fill));
+        memcpy(ls->pending + fill, samples + done, sizeof(uint64_t) * m);
+        memset(ls->pending + fill + m, 0, sizeof(uint64_t) * (BS_WORD_BITS - fill - m));
+
+        uint64_t block[64];
+        memcpy(block, ls->pending, sizeof(block));
+        laTranspose64(block);
+        uint64_t k = ls->written / BS_WORD_BITS;
+        REPTT(uint8_t, l, 0, ls->nLines) ls->plane[l][k] = block[l];
+
+        ls->written += m;
+        done        += m;
+    }
+    return n;
+}
+
+void laClear(logicStore_t *ls){
+    if(__is_null(ls)) return;
+    REPTT(uint8_t, l, 0, ls->nLines){
+        if(__is_not_null(ls->edges[l])){
+            __err("[laClear] line %u is compressed, record is closed", l);
+            return;
+        }
+    }
+    ls->written = 0;
+    memset(ls->pending, 0, sizeof(ls->pending));
+}
+
+status_t laCompress(logicStore_t *ls, uint8_t line){
+    if(__is_null(ls) || line >= ls->nLines){
+        __err("[laCompress] ls = %p, line = %u", ls, line);
+        return ERROR_INVALID_PARAMS;
+    }
+    if(__is_null(ls->plane[line]) || ls->written == 0) return STATUS_OK;
+
+    const uint64_t *w      = ls->plane[line];
+    const size_t    packed = bsWords(ls->written) * sizeof(uint64_t);
+    uint8_t         first  = (uint8_t)(w[0] & 1);
+
+    uint64_t nEdges = bsCountEdges(w, ls->written, first);
+    uint64_t nSeek  = nEdges / LA_INDEX_STRIDE + 1;
+    /// Worst case 10 bytes per delta; bail out early if even the seek table is too big
+    if(nSeek * (sizeof(uint64_t) + sizeof(uint32_t)) >= packed) return STATUS_OK;
+
+    laEdgeList_t *e = (laEdgeList_t *) mpCalloc(1, sizeof(laEdgeList_t));
+    size_t cap = __min(packed, (size_t)nEdges * 10 + 16);
+    if(__is_not_null(e)){
+        e->bytes   = (uint8_t *) mpAlloc(cap + 10);
+        e->seekPos = (uint64_t *) mpAlloc(sizeof(uint64_t) * nSeek);
+        e->seekOff = (uint32_t *) mpAlloc(sizeof(uint32_t) * nSeek);
+    }
+    if(__is_null(e) || __is_null(e->bytes) || __is_null(e->seekPos) || __is_null(e->seekOff)){
+        __err("[laCompress] malloc failed!");
+        laFreeEdges(&e);
+        return ERROR_UNKNOWN;
+    }
+    e->startLevel = first;
+
+    uint64_t prev = 0, pos = 0;
+    while((pos = bsNextEdge(w, ls->written, pos + 1, first)) < ls->written){
+        if(e->nBytes >= cap || e->nBytes > UINT32_MAX - 10){
+            laFreeEdges(&e);                    /// Not worth it, stay packed
+            return STATUS_OK;
+        }
+        e->nBytes += laVarintPut(e->bytes + e->nBytes, pos - prev);
+        if(e->nEdges % LA_INDEX_STRIDE == 0){
+            e->seekPos[e->nSeek] = pos;
+            e->seekOff[e->nSeek] = (uint32_t)e->nBytes;
+            e->nSeek++;
+        }
+        e->nEdges++;
+        prev = pos;
+    }
+
+    size_t compressed = e->nBytes + e->nSeek * (sizeof(uint64_t) + sizeof(uint32_t));
+    if(compressed >= packed){
+        laFreeEdges(&e);
+        return STATUS_OK;
+    }
+    __log("[laCompress] line %u: %llu edges, %zu -> %zu bytes", line, (unsigned long long)e->nEdges, packed, compressed);
+    ls->edges[line] = e;
+    mpFree(ls->plane[line]);
+    ls->plane[line] = NULL;
+    return STATUS_OK;
+}
+
+uint8_t laLevelAt(const logicStore_t *ls, uint8_t line, uint64_t pos){
+    if(__is_null(ls) || line >= ls->nLines || pos >= ls->written) return 0;
+    if(ls->plane[line]) return bsGet(ls->plane[line], pos);
+    laCursor_t cur;
+    laCursorSeek(ls->edges[line], &cur, pos);
+    return cur.level;
+}
+
+uint64_t laNextEdge(const logicStore_t *ls, uint8_t line, uint64_t from){
+    if(__is_null(ls) || line >= ls->nLines || from >= ls->written) return ls ? ls->written : 0;
+    if(ls->plane[line]){
+        /// No predecessor at 0: pass bit 0 itself as the level before the record
+        const uint64_t *w = ls->plane[line];
+        return bsNextEdge(w, ls->written, from, (uint8_t)(w[0] & 1));
+    }
+    laCursor_t cur;
+    laCursorSeek(ls->edges[line], &cur, from ? from - 1 : 0);
+    return __min(cur.next, ls->written);
+}
+
+uint64_t laFindTrigger(const logicStore_t *ls, const laTrigger_t *trig, uint64_t from){
+    if(__is_null(ls) || __is_null(trig) || from >= ls->written) return ls ? ls->written : 0;
+    const uint64_t nWords = bsWords(ls->written);
+    const int8_t   el     = (trig->edgeLine >= 0 && trig->edgeLine < ls->nLines) ? trig->edgeLine : -1;
+
+    laCursor_t cur[LA_MAX_LINES];
+    uint64_t k0 = from / BS_WORD_BITS;
+    REPTT(uint8_t, l, 0, ls->nLines){
+        if(ls->edges[l]) laCursorSeek(ls->edges[l], &cur[l], (k0 > 0 ? k0 - 1 : 0) * BS_WORD_BITS);
+    }
+    #define laWord(l, k) (ls->plane[l] ? ls->plane[l][k] : laEdgeWord(ls->edges[l], &cur[l], (k)))
+
+    uint64_t prevWord = 0;
+    if(el >= 0) prevWord = (k0 > 0) ? laWord(el, k0 - 1) : ((laLevelAt(ls, el, 0) ? ~0ULL : 0ULL));
+
+    for(uint64_t k = k0; k < nWords; ++k){
+        uint64_t m = ~0ULL;
+        uint64_t mask = trig->mask & ((ls->nLines == 64) ? ~0ULL : ((1ULL << ls->nLines) - 1));
+        /// Each word once per k: a compressed line's cursor has moved past it after the first read
+        uint64_t elWord = (el >= 0) ? laWord(el, k) : 0;
+        while(mask && m){
+            uint8_t  l = (uint8_t)__builtin_ctzll(mask);
+            uint64_t w = (l == el) ? elWord : laWord(l, k);
+            m &= ((trig->value >> l) & 1) ? w : ~w;
+            mask &= mask - 1;
+        }
+        if(el >= 0){
+            uint64_t t = elWord ^ ((elWord << 1) | (prevWord >> 63));
+            m &= trig->rising ? (t & elWord) : (t & ~elWord);
+            prevWord = elWord;
+        }
+        if(k == k0) m &= ~0ULL << (from % BS_WORD_BITS);
+        uint64_t end = ls->written - k * BS_WORD_BITS;
+        if(end < BS_WORD_BITS) m &= (1ULL << end) - 1;
+        if(m) return k * BS_WORD_BITS + (uint64_t)__builtin_ctzll(m);
+    }
+    #undef laWord
+    return ls->written;
+}
+
+size_t laMemoryUsage(const logicStore_t *ls){
+    if(__is_null(ls)) return 0;
+    size_t total = 0;
+    REPTT(uint8_t, l, 0, ls->nLines){
+        if(ls->plane[l]) total += bsWords(ls->depth) * sizeof(uint64_t);
+        if(ls->edges[l]) total += ls->edges[l]->nBytes + ls->edges[l]->nSeek * (sizeof(uint64_t) + sizeof(uint32_t));
+    }
+    return total;
+}
+
+void laRender(rsTarget_t *t, const logicStore_t *ls, uint8_t line, double viewStart, double samplesPerCol,
+    xy_t yTop, xy_t height, color_t c){
+    if(__is_null(t) || __is_null(ls) || line >= ls->nLines || !(samplesPerCol > 0.0)) return;
+    REPTT(xy_t, x, 0, t->w){
+        double a = viewStart + x * samplesPerCol;
+        if(a < 0.0) continue;
+        if(a >= (double)ls->written) break;
+        /// An edge at p is the change between samples p-1 and p, i.e. at time p
+        uint64_t lo = (uint64_t)ceil(a);
+        uint64_t hi = (uint64_t)ceil(a + samplesPerCol);
+        if(laNextEdge(ls, line, lo) < hi){
+            rsVSpan(t, x, yTop, yTop + height, c);
+        }else{
+            xy_t row = laLevelAt(ls, line, (uint64_t)a) ? yTop : yTop + height;
+            rsHSpan(t, row, x, x, c);
+        }
+    }
+}
@@ -0,0 +1,146 @@
+#ifndef __LOGIC_STORE_H__
+#define __LOGIC_STORE_H__
+
+#ifdef LOG_HEADER_INCLUDE
+#pragma message("INCLUDE: logicStore.h")
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../windowContext/windowContext.h"
+#include "../raster/raster.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LA_MAX_LINES        64
+#define LA_INDEX_STRIDE     64                  /// Edges between two seek points of a compressed line
+
+/**
+ * @brief A compressed line: start level plus varint-coded distances between edges.
+ *
+ * Every LA_INDEX_STRIDE edges a seek point records (position, byte offset),
+ * so random access only decodes a short run.
+ */
+typedef struct laEdgeList_t {
+    uint8_t         startLevel;
+    uint64_t        nEdges;
+    uint8_t *       bytes;
+    size_t          nBytes;
+    uint64_t *      seekPos;                    /// Position of edge i * LA_INDEX_STRIDE
+    uint32_t *      seekOff;                    /// Byte offset just after that edge
+    uint64_t        nSeek;
+} laEdgeList_t;
+
+/**
+ * @brief Logic-analyzer record: one bit-plane per line, 1 bit per sample.
+ *
+ * Each line is held either packed (64 samples per word) or, after
+ * laCompress(), as an edge list. Queries work on both without expanding.
+ */
+typedef struct logicStore_t {
+    uint8_t         nLines;
+    uint64_t        depth;                      /// Capacity in samples (multiple of 64)
+    uint64_t        written;
+    uint64_t *      plane[LA_MAX_LINES];        /// NULL once the line is compressed
+    laEdgeList_t *  edges[LA_MAX_LINES];        /// NULL while the line is packed
+    uint64_t        pending[64];                /// Sample words of the unfinished 64-sample block
+} logicStore_t;
+
+/**
+ * @brief Trigger condition: a pattern over the lines, optionally qualified by an edge.
+ */
+typedef struct laTrigger_t {
+    uint64_t        mask;                       /// Lines that take part in the pattern
+    uint64_t        value;                      /// Required level of each masked line
+    int8_t          edgeLine;                   /// -1 for a pure pattern trigger
+    uint8_t         rising;                     /// Edge polarity on edgeLine
+} laTrigger_t;
+
+/**
+ * @brief Create a logic store.
+ *
+ * @param[out] ls     Pointer to a logic store pointer. Will be allocated inside.
+ * @param[in]  nLines Number of lines, 1 ... LA_MAX_LINES.
+ * @param[in]  depth  Samples per line, rounded up to a multiple of 64.
+ *
+ * @return STATUS_OK on success, ERROR_INVALID_PARAMS or ERROR_UNKNOWN on failure.
+ */
+status_t createLogicStore(logicStore_t **ls, uint8_t nLines, uint64_t depth);
+
+/**
+ * @brief Destroy a logic store and set the pointer to NULL.
+ */
+void destroyLogicStore(logicStore_t **ls);
+
+/**
+ * @brief Append samples given as words, bit l of samples[i] = line l at sample i.
+ *
+ * Blocks of 64 samples are transposed into the bit-planes.
+ *
+ * @return Number of samples stored (less than n once the record is full or a line is compressed).
+ */
+uint64_t laWriteSamples(logicStore_t *ls, const uint64_t *samples, uint64_t n);
+
+/**
+ * @brief Empty the record so the same planes take a new capture. Lines must still be packed.
+ */
+void laClear(logicStore_t *ls);
+
+/**
+ * @brief Convert a line to the edge-list form if that is smaller.
+ *
+ * Meant for a finished capture; a compressed line accepts no more samples.
+ *
+ * @return STATUS_OK (compressed or kept packed), ERROR_UNKNOWN on allocation failure.
+ */
+status_t laCompress(logicStore_t *ls, uint8_t line);
+
+/**
+ * @brief Level of a line at sample pos.
+ */
+uint8_t laLevelAt(const logicStore_t *ls, uint8_t line, uint64_t pos);
+
+/**
+ * @brief Position of the first edge at or after `from`, or ls->written if none.
+ */
+uint64_t laNextEdge(const logicStore_t *ls, uint8_t line, uint64_t from);
+
+/**
+ * @brief First position at or after `from` that satisfies the trigger, or ls->written.
+ *
+ * Evaluated 64 samples at a time on the packed words.
+ */
+uint64_t laFindTrigger(const logicStore_t *ls, const laTrigger_t *trig, uint64_t from);
+
+/**
+ * @brief Bytes held by the record (planes + edge lists).
+ */
+size_t laMemoryUsage(const logicStore_t *ls);
+
+/**
+ * @brief Draw one line as a digital trace.
+ *
+ * Each column is either a level (one pixel at the high or low row) or, when
+ * an edge falls inside it, a full-height transition. Columns spanning many
+ * samples are resolved with one edge search each.
+ *
+ * @param[in,out] t             Target.
+ * @param[in]     ls            Logic store.
+ * @param[in]     line          Line to draw.
+ * @param[in]     viewStart     Sample at column 0.
+ * @param[in]     samplesPerCol Horizontal scale.
+ * @param[in]     yTop          Row of the high level.
+ * @param[in]     height        Pixels between high and low.
+ * @param[in]     c             Color.
+ */
+void laRender(rsTarget_t *t, const logicStore_t *ls, uint8_t line, double viewStart, double samplesPerCol,
+    xy_t yTop, xy_t height, color_t c);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,286 @@
+#include "maskTest.h"
+
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+
+#include "../../include/global.h"
+
+status_t createMaskTest(maskTest_t **mt, xy_t cols){
+    __entry("createMaskTest(%p, %d)", mt, cols);
+    if(__is_null(mt) || cols <= 0){
+        __err("[createMaskTest] Invalid params!");
+        return ERROR_INVALID_PARAMS;
+    }
+    *mt = (maskTest_t *) mpCalloc(1, sizeof(maskTest_t));
+    if(__is_null(*mt)){
+        __err("[createMaskTest] malloc failed!");
+        return ERROR_UNKNOWN;
+    }
+    /// One block for the six tables
+    float *p = (float *) mpAlloc(sizeof(float) * 6 * (size_t)cols);
+    if(__is_null(p)){
+        __err("[createMaskTest] malloc(%d columns) failed!", cols);
+        mpFree(*mt);
+        *mt = NULL;
+        return ERROR_UNKNOWN;
+    }
+    (*mt)->cols  = cols;
+    (*mt)->lo    = p;
+    (*mt)->hi    = p + cols;
+    (*mt)->loIn  = p + 2 * cols;
+    (*mt)->hiIn  = p + 3 * cols;
+    (*mt)->loOut = p + 4 * cols;
+    (*mt)->hiOut = p + 5 * cols;
+    mtClear(*mt);
+    __exit("createMaskTest()");
+    return STATUS_OK;
+}
+
+void destroyMaskTest(maskTest_t **mt){
+    if(__is_null(mt) || __is_null(*mt)) return;
+    mpFree((*mt)->lo);
+    mpFree(*mt);
+    *mt = NULL;
+}
+
+/// In / Out limits of every column from the centre values and the two half-way points
+static void mtUpdateBounds(maskTest_t *mt){
+    const xy_t n = mt->cols;
+    REPTT(xy_t, x, 0, n){
+        float lo = mt->lo[x], hi = mt->hi[x];
+        float loL = (x > 0) ? (mt->lo[x - 1] + lo) / 2 : lo, loR = (x + 1 < n) ? (lo + mt->lo[x + 1]) / 2 : lo;
+        float hiL = (x > 0) ? (mt->hi[x - 1] + hi) / 2 : hi, hiR = (x + 1 < n) ? (hi + mt->hi[x + 1]) / 2 : hi;
+        mt->loIn[x]  = __max(lo, __max(loL, loR));
+        mt->loOut[x] = __min(lo, __min(loL, loR));
+        mt->hiIn[x]  = __min(hi, __min(hiL, hiR));
+        mt->hiOut[x] = __max(hi, __max(hiL, hiR));
+    }
+}
+
+void mtClear(maskTest_t *mt){
+    if(__is_null(mt)) return;
+    REPTT(xy_t, x, 0, mt->cols){
+        mt->lo[x] = -INFINITY;
+        mt->hi[x] = INFINITY;
+    }
+    mtUpdateBounds(mt);
+}
+
+status_t mtAddPolygon(maskTest_t *mt, const float *xs, const float *ys, uint32_t n, mtRegion_t region){
+    if(__is_null(mt) || __is_null(xs) || __is_null(ys) || n < 3){
+        __err("[mtAddPolygon] Invalid params!");
+        return ERROR_INVALID_PARAMS;
+    }
+    REPTT(xy_t, x, 0, mt->cols){
+        const float cx = x + 0.5f;
+        float   yLo = INFINITY, yHi = -INFINITY;
+        REPTT(uint32_t, i, 0, n){
+            uint32_t j = (i + 1 == n) ? 0 : i + 1;
+            float x0 = xs[i], x1 = xs[j];
+            if(!((x0 <= cx && cx < x1) || (x1 <= cx && cx < x0))) continue;
+            float y = ys[i] + (cx - x0) * (ys[j] - ys[i]) / (x1 - x0);
+            yLo = __min(yLo, y);
+            yHi = __max(yHi, y);
+        }
+        if(yLo > yHi) continue;                 /// Column outside the polygon
+        if(region == MT_REGION_ABOVE) mt->hi[x] = __min(mt->hi[x], yLo);
+        else                          mt->lo[x] = __max(mt->lo[x], yHi);
+    }
+    mtUpdateBounds(mt);
+    return STATUS_OK;
+}
+
+status_t mtFromGolden(maskTest_t *mt, const float *golden, uint64_t n, float tolY, xy_t tolCols){
+    if(__is_null(mt) || __is_null(golden) || n == 0 || tolY < 0 || tolCols < 0){
+        __err("[mtFromGolden] Invalid params!");
+        return ERROR_INVALID_PARAMS;
+    }
+    mpArena_t *arena = mpThreadArena();
+    size_t     mark  = mpArenaMark(arena);
+    float *gMin = (float *) mpArenaAlloc(arena, sizeof(float) * mt->cols);
+    float *gMax = (float *) mpArenaAlloc(arena, sizeof(float) * mt->cols);
+    if(__is_null(gMin) || __is_null(gMax)){
+        __err("[mtFromGolden] arena exhausted");
+        mpArenaRelease(arena, mark);
+        return ERROR_UNKNOWN;
+    }
+    rsDecimateMinMax(golden, n, gMin, gMax, mt->cols);
+    REPTT(xy_t, x, 0, mt->cols){
+        float lo = gMin[x], hi = gMax[x];
+        for(xy_t k = __max(0, x - tolCols); k <= __min(mt->cols - 1, x + tolCols); ++k){
+            lo = __min(lo, gMin[k]);
+            hi = __max(hi, gMax[k]);
+        }
+        mt->lo[x] = lo - tolY;
+        mt->hi[x] = hi + tolY;
+    }
+    mpArenaRelease(arena, mark);
+    mtUpdateBounds(mt);
+    return STATUS_OK;
+}
+
+/// Limit at a position in column units (centre of column j is j + 0.5)
+static inline float mtLimitAt(const float *v, xy_t cols, double pos){
+    pos -= 0.5;
+    if(pos <= 0.0) return v[0];
+    xy_t j = (xy_t)pos;
+    if(j >= cols - 1) return v[cols - 1];
+    float a = v[j], b = v[j + 1], t = (float)(pos - j);
+    if(a == b || t == 0.0f) return a;
+    if(isinf(a)) return a;                      /// Unconstrained side wins, as in the In/Out bounds
+    if(isinf(b)) return b;
+    return a + (b - a) * t;
+}
+
+/// Full-resolution check of one column's samples
+static uint8_t mtRefine(const maskTest_t *mt, const float *s, uint64_t n, xy_t x){
+    const xy_t cols = mt->cols;
+    uint64_t a = n * (uint64_t)x / cols, b = n * (uint64_t)(x + 1) / cols;
+    if(b <= a) b = a + 1;
+    if(b > n) return 1;
+    const double scale = (double)cols / (double)n;
+    for(uint64_t i = a; i < b; ++i){
+        double pos = (i + 0.5) * scale;
+        float  v = s[i];
+        if(!(v >= mtLimitAt(mt->lo, cols, pos) && v <= mtLimitAt(mt->hi, cols, pos))) return 0;
+    }
+    return 1;
+}
+
+static inline void mtColumn(const maskTest_t *mt, const float *s, uint64_t n, xy_t x, float vMin, float vMax, mtResult_t *res){
+    if(vMin >= mt->loIn[x] && vMax <= mt->hiIn[x]) return;
+    uint8_t ok;
+    if(vMin < mt->loOut[x] || vMax > mt->hiOut[x]){
+        ok = 0;
+    }else{
+        res->nearCols++;
+        ok = mtRefine(mt, s, n, x);
+    }
+    if(!ok){
+        if(res->failCols++ == 0) res->firstFail = x;
+        res->pass = 0;
+    }
+}
+
+void mtCheck(const maskTest_t *mt, const float *samples, uint64_t n, mtResult_t *res){
+    if(__is_null(res)) return;
+    res->pass      = 1;
+    res->failCols  = 0;
+    res->firstFail = -1;
+    res->nearCols  = 0;
+    /// An empty capture has nothing outside the mask; no mask or no data is a failure
+    if(__is_null(mt) || __is_null(samples)){
+        res->pass = 0;
+        return;
+    }
+    if(n == 0) return;
+
+    mpArena_t *arena = mpThreadArena();
+    size_t     mark  = mpArenaMark(arena);
+    float *vMin = (float *) mpArenaAlloc(arena, sizeof(float) * mt->cols);
+    float *vMax = (float *) mpArenaAlloc(arena, sizeof(float) * mt->cols);
+    if(__is_null(vMin) || __is_null(vMax)){
+        __err("[mtCheck] arena exhausted");
+        res->pass = 0;
+        mpArenaRelease(arena, mark);
+        return;
+    }
+    rsDecimateMinMax(samples, n, vMin, vMax, mt->cols);
+
+    xy_t x = 0;
+#if defined(__SSE__)
+    for(; x + 4 <= mt->cols; x += 4){
+        __m128 mn = _mm_loadu_ps(vMin + x), mx = _mm_loadu_ps(vMax + x);
+        int in = _mm_movemask_ps(_mm_and_ps(_mm_cmpge_ps(mn, _mm_loadu_ps(mt->loIn + x)),
+                                            _mm_cmple_ps(mx, _mm_loadu_ps(mt->hiIn + x))));
+        if(in == 0xF) continue;                 /// The common case: four clear columns
+        REPTT(xy_t, k, 0, 4){
+            if(!(in & (1 << k))) mtColumn(mt, samples, n, x + k, vMin[x + k], vMax[x + k], res);
+        }
+    }
+#endif
+    for(; x < mt->cols; ++x) mtColumn(mt, samples, n, x, vMin[x], vMax[x], res);
+    mpArenaRelease(arena, mark);
+}
+
+static void mtSave(maskTest_t *mt, const float *samples, uint64_t n){
+    char path[MT_PATH_SIZE + 32];
+    snprintf(path, sizeof(path), "%s/fail-%llu.%s", mt->saveDir, (unsigned long long)mt->tests,
+             mt->compress ? "bcz" : "f32");
+    if(mt->compress){
+        if(bcWriteFile(path, samples, n) == STATUS_OK) mt->saved++;
+        return;
+    }
+    FILE *f = fopen(path, "wb");
+    if(__is_null(f)){
+        __err("[mtSave] Cannot open %s: %s", path, strerror(errno));
+        return;
+    }
+    if(fwrite(samples, sizeof(float), n, f) != n) __err("[mtSave] Short write to %s", path);
+    fclose(f);
+    mt->saved++;
+}
+
+uint8_t mtRun(maskTest_t *mt, const float *samples, uint64_t n, mtResult_t *res){
+    if(__is_null(mt) || __is_null(res) || mt->stopped) return 0;
+    mtCheck(mt, samples, n, res);
+    mt->tests++;
+    mt->nearCols += res->nearCols;
+    if(res->pass){
+        mt->passes++;
+        return 1;
+    }
+    mt->fails++;
+    if(mt->saveDir[0] && mt->saved < mt->saveMax) mtSave(mt, samples, n);
+    if(mt->stopOnFail){
+        mt->stopped = 1;
+        __log("[mtRun] Stopped on failure at test %llu, column %d", (unsigned long long)mt->tests, res->firstFail);
+    }
+    return 0;
+}
+
+void mtSetStopOnFail(maskTest_t *mt, uint8_t stop){
+    if(__is_not_null(mt)) mt->stopOnFail = stop;
+}
+
+status_t mtSetSaveDir(maskTest_t *mt, const char *dir, uint32_t max){
+    if(__is_null(mt)) return ERROR_INVALID_PARAMS;
+    if(__is_null(dir) || !*dir){
+        mt->saveDir[0] = '\0';
+        return STATUS_OK;
+    }
+    if(strlen(dir) >= MT_PATH_SIZE){
+        __err("[mtSetSaveDir] Path too long: %s", dir);
+        return ERROR_INVALID_PARAMS;
+    }
+    strcpy(mt->saveDir, dir);
+    mt->saveMax = max;
+    mt->saved   = 0;
+    return STATUS_OK;
+}
+
+void mtSetCompress(maskTest_t *mt, uint8_t compress){
+    if(__is_not_null(mt)) mt->compress = compress;
+}
+
+void mtResetStats(maskTest_t *mt){
+    if(__is_null(mt)) return;
+    mt->tests = mt->passes = mt->fails = mt->nearCols = 0;
+    mt->stopped = 0;
+}
+
+void mtDraw(rsTarget_t *t, const maskTest_t *mt, float yMin, float yMax, color_t c){
+    if(__is_null(t) || __is_null(mt)) return;
+    const xy_t cols = __min(t->w, mt->cols);
+    REPTT(xy_t, x, 0, cols){
+        if(isfinite(mt->hi[x])){
+            xy_t r = rsValueToRow(t, mt->hi[x], yMin, yMax);
+            if(r > 0) rsVSpan(t, x, 0, r - 1, c);
+        }
+        if(isfinite(mt->lo[x])){
+            xy_t r = rsValueToRow(t, mt->lo[x], yMin, yMax);
+            if(r < t->h - 1) rsVSpan(t, x, r + 1, t->h - 1, c);
+        }
+    }
+}
@@ -0,0 +1,152 @@
+#ifndef __MASK_TEST_H__
+#define __MASK_TEST_H__
+
+#ifdef LOG_HEADER_INCLUDE
+#pragma message("INCLUDE: maskTest.h")
+#endif
+
+#include <stdint.h>
+
+#include "../windowContext/windowContext.h"
+#include "../raster/raster.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MT_PATH_SIZE        256
+
+typedef enum mtRegion_t {
+    MT_REGION_ABOVE = 0,                        /// Keep-out polygon over the signal: limits the top
+    MT_REGION_BELOW,                            /// Keep-out polygon under the signal: limits the bottom
+} mtRegion_t;
+
+/**
+ * @brief Outcome of one test.
+ */
+typedef struct mtResult_t {
+    uint8_t         pass;
+    xy_t            failCols;                   /// Columns with at least one violating sample
+    xy_t            firstFail;                  /// First failing column, -1 if none
+    xy_t            nearCols;                   /// Columns that needed the per-sample check
+} mtResult_t;
+
+/**
+ * @brief Mask / limit tester.
+ *
+ * The mask is a per-column limit table: lo[x] / hi[x] are the limits at the
+ * centre of column x and the limit between centres is linear. From that,
+ * each column also gets its tightest (In) and loosest (Out) limits, so a
+ * test is:
+ *
+ *  1. min/max decimation of the capture into one envelope per column;
+ *  2. four columns per SSE compare: inside In passes, outside Out fails;
+ *  3. only the columns in between are checked sample by sample against the
+ *     interpolated limit.
+ *
+ * Unconstrained limits are +-INFINITY. Samples are expected to be finite:
+ * a NaN does not show in the min/max envelope.
+ */
+typedef struct maskTest_t {
+    xy_t            cols;
+    float *         lo;                         /// Limits at column centres
+    float *         hi;
+    float *         loIn;                       /// Tightest limits within each column
+    float *         hiIn;
+    float *         loOut;                      /// Loosest limits within each column
+    float *         hiOut;
+
+    uint64_t        tests;
+    uint64_t        passes;
+    uint64_t        fails;
+    uint64_t        nearCols;                   /// Columns refined at full resolution, all tests
+    uint8_t         stopOnFail;
+    uint8_t         stopped;                    /// Set by a failure when stopOnFail
+    char            saveDir[MT_PATH_SIZE];      /// Failing captures go here, empty = don't save
+    uint32_t        saveMax;
+    uint32_t        saved;
+    uint8_t         compress;                   /// Save as .bcz (blockCodec) instead of .f32
+} maskTest_t;
+
+/**
+ * @brief Create a tester with `cols` columns and no limits.
+ *
+ * @return STATUS_OK on success, ERROR_INVALID_PARAMS or ERROR_UNKNOWN on failure.
+ */
+status_t createMaskTest(maskTest_t **mt, xy_t cols);
+
+/**
+ * @brief Destroy a tester and set the pointer to NULL.
+ */
+void destroyMaskTest(maskTest_t **mt);
+
+/**
+ * @brief Remove every limit.
+ */
+void mtClear(maskTest_t *mt);
+
+/**
+ * @brief Rasterize a keep-out polygon into the limit table.
+ *
+ * The polygon is sampled at every column centre; features narrower than a
+ * column can fall between centres.
+ *
+ * @param[in] xs, ys   Vertices: x in columns (0 ... cols), y in signal units.
+ * @param[in] n        Number of vertices (>= 3), closed implicitly.
+ * @param[in] region   Whether the polygon bounds the signal from above or below.
+ */
+status_t mtAddPolygon(maskTest_t *mt, const float *xs, const float *ys, uint32_t n, mtRegion_t region);
+
+/**
+ * @brief Replace the mask with a golden waveform's envelope widened by tolY
+ *        and dilated by tolCols columns on each side.
+ */
+status_t mtFromGolden(maskTest_t *mt, const float *golden, uint64_t n, float tolY, xy_t tolCols);
+
+/**
+ * @brief Test one capture against the mask, without touching the counters.
+ *
+ * `res` is always filled in: an empty capture passes, a NULL mask or NULL
+ * samples fail.
+ */
+void mtCheck(const maskTest_t *mt, const float *samples, uint64_t n, mtResult_t *res);
+
+/**
+ * @brief Test one capture, update the counters, save it if it failed.
+ *
+ * @return 1 pass, 0 fail; also 0 without testing once stopped by stopOnFail.
+ */
+uint8_t mtRun(maskTest_t *mt, const float *samples, uint64_t n, mtResult_t *res);
+
+/**
+ * @brief Stop testing at the first failure (mtRun() then refuses until mtResetStats()).
+ */
+void mtSetStopOnFail(maskTest_t *mt, uint8_t stop);
+
+/**
+ * @brief Save up to `max` failing captures into dir as fail-<test>.f32 (raw float32).
+ *
+ * @param[in] dir   Existing directory, NULL or "" to stop saving.
+ */
+status_t mtSetSaveDir(maskTest_t *mt, const char *dir, uint32_t max);
+
+/**
+ * @brief Save failing captures losslessly compressed, as fail-<test>.bcz (see bcLoadFile()).
+ */
+void mtSetCompress(maskTest_t *mt, uint8_t compress);
+
+/**
+ * @brief Zero the counters and clear a stop.
+ */
+void mtResetStats(maskTest_t *mt);
+
+/**
+ * @brief Shade the keep-out area of every column (static layer).
+ */
+void mtDraw(rsTarget_t *t, const maskTest_t *mt, float yMin, float yMax, color_t c);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,481 @@
+#include "mathChannel.h"
+
+#include <ctype.h>
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+
+#include "../../include/global.h"
+
+/// PARSER ////////////////////////////////////////////////////////////////////////////////////////
+
+/// Result of a sub-expression: either a folded constant, or ops already emitted (value on top)
+typedef struct mcNode_t {
+    uint8_t         isConst;
+    float           value;
+} mcNode_t;
+
+typedef struct mcParser_t {
+    mathChannel_t * mc;
+    const char *    pos;
+    uint8_t         depth;
+    status_t        status;
+} mcParser_t;
+
+static mcNode_t mcParseExpr(mcParser_t *p);
+
+static void mcParseError(mcParser_t *p, const char *what){
+    if(p->status == STATUS_OK){
+        __err("[createMathChannel] %s at column %d in \"%s\"", what, (int)(p->pos - p->mc->expr) + 1, p->mc->expr);
+    }
+    p->status = ERROR_INVALID_PARAMS;
+}
+
+static void mcSkipSpace(mcParser_t *p){
+    while(isspace((unsigned char)*p->pos)) ++p->pos;
+}
+
+static uint8_t mcAccept(mcParser_t *p, char c){
+    mcSkipSpace(p);
+    if(*p->pos != c) return 0;
+    ++p->pos;
+    return 1;
+}
+
+static mcOp_t *mcEmit(mcParser_t *p, mcOpcode_t code){
+    mathChannel_t *mc = p->mc;
+    if(mc->nOps >= MC_MAX_OPS){
+        mcParseError(p, "expression too long");
+        return NULL;
+    }
+    mcOp_t *op = &mc->ops[mc->nOps++];
+    memset(op, 0, sizeof(mcOp_t));
+    op->code = code;
+    op->k    = 1.0f;
+    return op;
+}
+
+static void mcPush(mcParser_t *p){
+    if(++p->depth > MC_MAX_STACK){
+        mcParseError(p, "expression nested too deep");
+        return;
+    }
+    if(p->depth > p->mc->maxDepth) p->mc->maxDepth = p->depth;
+}
+
+/// Make sure a node lives on the stack (a constant becomes a CONST op)
+static void mcMaterialize(mcParser_t *p, mcNode_t *n){
+    if(!n->isConst) return;
+    mcOp_t *op = mcEmit(p, MC_OP_CONST);
+    if(op) op->k = n->value;
+    mcPush(p);
+    n->isConst = 0;
+}
+
+/// top = top * k + c, merged into the previous affine op when that op produced the top
+static void mcEmitAffine(mcParser_t *p, float k, float c){
+    mathChannel_t *mc = p->mc;
+    if(mc->nOps > 0 && mc->ops[mc->nOps - 1].code == MC_OP_AFFINE){
+        mcOp_t *prev = &mc->ops[mc->nOps - 1];
+        prev->c = prev->c * k + c;
+        prev->k = prev->k * k;
+        return;
+    }
+    mcOp_t *op = mcEmit(p, MC_OP_AFFINE);
+    if(!op) return;
+    op->k = k;
+    op->c = c;
+}
+
+static mcNode_t mcConst(float v){
+    mcNode_t n = {1, v};
+    return n;
+}
+
+static mcNode_t mcCombine(mcParser_t *p, char opc, mcNode_t a, mcNode_t b){
+    if(a.isConst && b.isConst){
+        switch(opc){
+            case '+': return mcConst(a.value + b.value);
+            case '-': return mcConst(a.value - b.value);
+            case '*': return mcConst(a.value * b.value);
+            default : return mcConst(a.value / b.value);
+        }
+    }
+    if(b.isConst){
+        switch(opc){
+            case '+': mcEmitAffine(p, 1.0f,  b.value);          break;
+            case '-': mcEmitAffine(p, 1.0f, -b.value);          break;
+            case '*': mcEmitAffine(p, b.value, 0.0f);           break;
+            default : mcEmitAffine(p, 1.0f / b.value, 0.0f);    break;
+        }
+        return a;
+    }
+    if(a.isConst){
+        switch(opc){
+            case '+': mcEmitAffine(p,  1.0f, a.value);          break;
+            case '-': mcEmitAffine(p, -1.0f, a.value);          break;
+            case '*': mcEmitAffine(p, a.value, 0.0f);           break;
+            default :
+                mcEmit(p, MC_OP_RECIP);
+                mcEmitAffine(p, a.value, 0.0f);
+                break;
+        }
+        return b;
+    }
+    switch(opc){
+        case '+': mcEmit(p, MC_OP_ADD); break;
+        case '-': mcEmit(p, MC_OP_SUB); break;
+        case '*': mcEmit(p, MC_OP_MUL); break;
+        default : mcEmit(p, MC_OP_DIV); break;
+    }
+    --p->depth;
+    return a;
+}
+
+/// Parse "(x, k0, k1, ...)" where every argument after x must fold to a constant
+static uint8_t mcParseArgs(mcParser_t *p, float *args, uint8_t maxArgs){
+    uint8_t nArgs = 0;
+    while(mcAccept(p, ',')){
+        mcNode_t a = mcParseExpr(p);
+        if(!a.isConst){
+            mcParseError(p, "filter coefficient must be constant");
+            return nArgs;
+        }
+        if(nArgs >= maxArgs){
+            mcParseError(p, "too many coefficients");
+            return nArgs;
+        }
+        args[nArgs++] = a.value;
+    }
+    if(!mcAccept(p, ')')) mcParseError(p, "expected ')'");
+    return nArgs;
+}
+
+static mcNode_t mcParsePrimary(mcParser_t *p){
+    mcSkipSpace(p);
+    const char *s = p->pos;
+
+    if(isdigit((unsigned char)*s) || *s == '.'){
+        char *end;
+        float v = strtof(s, &end);
+        p->pos = end;
+        return mcConst(v);
+    }
+
+    if(mcAccept(p, '(')){
+        mcNode_t n = mcParseExpr(p);
+        if(!mcAccept(p, ')')) mcParseError(p, "expected ')'");
+        return n;
+    }
+
+    if(isalpha((unsigned char)*s)){
+        char name[16];
+        uint8_t len = 0;
+        while(isalnum((unsigned char)*p->pos) && len < sizeof(name) - 1){
+            name[len++] = (char)tolower((unsigned char)*p->pos++);
+        }
+        name[len] = '\0';
+
+        if(len == 3 && name[0] == 'c' && name[1] == 'h' && '1' <= name[2] && name[2] <= '0' + MC_MAX_SOURCES){
+            mcOp_t *op = mcEmit(p, MC_OP_SRC);
+            if(op) op->src = (uint8_t)(name[2] - '1');
+            p->mc->srcMask |= (uint8_t)(1U << (name[2] - '1'));
+            mcPush(p);
+            mcNode_t n = {0, 0.0f};
+            return n;
+        }
+
+        mcOpcode_t code;
+        if     (strcmp(name, "integ") == 0) code = MC_OP_INTEG;
+        else if(strcmp(name, "diff")  == 0) code = MC_OP_DIFF;
+        else if(strcmp(name, "fir")   == 0) code = MC_OP_FIR;
+        else if(strcmp(name, "iir")   == 0) code = MC_OP_IIR;
+        else {
+            mcParseError(p, "unknown identifier");
+            return mcConst(0.0f);
+        }
+        if(!mcAccept(p, '(')){
+            mcParseError(p, "expected '('");
+            return mcConst(0.0f);
+        }
+        mcNode_t x = mcParseExpr(p);
+        mcMaterialize(p, &x);
+
+        float   args[MC_MAX_TAPS];
+        uint8_t nArgs = mcParseArgs(p, args, MC_MAX_TAPS);
+        if(p->status != STATUS_OK) return x;
+
+        if((code == MC_OP_INTEG || code == MC_OP_DIFF) && nArgs != 0){
+            mcParseError(p, "integ()/diff() take one argument");
+        }else if(code == MC_OP_FIR && nArgs == 0){
+            mcParseError(p, "fir() needs at least one tap");
+        }else if(code == MC_OP_IIR && nArgs != 5){
+            mcParseError(p, "iir() needs b0, b1, b2, a1, a2");
+        }
+        mcOp_t *op = mcEmit(p, code);
+        if(op){
+            op->nTaps = nArgs;
+            memcpy(op->coef, args, nArgs * sizeof(float));
+        }
+        return x;
+    }
+
+    mcParseError(p, "unexpected character");
+    return mcConst(0.0f);
+}
+
+static mcNode_t mcParseUnary(mcParser_t *p){
+    if(mcAccept(p, '-')){
+        mcNode_t n = mcParseUnary(p);
+        if(n.isConst) return mcConst(-n.value);
+        mcEmitAffine(p, -1.0f, 0.0f);
+        return n;
+    }
+    mcAccept(p, '+');
+    return mcParsePrimary(p);
+}
+
+static mcNode_t mcParseTerm(mcParser_t *p){
+    mcNode_t a = mcParseUnary(p);
+    while(p->status == STATUS_OK){
+        mcSkipSpace(p);
+        char opc = *p->pos;
+        if(opc != '*' && opc != '/') break;
+        ++p->pos;
+        a = mcCombine(p, opc, a, mcParseUnary(p));
+    }
+    return a;
+}
+
+static mcNode_t mcParseExpr(mcParser_t *p){
+    mcNode_t a = mcParseTerm(p);
+    while(p->status == STATUS_OK){
+        mcSkipSpace(p);
+        char opc = *p->pos;
+        if(opc != '+' && opc != '-') break;
+        ++p->pos;
+        a = mcCombine(p, opc, a, mcParseTerm(p));
+    }
+    return a;
+}
+
+/// KERNELS ///////////////////////////////////////////////////////////////////////////////////////
+
+#if defined(__SSE__)
+#define MC_BINARY_KERNEL(name, op, mmop)                                                    \
+static void name(float *d, const float *a, const float *b, uint32_t n){                     \
+    uint32_t i = 0;                                                                         \
+    for(; i + 4 <= n; i += 4)                                                               \
+        _mm_storeu_ps(d + i, mmop(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));               \
+    for(; i < n; ++i) d[i] = a[i] op b[i];                                                  \
+}
+#else
+#define MC_BINARY_KERNEL(name, op, mmop)                                                    \
+static void name(float *d, const float *a, const float *b, uint32_t n){                     \
+    for(uint32_t i = 0; i < n; ++i) d[i] = a[i] op b[i];                                    \
+}
+#endif
+
+MC_BINARY_KERNEL(mcKernelAdd, +, _mm_add_ps)
+MC_BINARY_KERNEL(mcKernelSub, -, _mm_sub_ps)
+MC_BINARY_KERNEL(mcKernelMul, *, _mm_mul_ps)
+MC_BINARY_KERNEL(mcKernelDiv, /, _mm_div_ps)
+
+static void mcKernelAffine(float *d, const float *a, float k, float c, uint32_t n){
+    uint32_t i = 0;
+#if defined(__SSE__)
+    __m128 vk = _mm_set1_ps(k), vc = _mm_set1_ps(c);
+    for(; i + 4 <= n; i += 4)
+        _mm_storeu_ps(d + i, _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(a + i), vk), vc));
+#endif
+    for(; i < n; ++i) d[i] = a[i] * k + c;
+}
+
+static void mcKernelFill(float *d, float v, uint32_t n){
+    for(uint32_t i = 0; i < n; ++i) d[i] = v;
+}
+
+static void mcKernelRecip(float *d, const float *a, uint32_t n){
+    uint32_t i = 0;
+#if defined(__SSE__)
+    __m128 one = _mm_set1_ps(1.0f);
+    for(; i + 4 <= n; i += 4)
+        _mm_storeu_ps(d + i, _mm_div_ps(one, _mm_loadu_ps(a + i)));
+#endif
+    for(; i < n; ++i) d[i] = 1.0f / a[i];
+}
+
+/// state[0] = integral, state[1] = previous input, state[2] = primed
+static void mcKernelInteg(mcOp_t *op, float *d, const float *a, float dt, uint32_t n){
+    float acc = op->state[0], prev = op->state[1];
+    uint32_t i = 0;
+    if(op->state[2] == 0.0f && n > 0){
+        prev = a[0];
+        d[i++] = acc;
+        op->state[2] = 1.0f;
+    }
+    const float h = 0.5f * dt;
+    for(; i < n; ++i){
+        float x = a[i];
+        acc += h * (x + prev);
+        prev = x;
+        d[i] = acc;
+    }
+    op->state[0] = acc;
+    op->state[1] = prev;
+}
+
+/// state[0] = previous input, state[1] = primed
+static void mcKernelDiff(mcOp_t *op, float *d, const float *a, float dt, uint32_t n){
+    float prev = op->state[0];
+    if(op->state[1] == 0.0f && n > 0){
+        prev = a[0];
+        op->state[1] = 1.0f;
+    }
+    const float inv = 1.0f / dt;
+    for(uint32_t i = 0; i < n; ++i){
+        float x = a[i];
+        d[i] = (x - prev) * inv;
+        prev = x;
+    }
+    op->state[0] = prev;
+}
+
+/// state[] holds the last nTaps-1 inputs; work = [history | block] so every output is a plain dot product
+static void mcKernelFir(mcOp_t *op, float *work, float *d, const float *a, uint32_t n){
+    const uint32_t T = op->nTaps, H = T - 1;
+    const float *h = op->coef;
+    memcpy(work, op->state, H * sizeof(float));
+    memcpy(work + H, a, n * sizeof(float));
+
+    uint32_t i = 0;
+#if defined(__SSE__)
+    for(; i + 4 <= n; i += 4){
+        __m128 acc = _mm_setzero_ps();
+        for(uint32_t k = 0; k < T; ++k)
+            acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(h[k]), _mm_loadu_ps(work + i + H - k)));
+        _mm_storeu_ps(d + i, acc);
+    }
+#endif
+    for(; i < n; ++i){
+        float acc = 0.0f;
+        for(uint32_t k = 0; k < T; ++k) acc += h[k] * work[i + H - k];
+        d[i] = acc;
+    }
+    memcpy(op->state, work + n, H * sizeof(float));
+}
+
+/// coef = b0 b1 b2 a1 a2, state[0..1] = z1 z2
+static void mcKernelIir(mcOp_t *op, float *d, const float *a, uint32_t n){
+    const float b0 = op->coef[0], b1 = op->coef[1], b2 = op->coef[2];
+    const float a1 = op->coef[3], a2 = op->coef[4];
+    float z1 = op->state[0], z2 = op->state[1];
+    for(uint32_t i = 0; i < n; ++i){
+        float x = a[i];
+        float y = b0 * x + z1;
+        z1 = b1 * x - a1 * y + z2;
+        z2 = b2 * x - a2 * y;
+        d[i] = y;
+    }
+    op->state[0] = z1;
+    op->state[1] = z2;
+}
+
+/// API ///////////////////////////////////////////////////////////////////////////////////////////
+
+status_t createMathChannel(mathChannel_t **mc, const char *expr, float dt){
+    __entry("createMathChannel(%p, %s, %g)", mc, expr, dt);
+    if(__is_null(mc) || __is_null(expr) || !(dt > 0.0f) || strlen(expr) >= MC_MAX_EXPR_SIZE){
+        __err("[createMathChannel] Invalid params!");
+        return ERROR_INVALID_PARAMS;
+    }
+
+    *mc = (mathChannel_t *) mpAlloc(sizeof(mathChannel_t));
+    if(__is_null(*mc)){
+        __err("[createMathChannel] malloc failed!");
+        return ERROR_UNKNOWN;
+    }
+    memset(*mc, 0, sizeof(mathChannel_t));
+    strcpy((*mc)->expr, expr);
+    (*mc)->dt = dt;
+
+    mcParser_t p = {*mc, (*mc)->expr, 0, STATUS_OK};
+    mcNode_t root = mcParseExpr(&p);
+    mcMaterialize(&p, &root);
+    mcSkipSpace(&p);
+    if(p.status == STATUS_OK && *p.pos != '\0'){
+        mcParseError(&p, "trailing characters");
+    }
+    if(p.status != STATUS_OK){
+        mpFree(*mc);
+        *mc = NULL;
+        __exit("createMathChannel() failed");
+        return p.status;
+    }
+
+    __log("[createMathChannel] \"%s\" -> %d ops, depth %d", expr, (*mc)->nOps, (*mc)->maxDepth);
+    __exit("createMathChannel()");
+    return STATUS_OK;
+}
+
+void destroyMathChannel(mathChannel_t **mc){
+    if(__is_null(mc) || __is_null(*mc)) return;
+    mpFree(*mc);
+    *mc = NULL;
+}
+
+void mcReset(mathChannel_t *mc){
+    if(__is_null(mc)) return;
+    REPTT(uint8_t, i, 0, mc->nOps){
+        memset(mc->ops[i].state, 0, sizeof(mc->ops[i].state));
+    }
+}
+
+status_t mcEvaluate(mathChannel_t *mc, const float * const *src, uint8_t nSrc, float *out, uint32_t n){
+    if(__is_null(mc) || __is_null(out)){
+        __err("[mcEvaluate] mc = %p, out = %p", mc, out);
+        return ERROR_INVALID_PARAMS;
+    }
+    REPTT(uint8_t, s, 0, MC_MAX_SOURCES){
+        if((mc->srcMask & (1U << s)) && (s >= nSrc || __is_null(src) || __is_null(src[s]))){
+            __err("[mcEvaluate] CH%d is referenced but not provided", s + 1);
+            return ERROR_INVALID_PARAMS;
+        }
+    }
+
+    const float *reg[MC_MAX_STACK];
+    for(uint32_t o = 0; o < n; o += MC_BLOCK_SIZE){
+        const uint32_t m = __min(n - o, (uint32_t)MC_BLOCK_SIZE);
+        uint8_t d = 0;
+        REPTT(uint8_t, i, 0, mc->nOps){
+            mcOp_t *op  = &mc->ops[i];
+            /// The last op writes straight into the output, no final copy
+            const uint8_t top = (op->code == MC_OP_SRC || op->code == MC_OP_CONST) ? d : d - 1;
+            const uint8_t dst = (op->code >= MC_OP_ADD && op->code <= MC_OP_DIV) ? top - 1 : top;
+            float *w = (i + 1 == mc->nOps) ? out + o : mc->scratch[dst];
+            switch(op->code){
+                case MC_OP_SRC:
+                    reg[d++] = src[op->src] + o;
+                    continue;
+                case MC_OP_CONST:
+                    mcKernelFill(w, op->k, m);
+                    ++d;
+                    break;
+                case MC_OP_ADD: mcKernelAdd(w, reg[dst], reg[top], m); --d; break;
+                case MC_OP_SUB: mcKernelSub(w, reg[dst], reg[top], m); --d; break;
+                case MC_OP_MUL: mcKernelMul(w, reg[dst], reg[top], m); --d; break;
+                case MC_OP_DIV: mcKernelDiv(w, reg[dst], reg[top], m); --d; break;
+                case MC_OP_RECIP:  mcKernelRecip(w, reg[top], m); break;
+                case MC_OP_AFFINE: mcKernelAffine(w, reg[top], op->k, op->c, m); break;
+                case MC_OP_INTEG:  mcKernelInteg(op, w, reg[top], mc->dt, m); break;
+                case MC_OP_DIFF:   mcKernelDiff(op, w, reg[top], mc->dt, m); break;
+                case MC_OP_FIR:    mcKernelFir(op, mc->firWork, w, reg[top], m); break;
+                case MC_OP_IIR:    mcKernelIir(op, w, reg[top], m); break;
+            }
+            reg[dst] = w;
+        }
+        /// Expression was a bare source, e.g. "CH1"
+        if(reg[0] != out + o) memcpy(out + o, reg[0], m * sizeof(float));
+    }
+    return STATUS_OK;
+}
@@ -0,0 +1,113 @@
+#ifndef __MATH_CHANNEL_H__
+#define __MATH_CHANNEL_H__
+
+#ifdef LOG_HEADER_INCLUDE
+#pragma message("INCLUDE: mathChannel.h")
+#endif
+
+#include <stdint.h>
+
+#include "../windowContext/windowContext.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MC_BLOCK_SIZE       256                 /// Samples processed per kernel pass (fits in L1)
+#define MC_MAX_SOURCES      8                   /// CH1 ... CH8
+#define MC_MAX_OPS          64                  /// Max compiled ops per expression
+#define MC_MAX_STACK        8                   /// Max expression depth (scratch blocks)
+#define MC_MAX_TAPS         64                  /// Max FIR taps
+#define MC_MAX_EXPR_SIZE    256
+
+typedef enum mcOpcode_t {
+    MC_OP_SRC = 0,          /// push source channel (zero-copy, points into the source)
+    MC_OP_CONST,            /// push constant (only kept when it cannot be folded)
+    MC_OP_ADD,
+    MC_OP_SUB,
+    MC_OP_MUL,
+    MC_OP_DIV,
+    MC_OP_RECIP,            /// top = 1 / top (lets const / x fold without a const block)
+    MC_OP_AFFINE,           /// top = top * k + c (fused scale / offset / negate)
+    MC_OP_INTEG,            /// running integral, trapezoidal, scaled by dt
+    MC_OP_DIFF,             /// first difference divided by dt
+    MC_OP_FIR,              /// direct-form FIR, history kept across blocks
+    MC_OP_IIR,              /// biquad, transposed direct form II
+} mcOpcode_t;
+
+typedef struct mcOp_t {
+    mcOpcode_t      code;
+    uint8_t         src;                        /// MC_OP_SRC: source index
+    uint8_t         nTaps;                      /// MC_OP_FIR: number of taps
+    float           k;                          /// MC_OP_CONST value / MC_OP_AFFINE gain
+    float           c;                          /// MC_OP_AFFINE offset
+    float           coef[MC_MAX_TAPS];          /// FIR taps or biquad b0 b1 b2 a1 a2
+    float           state[MC_MAX_TAPS];         /// integrator / last sample / FIR history / biquad z1 z2
+} mcOp_t;
+
+/**
+ * @brief Compiled math channel.
+ *
+ * The expression is parsed once into a short op list. Evaluation walks the
+ * list once per MC_BLOCK_SIZE samples, so the only intermediates are the
+ * MC_MAX_STACK scratch blocks below, never full-length arrays.
+ */
+typedef struct mathChannel_t {
+    char            expr[MC_MAX_EXPR_SIZE];
+    float           dt;                         /// Sample interval, used by integ() and diff()
+    uint8_t         nOps;
+    uint8_t         maxDepth;
+    uint8_t         srcMask;                    /// Bit i set if CH(i+1) is referenced
+    mcOp_t          ops[MC_MAX_OPS];
+    float           scratch[MC_MAX_STACK][MC_BLOCK_SIZE] __attribute__((aligned(16)));
+    float           firWork[MC_MAX_TAPS + MC_BLOCK_SIZE] __attribute__((aligned(16)));
+} mathChannel_t;
+
+/**
+ * @brief Parse and compile an expression into a math channel.
+ *
+ * Grammar: operators + - * / and unary -, parentheses, numbers, sources
+ * CH1...CH8, and the functions integ(x), diff(x), fir(x, c0, c1, ...),
+ * iir(x, b0, b1, b2, a1, a2). Constant sub-expressions are folded and
+ * scale/offset chains are fused into a single affine pass.
+ *
+ * @param[out] mc    Pointer to a math channel pointer. Will be allocated inside.
+ * @param[in]  expr  Expression string, e.g. "(CH1-CH2)*0.5".
+ * @param[in]  dt    Sample interval in seconds (must be > 0).
+ *
+ * @return STATUS_OK on success, ERROR_INVALID_PARAMS on a parse error.
+ */
+status_t createMathChannel(mathChannel_t **mc, const char *expr, float dt);
+
+/**
+ * @brief Destroy a math channel and set the pointer to NULL.
+ */
+void destroyMathChannel(mathChannel_t **mc);
+
+/**
+ * @brief Clear integrator, differentiator and filter state.
+ */
+void mcReset(mathChannel_t *mc);
+
+/**
+ * @brief Evaluate the next n samples of the math channel.
+ *
+ * State is carried across calls, so a record can be pushed through in any
+ * block sizes as it arrives. The output has the same shape as a real channel
+ * and can be handed to the same consumers.
+ *
+ * @param[in,out] mc   Compiled math channel.
+ * @param[in]     src  Source channel pointers, src[0] is CH1.
+ * @param[in]     nSrc Number of entries in src.
+ * @param[out]    out  Destination, n samples.
+ * @param[in]     n    Number of samples.
+ *
+ * @return STATUS_OK, or ERROR_INVALID_PARAMS if a referenced source is missing.
+ */
+status_t mcEvaluate(mathChannel_t *mc, const float * const *src, uint8_t nSrc, float *out, uint32_t n);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,323 @@
+#include "memPool.h"
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#include "../../include/global.h"
+
+#define MP_HEADER           16                  /// Size prefix kept in front of every mpAlloc() block
+#define mpRound(n, a)       (((n) + (a) - 1) & ~((size_t)(a) - 1))
+
+static mpStats_t        mpStats;
+static __thread mpArena_t *mpTls;
+static pthread_key_t    mpTlsKey;
+static pthread_once_t   mpTlsOnce = PTHREAD_ONCE_INIT;
+
+#define mpCount(field, v)   __atomic_fetch_add(&mpStats.field, (uint64_t)(v), __ATOMIC_RELAXED)
+
+static void mpRaise(uint64_t *field, uint64_t v){
+    uint64_t cur = __atomic_load_n(field, __ATOMIC_RELAXED);
+    while(v > cur && !__atomic_compare_exchange_n(field, &cur, v, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+}
+
+/// HEAP //////////////////////////////////////////////////////////////////////////////////////////
+
+void *mpAlloc(size_t size){
+    uint8_t *p = (uint8_t *) malloc(MP_HEADER + size);
+    if(__is_null(p)) return NULL;
+    *(size_t *)p = size;
+    mpCount(heapAllocs, 1);
+    mpRaise(&mpStats.heapPeak, mpCount(heapBytes, size) + size);
+    return p + MP_HEADER;
+}
+
+void *mpCalloc(size_t n, size_t size){
+    if(size != 0 && n > SIZE_MAX / size) return NULL;
+    void *p = mpAlloc(n * size);
+    if(__is_not_null(p)) memset(p, 0, n * size);
+    return p;
+}
+
+void mpFree(void *p){
+    if(__is_null(p)) return;
+    uint8_t *h = (uint8_t *)p - MP_HEADER;
+    mpCount(heapFrees, 1);
+    __atomic_fetch_sub(&mpStats.heapBytes, (uint64_t)*(size_t *)h, __ATOMIC_RELAXED);
+    free(h);
+}
+
+void mpGetStats(mpStats_t *stats){
+    if(__is_null(stats)) return;
+    const uint64_t *src = (const uint64_t *)&mpStats;
+    uint64_t       *dst = (uint64_t *)stats;
+    REPTT(size_t, i, 0, sizeof(mpStats_t) / sizeof(uint64_t)) dst[i] = __atomic_load_n(&src[i], __ATOMIC_RELAXED);
+}
+
+void mpLogStats(void){
+    mpStats_t s;
+    mpGetStats(&s);
+    __log("[mpStats] heap: %llu allocs, %llu frees, %llu B live, %llu B peak",
+        (unsigned long long)s.heapAllocs, (unsigned long long)s.heapFrees,
+        (unsigned long long)s.heapBytes, (unsigned long long)s.heapPeak);
+    __log("[mpStats] arena: %llu allocs, %llu overflows, %llu B high water",
+        (unsigned long long)s.arenaAllocs, (unsigned long long)s.arenaOverflows,
+        (unsigned long long)s.arenaHighWater);
+    __log("[mpStats] pool: %llu gets, %llu puts, %llu misses, %llu bad puts",
+        (unsigned long long)s.poolGets, (unsigned long long)s.poolPuts, (unsigned long long)s.poolMisses,
+        (unsigned long long)s.poolBadPuts);
+    __log("[mpStats] large: %llu B live, %llu B on huge pages",
+        (unsigned long long)s.largeBytes, (unsigned long long)s.largeHugeBytes);
+}
+
+/// ARENA /////////////////////////////////////////////////////////////////////////////////////////
+
+status_t createArena(mpArena_t **a, size_t size){
+    __entry("createArena(%p, %zu)", a, size);
+    if(__is_null(a) || size == 0){
+        __err("[createArena] Invalid params!");
+        return ERROR_INVALID_PARAMS;
+    }
+    *a = (mpArena_t *) mpAlloc(sizeof(mpArena_t));
+    if(__is_null(*a)){
+        __err("[createArena] malloc failed!");
+        return ERROR_UNKNOWN;
+    }
+    (*a)->size = mpRound(size, MP_ALIGN);
+    (*a)->used = 0;
+    (*a)->base = (uint8_t *) mpAlloc((*a)->size + MP_ALIGN);
+    if(__is_null((*a)->base)){
+        __err("[createArena] malloc(%zu) failed!", size);
+        mpFree(*a);
+        *a = NULL;
+        return ERROR_UNKNOWN;
+    }
+    __exit("createArena()");
+    return STATUS_OK;
+}
+
+void destroyArena(mpArena_t **a){
+    if(__is_null(a) || __is_null(*a)) return;
+    mpFree((*a)->base);
+    mpFree(*a);
+    *a = NULL;
+}
+
+void *mpArenaAlloc(mpArena_t *a, size_t size){
+    if(__is_null(a)) return NULL;
+    uint8_t *first = (uint8_t *) mpRound((uintptr_t)a->base, MP_ALIGN);
+    size_t   need  = mpRound(size, MP_ALIGN);
+    if(need > a->size - a->used){
+        mpCount(arenaOverflows, 1);
+        __err("[mpArenaAlloc] %zu B requested, %zu B left", size, a->size - a->used);
+        return NULL;
+    }
+    void *p = first + a->used;
+    a->used += need;
+    mpCount(arenaAllocs, 1);
+    mpRaise(&mpStats.arenaHighWater, a->used);
+    return p;
+}
+
+size_t mpArenaMark(const mpArena_t *a){
+    return __is_null(a) ? 0 : a->used;
+}
+
+void mpArenaRelease(mpArena_t *a, size_t mark){
+    if(__is_not_null(a) && mark <= a->used) a->used = mark;
+}
+
+void mpArenaReset(mpArena_t *a){
+    if(__is_not_null(a)) a->used = 0;
+}
+
+static void mpTlsDestroy(void *p){
+    mpArena_t *a = (mpArena_t *)p;
+    destroyArena(&a);
+}
+
+static void mpTlsInit(void){
+    pthread_key_create(&mpTlsKey, mpTlsDestroy);
+}
+
+mpArena_t *mpThreadArena(void){
+    if(__is_not_null(mpTls)) return mpTls;
+    pthread_once(&mpTlsOnce, mpTlsInit);
+    if(createArena(&mpTls, MP_THREAD_ARENA_SIZE) == STATUS_OK){
+        pthread_setspecific(mpTlsKey, mpTls);
+    }
+    return mpTls;
+}
+
+void mpThreadArenaFree(void){
+    if(__is_null(mpTls)) return;
+    pthread_setspecific(mpTlsKey, NULL);
+    destroyArena(&mpTls);
+}
+
+/// LARGE BUFFERS /////////////////////////////////////////////////////////////////////////////////
+
+#define MP_MPOL_PREFERRED   1                   /// From <linux/mempolicy.h>, no libnuma needed
+
+static int mpCurrentNode(void){
+#if defined(SYS_getcpu)
+    unsigned cpu, node;
+    if(syscall(SYS_getcpu, &cpu, &node, NULL) == 0) return (int)node;
+#endif
+    return -1;
+}
+
+static int mpBindNode(void *p, size_t size, int node){
+#if defined(SYS_mbind)
+    if(node < 0 || node >= 64) return -1;
+    unsigned long mask = 1UL << node;
+    if(syscall(SYS_mbind, p, size, MP_MPOL_PREFERRED, &mask, sizeof(mask) * 8, 0) == 0) return node;
+#endif
+    return -1;
+}
+
+const char *mpBackingName(mpBacking_t backing){
+    switch(backing){
+        case MP_BACKING_HUGETLB: return "hugetlb";
+        case MP_BACKING_THP:     return "thp";
+        default:                 return "4k";
+    }
+}
+
+status_t mpLargeAlloc(mpLarge_t *l, size_t size, int node){
+    __entry("mpLargeAlloc(%p, %zu, %d)", l, size, node);
+    if(__is_null(l) || size == 0){
+        __err("[mpLargeAlloc] Invalid params!");
+        return ERROR_INVALID_PARAMS;
+    }
+    memset(l, 0, sizeof(mpLarge_t));
+    /// Below one huge page there is nothing to gain, and rounding up would waste most of it
+    const uint8_t huge = size >= MP_HUGE_PAGE;
+    l->size = mpRound(size, huge ? MP_HUGE_PAGE : 4096);
+    l->node = -1;
+
+    void *p = MAP_FAILED;
+#if defined(MAP_HUGETLB)
+    if(huge) p = mmap(NULL, l->size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    l->backing = MP_BACKING_HUGETLB;
+#endif
+    if(p == MAP_FAILED){
+        p = mmap(NULL, l->size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if(p == MAP_FAILED){
+            __err("[mpLargeAlloc] mmap(%zu) failed: %s", l->size, strerror(errno));
+            return ERROR_UNKNOWN;
+        }
+        l->backing = MP_BACKING_PAGES;
+#if defined(MADV_HUGEPAGE)
+        if(huge && madvise(p, l->size, MADV_HUGEPAGE) == 0) l->backing = MP_BACKING_THP;
+#endif
+    }
+    l->p = p;
+
+    if(node != MP_NODE_ANY) l->node = mpBindNode(p, l->size, node == MP_NODE_LOCAL ? mpCurrentNode() : node);
+
+    /// Prefault: one write per 4 KB page, after the policy is in place
+    for(size_t off = 0; off < l->size; off += 4096) ((volatile uint8_t *)p)[off] = 0;
+
+    mpCount(largeBytes, l->size);
+    if(l->backing != MP_BACKING_PAGES) mpCount(largeHugeBytes, l->size);
+    __log("[mpLargeAlloc] %zu B on %s pages, node %d", l->size, mpBackingName(l->backing), l->node);
+    __exit("mpLargeAlloc()");
+    return STATUS_OK;
+}
+
+void mpLargeFree(mpLarge_t *l){
+    if(__is_null(l) || __is_null(l->p)) return;
+    munmap(l->p, l->size);
+    __atomic_fetch_sub(&mpStats.largeBytes, (uint64_t)l->size, __ATOMIC_RELAXED);
+    if(l->backing != MP_BACKING_PAGES) __atomic_fetch_sub(&mpStats.largeHugeBytes, (uint64_t)l->size, __ATOMIC_RELAXED);
+    memset(l, 0, sizeof(mpLarge_t));
+}
+
+/// POOL //////////////////////////////////////////////////////////////////////////////////////////
+
+status_t createPool(mpPool_t **p, size_t blockSize, uint32_t nBlocks){
+    __entry("createPool(%p, %zu, %u)", p, blockSize, nBlocks);
+    if(__is_null(p) || blockSize == 0 || nBlocks == 0){
+        __err("[createPool] Invalid params!");
+        return ERROR_INVALID_PARAMS;
+    }
+    *p = (mpPool_t *) mpCalloc(1, sizeof(mpPool_t));
+    if(__is_null(*p)){
+        __err("[createPool] malloc failed!");
+        return ERROR_UNKNOWN;
+    }
+    (*p)->blockSize = mpRound(blockSize, MP_ALIGN);
+    (*p)->nBlocks   = nBlocks;
+    (*p)->mem       = (uint8_t *) mpAlloc((*p)->blockSize * nBlocks + MP_ALIGN);
+    (*p)->freeList  = (uint32_t *) mpAlloc(sizeof(uint32_t) * nBlocks);
+    (*p)->taken     = (uint8_t *) mpCalloc(nBlocks, 1);
+    if(__is_null((*p)->mem) || __is_null((*p)->freeList) || __is_null((*p)->taken)){
+        __err("[createPool] malloc(%u x %zu) failed!", nBlocks, (*p)->blockSize);
+        mpFree((*p)->mem);
+        mpFree((*p)->freeList);
+        mpFree((*p)->taken);
+        mpFree(*p);
+        *p = NULL;
+        return ERROR_UNKNOWN;
+    }
+    /// Hand out low blocks first
+    REPTT(uint32_t, i, 0, nBlocks) (*p)->freeList[i] = nBlocks - 1 - i;
+    (*p)->nFree = nBlocks;
+    pthread_mutex_init(&(*p)->lock, NULL);
+    __exit("createPool()");
+    return STATUS_OK;
+}
+
+void destroyPool(mpPool_t **p){
+    if(__is_null(p) || __is_null(*p)) return;
+    pthread_mutex_destroy(&(*p)->lock);
+    mpFree((*p)->mem);
+    mpFree((*p)->freeList);
+    mpFree((*p)->taken);
+    mpFree(*p);
+    *p = NULL;
+}
+
+void *mpPoolGet(mpPool_t *p){
+    if(__is_null(p)) return NULL;
+    uint8_t *first = (uint8_t *) mpRound((uintptr_t)p->mem, MP_ALIGN);
+    void    *block = NULL;
+    pthread_mutex_lock(&p->lock);
+    if(p->nFree > 0){
+        uint32_t i = p->freeList[--p->nFree];
+        p->taken[i] = 1;
+        block = first + (size_t)i * p->blockSize;
+    }
+    pthread_mutex_unlock(&p->lock);
+    if(__is_null(block)){
+        mpCount(poolMisses, 1);
+        return NULL;
+    }
+    mpCount(poolGets, 1);
+    return block;
+}
+
+void mpPoolPut(mpPool_t *p, void *block){
+    if(__is_null(p) || __is_null(block)) return;
+    uint8_t *first = (uint8_t *) mpRound((uintptr_t)p->mem, MP_ALIGN);
+    size_t   off   = (size_t)((uint8_t *)block - first);
+    if((uint8_t *)block < first || off % p->blockSize != 0 || off / p->blockSize >= p->nBlocks){
+        __err("[mpPoolPut] %p is not a block of this pool", block);
+        mpCount(poolBadPuts, 1);
+        return;
+    }
+    const uint32_t i = (uint32_t)(off / p->blockSize);
+    pthread_mutex_lock(&p->lock);
+    uint8_t taken = p->taken[i];
+    if(taken){
+        p->taken[i] = 0;
+        p->freeList[p->nFree++] = i;
+    }
+    pthread_mutex_unlock(&p->lock);
+    if(!taken){
+        __err("[mpPoolPut] block %u put back twice", i);
+        mpCount(poolBadPuts, 1);
+        return;
+    }
+    mpCount(poolPuts, 1);
+}
@@ -0,0 +1,231 @@
+#ifndef __MEM_POOL_H__
+#define __MEM_POOL_H__
+
+#ifdef LOG_HEADER_INCLUDE
+#pragma message("INCLUDE: memPool.h")
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#include "../windowContext/windowContext.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MP_ALIGN                64                  /// Arena and pool blocks start on a cache line
+#define MP_THREAD_ARENA_SIZE    (4U << 20)          /// Per-thread scratch, created on first use
+#define MP_HUGE_PAGE            (2U << 20)
+#define MP_NODE_LOCAL           (-1)                /// NUMA node of the calling thread
+#define MP_NODE_ANY             (-2)                /// No NUMA policy
+
+/**
+ * @brief What a large mapping ended up on.
+ */
+typedef enum mpBacking_t {
+    MP_BACKING_HUGETLB = 0,                     /// Explicit huge pages (MAP_HUGETLB)
+    MP_BACKING_THP,                             /// 4 KB mapping with MADV_HUGEPAGE accepted
+    MP_BACKING_PAGES,                           /// Plain 4 KB pages
+} mpBacking_t;
+
+/**
+ * @brief A large, page-aligned buffer for capture memory.
+ */
+typedef struct mpLarge_t {
+    void *          p;
+    size_t          size;                       /// Mapped bytes (rounded up to a page)
+    mpBacking_t     backing;
+    int             node;                       /// NUMA node it was bound to, -1 if none
+} mpLarge_t;
+
+/**
+ * @brief Allocation counters, shared by every thread.
+ */
+typedef struct mpStats_t {
+    uint64_t        heapAllocs;                 /// mpAlloc()/mpCalloc() calls that succeeded
+    uint64_t        heapFrees;
+    uint64_t        heapBytes;                  /// Live bytes from mpAlloc()
+    uint64_t        heapPeak;
+    uint64_t        arenaAllocs;
+    uint64_t        arenaOverflows;             /// Arena requests that did not fit
+    uint64_t        arenaHighWater;             /// Largest arena fill seen, bytes
+    uint64_t        poolGets;
+    uint64_t        poolPuts;
+    uint64_t        poolMisses;                 /// mpPoolGet() on an empty pool
+    uint64_t        poolBadPuts;                /// mpPoolPut() of a foreign or already free block, ignored
+    uint64_t        largeBytes;                 /// Live bytes from mpLargeAlloc()
+    uint64_t        largeHugeBytes;             /// ... of which on explicit or transparent huge pages
+} mpStats_t;
+
+/**
+ * @brief Bump allocator for scratch with a frame or call lifetime.
+ *
+ * Allocation is a pointer bump; everything is released at once with
+ * mpArenaReset() or back to a mark with mpArenaRelease().
+ */
+typedef struct mpArena_t {
+    uint8_t *       base;
+    size_t          size;
+    size_t          used;
+} mpArena_t;
+
+/**
+ * @brief Pool of fixed-size blocks carved from one allocation.
+ */
+typedef struct mpPool_t {
+    uint8_t *       mem;
+    size_t          blockSize;                  /// Rounded up to MP_ALIGN
+    uint32_t        nBlocks;
+    uint32_t *      freeList;                   /// Stack of free block indices
+    uint32_t        nFree;
+    uint8_t *       taken;                      /// Per block: 1 while handed out, catches double puts
+    pthread_mutex_t lock;
+} mpPool_t;
+
+/// HEAP //////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief Counted malloc for long-lived objects. Release with mpFree() only.
+ *
+ * Blocks are only 16-byte aligned (malloc's alignment behind a 16-byte size
+ * header), enough for SSE but not for a cache line or AVX: use the arena, a
+ * pool or mpLargeAlloc() for MP_ALIGN or page alignment.
+ */
+void *mpAlloc(size_t size);
+
+/**
+ * @brief Counted, zeroed allocation of n * size bytes. Release with mpFree() only.
+ */
+void *mpCalloc(size_t n, size_t size);
+
+/**
+ * @brief Release memory from mpAlloc()/mpCalloc(). NULL is ignored.
+ */
+void mpFree(void *p);
+
+/**
+ * @brief Snapshot of the allocation counters.
+ */
+void mpGetStats(mpStats_t *stats);
+
+/**
+ * @brief Print the allocation counters with __log.
+ */
+void mpLogStats(void);
+
+/// ARENA /////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief Create an arena.
+ *
+ * @param[out] a     Pointer to an arena pointer. Will be allocated inside.
+ * @param[in]  size  Capacity in bytes.
+ *
+ * @return STATUS_OK on success, ERROR_INVALID_PARAMS or ERROR_UNKNOWN on failure.
+ */
+status_t createArena(mpArena_t **a, size_t size);
+
+/**
+ * @brief Destroy an arena and set the pointer to NULL.
+ */
+void destroyArena(mpArena_t **a);
+
+/**
+ * @brief Take size bytes, MP_ALIGN aligned.
+ *
+ * @return NULL when the arena is full (counted as an overflow).
+ */
+void *mpArenaAlloc(mpArena_t *a, size_t size);
+
+/**
+ * @brief Current fill, to hand back to mpArenaRelease().
+ */
+size_t mpArenaMark(const mpArena_t *a);
+
+/**
+ * @brief Drop everything allocated after the mark.
+ */
+void mpArenaRelease(mpArena_t *a, size_t mark);
+
+/**
+ * @brief Drop everything. Called once per frame by the thread that owns the arena.
+ */
+void mpArenaReset(mpArena_t *a);
+
+/**
+ * @brief The calling thread's scratch arena, created on first use.
+ *
+ * Library code takes a mark on entry and releases it on return, so the
+ * arena never needs to know who else is using it.
+ */
+mpArena_t *mpThreadArena(void);
+
+/**
+ * @brief Free the calling thread's arena now (threads that exit free theirs automatically).
+ */
+void mpThreadArenaFree(void);
+
+/// LARGE BUFFERS /////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief Map a large buffer on huge pages, bound to a NUMA node and prefaulted.
+ *
+ * Tries MAP_HUGETLB first, then a regular mapping with MADV_HUGEPAGE, then
+ * plain pages; buffers under MP_HUGE_PAGE go straight to plain pages. The
+ * memory policy is set before the first touch, so every page is faulted in
+ * on the requested node up front instead of during the first decimation sweep.
+ *
+ * @param[out] l     Filled with the mapping and the backing it got.
+ * @param[in]  size  Bytes.
+ * @param[in]  node  NUMA node, MP_NODE_LOCAL or MP_NODE_ANY.
+ *
+ * @return STATUS_OK on success, ERROR_INVALID_PARAMS or ERROR_UNKNOWN on failure.
+ */
+status_t mpLargeAlloc(mpLarge_t *l, size_t size, int node);
+
+/**
+ * @brief Unmap a buffer from mpLargeAlloc() and clear it.
+ */
+void mpLargeFree(mpLarge_t *l);
+
+/**
+ * @brief Printable name of a backing.
+ */
+const char *mpBackingName(mpBacking_t backing);
+
+/// POOL //////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief Create a pool of nBlocks blocks of blockSize bytes.
+ *
+ * @return STATUS_OK on success, ERROR_INVALID_PARAMS or ERROR_UNKNOWN on failure.
+ */
+status_t createPool(mpPool_t **p, size_t blockSize, uint32_t nBlocks);
+
+/**
+ * @brief Destroy a pool and set the pointer to NULL. Outstanding blocks become invalid.
+ */
+void destroyPool(mpPool_t **p);
+
+/**
+ * @brief Take a block, thread-safe.
+ *
+ * @return NULL when every block is in use (counted as a miss).
+ */
+void *mpPoolGet(mpPool_t *p);
+
+/**
+ * @brief Return a block taken from the same pool, thread-safe.
+ *
+ * A block that is not from this pool, or that is already free, is logged,
+ * counted in poolBadPuts and otherwise ignored, so it cannot be handed out twice.
+ */
+void mpPoolPut(mpPool_t *p, void *block);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,110 @@
+#include "pixelFormat.h"
+
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "../../include/global.h"
+
+const pfLayout_t pfColorLayout = { COLOR_R_SHIFT, COLOR_G_SHIFT, COLOR_B_SHIFT, COLOR_A_SHIFT };
+
+typedef struct pfFormat_t {
+    Uint32          format;
+    pfLayout_t      layout;
+} pfFormat_t;
+
+static const pfFormat_t pfFormats[] = {
+    { SDL_PIXELFORMAT_RGBA8888, { 24, 16,  8,  0 } },
+    { SDL_PIXELFORMAT_ARGB8888, { 16,  8,  0, 24 } },
+    { SDL_PIXELFORMAT_ABGR8888, {  0,  8, 16, 24 } },
+    { SDL_PIXELFORMAT_BGRA8888, {  8, 16, 24,  0 } },
+    { SDL_PIXELFORMAT_RGB888,   { 16,  8,  0, 24 } },    /// XRGB
+    { SDL_PIXELFORMAT_BGR888,   {  0,  8, 16, 24 } },    /// XBGR
+    { SDL_PIXELFORMAT_RGBX8888, { 24, 16,  8,  0 } },
+    { SDL_PIXELFORMAT_BGRX8888, {  8, 16, 24,  0 } },
+};
+
+#define PF_N_FORMATS        (sizeof(pfFormats) / sizeof(pfFormats[0]))
+
+uint8_t pfLayoutOf(Uint32 format, pfLayout_t *l){
+    REPTT(size_t, i, 0, PF_N_FORMATS){
+        if(pfFormats[i].format != format) continue;
+        if(__is_not_null(l)) *l = pfFormats[i].layout;
+        return 1;
+    }
+    return 0;
+}
+
+Uint32 pfNegotiate(SDL_Renderer *renderer, uint8_t *convert){
+    SDL_RendererInfo info;
+    Uint32           pick = COLOR_SDL_FORMAT;
+    if(__is_not_null(convert)) *convert = 0;
+    if(__is_null(renderer) || SDL_GetRendererInfo(renderer, &info) != 0){
+        __err("[pfNegotiate] SDL_GetRendererInfo failed: %s", SDL_GetError());
+        return pick;
+    }
+    REPTT(Uint32, i, 0, info.num_texture_formats){
+        if(info.texture_formats[i] == COLOR_SDL_FORMAT) return pick;
+    }
+    REPTT(Uint32, i, 0, info.num_texture_formats){
+        if(!pfLayoutOf(info.texture_formats[i], NULL)) continue;
+        pick = info.texture_formats[i];
+        if(__is_not_null(convert)) *convert = 1;
+        break;
+    }
+    __log("[pfNegotiate] %s: textures in format 0x%08X%s", info.name, pick,
+          pick == COLOR_SDL_FORMAT ? ", converted by SDL" : ", converted on upload");
+    return pick;
+}
+
+void pfConvert(const uint32_t *src, uint32_t *dst, size_t n, const pfLayout_t *from, const pfLayout_t *to){
+    if(__is_null(src) || __is_null(dst) || __is_null(from) || __is_null(to)) return;
+    const uint8_t fs[4] = { from->r, from->g, from->b, from->a }, ts[4] = { to->r, to->g, to->b, to->a };
+    size_t i = 0;
+#if defined(__SSSE3__)
+    /// Destination byte to->c / 8 of each pixel takes source byte from->c / 8
+    int8_t m[16];
+    memset(m, -1, sizeof(m));
+    REPTT(int, p, 0, 4){
+        REPTT(int, c, 0, 4) m[4 * p + ts[c] / 8] = (int8_t)(4 * p + fs[c] / 8);
+    }
+    const __m128i shuffle = _mm_loadu_si128((const __m128i *)m);
+    for(; i + 4 <= n; i += 4){
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(src + i)), shuffle));
+    }
+#elif defined(__SSE2__)
+    /// Each channel: mask it in place, then one shift to its new place
+    __m128i mask[4], left[4], right[4];
+    REPTT(int, c, 0, 4){
+        mask[c]  = _mm_set1_epi32((int)(0xFFU << fs[c]));
+        left[c]  = _mm_cvtsi32_si128(ts[c] > fs[c] ? ts[c] - fs[c] : 0);
+        right[c] = _mm_cvtsi32_si128(fs[c] > ts[c] ? fs[c] - ts[c] : 0);
+    }
+#define pfMove(v, c)        _mm_srl_epi32(_mm_sll_epi32(_mm_and_si128(v, mask[c]), left[c]), right[c])
+    for(; i + 4 <= n; i += 4){
+        __m128i v = _mm_loadu_si128((const __m128i *)(src + i));
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_or_si128(_mm_or_si128(pfMove(v, 0), pfMove(v, 1)),
+                                                             _mm_or_si128(pfMove(v, 2), pfMove(v, 3))));
+    }
+#undef pfMove
+#endif
+    for(; i < n; ++i){
+        uint32_t v = src[i], out = 0;
+        REPTT(int, c, 0, 4) out |= ((v >> fs[c]) & 0xFF) << ts[c];
+        dst[i] = out;
+    }
+}
+
+void pfConvertRect(const uint32_t *src, xy_t srcPitch, uint32_t *dst, xy_t dstPitch, xy_t w, xy_t h,
+                   const pfLayout_t *from, const pfLayout_t *to){
+    if(__is_null(src) || __is_null(dst) || w <= 0 || h <= 0) return;
+    if(srcPitch == w && dstPitch == w){
+        pfConvert(src, dst, (size_t)w * h, from, to);
+        return;
+    }
+    REPTT(xy_t, y, 0, h){
+        pfConvert(src + (size_t)y * srcPitch, dst + (size_t)y * dstPitch, (size_t)w, from, to);
+    }
+}
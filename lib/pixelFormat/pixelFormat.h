@@ -0,0 +1,82 @@
+#ifndef __PIXEL_FORMAT_H__
+#define __PIXEL_FORMAT_H__
+
+#ifdef LOG_HEADER_INCLUDE
+#pragma message("INCLUDE: pixelFormat.h")
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "../windowContext/windowContext.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// SDL format of color_t, from the compile-time layout in helper.h
+#if defined(COLOR_LAYOUT_ARGB8888)
+#define COLOR_SDL_FORMAT    SDL_PIXELFORMAT_ARGB8888
+#elif defined(COLOR_LAYOUT_ABGR8888)
+#define COLOR_SDL_FORMAT    SDL_PIXELFORMAT_ABGR8888
+#elif defined(COLOR_LAYOUT_BGRA8888)
+#define COLOR_SDL_FORMAT    SDL_PIXELFORMAT_BGRA8888
+#else
+#define COLOR_SDL_FORMAT    SDL_PIXELFORMAT_RGBA8888
+#endif
+
+/**
+ * @brief Bit position of each channel in a 32-bit pixel; padding (X) formats put alpha on the pad byte.
+ */
+typedef struct pfLayout_t {
+    uint8_t         r;
+    uint8_t         g;
+    uint8_t         b;
+    uint8_t         a;
+} pfLayout_t;
+
+/**
+ * @brief The layout of color_t.
+ */
+extern const pfLayout_t pfColorLayout;
+
+/**
+ * @brief Layout of a 32-bit, 8 bits per channel SDL format.
+ *
+ * @return 1 if format is one, 0 otherwise (l untouched).
+ */
+uint8_t pfLayoutOf(Uint32 format, pfLayout_t *l);
+
+/**
+ * @brief Choose the texture format for color_t pixels on a renderer.
+ *
+ * COLOR_SDL_FORMAT if the renderer lists it (no conversion anywhere), else
+ * the first 8888 format it lists, i.e. its preferred one, which the caller
+ * converts to with pfConvert(); COLOR_SDL_FORMAT again if the renderer
+ * lists neither, leaving the conversion to SDL.
+ *
+ * @param[in]  renderer  Renderer.
+ * @param[out] convert   1 if uploads must go through pfConvert().
+ *
+ * @return SDL pixel format.
+ */
+Uint32 pfNegotiate(SDL_Renderer *renderer, uint8_t *convert);
+
+/**
+ * @brief Reorder the channels of n pixels from one layout to another. src == dst is allowed.
+ *
+ * One byte shuffle per four pixels with SSSE3, shifts and masks with SSE2.
+ */
+void pfConvert(const uint32_t *src, uint32_t *dst, size_t n, const pfLayout_t *from, const pfLayout_t *to);
+
+/**
+ * @brief pfConvert() over w x h pixels; pitches in pixels.
+ */
+void pfConvertRect(const uint32_t *src, xy_t srcPitch, uint32_t *dst, xy_t dstPitch, xy_t w, xy_t h,
+                   const pfLayout_t *from, const pfLayout_t *to);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,79 @@
+#include "protoDecode.h"
+
+#include "../../include/global.h"
+
+#define PD_I2C_SCL      0
+#define PD_I2C_SDA      1
+
+typedef struct pdI2cState_t {
+    uint64_t        byteStart;
+    uint16_t        byte;
+    uint8_t         inFrame;
+    uint8_t         bitCount;
+    uint8_t         isAddress;                  /// First byte after a (repeated) START
+} pdI2cState_t;
+
+#define pdI2cState(d)   ((pdI2cState_t *)(d)->state)
+
+static void pdI2cReset(pdDecoder_t *d){
+    d->last[PD_I2C_SCL] = 1;
+    d->last[PD_I2C_SDA] = 1;
+}
+
+/// Walk the edges of both lines in time order: SDA edges with SCL high are START/STOP, SCL rising samples a bit.
+/// Each line's next edge is found once and advanced when consumed. Both lines switching on one sample is a
+/// data change (SDA hold after SCL falls, setup before it rises, seen at sample resolution), never START/STOP:
+/// an SCL rise there samples the new SDA level.
+static void pdI2cFeed(pdDecoder_t *d, const uint64_t * const *lines, uint32_t nBits){
+    pdI2cState_t   *s   = pdI2cState(d);
+    const uint64_t *scl = lines[PD_I2C_SCL];
+    const uint64_t *sda = lines[PD_I2C_SDA];
+    uint64_t        eScl = bsNextEdge(scl, nBits, 0, d->last[PD_I2C_SCL]);
+    uint64_t        eSda = bsNextEdge(sda, nBits, 0, d->last[PD_I2C_SDA]);
+
+    for(;;){
+        const uint64_t e = __min(eScl, eSda);
+        if(e >= nBits) return;
+        const uint64_t at = d->base + e;
+        const uint8_t  onScl = (e == eScl), onSda = (e == eSda);
+        if(onScl) eScl = bsNextEdge(scl, nBits, e + 1, d->last[PD_I2C_SCL]);
+        if(onSda) eSda = bsNextEdge(sda, nBits, e + 1, d->last[PD_I2C_SDA]);
+
+        if(onSda && !onScl){
+            if(!bsGet(scl, e)) continue;            /// Data change while SCL low: normal
+            if(!bsGet(sda, e)){
+                pdEmit(d, at, at + 1, PD_ANN_START, 0, 0);
+                s->inFrame   = 1;
+                s->isAddress = 1;
+            }else{
+                /// The SCL rise that precedes a STOP reads as one stray bit; more than that is a cut byte
+                if(s->inFrame && s->bitCount > 1) pdEmit(d, s->byteStart, at, PD_ANN_ERROR, 0, s->byte);
+                pdEmit(d, at, at + 1, PD_ANN_STOP, 0, 0);
+                s->inFrame = 0;
+            }
+            s->bitCount = 0;
+            s->byte     = 0;
+            continue;
+        }
+
+        if(!s->inFrame || !bsGet(scl, e)) continue;
+        uint8_t b = bsGet(sda, e);
+        if(s->bitCount == 0) s->byteStart = at;
+        if(s->bitCount < 8){
+            s->byte = (uint16_t)((s->byte << 1) | b);
+            s->bitCount++;
+            continue;
+        }
+        /// 9th clock: ACK (SDA low) or NACK
+        uint64_t bitLen = (at - s->byteStart) / 8;
+        pdEmit(d, s->byteStart, at, s->isAddress ? PD_ANN_ADDRESS : PD_ANN_DATA, 0, s->byte);
+        pdEmit(d, at, at + __max(bitLen, 1), b ? PD_ANN_NACK : PD_ANN_ACK, 0, b);
+        s->isAddress = 0;
+        s->bitCount  = 0;
+        s->byte      = 0;
+    }
+}
+
+const pdDecoderOps_t pdI2cOps = {
+    "i2c", 2, 1, NULL, pdI2cReset, pdI2cFeed, NULL,
+};
@@ -0,0 +1,89 @@
+#include "protoDecode.h"
+
+#include "../../include/global.h"
+
+#define PD_SPI_CLK      0
+#define PD_SPI_MOSI     1
+#define PD_SPI_MISO     2
+#define PD_SPI_CS       3                       /// Optional, read only when conf.spi.useCs is set
+
+typedef struct pdSpiState_t {
+    uint64_t        wordStart;
+    uint16_t        mosi;
+    uint16_t        miso;
+    uint8_t         count;
+    uint8_t         csLast;                     /// CS level at the end of the previous block
+    uint8_t         csToggled;                  /// CS moved after the last sampled clock edge
+} pdSpiState_t;
+
+#define pdSpiState(d)   ((pdSpiState_t *)(d)->state)
+
+static status_t pdSpiValidate(const pdConfig_t *conf){
+    const pdSpiConfig_t *c = &conf->spi;
+    return (c->bits >= 1 && c->bits <= 16) ? STATUS_OK : ERROR_INVALID_PARAMS;
+}
+
+static uint8_t pdSpiLines(const pdConfig_t *conf){
+    return conf->spi.useCs ? PD_SPI_CS + 1 : PD_SPI_CS;
+}
+
+static void pdSpiReset(pdDecoder_t *d){
+    d->last[PD_SPI_CLK] = d->conf.spi.cpol;
+    pdSpiState(d)->csLast = 1;
+}
+
+static void pdSpiFeed(pdDecoder_t *d, const uint64_t * const *lines, uint32_t nBits){
+    const pdSpiConfig_t *c = &d->conf.spi;
+    pdSpiState_t        *s = pdSpiState(d);
+    const uint64_t *clk  = lines[PD_SPI_CLK];
+    const uint64_t *mosi = lines[PD_SPI_MOSI];
+    const uint64_t *miso = lines[PD_SPI_MISO];
+    const uint64_t *cs   = c->useCs ? lines[PD_SPI_CS] : NULL;
+    /// Mode 0/3 sample on rising, mode 1/2 on falling
+    const uint8_t   sampleLevel = (c->cpol ^ c->cpha) ? 0 : 1;
+    uint64_t        pos = 0;
+    /// First CS edge after the last sampled clock edge, found once and advanced past each sample
+    uint64_t        csEdge = cs ? bsNextEdge(cs, nBits, 0, s->csLast) : nBits;
+
+    for(;;){
+        uint64_t e = bsNextEdge(clk, nBits, pos, d->last[PD_SPI_CLK]);
+        if(e >= nBits) break;
+        pos = e + 1;
+        if(bsGet(clk, e) != sampleLevel) continue;
+
+        if(cs){
+            /// A CS transition since the last sample starts a new word
+            if(s->csToggled || csEdge <= e) s->count = 0;
+            if(csEdge <= e) csEdge = bsNextEdge(cs, nBits, e + 1, s->csLast);
+            s->csToggled = 0;
+            if(bsGet(cs, e)) continue;              /// Not selected
+        }
+
+        uint8_t bo = bsGet(mosi, e), bi = bsGet(miso, e);
+        if(s->count == 0){
+            s->wordStart = d->base + e;
+            s->mosi = s->miso = 0;
+        }
+        if(c->lsbFirst){
+            s->mosi |= (uint16_t)(bo << s->count);
+            s->miso |= (uint16_t)(bi << s->count);
+        }else{
+            s->mosi = (uint16_t)((s->mosi << 1) | bo);
+            s->miso = (uint16_t)((s->miso << 1) | bi);
+        }
+        if(++s->count == c->bits){
+            pdEmit(d, s->wordStart, d->base + e + 1, PD_ANN_DATA, 0, s->mosi);
+            pdEmit(d, s->wordStart, d->base + e + 1, PD_ANN_DATA, 1, s->miso);
+            s->count = 0;
+        }
+    }
+
+    if(cs){
+        if(csEdge < nBits) s->csToggled = 1;
+        s->csLast = bsGet(cs, nBits - 1);
+    }
+}
+
+const pdDecoderOps_t pdSpiOps = {
+    "spi", 3, 2, pdSpiValidate, pdSpiReset, pdSpiFeed, pdSpiLines,
+};
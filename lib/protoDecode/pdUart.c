@@ -0,0 +1,83 @@
+#include "protoDecode.h"
+
+#include "../../include/global.h"
+
+typedef struct pdUartState_t {
+    uint64_t        frameStart;                 /// Absolute position of the start edge
+    uint16_t        shift;
+    uint8_t         busy;
+    uint8_t         bitIdx;                     /// Next bit to sample, 0 = start bit
+    uint8_t         error;
+} pdUartState_t;
+
+#define pdUartState(d)  ((pdUartState_t *)(d)->state)
+
+static status_t pdUartValidate(const pdConfig_t *conf){
+    const pdUartConfig_t *c = &conf->uart;
+    if(!(c->samplesPerBit >= 2.0f) || c->dataBits < 5 || c->dataBits > 9 || c->parity > 2 || c->stopBits < 1 || c->stopBits > 2){
+        return ERROR_INVALID_PARAMS;
+    }
+    return STATUS_OK;
+}
+
+static void pdUartReset(pdDecoder_t *d){
+    d->last[0] = d->conf.uart.inverted ? 0 : 1;
+}
+
+/// Idle: jump edge to edge. In a frame: read only the bit centres, waiting for the next block when needed
+static void pdUartFeed(pdDecoder_t *d, const uint64_t * const *lines, uint32_t nBits){
+    const pdUartConfig_t *c = &d->conf.uart;
+    pdUartState_t        *s = pdUartState(d);
+    const uint64_t *rx   = lines[0];
+    const uint8_t   inv  = c->inverted ? 1 : 0;
+    const uint8_t   nBitsFrame = 1 + c->dataBits + (c->parity ? 1 : 0) + c->stopBits;
+    uint64_t        pos  = 0;
+
+    for(;;){
+        if(!s->busy){
+            uint64_t e = bsNextEdge(rx, nBits, pos, d->last[0]);
+            if(e >= nBits) return;
+            pos = e + 1;
+            if((bsGet(rx, e) ^ inv) != 0) continue;         /// Edge back to idle
+            s->busy       = 1;
+            s->frameStart = d->base + e;
+            s->bitIdx     = 0;
+            s->shift      = 0;
+            s->error      = 0;
+        }
+
+        while(s->bitIdx < nBitsFrame){
+            uint64_t at = (uint64_t)((double)s->frameStart + (s->bitIdx + 0.5) * c->samplesPerBit);
+            if(at >= d->base + nBits) return;
+            uint8_t b = bsGet(rx, at - d->base) ^ inv;
+            uint8_t i = s->bitIdx++;
+
+            if(i == 0){
+                if(b){                                      /// Glitch, not a start bit
+                    s->busy = 0;
+                    pos = at - d->base;
+                    break;
+                }
+            }else if(i <= c->dataBits){
+                s->shift |= (uint16_t)(b << (i - 1));       /// LSB first
+            }else if(c->parity && i == c->dataBits + 1){
+                uint8_t ones = (uint8_t)(__builtin_popcount(s->shift) + b);
+                if((ones & 1U) != (c->parity == 1 ? 1U : 0U)) s->error = 1;
+            }else if(!b){
+                s->error = 1;                               /// Framing error
+            }
+        }
+        if(!s->busy) continue;
+
+        uint64_t end = (uint64_t)((double)s->frameStart + nBitsFrame * c->samplesPerBit);
+        pdEmit(d, s->frameStart, end, s->error ? PD_ANN_ERROR : PD_ANN_DATA, 0, s->shift);
+        s->busy = 0;
+        /// Resume the edge search from the middle of the last stop bit
+        uint64_t resume = (uint64_t)((double)s->frameStart + (nBitsFrame - 0.5) * c->samplesPerBit);
+        pos = (resume > d->base) ? resume - d->base : 0;
+    }
+}
+
+const pdDecoderOps_t pdUartOps = {
+    "uart", 1, 1, pdUartValidate, pdUartReset, pdUartFeed, NULL,
+};
@@ -0,0 +1,165 @@
+#include "protoDecode.h"
+
+#include "../../include/global.h"
+
+static const pdDecoderOps_t *pdRegistry[] = {
+    &pdUartOps,
+    &pdSpiOps,
+    &pdI2cOps,
+};
+
+/// Bar fill per annotation kind
+static const color_t pdKindColor[] = {
+    __combiRGBA( 40,  90, 160, 255),    /// PD_ANN_DATA
+    __combiRGBA(150,  90,  20, 255),    /// PD_ANN_ADDRESS
+    __combiRGBA( 30, 130,  60, 255),    /// PD_ANN_START
+    __combiRGBA(130,  40,  40, 255),    /// PD_ANN_STOP
+    __combiRGBA( 60, 110,  60, 255),    /// PD_ANN_ACK
+    __combiRGBA(160,  60,  20, 255),    /// PD_ANN_NACK
+    __combiRGBA(200,   0,   0, 255),    /// PD_ANN_ERROR
+};
+
+#define PD_LABEL_COLOR      __combiRGBA(255, 255, 255, 255)
+
+const pdDecoderOps_t *pdFindDecoder(const char *name){
+    if(__is_null(name)) return NULL;
+    REPTT(size_t, i, 0, sizeof(pdRegistry) / sizeof(pdRegistry[0])){
+        if(strcmp(pdRegistry[i]->name, name) == 0) return pdRegistry[i];
+    }
+    return NULL;
+}
+
+status_t createDecoder(pdDecoder_t **d, const pdDecoderOps_t *ops, const pdConfig_t *conf){
+    __entry("createDecoder(%p, %s, %p)", d, ops ? ops->name : "(null)", conf);
+    if(__is_null(d) || __is_null(ops) || __is_null(conf)){
+        __err("[createDecoder] d = %p, ops = %p, conf = %p", d, ops, conf);
+        return ERROR_INVALID_PARAMS;
+    }
+    if(ops->validate && ops->validate(conf) != STATUS_OK){
+        __err("[createDecoder] %s: invalid config", ops->name);
+        return ERROR_INVALID_PARAMS;
+    }
+    *d = (pdDecoder_t *) mpAlloc(sizeof(pdDecoder_t));
+    if(__is_null(*d)){
+        __err("[createDecoder] malloc failed!");
+        return ERROR_UNKNOWN;
+    }
+    memset(*d, 0, sizeof(pdDecoder_t));
+    (*d)->ann = (pdAnnotation_t *) mpAlloc(sizeof(pdAnnotation_t) * PD_MAX_ANNOTATIONS);
+    if(__is_null((*d)->ann)){
+        __err("[createDecoder] malloc failed!");
+        mpFree(*d);
+        *d = NULL;
+        return ERROR_UNKNOWN;
+    }
+    (*d)->ops    = ops;
+    (*d)->conf   = *conf;
+    (*d)->nLines = ops->lines ? ops->lines(conf) : ops->nLines;
+    pdReset(*d, 0, 1);
+    __exit("createDecoder()");
+    return STATUS_OK;
+}
+
+void destroyDecoder(pdDecoder_t **d){
+    if(__is_null(d) || __is_null(*d)) return;
+    mpFree((*d)->ann);
+    mpFree(*d);
+    *d = NULL;
+}
+
+void pdReset(pdDecoder_t *d, uint64_t base, uint8_t idle){
+    if(__is_null(d)) return;
+    d->base     = base;
+    d->annHead  = 0;
+    d->annCount = 0;
+    d->packets  = 0;
+    memset(d->last, idle ? 1 : 0, sizeof(d->last));
+    memset(d->state, 0, sizeof(d->state));
+    if(d->ops->reset) d->ops->reset(d);
+}
+
+void pdFeed(pdDecoder_t *d, const uint64_t * const *lines, uint32_t nBits){
+    if(__is_null(d) || __is_null(lines) || nBits == 0) return;
+    REPTT(uint8_t, l, 0, d->nLines){
+        if(__is_null(lines[l])){
+            __err("[pdFeed] %s: line %d missing", d->ops->name, l);
+            return;
+        }
+    }
+    d->ops->feed(d, lines, nBits);
+    REPTT(uint8_t, l, 0, d->nLines) d->last[l] = bsGet(lines[l], nBits - 1);
+    d->base += nBits;
+}
+
+void pdEmit(pdDecoder_t *d, uint64_t start, uint64_t end, pdAnnKind_t kind, uint8_t row, uint16_t value){
+    uint32_t slot;
+    if(d->annCount < PD_MAX_ANNOTATIONS){
+        slot = (d->annHead + d->annCount++) % PD_MAX_ANNOTATIONS;
+    }else{
+        slot = d->annHead;
+        d->annHead = (d->annHead + 1) % PD_MAX_ANNOTATIONS;
+    }
+    pdAnnotation_t *a = &d->ann[slot];
+    a->start = start;
+    a->end   = end;
+    a->kind  = (uint8_t)kind;
+    a->row   = row;
+    a->value = value;
+    switch(kind){
+        case PD_ANN_DATA:    snprintf(a->text, PD_TEXT_SIZE, "0x%02X", value); break;
+        case PD_ANN_ADDRESS: snprintf(a->text, PD_TEXT_SIZE, "A:0x%02X %c", value >> 1, (value & 1) ? 'R' : 'W'); break;
+        case PD_ANN_START:   snprintf(a->text, PD_TEXT_SIZE, "S"); break;
+        case PD_ANN_STOP:    snprintf(a->text, PD_TEXT_SIZE, "P"); break;
+        case PD_ANN_ACK:     snprintf(a->text, PD_TEXT_SIZE, "A"); break;
+        case PD_ANN_NACK:    snprintf(a->text, PD_TEXT_SIZE, "N"); break;
+        default:             snprintf(a->text, PD_TEXT_SIZE, "ERR"); break;
+    }
+    d->packets++;
+}
+
+const pdAnnotation_t *pdAnnotationAt(const pdDecoder_t *d, uint32_t i){
+    if(__is_null(d) || i >= d->annCount) return NULL;
+    return &d->ann[(d->annHead + i) % PD_MAX_ANNOTATIONS];
+}
+
+status_t pdRender(rsTarget_t *t, const pdDecoder_t *d, const fontAtlas_t *fa, uint64_t viewStart, double samplesPerPx, xy_t y, xy_t rowH){
+    if(__is_null(t) || __is_null(t->px) || __is_null(d) || !(samplesPerPx > 0.0)){
+        __err("[pdRender] t = %p, d = %p", t, d);
+        return ERROR_INVALID_PARAMS;
+    }
+    const double viewEnd = viewStart + samplesPerPx * t->w;
+
+    /// Annotations are emitted in order, so skip everything that ended before the view
+    uint32_t lo = 0, hi = d->annCount;
+    while(lo < hi){
+        uint32_t mid = (lo + hi) / 2;
+        if(pdAnnotationAt(d, mid)->end < viewStart) lo = mid + 1;
+        else hi = mid;
+    }
+
+    /// Zoomed out, many annotations land in one column: draw each column of a row once
+    xy_t drawnTo[PD_MAX_LINES];
+    REPTT(uint8_t, r, 0, PD_MAX_LINES) drawnTo[r] = -1;
+
+    for(uint32_t i = lo; i < d->annCount; ++i){
+        const pdAnnotation_t *a = pdAnnotationAt(d, i);
+        if((double)a->start > viewEnd) break;
+
+        xy_t x0 = (xy_t)(((double)a->start - (double)viewStart) / samplesPerPx);
+        xy_t w  = __max(1, (xy_t)((double)(a->end - a->start) / samplesPerPx));
+        uint8_t row = __min(a->row, PD_MAX_LINES - 1);
+        if(x0 + w - 1 <= drawnTo[row]) continue;
+        drawnTo[row] = x0 + w - 1;
+        xy_t y0 = y + a->row * rowH;
+        xy_t h  = rowH - 1;
+        REPTT(xy_t, r, y0, y0 + h) rsHSpan(t, r, x0, x0 + w - 1, pdKindColor[a->kind]);
+
+        /// Labels from the glyph atlas: no text rendering or texture per annotation
+        if(__is_null(fa)) continue;
+        xy_t tw, th;
+        faTextSize(fa, a->text, &tw, &th);
+        if(tw + 4 > w) continue;
+        faDrawText(fa, t, x0 + (w - tw) / 2, y0 + (h - th) / 2, a->text, PD_LABEL_COLOR);
+    }
+    return STATUS_OK;
+}
@@ -0,0 +1,176 @@
+#ifndef __PROTO_DECODE_H__
+#define __PROTO_DECODE_H__
+
+#ifdef LOG_HEADER_INCLUDE
+#pragma message("INCLUDE: protoDecode.h")
+#endif
+
+#include <stdint.h>
+
+#include "../windowContext/windowContext.h"
+#include "../bitStream/bitStream.h"
+#include "../raster/raster.h"
+#include "../fontAtlas/fontAtlas.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PD_MAX_LINES        4
+#define PD_MAX_ANNOTATIONS  4096                /// Ring, oldest annotations are dropped
+#define PD_TEXT_SIZE        16
+#define PD_STATE_WORDS      16
+
+typedef enum pdAnnKind_t {
+    PD_ANN_DATA = 0,
+    PD_ANN_ADDRESS,
+    PD_ANN_START,
+    PD_ANN_STOP,
+    PD_ANN_ACK,
+    PD_ANN_NACK,
+    PD_ANN_ERROR,
+} pdAnnKind_t;
+
+/**
+ * @brief One decoded item, in absolute sample positions.
+ */
+typedef struct pdAnnotation_t {
+    uint64_t        start;
+    uint64_t        end;
+    uint8_t         kind;                       /// pdAnnKind_t
+    uint8_t         row;                        /// Bar row (e.g. SPI MOSI = 0, MISO = 1)
+    uint16_t        value;
+    char            text[PD_TEXT_SIZE];
+} pdAnnotation_t;
+
+typedef struct pdUartConfig_t {
+    float           samplesPerBit;
+    uint8_t         dataBits;                   /// 5 ... 9
+    uint8_t         parity;                     /// 0 none, 1 odd, 2 even
+    uint8_t         stopBits;                   /// 1 or 2
+    uint8_t         inverted;                   /// Idle low
+} pdUartConfig_t;
+
+typedef struct pdSpiConfig_t {
+    uint8_t         cpol;
+    uint8_t         cpha;
+    uint8_t         bits;                       /// Bits per word, 1 ... 16
+    uint8_t         lsbFirst;
+    uint8_t         useCs;                      /// Line 3 is an active-low chip select
+} pdSpiConfig_t;
+
+typedef struct pdI2cConfig_t {
+    uint8_t         reserved;
+} pdI2cConfig_t;
+
+typedef union pdConfig_t {
+    pdUartConfig_t  uart;                       /// Lines: RX
+    pdSpiConfig_t   spi;                        /// Lines: CLK, MOSI, MISO, CS
+    pdI2cConfig_t   i2c;                        /// Lines: SCL, SDA
+} pdConfig_t;
+
+typedef struct pdDecoder_t pdDecoder_t;
+
+/**
+ * @brief Decoder plugin: an incremental state machine over packed lines.
+ *
+ * feed() receives the next block of every line (same length, consecutive
+ * with the previous block) and must keep whatever it needs in `state`,
+ * since earlier blocks are not shown again. It may read lines 0 ...
+ * lines(conf) - 1, or 0 ... nLines - 1 when lines is NULL; pdFeed() checks
+ * all of them.
+ */
+typedef struct pdDecoderOps_t {
+    const char *    name;
+    uint8_t         nLines;                     /// Lines every configuration reads
+    uint8_t         nRows;
+    status_t        (*validate)(const pdConfig_t *conf);
+    void            (*reset)(pdDecoder_t *d);
+    void            (*feed)(pdDecoder_t *d, const uint64_t * const *lines, uint32_t nBits);
+    uint8_t         (*lines)(const pdConfig_t *conf);   /// Lines read under conf, NULL = nLines
+} pdDecoderOps_t;
+
+struct pdDecoder_t {
+    const pdDecoderOps_t *ops;
+    pdConfig_t      conf;
+    uint8_t         nLines;                     /// Lines this instance reads, see pdDecoderOps_t::lines
+    uint64_t        base;                       /// Absolute position of bit 0 of the current block
+    uint8_t         last[PD_MAX_LINES];         /// Level of each line just before the current block
+    uint64_t        state[PD_STATE_WORDS];      /// Decoder-private state
+    pdAnnotation_t *ann;                        /// Ring of PD_MAX_ANNOTATIONS
+    uint32_t        annHead;                    /// Index of the oldest annotation
+    uint32_t        annCount;
+    uint64_t        packets;                    /// Total annotations emitted
+};
+
+extern const pdDecoderOps_t pdUartOps;
+extern const pdDecoderOps_t pdSpiOps;
+extern const pdDecoderOps_t pdI2cOps;
+
+/**
+ * @brief Look up a decoder plugin by name ("uart", "spi", "i2c").
+ *
+ * @return The plugin, or NULL if unknown.
+ */
+const pdDecoderOps_t *pdFindDecoder(const char *name);
+
+/**
+ * @brief Create a decoder instance.
+ *
+ * @param[out] d     Pointer to a decoder pointer. Will be allocated inside.
+ * @param[in]  ops   Decoder plugin.
+ * @param[in]  conf  Plugin configuration.
+ *
+ * @return STATUS_OK on success, ERROR_INVALID_PARAMS if the configuration is rejected.
+ */
+status_t createDecoder(pdDecoder_t **d, const pdDecoderOps_t *ops, const pdConfig_t *conf);
+
+/**
+ * @brief Destroy a decoder and set the pointer to NULL.
+ */
+void destroyDecoder(pdDecoder_t **d);
+
+/**
+ * @brief Restart decoding at absolute position `base`, all lines at `idle` level.
+ */
+void pdReset(pdDecoder_t *d, uint64_t base, uint8_t idle);
+
+/**
+ * @brief Feed the next block of packed samples (one stream per line).
+ */
+void pdFeed(pdDecoder_t *d, const uint64_t * const *lines, uint32_t nBits);
+
+/**
+ * @brief Append an annotation (used by decoder plugins).
+ */
+void pdEmit(pdDecoder_t *d, uint64_t start, uint64_t end, pdAnnKind_t kind, uint8_t row, uint16_t value);
+
+/**
+ * @brief Get the i-th retained annotation, oldest first.
+ */
+const pdAnnotation_t *pdAnnotationAt(const pdDecoder_t *d, uint32_t i);
+
+/**
+ * @brief Draw the annotation bars of a decoder into a raster target.
+ *
+ * Each row is a bar of `rowH` pixels starting at `y`. Labels are blended
+ * from a glyph atlas and only where they fit inside their box; nothing is
+ * allocated per frame.
+ *
+ * @param[in,out] t             Target.
+ * @param[in]     d             Decoder.
+ * @param[in]     fa            Label glyphs, NULL = bars only.
+ * @param[in]     viewStart     Sample position at the left edge.
+ * @param[in]     samplesPerPx  Horizontal scale.
+ * @param[in]     y             Top of the first bar.
+ * @param[in]     rowH          Bar height.
+ *
+ * @return STATUS_OK, or ERROR_INVALID_PARAMS if t has no pixels.
+ */
+status_t pdRender(rsTarget_t *t, const pdDecoder_t *d, const fontAtlas_t *fa, uint64_t viewStart, double samplesPerPx, xy_t y, xy_t rowH);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
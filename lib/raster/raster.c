@@ -0,0 +1,183 @@
+#include "raster.h"
+
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "../../include/global.h"
+
+void rsClear(rsTarget_t *t, color_t c){
+    if(__is_null(t) || __is_null(t->px)) return;
+    REPTT(xy_t, y, 0, t->h){
+        color_t *row = t->px + (size_t)y * t->pitch;
+        REPTT(xy_t, x, 0, t->w) row[x] = c;
+    }
+}
+
+void rsVSpan(rsTarget_t *t, xy_t x, xy_t y0, xy_t y1, color_t c){
+    if(x < 0 || x >= t->w) return;
+    if(y0 > y1){ xy_t s = y0; y0 = y1; y1 = s; }
+    y0 = __max(y0, 0);
+    y1 = __min(y1, t->h - 1);
+    color_t *p = t->px + (size_t)y0 * t->pitch + x;
+    for(xy_t y = y0; y <= y1; ++y, p += t->pitch) *p = c;
+}
+
+void rsHSpan(rsTarget_t *t, xy_t y, xy_t x0, xy_t x1, color_t c){
+    if(y < 0 || y >= t->h) return;
+    if(x0 > x1){ xy_t s = x0; x0 = x1; x1 = s; }
+    x0 = __max(x0, 0);
+    x1 = __min(x1, t->w - 1);
+    color_t *row = t->px + (size_t)y * t->pitch;
+    for(xy_t x = x0; x <= x1; ++x) row[x] = c;
+}
+
+xy_t rsValueToRow(const rsTarget_t *t, float v, float yMin, float yMax){
+    float r = (yMax - v) / (yMax - yMin) * (float)(t->h - 1);
+    /// Clamp a little outside the screen so off-screen spans still clip correctly
+    if(r < -1.0f) r = -1.0f;
+    if(r > (float)t->h) r = (float)t->h;
+    return (xy_t)lrintf(r);
+}
+
+void rsDrawTrace(rsTarget_t *t, xy_t x0, const float *v, xy_t n, float yMin, float yMax, color_t c){
+    if(__is_null(t) || __is_null(v) || n <= 0) return;
+    xy_t prev = rsValueToRow(t, v[0], yMin, yMax);
+    REPTT(xy_t, i, 0, n){
+        xy_t row = rsValueToRow(t, v[i], yMin, yMax);
+        /// Join halfway towards the previous column on each side
+        rsVSpan(t, x0 + i, row, (row + prev) / 2, c);
+        if(i > 0) rsVSpan(t, x0 + i - 1, prev, (row + prev) / 2, c);
+        prev = row;
+    }
+}
+
+void rsDrawEnvelope(rsTarget_t *t, xy_t x0, const float *vMin, const float *vMax, xy_t n, float yMin, float yMax, color_t c){
+    if(__is_null(t) || __is_null(vMin) || __is_null(vMax)) return;
+    REPTT(xy_t, i, 0, n){
+        if(vMin[i] > vMax[i]) continue;
+        rsVSpan(t, x0 + i, rsValueToRow(t, vMax[i], yMin, yMax), rsValueToRow(t, vMin[i], yMin, yMax), c);
+    }
+}
+
+static void rsMinMax(const float *s, uint64_t n, float *mn, float *mx){
+    uint64_t i = 0;
+    float lo = s[0], hi = s[0];
+#if defined(__SSE__)
+    if(n >= 4){
+        __m128 vlo = _mm_loadu_ps(s), vhi = vlo;
+        for(i = 4; i + 4 <= n; i += 4){
+            __m128 x = _mm_loadu_ps(s + i);
+            vlo = _mm_min_ps(vlo, x);
+            vhi = _mm_max_ps(vhi, x);
+        }
+        float a[4], b[4];
+        _mm_storeu_ps(a, vlo);
+        _mm_storeu_ps(b, vhi);
+        lo = __min(__min(a[0], a[1]), __min(a[2], a[3]));
+        hi = __max(__max(b[0], b[1]), __max(b[2], b[3]));
+    }
+#endif
+    for(; i < n; ++i){
+        lo = __min(lo, s[i]);
+        hi = __max(hi, s[i]);
+    }
+    *mn = lo;
+    *mx = hi;
+}
+
+void rsDecimateMinMax(const float *src, uint64_t n, float *vMin, float *vMax, xy_t cols){
+    if(__is_null(src) || cols <= 0) return;
+    REPTT(xy_t, i, 0, cols){
+        uint64_t a = n * (uint64_t)i / cols;
+        uint64_t b = n * (uint64_t)(i + 1) / cols;
+        if(b <= a) b = a + 1;
+        if(b > n){
+            vMin[i] = vMax[i] = (n > 0) ? src[n - 1] : 0.0f;
+            continue;
+        }
+        rsMinMax(src + a, b - a, &vMin[i], &vMax[i]);
+    }
+}
+
+void rsBlit(rsTarget_t *dst, const rsTarget_t *src){
+    if(__is_null(dst) || __is_null(src) || __is_null(dst->px) || __is_null(src->px)) return;
+    const xy_t w = __min(dst->w, src->w), h = __min(dst->h, src->h);
+    if(w <= 0) return;
+    if(dst->pitch == src->pitch && w == dst->pitch){
+        memcpy(dst->px, src->px, sizeof(color_t) * (size_t)w * h);
+        return;
+    }
+    REPTT(xy_t, y, 0, h){
+        memcpy(dst->px + (size_t)y * dst->pitch, src->px + (size_t)y * src->pitch, sizeof(color_t) * w);
+    }
+}
+
+/// One channel: (s * a + d * (255 - a)) / 255, rounded
+static inline uint32_t rsMix(uint32_t s, uint32_t d, uint32_t a){
+    uint32_t v = s * a + d * (255 - a) + 128;
+    return (v + (v >> 8)) >> 8;
+}
+
+void rsBlendOver(rsTarget_t *dst, xy_t x, xy_t y, const rsTarget_t *src){
+    if(__is_null(dst) || __is_null(src) || __is_null(dst->px) || __is_null(src->px)) return;
+    const xy_t sx0 = __max(0, -x), sy0 = __max(0, -y);
+    const xy_t sx1 = __min(src->w, dst->w - x), sy1 = __min(src->h, dst->h - y);
+    for(xy_t sy = sy0; sy < sy1; ++sy){
+        const uint32_t *s = (const uint32_t *)(src->px + (size_t)sy * src->pitch);
+        uint32_t       *d = (uint32_t *)(dst->px + (size_t)(sy + y) * dst->pitch + x);
+        xy_t sx = sx0;
+#if defined(__SSE2__)
+        /// Four pixels at a time, each 8-bit channel widened to 16 bits
+        const __m128i zero = _mm_setzero_si128(), c255 = _mm_set1_epi16(255), c128 = _mm_set1_epi16(128);
+        const __m128i opaque = _mm_set1_epi32((int)(0xFFU << COLOR_A_SHIFT));
+        for(; sx + 4 <= sx1; sx += 4){
+            __m128i vs = _mm_loadu_si128((const __m128i *)(s + sx));
+            __m128i vd = _mm_loadu_si128((__m128i *)(d + sx));
+            /// Broadcast each pixel's alpha to its four lanes
+            __m128i va = _mm_srli_epi32(_mm_and_si128(vs, opaque), COLOR_A_SHIFT);
+            va = _mm_or_si128(va, _mm_slli_epi32(va, 8));
+            va = _mm_or_si128(va, _mm_slli_epi32(va, 16));
+            __m128i r[2];
+            REPTT(int, half, 0, 2){
+                __m128i s16 = half ? _mm_unpackhi_epi8(vs, zero) : _mm_unpacklo_epi8(vs, zero);
+                __m128i d16 = half ? _mm_unpackhi_epi8(vd, zero) : _mm_unpacklo_epi8(vd, zero);
+                __m128i a16 = half ? _mm_unpackhi_epi8(va, zero) : _mm_unpacklo_epi8(va, zero);
+                __m128i v   = _mm_add_epi16(_mm_mullo_epi16(s16, a16), _mm_mullo_epi16(d16, _mm_sub_epi16(c255, a16)));
+                v    = _mm_add_epi16(v, c128);
+                r[half] = _mm_srli_epi16(_mm_add_epi16(v, _mm_srli_epi16(v, 8)), 8);
+            }
+            _mm_storeu_si128((__m128i *)(d + sx), _mm_or_si128(_mm_packus_epi16(r[0], r[1]), opaque));
+        }
+#endif
+        for(; sx < sx1; ++sx){
+            uint32_t sp = s[sx], dp = d[sx], a = __getAFromRGBA(sp);
+            d[sx] = __combiRGBA(rsMix(__getRFromRGBA(sp), __getRFromRGBA(dp), a), rsMix(__getGFromRGBA(sp), __getGFromRGBA(dp), a),
+                                rsMix(__getBFromRGBA(sp), __getBFromRGBA(dp), a), 0xFF);
+        }
+    }
+}
+
+void rsDrawGrid(rsTarget_t *t, xy_t divX, xy_t divY, color_t c){
+    if(__is_null(t) || __is_null(t->px) || divX <= 0 || divY <= 0 || t->w < 2 || t->h < 2) return;
+    const xy_t cx = (t->w - 1) / 2, cy = (t->h - 1) / 2;
+    REPTT(xy_t, i, 1, divX){
+        xy_t x = (t->w - 1) * i / divX;
+        for(xy_t y = 0; y < t->h; y += 4) t->px[(size_t)y * t->pitch + x] = c;
+    }
+    REPTT(xy_t, j, 1, divY){
+        xy_t y = (t->h - 1) * j / divY;
+        color_t *row = t->px + (size_t)y * t->pitch;
+        for(xy_t x = 0; x < t->w; x += 4) row[x] = c;
+    }
+    /// Five minor ticks per division on the center axes
+    for(xy_t k = 0; k <= divX * 5; ++k) rsVSpan(t, (t->w - 1) * k / (divX * 5), cy - 2, cy + 2, c);
+    for(xy_t k = 0; k <= divY * 5; ++k) rsHSpan(t, (t->h - 1) * k / (divY * 5), cx - 2, cx + 2, c);
+    rsHSpan(t, 0, 0, t->w - 1, c);
+    rsHSpan(t, t->h - 1, 0, t->w - 1, c);
+    rsVSpan(t, 0, 0, t->h - 1, c);
+    rsVSpan(t, t->w - 1, 0, t->h - 1, c);
+}
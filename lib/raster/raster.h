@@ -0,0 +1,100 @@
+#ifndef __RASTER_H__
+#define __RASTER_H__
+
+#ifdef LOG_HEADER_INCLUDE
+#pragma message("INCLUDE: raster.h")
+#endif
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef int32_t             xy_t;
+typedef uint32_t            color_t;
+
+/**
+ * @brief A pixel buffer to draw into (screenBuffer, a locked texture, a layer cache...).
+ *
+ * Row-major, `pitch` is in pixels, row 0 is the top of the screen.
+ */
+typedef struct rsTarget_t {
+    color_t *       px;
+    xy_t            w;
+    xy_t            h;
+    xy_t            pitch;
+} rsTarget_t;
+
+/**
+ * @brief Fill the whole target with one color.
+ */
+void rsClear(rsTarget_t *t, color_t c);
+
+/**
+ * @brief Draw a vertical span [y0, y1] (inclusive, any order, clipped) in column x.
+ */
+void rsVSpan(rsTarget_t *t, xy_t x, xy_t y0, xy_t y1, color_t c);
+
+/**
+ * @brief Draw a horizontal span [x0, x1] (inclusive, any order, clipped) in row y.
+ */
+void rsHSpan(rsTarget_t *t, xy_t y, xy_t x0, xy_t x1, color_t c);
+
+/**
+ * @brief Map a sample value to a row, yMax at the top, yMin at the bottom.
+ */
+xy_t rsValueToRow(const rsTarget_t *t, float v, float yMin, float yMax);
+
+/**
+ * @brief Draw a trace given one value per column.
+ *
+ * Neighbouring columns are joined with vertical spans so steep edges stay
+ * connected. This is the rasterization path for both interpolated
+ * (zoomed in) and plain per-column data.
+ *
+ * @param[in,out] t      Target.
+ * @param[in]     x0     First column.
+ * @param[in]     v      Values, one per column.
+ * @param[in]     n      Number of columns.
+ * @param[in]     yMin   Value at the bottom row.
+ * @param[in]     yMax   Value at the top row.
+ * @param[in]     c      Color.
+ */
+void rsDrawTrace(rsTarget_t *t, xy_t x0, const float *v, xy_t n, float yMin, float yMax, color_t c);
+
+/**
+ * @brief Draw a min/max envelope, one [min, max] pair per column (zoomed out).
+ *
+ * Columns with vMin > vMax hold no data and are skipped.
+ */
+void rsDrawEnvelope(rsTarget_t *t, xy_t x0, const float *vMin, const float *vMax, xy_t n, float yMin, float yMax, color_t c);
+
+/**
+ * @brief Min/max decimation of n samples into `cols` column envelopes.
+ */
+void rsDecimateMinMax(const float *src, uint64_t n, float *vMin, float *vMax, xy_t cols);
+
+/**
+ * @brief Copy src into dst row by row (pitches may differ), clipped to the smaller size.
+ */
+void rsBlit(rsTarget_t *dst, const rsTarget_t *src);
+
+/**
+ * @brief Alpha-blend src over dst with its top-left corner at (x, y), clipped.
+ *
+ * Alpha is the byte at COLOR_A_SHIFT of the compile-time COLOR_LAYOUT_*
+ * (see helper.h); dst alpha is left opaque.
+ */
+void rsBlendOver(rsTarget_t *dst, xy_t x, xy_t y, const rsTarget_t *src);
+
+/**
+ * @brief Graticule: dotted divX x divY grid, solid border, ticks along the center axes.
+ */
+void rsDrawGrid(rsTarget_t *t, xy_t divX, xy_t divY, color_t c);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
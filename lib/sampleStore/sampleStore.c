@@ -0,0 +1,120 @@
+#include "sampleStore.h"
+
+#include "../../include/global.h"
+
+status_t createSampleStore(sampleStore_t **ss, uint32_t size){
+    __entry("createSampleStore(%p, %u)", ss, size);
+    if(__is_null(ss) || size == 0 || size > (1U << 31)){
+        __err("[createSampleStore] Invalid params!");
+        return ERROR_INVALID_PARAMS;
+    }
+
+    uint32_t cap = 1;
+    while(cap < size) cap <<= 1;
+
+    *ss = (sampleStore_t *) mpAlloc(sizeof(sampleStore_t));
+    if(__is_null(*ss)){
+        __err("[createSampleStore] malloc failed!");
+        return ERROR_UNKNOWN;
+    }
+    if(mpLargeAlloc(&(*ss)->mem, sizeof(float) * (size_t)cap, MP_NODE_LOCAL) != STATUS_OK){
+        __err("[createSampleStore] mpLargeAlloc(%u samples) failed!", cap);
+        mpFree(*ss);
+        *ss = NULL;
+        return ERROR_UNKNOWN;
+    }
+    (*ss)->buff    = (float *) (*ss)->mem.p;
+    (*ss)->size    = cap;
+    (*ss)->mask    = cap - 1;
+    (*ss)->written = 0;
+    (*ss)->stampNs = 0;
+
+    __exit("createSampleStore()");
+    return STATUS_OK;
+}
+
+void destroySampleStore(sampleStore_t **ss){
+    if(__is_null(ss) || __is_null(*ss)) return;
+    mpLargeFree(&(*ss)->mem);
+    mpFree(*ss);
+    *ss = NULL;
+}
+
+float *ssReserve(sampleStore_t *ss, uint32_t *n){
+    uint32_t head = (uint32_t)ss->written & ss->mask;
+    *n = ss->size - head;
+    return ss->buff + head;
+}
+
+void ssCommit(sampleStore_t *ss, uint32_t n){
+    __atomic_store_n(&ss->stampNs, ltNow(), __ATOMIC_RELAXED);
+    __atomic_store_n(&ss->written, ss->written + n, __ATOMIC_RELEASE);
+}
+
+void ssWrite(sampleStore_t *ss, const float *src, uint32_t n){
+    if(__is_null(ss) || __is_null(src)) return;
+    /// Only the newest `size` samples can survive anyway
+    if(n > ss->size){
+        ssCommit(ss, n - ss->size);
+        src += n - ss->size;
+        n    = ss->size;
+    }
+    while(n > 0){
+        uint32_t room;
+        float *dst = ssReserve(ss, &room);
+        uint32_t m = __min(room, n);
+        memcpy(dst, src, sizeof(float) * m);
+        ssCommit(ss, m);
+        src += m;
+        n   -= m;
+    }
+}
+
+uint64_t ssWritten(const sampleStore_t *ss){
+    return ss ? __atomic_load_n(&ss->written, __ATOMIC_ACQUIRE) : 0;
+}
+
+uint64_t ssStamp(const sampleStore_t *ss){
+    return ss ? __atomic_load_n(&ss->stampNs, __ATOMIC_RELAXED) : 0;
+}
+
+uint64_t ssOldest(const sampleStore_t *ss){
+    uint64_t w = ssWritten(ss);
+    return (ss && w > ss->size) ? w - ss->size : 0;
+}
+
+uint32_t ssGetSpan(const sampleStore_t *ss, uint64_t start, uint32_t n, ssSpan_t *span){
+    if(__is_null(ss) || __is_null(span)) return 0;
+    span->p[0] = span->p[1] = NULL;
+    span->n[0] = span->n[1] = 0;
+
+    uint64_t w = ssWritten(ss);
+    uint64_t oldest = (w > ss->size) ? w - ss->size : 0;
+    if(start < oldest){
+        uint64_t skip = oldest - start;
+        if(skip >= n) return 0;
+        n    -= (uint32_t)skip;
+        start = oldest;
+    }
+    if(start >= w) return 0;
+    if(start + n > w) n = (uint32_t)(w - start);
+
+    uint32_t head  = (uint32_t)start & ss->mask;
+    uint32_t first = __min(n, ss->size - head);
+    span->p[0] = ss->buff + head;
+    span->n[0] = first;
+    if(first < n){
+        span->p[1] = ss->buff;
+        span->n[1] = n - first;
+    }
+    return n;
+}
+
+uint32_t ssRead(const sampleStore_t *ss, uint64_t start, uint32_t n, float *dst){
+    ssSpan_t span;
+    uint32_t got = ssGetSpan(ss, start, n, &span);
+    if(got == 0 || __is_null(dst)) return 0;
+    memcpy(dst, span.p[0], sizeof(float) * span.n[0]);
+    if(span.n[1]) memcpy(dst + span.n[0], span.p[1], sizeof(float) * span.n[1]);
+    return got;
+}
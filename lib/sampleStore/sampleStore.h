@@ -0,0 +1,117 @@
+#ifndef __SAMPLE_STORE_H__
+#define __SAMPLE_STORE_H__
+
+#ifdef LOG_HEADER_INCLUDE
+#pragma message("INCLUDE: sampleStore.h")
+#endif
+
+#include <stdint.h>
+
+#include "../windowContext/windowContext.h"
+#include "../memPool/memPool.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Sample store: a power-of-two ring of samples for one channel.
+ *
+ * One producer appends with ssWrite(), any number of readers address samples
+ * by their absolute index (0 = first sample ever written). Only the newest
+ * `size` samples are retained.
+ */
+typedef struct sampleStore_t {
+    float *         buff;
+    mpLarge_t       mem;                        /// Backing of buff (huge pages, NUMA node)
+    uint32_t        size;                       /// Capacity in samples (power of two)
+    uint32_t        mask;                       /// size - 1
+    uint64_t        written;                    /// Total samples written (published with release order)
+    uint64_t        stampNs;                    /// ltNow() at the last commit, i.e. ingest time of the newest sample
+} sampleStore_t;
+
+/**
+ * @brief A read view over the store: at most two contiguous regions.
+ */
+typedef struct ssSpan_t {
+    const float *   p[2];
+    uint32_t        n[2];
+} ssSpan_t;
+
+/**
+ * @brief Create a sample store.
+ *
+ * The ring is mapped on huge pages when available, prefaulted, and bound to
+ * the NUMA node of the calling thread, so create it from the thread that
+ * will consume (decimate) it.
+ *
+ * @param[out] ss    Pointer to a sample store pointer. Will be allocated inside.
+ * @param[in]  size  Capacity in samples, rounded up to a power of two.
+ *
+ * @return STATUS_OK on success, ERROR_INVALID_PARAMS or ERROR_UNKNOWN on failure.
+ */
+status_t createSampleStore(sampleStore_t **ss, uint32_t size);
+
+/**
+ * @brief Destroy a sample store and set the pointer to NULL.
+ */
+void destroySampleStore(sampleStore_t **ss);
+
+/**
+ * @brief Append n samples (producer side).
+ */
+void ssWrite(sampleStore_t *ss, const float *src, uint32_t n);
+
+/**
+ * @brief Reserve the next contiguous writable region (producer side).
+ *
+ * Lets a producer generate samples in place; commit them with ssCommit().
+ *
+ * @param[in]  ss   Sample store.
+ * @param[out] n    Number of contiguous samples available at the returned pointer.
+ *
+ * @return Pointer to the write position.
+ */
+float *ssReserve(sampleStore_t *ss, uint32_t *n);
+
+/**
+ * @brief Publish n samples previously written through ssReserve(), stamped with the current time.
+ */
+void ssCommit(sampleStore_t *ss, uint32_t n);
+
+/**
+ * @brief Total number of samples written so far (absolute index of the next sample).
+ */
+uint64_t ssWritten(const sampleStore_t *ss);
+
+/**
+ * @brief Ingest time (ltNow() clock) of the newest sample, 0 before the first write.
+ */
+uint64_t ssStamp(const sampleStore_t *ss);
+
+/**
+ * @brief Absolute index of the oldest sample still held.
+ */
+uint64_t ssOldest(const sampleStore_t *ss);
+
+/**
+ * @brief Get a zero-copy view of samples [start, start + n).
+ *
+ * The range is clipped to what the store still holds.
+ *
+ * @return Number of samples in the view.
+ */
+uint32_t ssGetSpan(const sampleStore_t *ss, uint64_t start, uint32_t n, ssSpan_t *span);
+
+/**
+ * @brief Copy samples [start, start + n) into dst, clipped like ssGetSpan().
+ *
+ * @return Number of samples copied.
+ */
+uint32_t ssRead(const sampleStore_t *ss, uint64_t start, uint32_t n, float *dst);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,863 @@
+#define _GNU_SOURCE
+#include "scpiServer.h"
+
+#include <ctype.h>
+#include <stdarg.h>
+#include <strings.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "../../include/global.h"
+
+#define SC_EV_LISTEN        ((uint64_t)-1)
+#define SC_EV_WAKE          ((uint64_t)-2)
+
+typedef void (*scHandler_t)(scpiServer_t *srv, scClient_t *c, uint8_t query, const char *args);
+
+static uint8_t scMatch(const char *pat, const char *tok);
+
+typedef struct scCommand_t {
+    const char *    pattern;                    /// Upper case = required short form
+    uint8_t         canSet;
+    uint8_t         canQuery;
+    scHandler_t     handler;
+} scCommand_t;
+
+/// REPLIES ///////////////////////////////////////////////////////////////////////////////////////
+
+static void scReply(scClient_t *c, const char *format, ...) __attribute__((format(printf, 2, 3)));
+static void scReply(scClient_t *c, const char *format, ...){
+    va_list ap;
+    va_start(ap, format);
+    int n = vsnprintf((char *)c->out + c->outLen, SC_OUT_SIZE - c->outLen, format, ap);
+    va_end(ap);
+    if(n > 0) c->outLen = __min(SC_OUT_SIZE - 1, c->outLen + (uint32_t)n);
+}
+
+/// ARGUMENTS /////////////////////////////////////////////////////////////////////////////////////
+
+/// Next comma / space separated token, NULL at the end
+static const char *scNextArg(const char **args, char *tok, size_t size){
+    const char *s = *args;
+    while(*s == ' ' || *s == '\t' || *s == ',') ++s;
+    if(*s == '\0') return NULL;
+    size_t n = 0;
+    while(*s && *s != ',' && *s != ' ' && *s != '\t'){
+        if(n + 1 < size) tok[n++] = *s;
+        ++s;
+    }
+    tok[n] = '\0';
+    *args = s;
+    return tok;
+}
+
+static uint8_t scArgDouble(const char **args, double *v){
+    char tok[64], *end;
+    if(__is_null(scNextArg(args, tok, sizeof(tok)))) return 0;
+    *v = strtod(tok, &end);
+    return end != tok && *end == '\0' && isfinite(*v);
+}
+
+static uint8_t scArgInt(const char **args, int64_t *v){
+    char tok[64], *end;
+    if(__is_null(scNextArg(args, tok, sizeof(tok)))) return 0;
+    *v = strtoll(tok, &end, 10);
+    return end != tok && *end == '\0';
+}
+
+/// "CH2" or "2" -> 1, with the channel attached
+static const sampleStore_t *scArgChannel(scpiServer_t *srv, scClient_t *c, const char **args, uint8_t *ch){
+    char tok[16], *end;
+    if(__is_null(scNextArg(args, tok, sizeof(tok)))){
+        scReply(c, "ERR missing channel\n");
+        return NULL;
+    }
+    const char *num = (strncasecmp(tok, "CH", 2) == 0) ? tok + 2 : tok;
+    long n = strtol(num, &end, 10);
+    if(end == num || *end != '\0' || n < 1 || n > SC_MAX_CHANNELS){
+        scReply(c, "ERR bad channel '%s'\n", tok);
+        return NULL;
+    }
+    const sampleStore_t *ss = __atomic_load_n(&srv->stores[n - 1], __ATOMIC_ACQUIRE);
+    if(__is_null(ss)){
+        scReply(c, "ERR channel %ld is off\n", n);
+        return NULL;
+    }
+    *ch = (uint8_t)(n - 1);
+    return ss;
+}
+
+/// SETTINGS //////////////////////////////////////////////////////////////////////////////////////
+
+static void scBeginWrite(scpiServer_t *srv){
+    __atomic_add_fetch(&srv->seq, 1, __ATOMIC_RELEASE);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+static void scEndWrite(scpiServer_t *srv){
+    srv->settings.revision++;
+    __atomic_add_fetch(&srv->seq, 1, __ATOMIC_RELEASE);
+}
+
+void scGetSettings(const scpiServer_t *srv, scSettings_t *out){
+    if(__is_null(srv) || __is_null(out)) return;
+    uint64_t s0, s1;
+    do{
+        s0 = __atomic_load_n(&srv->seq, __ATOMIC_ACQUIRE);
+        memcpy(out, (const void *)&srv->settings, sizeof(scSettings_t));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        s1 = __atomic_load_n(&srv->seq, __ATOMIC_RELAXED);
+    }while((s0 & 1) || s0 != s1);
+}
+
+static void scDefaults(scpiServer_t *srv){
+    scBeginWrite(srv);
+    srv->settings.timebase   = 1e-3;
+    srv->settings.position   = 0.0;
+    srv->settings.trigLevel  = 0.0f;
+    srv->settings.trigRising = 1;
+    srv->settings.trigSource = 0;
+    srv->settings.acq        = SC_ACQ_RUN;
+    scEndWrite(srv);
+}
+
+/// HANDLERS //////////////////////////////////////////////////////////////////////////////////////
+
+static void scIdn(scpiServer_t *srv, scClient_t *c, uint8_t query, const char *args){
+    scReply(c, "ngxxfus,osc,0,1\n");
+}
+
+static void scRst(scpiServer_t *srv, scClient_t *c, uint8_t query, const char *args){
+    scDefaults(srv);
+}
+
+static void scOpc(scpiServer_t *srv, scClient_t *c, uint8_t query, const char *args){
+    scReply(c, "1\n");
+}
+
+/// Shared setter / getter for the double-valued settings
+static void scDoubleSetting(scpiServer_t *srv, scClient_t *c, uint8_t query, const char *args, double *field, double min){
+    if(query){
+        scReply(c, "%.9g\n", *field);
+        return;
+    }
+    double v;
+    if(!scArgDouble(&args, &v) || v < min){
+        scReply(c, "ERR bad value\n");
+        return;
+    }
+    scBeginWrite(srv);
+    *field = v;
+    scEndWrite(srv);
+}
+
+static void scTimebase(scpiServer_t *srv, scClient_t *c, uint8_t query, const char *args){
+    scDoubleSetting(srv, c, query, args, &srv->settings.timebase, 1e-12);
+}
+
+static void scPosition(scpiServer_t *srv, scClient_t *c, uint8_t query, const char *args){
+    scDoubleSetting(srv, c, query, args, &srv->settings.position, -INFINITY);
+}
+
+static void scTrigLevel(scpiServer_t *srv, scClient_t *c, uint8_t query, const char *args){
+    if(query){
+        scReply(c, "%.9g\n", srv->settings.trigLevel);
+        return;
+    }
+    double v;
+    if(!scArgDouble(&args, &v)){
+        scReply(c, "ERR bad level\n");
+        return;
+    }
+    scBeginWrite(srv);
+    srv->settings.trigLevel = (float)v;
+    scEndWrite(srv);
+}
+
+static void scTrigSlope(scpiServer_t *srv, scClient_t *c, uint8_t query, const char *args){
+    if(query){
+        scReply(c, "%s\n", srv->settings.trigRising ? "RIS" : "FALL");
+        return;
+    }
+    char tok[16];
+    if(__is_null(scNextArg(&args, tok, sizeof(tok)))){
+        scReply(c, "ERR missing slope\n");
+        return;
+    }
+    uint8_t rising;
+    if(strcasecmp(tok, "RIS") == 0 || strcasecmp(tok, "RISING") == 0)       rising = 1;
+    else if(strcasecmp(tok, "FALL") == 0 || strcasecmp(tok, "FALLING") == 0) rising = 0;
+    else{
+        scReply(c, "ERR bad slope '%s'\n", tok);
+        return;
+    }
+    scBeginWrite(srv);
+    srv->settings.trigRising = rising;
+    scEndWrite(srv);
+}
+
+static void scTrigSource(scpiServer_t *srv, scClient_t *c, uint8_t query, const char *args){
+    if(query){
+        scReply(c, "CH%d\n", srv->settings.trigSource + 1);
+        return;
+    }
+    uint8_t ch;
+    if(__is_null(scArgChannel(srv, c, &args, &ch))) return;
+    scBeginWrite(srv);
+    srv->settings.trigSource = ch;
+    scEndWrite(srv);
+}
+
+static void scSetAcq(scpiServer_t *srv, scAcqState_t acq){
+    scBeginWrite(srv);
+    srv->settings.acq = acq;
+    scEndWrite(srv);
+}
+
+static void scRun(scpiServer_t *srv, scClient_t *c, uint8_t query, const char *args){
+    scSetAcq(srv, SC_ACQ_RUN);
+}
+
+static void scStop(scpiServer_t *srv, scClient_t *c, uint8_t query, const char *args){
+    scSetAcq(srv, SC_ACQ_STOP);
+}
+
+static void scSingle(scpiServer_t *srv, scClient_t *c, uint8_t query, const char *args){
+    scSetAcq(srv, SC_ACQ_SINGLE);
+}
+
+static void scAcqState(scpiServer_t *srv, scClient_t *c, uint8_t query, const char *args){
+    static const char *names[] = { "STOP", "RUN", "SINGLE" };
+    scReply(c, "%s\n", names[srv->settings.acq]);
+}
+
+static void scPoints(scpiServer_t *srv, scClient_t *c, uint8_t query, const char *args){
+    uint8_t ch;
+    const sampleStore_t *ss = scArgChannel(srv, c, &args, &ch);
+    if(__is_null(ss)) return;
+    scReply(c, "%llu\n", (unsigned long long)ssWritten(ss));
+}
+
+/// The newest n samples (n = 0: the record length) as a span
+static uint32_t scNewest(scpiServer_t *srv, const sampleStore_t *ss, int64_t n, ssSpan_t *span, uint64_t *first){
+    uint64_t written = ssWritten(ss), oldest = ssOldest(ss);
+    if(n <= 0) n = srv->recordLength;
+    if((uint64_t)n > written - oldest) n = (int64_t)(written - oldest);
+    *first = written - (uint64_t)n;
+    return ssGetSpan(ss, *first, (uint32_t)n, span);
+}
+
+#define scSpanAt(s, i)      ((i) < (s).n[0] ? (s).p[0][i] : (s).p[1][(i) - (s).n[0]])
+
+typedef enum scMeasure_t { SC_MIN, SC_MAX, SC_PKPK, SC_MEAN, SC_RMS, SC_FREQ } scMeasure_t;
+
+static void scMeasure(scpiServer_t *srv, scClient_t *c, const char *args, scMeasure_t what){
+    uint8_t  ch;
+    int64_t  n = 0;
+    uint64_t first;
+    ssSpan_t span;
+    const sampleStore_t *ss = scArgChannel(srv, c, &args, &ch);
+    if(__is_null(ss)) return;
+    if(*args && !scArgInt(&args, &n)){
+        scReply(c, "ERR bad count\n");
+        return;
+    }
+    uint32_t got = scNewest(srv, ss, n, &span, &first);
+    if(got == 0){
+        scReply(c, "ERR no data\n");
+        return;
+    }
+    float  vMin = INFINITY, vMax = -INFINITY;
+    double sum = 0.0, sum2 = 0.0;
+    REPTT(uint8_t, k, 0, 2){
+        REPTT(uint32_t, i, 0, span.n[k]){
+            float v = span.p[k][i];
+            vMin = __min(vMin, v);
+            vMax = __max(vMax, v);
+            sum  += v;
+            sum2 += (double)v * v;
+        }
+    }
+    switch(what){
+        case SC_MIN:  scReply(c, "%.9g\n", vMin); return;
+        case SC_MAX:  scReply(c, "%.9g\n", vMax); return;
+        case SC_PKPK: scReply(c, "%.9g\n", vMax - vMin); return;
+        case SC_MEAN: scReply(c, "%.9g\n", sum / got); return;
+        case SC_RMS:  scReply(c, "%.9g\n", sqrt(sum2 / got)); return;
+        case SC_FREQ: break;
+    }
+    /// Rising crossings of the mid level, with 10% hysteresis
+    float    mid = (vMin + vMax) / 2, hys = (vMax - vMin) / 10;
+    uint8_t  low = 0;
+    int64_t  firstX = -1, lastX = -1;
+    uint32_t cycles = 0;
+    REPTT(uint32_t, i, 0, got){
+        float v = scSpanAt(span, i);
+        if(v < mid - hys) low = 1;
+        else if(low && v > mid){
+            low = 0;
+            if(firstX < 0) firstX = i;
+            else ++cycles;
+            lastX = i;
+        }
+    }
+    if(cycles == 0 || vMax - vMin <= 0){
+        scReply(c, "ERR no period\n");
+        return;
+    }
+    scReply(c, "%.9g\n", cycles * srv->sampleRate / (double)(lastX - firstX));
+}
+
+static void scMeasMin(scpiServer_t *srv, scClient_t *c, uint8_t query, const char *args)  { scMeasure(srv, c, args, SC_MIN); }
+static void scMeasMax(scpiServer_t *srv, scClient_t *c, uint8_t query, const char *args)  { scMeasure(srv, c, args, SC_MAX); }
+static void scMeasPkpk(scpiServer_t *srv, scClient_t *c, uint8_t query, const char *args) { scMeasure(srv, c, args, SC_PKPK); }
+static void scMeasMean(scpiServer_t *srv, scClient_t *c, uint8_t query, const char *args) { scMeasure(srv, c, args, SC_MEAN); }
+static void scMeasRms(scpiServer_t *srv, scClient_t *c, uint8_t query, const char *args)  { scMeasure(srv, c, args, SC_RMS); }
+static void scMeasFreq(scpiServer_t *srv, scClient_t *c, uint8_t query, const char *args) { scMeasure(srv, c, args, SC_FREQ); }
+
+static void scWaveRaw(scpiServer_t *srv, scClient_t *c, uint8_t query, const char *args){
+    uint8_t  ch;
+    int64_t  first, n;
+    ssSpan_t span;
+    const sampleStore_t *ss = scArgChannel(srv, c, &args, &ch);
+    if(__is_null(ss)) return;
+    if(!scArgInt(&args, &first) || !scArgInt(&args, &n) || n <= 0){
+        scReply(c, "ERR expected <ch>,<first>,<n>\n");
+        return;
+    }
+    n = __min(n, (int64_t)(UINT32_MAX / sizeof(float)));
+    uint64_t start;
+    uint32_t got = 0;
+    memset(&span, 0, sizeof(span));
+    if(first < 0){
+        got = scNewest(srv, ss, n, &span, &start);
+    }else{
+        uint64_t end = (uint64_t)first + (uint64_t)n;
+        start = __max((uint64_t)first, ssOldest(ss));
+        if(start < end) got = ssGetSpan(ss, start, (uint32_t)(end - start), &span);
+    }
+
+    scFrameHeader_t h = {SC_FRAME_MAGIC, SC_FRAME_RAW, ch, got, start, got, got * (uint32_t)sizeof(float)};
+    memcpy(c->out + c->outLen, &h, sizeof(h));
+    c->outLen      += sizeof(h);
+    /// The payload is never copied: the iovecs point into the ring
+    c->bulk[0]      = (const uint8_t *)span.p[0];
+    c->bulkBytes[0] = span.n[0] * sizeof(float);
+    c->bulk[1]      = (const uint8_t *)span.p[1];
+    c->bulkBytes[1] = span.n[1] * sizeof(float);
+    c->bulkFirst    = start;
+    c->bulkCh       = ch;
+}
+
+static void scWaveData(scpiServer_t *srv, scClient_t *c, uint8_t query, const char *args){
+    uint8_t  ch;
+    int64_t  n, points;
+    uint64_t first;
+    ssSpan_t span;
+    const sampleStore_t *ss = scArgChannel(srv, c, &args, &ch);
+    if(__is_null(ss)) return;
+    if(!scArgInt(&args, &n) || !scArgInt(&args, &points) || points <= 0){
+        scReply(c, "ERR expected <ch>,<n>,<points>\n");
+        return;
+    }
+    uint32_t got = scNewest(srv, ss, n, &span, &first);
+    uint32_t pts = (uint32_t)__min((int64_t)__min(got, (uint32_t)SC_MAX_POINTS), points);
+
+    scFrameHeader_t h = {SC_FRAME_MAGIC, SC_FRAME_MINMAX, ch, pts, first, got, pts * 2 * (uint32_t)sizeof(float)};
+    if(c->outLen + sizeof(h) + h.bytes > SC_OUT_SIZE){
+        scReply(c, "ERR reply too large\n");
+        return;
+    }
+    memcpy(c->out + c->outLen, &h, sizeof(h));
+    float *pairs = (float *)(c->out + c->outLen + sizeof(h));
+    REPTT(uint32_t, p, 0, pts){
+        uint32_t a = (uint32_t)((uint64_t)got * p / pts), b = (uint32_t)((uint64_t)got * (p + 1) / pts);
+        float vMin = INFINITY, vMax = -INFINITY;
+        REPTT(uint32_t, i, a, b){
+            float v = scSpanAt(span, i);
+            vMin = __min(vMin, v);
+            vMax = __max(vMax, v);
+        }
+        memcpy(pairs + 2 * p, &vMin, sizeof(float));
+        memcpy(pairs + 2 * p + 1, &vMax, sizeof(float));
+    }
+    c->outLen += sizeof(h) + h.bytes;
+}
+
+/// DEFine <expr>: the rest of the line, surrounding quotes dropped (fir() and iir() take commas)
+static void scMathDefine(scpiServer_t *srv, scClient_t *c, uint8_t query, const char *args){
+    if(query){
+        scReply(c, "\"%s\"\n", srv->settings.math);
+        return;
+    }
+    while(isspace((unsigned char)*args)) ++args;
+    size_t len = strlen(args);
+    while(len > 0 && isspace((unsigned char)args[len - 1])) --len;
+    if(len >= 2 && (args[0] == '"' || args[0] == '\'') && args[len - 1] == args[0]){
+        ++args;
+        len -= 2;
+    }
+    if(len == 0 || len >= SC_MATH_SIZE){
+        scReply(c, "ERR expected <expr> of 1 ... %d characters\n", SC_MATH_SIZE - 1);
+        return;
+    }
+    scBeginWrite(srv);
+    memcpy(srv->settings.math, args, len);
+    srv->settings.math[len] = '\0';
+    srv->settings.mathRevision++;
+    scEndWrite(srv);
+}
+
+/// The attached search, or an error reply
+static search_t *scSearch(scpiServer_t *srv, scClient_t *c){
+    search_t *sr = __atomic_load_n(&srv->search, __ATOMIC_ACQUIRE);
+    if(__is_null(sr)) scReply(c, "ERR no search\n");
+    return sr;
+}
+
+static void scSearchDefine(scpiServer_t *srv, scClient_t *c, uint8_t query, const char *args){
+    static const char *kinds[]  = { "EDGE", "PULSe", "RUNT" };
+    static const char *pols[]   = { "POSitive", "NEGative", "EITHer" };
+    static const char *widths[] = { "ANY", "LESS", "MORE" };
+    search_t *sr = scSearch(srv, c);
+    if(__is_null(sr)) return;
+    uint8_t   ch;
+    const sampleStore_t *ss = scArgChannel(srv, c, &args, &ch);
+    if(__is_null(ss)) return;
+
+    srQuery_t q;
+    char      kind[16], pol[16], cmp[16];
+    double    lo, hi, width = 0.0;
+    int       k = -1, p = -1, w = 0;
+    memset(&q, 0, sizeof(q));
+    if(__is_null(scNextArg(&args, kind, sizeof(kind))) || __is_null(scNextArg(&args, pol, sizeof(pol)))
+    || !scArgDouble(&args, &lo) || !scArgDouble(&args, &hi)){
+        scReply(c, "ERR expected <ch>,EDGE|PULSe|RUNT,POSitive|NEGative|EITHer,<lo>,<hi>[,LESS|MORE,<width>]\n");
+        return;
+    }
+    REPTT(int, i, 0, 3){
+        if(scMatch(kinds[i], kind)) k = i;
+        if(scMatch(pols[i], pol))   p = i;
+    }
+    if(__is_not_null(scNextArg(&args, cmp, sizeof(cmp)))){
+        w = -1;
+        REPTT(int, i, 0, 3) if(scMatch(widths[i], cmp)) w = i;
+        if(w > 0 && (!scArgDouble(&args, &width) || width < 0.0)) w = -1;
+    }
+    if(k < 0 || p < 0 || w < 0){
+        scReply(c, "ERR bad search definition\n");
+        return;
+    }
+    q.kind     = (srKind_t)k;
+    q.polarity = (srPolarity_t)p;
+    q.lo       = (float)__min(lo, hi);
+    q.hi       = (float)__max(lo, hi);
+    q.widthCmp = (srWidthCmp_t)w;
+    q.width    = (uint64_t)width;
+    srSetQuery(sr, ss, &q);
+}
+
+static void scSearchCount(scpiServer_t *srv, scClient_t *c, uint8_t query, const char *args){
+    search_t *sr = scSearch(srv, c);
+    if(__is_not_null(sr)) scReply(c, "%llu\n", (unsigned long long)srCount(sr));
+}
+
+static void scReplyEvent(scClient_t *c, const srEvent_t *ev, const char *end){
+    scReply(c, "%llu,%llu,%llu,%s%s", (unsigned long long)ev->index, (unsigned long long)ev->pos,
+        (unsigned long long)ev->width, ev->negative ? "NEG" : "POS", end);
+}
+
+/// NEXT? / PREVious? <pos>: "<index>,<pos>,<width>,POS|NEG" or "NONE"
+static void scSearchStep(scpiServer_t *srv, scClient_t *c, const char *args, uint8_t forward){
+    search_t *sr = scSearch(srv, c);
+    int64_t   pos;
+    srEvent_t ev;
+    if(__is_null(sr)) return;
+    if(!scArgInt(&args, &pos) || pos < 0){
+        scReply(c, "ERR expected <pos>\n");
+        return;
+    }
+    if(forward ? srNext(sr, (uint64_t)pos, &ev) : srPrev(sr, (uint64_t)pos, &ev)) scReplyEvent(c, &ev, "\n");
+    else scReply(c, "NONE\n");
+}
+
+static void scSearchNext(scpiServer_t *srv, scClient_t *c, uint8_t query, const char *args) { scSearchStep(srv, c, args, 1); }
+static void scSearchPrev(scpiServer_t *srv, scClient_t *c, uint8_t query, const char *args) { scSearchStep(srv, c, args, 0); }
+
+/// LIST? <first>,<n>: events separated by ';' on one line, as many as fit
+static void scSearchList(scpiServer_t *srv, scClient_t *c, uint8_t query, const char *args){
+    search_t *sr = scSearch(srv, c);
+    int64_t   first, n;
+    srEvent_t evs[SC_MAX_EVENTS];
+    if(__is_null(sr)) return;
+    if(!scArgInt(&args, &first) || !scArgInt(&args, &n) || first < 0 || n <= 0){
+        scReply(c, "ERR expected <first>,<n>\n");
+        return;
+    }
+    uint32_t got = srList(sr, (uint64_t)first, evs, (uint32_t)__min(n, (int64_t)SC_MAX_EVENTS));
+    REPTT(uint32_t, i, 0, got) scReplyEvent(c, &evs[i], (i + 1 < got) ? ";" : "");
+    scReply(c, "\n");
+}
+
+static const scCommand_t scCommands[] = {
+    { "*IDN",                  0, 1, scIdn },
+    { "*RST",                  1, 0, scRst },
+    { "*OPC",                  0, 1, scOpc },
+    { "TIMebase:SCALe",        1, 1, scTimebase },
+    { "TIMebase:POSition",     1, 1, scPosition },
+    { "TRIGger:LEVel",         1, 1, scTrigLevel },
+    { "TRIGger:SLOPe",         1, 1, scTrigSlope },
+    { "TRIGger:SOURce",        1, 1, scTrigSource },
+    { "RUN",                   1, 0, scRun },
+    { "STOP",                  1, 0, scStop },
+    { "SINGle",                1, 0, scSingle },
+    { "ACQuire:STATe",         0, 1, scAcqState },
+    { "ACQuire:POINts",        0, 1, scPoints },
+    { "MEASure:MIN",           0, 1, scMeasMin },
+    { "MEASure:MAX",           0, 1, scMeasMax },
+    { "MEASure:PKPK",          0, 1, scMeasPkpk },
+    { "MEASure:MEAN",          0, 1, scMeasMean },
+    { "MEASure:RMS",           0, 1, scMeasRms },
+    { "MEASure:FREQuency",     0, 1, scMeasFreq },
+    { "WAVeform:RAW",          0, 1, scWaveRaw },
+    { "WAVeform:DATA",         0, 1, scWaveData },
+    { "SEARch:DEFine",         1, 0, scSearchDefine },
+    { "SEARch:COUNt",          0, 1, scSearchCount },
+    { "SEARch:NEXT",           0, 1, scSearchNext },
+    { "SEARch:PREVious",       0, 1, scSearchPrev },
+    { "SEARch:LIST",           0, 1, scSearchList },
+    { "MATH:DEFine",           1, 1, scMathDefine },
+};
+
+/// PARSER ////////////////////////////////////////////////////////////////////////////////////////
+
+/// One header node against one pattern node: the short (upper case) or the long form
+static uint8_t scMatchNode(const char *pat, size_t patLen, const char *tok, size_t tokLen){
+    size_t req = 0;
+    while(req < patLen && !islower((unsigned char)pat[req])) ++req;
+    if(tokLen != req && tokLen != patLen) return 0;
+    return strncasecmp(pat, tok, tokLen) == 0;
+}
+
+static uint8_t scMatch(const char *pat, const char *tok){
+    if(*tok == ':') ++tok;
+    while(1){
+        const char *pe = strchr(pat, ':'), *te = strchr(tok, ':');
+        size_t pl = pe ? (size_t)(pe - pat) : strlen(pat);
+        size_t tl = te ? (size_t)(te - tok) : strlen(tok);
+        if(!scMatchNode(pat, pl, tok, tl)) return 0;
+        if(!pe || !te) return !pe && !te;
+        pat = pe + 1;
+        tok = te + 1;
+    }
+}
+
+static void scExec(scpiServer_t *srv, scClient_t *c, char *line){
+    while(isspace((unsigned char)*line)) ++line;
+    if(*line == '\0') return;
+    char *args = line;
+    while(*args && !isspace((unsigned char)*args)) ++args;
+    if(*args) *args++ = '\0';
+
+    size_t  len   = strlen(line);
+    uint8_t query = (len > 0 && line[len - 1] == '?');
+    if(query) line[len - 1] = '\0';
+
+    REPTT(size_t, i, 0, sizeof(scCommands) / sizeof(scCommands[0])){
+        const scCommand_t *cmd = &scCommands[i];
+        if(!scMatch(cmd->pattern, line)) continue;
+        if((query && !cmd->canQuery) || (!query && !cmd->canSet)){
+            scReply(c, "ERR %s %s\n", cmd->pattern, query ? "is not a query" : "is query only");
+            return;
+        }
+        cmd->handler(srv, c, query, args);
+        return;
+    }
+    scReply(c, "ERR unknown command '%s%s'\n", line, query ? "?" : "");
+}
+
+/// I/O ///////////////////////////////////////////////////////////////////////////////////////////
+
+static uint8_t scPending(const scClient_t *c){
+    return c->outOff < c->outLen || c->bulkBytes[0] || c->bulkBytes[1];
+}
+
+static void scWatch(scpiServer_t *srv, scClient_t *c, uint8_t out){
+    struct epoll_event ev;
+    ev.events   = EPOLLIN | EPOLLRDHUP | (out ? EPOLLOUT : 0);
+    ev.data.u64 = (uint64_t)(c - srv->clients);
+    epoll_ctl(srv->epollFd, EPOLL_CTL_MOD, c->fd, &ev);
+}
+
+static void scClose(scpiServer_t *srv, scClient_t *c){
+    epoll_ctl(srv->epollFd, EPOLL_CTL_DEL, c->fd, NULL);
+    close(c->fd);
+    memset(c, 0, sizeof(scClient_t));
+    c->fd = -1;
+}
+
+/// Advance the send state by n bytes
+static void scConsume(scClient_t *c, size_t n){
+    size_t k = __min(n, (size_t)(c->outLen - c->outOff));
+    c->outOff += k;
+    n -= k;
+    REPTT(uint8_t, i, 0, 2){
+        k = __min(n, (size_t)c->bulkBytes[i]);
+        c->bulk[i]      += k;
+        c->bulkBytes[i] -= k;
+        n -= k;
+    }
+}
+
+/**
+ * @brief Send as much as the socket takes.
+ *
+ * @return 1 when everything queued has been sent, 0 if more is pending, -1 on error.
+ */
+static int scFlush(scpiServer_t *srv, scClient_t *c){
+    uint8_t hadBulk = c->bulkBytes[0] || c->bulkBytes[1];
+    while(scPending(c)){
+        struct iovec iov[3];
+        int          n = 0;
+        if(c->outOff < c->outLen){
+            iov[n].iov_base = c->out + c->outOff;
+            iov[n].iov_len  = c->outLen - c->outOff;
+            ++n;
+        }
+        REPTT(uint8_t, i, 0, 2){
+            if(c->bulkBytes[i] == 0) continue;
+            iov[n].iov_base = (void *)c->bulk[i];
+            iov[n].iov_len  = c->bulkBytes[i];
+            ++n;
+        }
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov    = iov;
+        msg.msg_iovlen = n;
+        ssize_t sent = sendmsg(c->fd, &msg, MSG_NOSIGNAL);
+        if(sent < 0){
+            if(errno == EAGAIN || errno == EWOULDBLOCK) return 0;
+            if(errno == EINTR) continue;
+            return -1;
+        }
+        scConsume(c, (size_t)sent);
+    }
+    c->outOff = c->outLen = 0;
+    if(hadBulk){
+        /// The producer may have lapped the range while it was on the wire
+        const sampleStore_t *ss = __atomic_load_n(&srv->stores[c->bulkCh], __ATOMIC_ACQUIRE);
+        if(__is_null(ss) || ssOldest(ss) > c->bulkFirst){
+            scReply(c, "OVERRUN %llu\n", (unsigned long long)c->bulkFirst);
+            return scFlush(srv, c);
+        }
+    }
+    return 1;
+}
+
+/// Run buffered commands until one produces output that cannot be sent right away
+static int scService(scpiServer_t *srv, scClient_t *c){
+    while(!scPending(c)){
+        char *nl = memchr(c->in, '\n', c->inLen);
+        if(__is_null(nl)) break;
+        *nl = '\0';
+        if(nl > c->in && nl[-1] == '\r') nl[-1] = '\0';
+        scExec(srv, c, c->in);
+        uint32_t used = (uint32_t)(nl + 1 - c->in);
+        memmove(c->in, nl + 1, c->inLen - used);
+        c->inLen -= used;
+
+        int rc = scFlush(srv, c);
+        if(rc < 0) return -1;
+        if(rc == 0){
+            scWatch(srv, c, 1);
+            return 0;
+        }
+    }
+    scWatch(srv, c, scPending(c));
+    return 0;
+}
+
+static void scAccept(scpiServer_t *srv){
+    while(1){
+        int fd = accept4(srv->listenFd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if(fd < 0) return;
+        scClient_t *c = NULL;
+        REPTT(uint8_t, i, 0, SC_MAX_CLIENTS){
+            if(srv->clients[i].fd < 0){
+                c = &srv->clients[i];
+                break;
+            }
+        }
+        if(__is_null(c)){
+            __err("[scAccept] %d clients already connected", SC_MAX_CLIENTS);
+            close(fd);
+            continue;
+        }
+        struct epoll_event ev;
+        ev.events   = EPOLLIN | EPOLLRDHUP;
+        ev.data.u64 = (uint64_t)(c - srv->clients);
+        c->fd = fd;
+        epoll_ctl(srv->epollFd, EPOLL_CTL_ADD, fd, &ev);
+        __log("[scAccept] client %d connected", (int)(c - srv->clients));
+    }
+}
+
+static void scReadable(scpiServer_t *srv, scClient_t *c){
+    while(c->inLen < SC_IN_SIZE){
+        ssize_t n = read(c->fd, c->in + c->inLen, SC_IN_SIZE - c->inLen);
+        if(n > 0){
+            c->inLen += (uint32_t)n;
+            continue;
+        }
+        if(n < 0 && errno == EINTR) continue;
+        if(n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        if(n == 0) scService(srv, c);           /// Answer what was sent before the EOF
+        scClose(srv, c);
+        return;
+    }
+    if(c->inLen == SC_IN_SIZE && __is_null(memchr(c->in, '\n', c->inLen))){
+        __err("[scReadable] client %d: line longer than %d bytes", (int)(c - srv->clients), SC_IN_SIZE);
+        scClose(srv, c);
+        return;
+    }
+    if(scService(srv, c) < 0) scClose(srv, c);
+}
+
+static void *scLoop(void *arg){
+    scpiServer_t *srv = (scpiServer_t *)arg;
+    struct epoll_event events[SC_MAX_CLIENTS + 2];
+    __log("[scLoop] listening on %s", srv->path);
+    while(srv->running){
+        int n = epoll_wait(srv->epollFd, events, SC_MAX_CLIENTS + 2, -1);
+        if(n < 0){
+            if(errno == EINTR) continue;
+            __err("[scLoop] epoll_wait: %s", strerror(errno));
+            break;
+        }
+        REPTT(int, i, 0, n){
+            uint64_t id = events[i].data.u64;
+            if(id == SC_EV_WAKE) continue;
+            if(id == SC_EV_LISTEN){
+                scAccept(srv);
+                continue;
+            }
+            scClient_t *c = &srv->clients[id];
+            if(c->fd < 0) continue;
+            if(events[i].events & EPOLLOUT){
+                int rc = scFlush(srv, c);
+                if(rc < 0){
+                    scClose(srv, c);
+                    continue;
+                }
+                if(rc > 0 && scService(srv, c) < 0){
+                    scClose(srv, c);
+                    continue;
+                }
+            }
+            if(events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) scReadable(srv, c);
+        }
+    }
+    __log("[scLoop] stopped");
+    return NULL;
+}
+
+/// CREATE & DESTROY //////////////////////////////////////////////////////////////////////////////
+
+status_t createScpiServer(scpiServer_t **srv, const char *path, double sampleRate, uint32_t recordLength){
+    __entry("createScpiServer(%p, %s, %g, %u)", srv, path, sampleRate, recordLength);
+    if(__is_null(srv) || __is_null(path) || !*path || sampleRate <= 0 || recordLength == 0){
+        __err("[createScpiServer] Invalid params!");
+        return ERROR_INVALID_PARAMS;
+    }
+    struct sockaddr_un addr;
+    if(strlen(path) >= sizeof(addr.sun_path)){
+        __err("[createScpiServer] Socket path too long: %s", path);
+        return ERROR_INVALID_PARAMS;
+    }
+    *srv = (scpiServer_t *) mpCalloc(1, sizeof(scpiServer_t));
+    if(__is_null(*srv)){
+        __err("[createScpiServer] malloc failed!");
+        return ERROR_UNKNOWN;
+    }
+    scpiServer_t *s = *srv;
+    s->listenFd     = s->epollFd = s->wakeFd = -1;
+    s->sampleRate   = sampleRate;
+    s->recordLength = recordLength;
+    strcpy(s->path, path);
+    REPTT(uint8_t, i, 0, SC_MAX_CLIENTS) s->clients[i].fd = -1;
+    scDefaults(s);
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+    unlink(path);
+
+    struct epoll_event ev;
+    s->listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if(s->listenFd < 0 || bind(s->listenFd, (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(s->listenFd, SC_MAX_CLIENTS) != 0){
+        __err("[createScpiServer] %s: %s", path, strerror(errno));
+        goto fail;
+    }
+    s->epollFd = epoll_create1(EPOLL_CLOEXEC);
+    s->wakeFd  = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if(s->epollFd < 0 || s->wakeFd < 0){
+        __err("[createScpiServer] epoll / eventfd: %s", strerror(errno));
+        goto fail;
+    }
+    ev.events   = EPOLLIN;
+    ev.data.u64 = SC_EV_LISTEN;
+    epoll_ctl(s->epollFd, EPOLL_CTL_ADD, s->listenFd, &ev);
+    ev.data.u64 = SC_EV_WAKE;
+    epoll_ctl(s->epollFd, EPOLL_CTL_ADD, s->wakeFd, &ev);
+
+    s->running = 1;
+    if(pthread_create(&s->thread, NULL, scLoop, s) != 0){
+        __err("[createScpiServer] pthread_create failed!");
+        s->running = 0;
+        goto fail;
+    }
+    __exit("createScpiServer()");
+    return STATUS_OK;
+
+fail:
+    if(s->listenFd >= 0){
+        close(s->listenFd);
+        unlink(path);
+    }
+    if(s->epollFd >= 0) close(s->epollFd);
+    if(s->wakeFd >= 0) close(s->wakeFd);
+    mpFree(s);
+    *srv = NULL;
+    __exit("createScpiServer() failed");
+    return ERROR_UNKNOWN;
+}
+
+void destroyScpiServer(scpiServer_t **srv){
+    if(__is_null(srv) || __is_null(*srv)) return;
+    scpiServer_t *s = *srv;
+    uint64_t one = 1;
+    s->running = 0;
+    if(write(s->wakeFd, &one, sizeof(one)) != sizeof(one)) __err("[destroyScpiServer] wake failed");
+    pthread_join(s->thread, NULL);
+    REPTT(uint8_t, i, 0, SC_MAX_CLIENTS){
+        if(s->clients[i].fd >= 0) scClose(s, &s->clients[i]);
+    }
+    close(s->listenFd);
+    close(s->epollFd);
+    close(s->wakeFd);
+    unlink(s->path);
+    mpFree(s);
+    *srv = NULL;
+}
+
+void scAttach(scpiServer_t *srv, uint8_t ch, const sampleStore_t *ss){
+    if(__is_null(srv) || ch >= SC_MAX_CHANNELS) return;
+    __atomic_store_n(&srv->stores[ch], ss, __ATOMIC_RELEASE);
+}
+
+void scAttachSearch(scpiServer_t *srv, search_t *sr){
+    if(__is_null(srv)) return;
+    __atomic_store_n(&srv->search, sr, __ATOMIC_RELEASE);
+}
@@ -0,0 +1,165 @@
+#ifndef __SCPI_SERVER_H__
+#define __SCPI_SERVER_H__
+
+#ifdef LOG_HEADER_INCLUDE
+#pragma message("INCLUDE: scpiServer.h")
+#endif
+
+#include <stdint.h>
+#include <pthread.h>
+
+#include "../windowContext/windowContext.h"
+#include "../sampleStore/sampleStore.h"
+#include "../search/search.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SC_MAX_CLIENTS      8
+#define SC_MAX_CHANNELS     8
+#define SC_IN_SIZE          1024                /// Per-client command line buffer
+#define SC_OUT_SIZE         4096                /// Per-client text / decimated reply buffer
+#define SC_MAX_POINTS       (SC_OUT_SIZE / (2 * sizeof(float)) - 8)
+#define SC_MAX_EVENTS       (SC_OUT_SIZE / 80)  /// Per SEARch:LIST? reply, worst case 80 chars each
+#define SC_MATH_SIZE        256                 /// MATH:DEFine expression, terminator included
+
+/// Binary frame: "#B" magic, then scFrameHeader_t, then `bytes` of payload
+#define SC_FRAME_MAGIC      0x4223              /// '#', 'B' little-endian
+
+typedef enum scFrameType_t {
+    SC_FRAME_RAW = 1,                           /// float32 samples straight from the ring
+    SC_FRAME_MINMAX = 2,                        /// float32 [min, max] pairs
+} scFrameType_t;
+
+typedef struct __attribute__((packed)) scFrameHeader_t {
+    uint16_t        magic;
+    uint8_t         type;                       /// scFrameType_t
+    uint8_t         channel;
+    uint32_t        count;                      /// Samples (RAW) or pairs (MINMAX)
+    uint64_t        first;                      /// Absolute sample index of the first sample
+    uint64_t        span;                       /// Samples covered (MINMAX: count * samples per pair)
+    uint32_t        bytes;                      /// Payload size
+} scFrameHeader_t;
+
+typedef enum scAcqState_t {
+    SC_ACQ_STOP = 0,
+    SC_ACQ_RUN,
+    SC_ACQ_SINGLE,
+} scAcqState_t;
+
+/**
+ * @brief Settings changed by remote commands, read by the render loop.
+ */
+typedef struct scSettings_t {
+    double          timebase;                   /// Seconds per division
+    double          position;                   /// Horizontal offset, seconds
+    float           trigLevel;
+    uint8_t         trigRising;
+    uint8_t         trigSource;
+    scAcqState_t    acq;
+    char            math[SC_MATH_SIZE];         /// Last MATH:DEFine expression, empty = none given
+    uint64_t        mathRevision;               /// Bumped on every MATH:DEFine, even with the same text
+    uint64_t        revision;                   /// Bumped on every change
+} scSettings_t;
+
+typedef struct scClient_t {
+    int             fd;                         /// -1 = free slot
+    char            in[SC_IN_SIZE];
+    uint32_t        inLen;
+    uint8_t         out[SC_OUT_SIZE];           /// Text reply, or header + decimated payload
+    uint32_t        outLen;
+    uint32_t        outOff;
+    /// Pending zero-copy transfer: the rest of out, then two ring regions
+    const uint8_t * bulk[2];
+    uint32_t        bulkBytes[2];
+    uint64_t        bulkFirst;
+    uint8_t         bulkCh;
+} scClient_t;
+
+/**
+ * @brief SCPI-like command server on a Unix domain socket.
+ *
+ * One thread runs an epoll loop over the listening socket and the clients;
+ * all sockets are non-blocking, so a slow reader only holds up itself.
+ * Commands are newline terminated. Queries answer with one text line, except
+ * WAVeform:RAW? / WAVeform:DATA?, which answer with one binary frame.
+ *
+ * RAW frames are sent with writev() straight from the sample store ring (no
+ * copy). The producer keeps writing meanwhile; if it laps the range before
+ * the transfer ends, a text line "OVERRUN <first>" follows the frame.
+ *
+ * Settings commands write scSettings_t under a sequence counter; the render
+ * loop polls it with scGetSettings() and never blocks on the server.
+ *
+ * Command set (SCPI short forms accepted, case-insensitive; <ch> is 1-based,
+ * "CH2" and "2" both work; setters answer nothing, errors answer "ERR ..."):
+ *   *IDN?  *RST  *OPC?
+ *   TIMebase:SCALe <s/div> | ?        TIMebase:POSition <s> | ?
+ *   TRIGger:LEVel <v> | ?             TRIGger:SLOPe RISing|FALLing | ?
+ *   TRIGger:SOURce <ch> | ?
+ *   RUN  STOP  SINGle  ACQuire:STATe?
+ *   ACQuire:POINts? <ch>              total samples written
+ *   MEASure:MIN? | MAX? | PKPK? | MEAN? | RMS? | FREQuency? <ch>[,<n>]
+ *   WAVeform:RAW? <ch>,<first>,<n>    first < 0: the newest n samples
+ *   WAVeform:DATA? <ch>,<n>,<points>  newest n samples as min/max pairs
+ *   SEARch:DEFine <ch>,EDGE|PULSe|RUNT,POSitive|NEGative|EITHer,<lo>,<hi>[,LESS|MORE,<width>]
+ *   SEARch:COUNt?                     events indexed
+ *   SEARch:NEXT? | PREVious? <pos>    nearest event after / before sample pos
+ *   SEARch:LIST? <first>,<n>          events by running number, ';' separated
+ *   MATH:DEFine <expr> | ?            math channel expression, e.g. (CH1-CH2)*0.5; the rest
+ *                                     of the line, optionally quoted (compiled by the render loop)
+ */
+typedef struct scpiServer_t {
+    int                     listenFd;
+    int                     epollFd;
+    int                     wakeFd;             /// eventfd used to stop the loop
+    char                    path[108];
+    pthread_t               thread;
+    volatile uint8_t        running;
+    const sampleStore_t *   stores[SC_MAX_CHANNELS];
+    search_t *              search;             /// Event index for SEARch commands, may be NULL
+    double                  sampleRate;
+    uint32_t                recordLength;       /// Default measurement window
+    scSettings_t            settings;
+    volatile uint64_t       seq;                /// Odd while settings are being written
+    scClient_t              clients[SC_MAX_CLIENTS];
+} scpiServer_t;
+
+/**
+ * @brief Bind the socket and start the server thread.
+ *
+ * @param[out] srv           Pointer to a server pointer. Will be allocated inside.
+ * @param[in]  path          Socket path; a stale socket file there is replaced.
+ * @param[in]  sampleRate    Samples/s, for FREQuency and the timebase.
+ * @param[in]  recordLength  Samples measured when a query gives no count.
+ *
+ * @return STATUS_OK on success, ERROR_INVALID_PARAMS or ERROR_UNKNOWN on failure.
+ */
+status_t createScpiServer(scpiServer_t **srv, const char *path, double sampleRate, uint32_t recordLength);
+
+/**
+ * @brief Stop the thread, close every client, unlink the socket and set the pointer to NULL.
+ */
+void destroyScpiServer(scpiServer_t **srv);
+
+/**
+ * @brief Expose a sample store as channel ch (NULL detaches it).
+ */
+void scAttach(scpiServer_t *srv, uint8_t ch, const sampleStore_t *ss);
+
+/**
+ * @brief Serve SEARch commands from sr (NULL detaches it).
+ */
+void scAttachSearch(scpiServer_t *srv, search_t *sr);
+
+/**
+ * @brief Consistent snapshot of the remote settings; never blocks.
+ */
+void scGetSettings(const scpiServer_t *srv, scSettings_t *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
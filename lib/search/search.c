@@ -0,0 +1,532 @@
+#include "search.h"
+
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+
+#include "../../include/global.h"
+
+/// Crossing record: position << 2 | level (0 = lo, 1 = hi) << 1 | upwards
+#define srCrossing(pos, level, up)  (((uint64_t)(pos) << 2) | ((level) << 1) | (up))
+#define SR_CROSS_PER_BUF    (2 * SR_CHUNK)
+
+typedef enum srZone_t {
+    SR_ZONE_UNKNOWN = 0,                        /// Between the thresholds since the scan started
+    SR_ZONE_LOW,
+    SR_ZONE_HIGH,
+} srZone_t;
+
+typedef struct srScanJob_t {
+    search_t *      sr;
+    uint64_t        start;                      /// First sample of the round
+    uint64_t        end;
+    uint8_t         prevBits;                   /// Threshold bits of sample start - 1
+    uint32_t        n[SR_MAX_BUFS];             /// Crossings found per chunk
+    uint8_t         lastBits[SR_MAX_BUFS];      /// Threshold bits of each chunk's last sample
+} srScanJob_t;
+
+static inline uint8_t srBits(float v, float lo, float hi){
+    return (uint8_t)((v >= lo) | ((v >= hi) << 1));
+}
+
+/// INDEX /////////////////////////////////////////////////////////////////////////////////////////
+
+/// Grow *p to hold need elements, doubling
+static uint8_t srGrow(void **p, size_t *cap, size_t need, size_t elem){
+    if(need <= *cap) return 1;
+    size_t size = __max(need, __max((size_t)256, *cap * 2));
+    void  *q    = mpAlloc(size * elem);
+    if(__is_null(q)) return 0;
+    if(*cap) memcpy(q, *p, *cap * elem);
+    mpFree(*p);
+    *p   = q;
+    *cap = size;
+    return 1;
+}
+
+static inline uint8_t *srPutVarint(uint8_t *p, uint64_t v){
+    while(v >= 0x80){
+        *p++ = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    *p++ = (uint8_t)v;
+    return p;
+}
+
+static inline const uint8_t *srGetVarint(const uint8_t *p, uint64_t *v){
+    uint64_t r = 0;
+    uint32_t s = 0;
+    while(*p & 0x80){
+        r |= (uint64_t)(*p++ & 0x7F) << s;
+        s += 7;
+    }
+    *v = r | ((uint64_t)*p++ << s);
+    return p;
+}
+
+/// Append an event; positions never decrease. Call with lock held.
+static void srAppend(search_t *sr, uint64_t pos, uint64_t width, uint8_t negative){
+    uint64_t live = sr->count - sr->base;
+    if(live % SR_BLOCK == 0){
+        uint32_t capBlocks = sr->capBlocks;
+        size_t   cap = capBlocks;
+        if(!srGrow((void **)&sr->blocks, &cap, sr->nBlocks + 1, sizeof(srBlock_t))) return;
+        sr->capBlocks = (uint32_t)cap;
+        sr->blocks[sr->nBlocks].first  = pos;
+        sr->blocks[sr->nBlocks].offset = sr->bytes;
+        sr->nBlocks++;
+        sr->lastPos = pos;
+    }
+    if(!srGrow((void **)&sr->data, &sr->capBytes, sr->bytes + 20, 1)) return;
+    uint8_t *p = sr->data + sr->bytes;
+    p = srPutVarint(p, pos - sr->lastPos);
+    p = srPutVarint(p, (width << 1) | negative);
+    sr->bytes   = (size_t)(p - sr->data);
+    sr->lastPos = pos;
+    sr->count++;
+}
+
+/// Drop blocks that end before oldest. Call with lock held.
+static void srTrim(search_t *sr, uint64_t oldest){
+    while(sr->head + 1 < sr->nBlocks && sr->blocks[sr->head + 1].first <= oldest){
+        sr->head++;
+        sr->base += SR_BLOCK;
+    }
+    /// Compact once the dead half outweighs the live one
+    if(sr->head == 0 || sr->head < sr->nBlocks - sr->head) return;
+    size_t   cut  = sr->blocks[sr->head].offset;
+    uint32_t live = sr->nBlocks - sr->head;
+    memmove(sr->data, sr->data + cut, sr->bytes - cut);
+    memmove(sr->blocks, sr->blocks + sr->head, sizeof(srBlock_t) * live);
+    REPTT(uint32_t, k, 0, live) sr->blocks[k].offset -= cut;
+    sr->bytes  -= cut;
+    sr->nBlocks = live;
+    sr->head    = 0;
+}
+
+static void srClear(search_t *sr){
+    sr->bytes   = 0;
+    sr->head    = 0;
+    sr->nBlocks = 0;
+    sr->base    = 0;
+    sr->count   = 0;
+    sr->lastPos = 0;
+}
+
+/// Decode block k into out (SR_BLOCK entries). Call with lock held.
+static uint32_t srDecode(const search_t *sr, uint32_t k, srEvent_t *out){
+    uint64_t live = sr->count - sr->base;
+    uint32_t n    = (k + 1 < sr->nBlocks) ? SR_BLOCK : (uint32_t)(live - (uint64_t)(k - sr->head) * SR_BLOCK);
+    uint64_t pos  = sr->blocks[k].first;
+    const uint8_t *p = sr->data + sr->blocks[k].offset;
+    REPTT(uint32_t, i, 0, n){
+        uint64_t delta, w;
+        p = srGetVarint(p, &delta);
+        p = srGetVarint(p, &w);
+        pos += delta;
+        out[i].index    = sr->base + (uint64_t)(k - sr->head) * SR_BLOCK + i;
+        out[i].pos      = pos;
+        out[i].width    = w >> 1;
+        out[i].negative = (uint8_t)(w & 1);
+    }
+    return n;
+}
+
+/// Last live block whose first event is before pos (inclusive: <= pos), head - 1 if none
+static int64_t srFindBlock(const search_t *sr, uint64_t pos, uint8_t inclusive){
+    int64_t lo = sr->head, hi = (int64_t)sr->nBlocks - 1, k = (int64_t)sr->head - 1;
+    while(lo <= hi){
+        int64_t  mid = (lo + hi) / 2;
+        uint64_t f   = sr->blocks[mid].first;
+        if(f < pos || (inclusive && f == pos)){
+            k  = mid;
+            lo = mid + 1;
+        }else{
+            hi = mid - 1;
+        }
+    }
+    return k;
+}
+
+/// SCANNER ///////////////////////////////////////////////////////////////////////////////////////
+
+/// Crossings between consecutive samples, in order; a jump over both thresholds gives two
+static inline void srEmitCrossings(uint64_t pos, uint8_t prev, uint8_t cur, uint64_t *out, uint32_t *n){
+    uint8_t ch = prev ^ cur;
+    if(cur & ch){
+        if(ch & 1) out[(*n)++] = srCrossing(pos, 0, 1);
+        if(ch & 2) out[(*n)++] = srCrossing(pos, 1, 1);
+    }else{
+        if(ch & 2) out[(*n)++] = srCrossing(pos, 1, 0);
+        if(ch & 1) out[(*n)++] = srCrossing(pos, 0, 0);
+    }
+}
+
+static void srScanRegion(const float *p, uint32_t n, uint64_t pos, float lo, float hi, uint8_t *prev, uint64_t *out, uint32_t *nOut){
+    uint8_t  last = *prev;
+    uint32_t i = 0;
+#if defined(__SSE__)
+    const __m128 vlo = _mm_set1_ps(lo), vhi = _mm_set1_ps(hi);
+    for(; i + 4 <= n; i += 4){
+        __m128   v   = _mm_loadu_ps(p + i);
+        uint32_t mlo = (uint32_t)_mm_movemask_ps(_mm_cmpge_ps(v, vlo));
+        uint32_t mhi = (uint32_t)_mm_movemask_ps(_mm_cmpge_ps(v, vhi));
+        /// Each lane against the previous sample; the common case is no change at all
+        uint32_t plo = ((mlo << 1) | (last & 1)) & 15, phi = ((mhi << 1) | (last >> 1)) & 15;
+        uint32_t ch  = (mlo ^ plo) | (mhi ^ phi);
+        while(ch){
+            uint32_t j   = __builtin_ctz(ch);
+            uint8_t  was = (uint8_t)(((plo >> j) & 1) | (((phi >> j) & 1) << 1));
+            uint8_t  cur = (uint8_t)(((mlo >> j) & 1) | (((mhi >> j) & 1) << 1));
+            srEmitCrossings(pos + i + j, was, cur, out, nOut);
+            ch &= ch - 1;
+        }
+        last = (uint8_t)(((mlo >> 3) & 1) | (((mhi >> 3) & 1) << 1));
+    }
+#endif
+    for(; i < n; ++i){
+        uint8_t cur = srBits(p[i], lo, hi);
+        if(cur != last) srEmitCrossings(pos + i, last, cur, out, nOut);
+        last = cur;
+    }
+    *prev = last;
+}
+
+static void srScanChunk(void *ctx, uint32_t chunk){
+    srScanJob_t    *job = (srScanJob_t *)ctx;
+    const search_t *sr  = job->sr;
+    const float     lo  = sr->active.lo, hi = sr->active.hi;
+    uint64_t       *out = sr->cross + (size_t)chunk * SR_CROSS_PER_BUF;
+    uint64_t        a   = job->start + (uint64_t)chunk * SR_CHUNK, b = __min(job->end, a + SR_CHUNK);
+    uint8_t         prev = job->prevBits;
+    uint32_t        n    = 0;
+    ssSpan_t        span;
+    /// Later chunks start one sample early for their predecessor's threshold bits
+    uint64_t from = (chunk == 0) ? a : a - 1;
+    uint32_t got  = ssGetSpan(sr->src, from, (uint32_t)(b - from), &span);
+    uint64_t pos  = b - got;                    /// Clipped at the front if the producer lapped us
+    uint8_t  seed = (chunk != 0);
+    REPTT(uint8_t, k, 0, 2){
+        const float *p = span.p[k];
+        uint32_t     m = span.n[k];
+        if(m == 0) continue;
+        if(seed){
+            seed = 0;
+            prev = srBits(p[0], lo, hi);
+            ++p;
+            --m;
+            ++pos;
+        }
+        srScanRegion(p, m, pos, lo, hi, &prev, out, &n);
+        pos += m;
+    }
+    job->n[chunk]        = n;
+    job->lastBits[chunk] = prev;
+}
+
+static inline uint8_t srWants(const srQuery_t *q, uint8_t negative, uint64_t width){
+    if(q->polarity != SR_EITHER && (q->polarity == SR_NEGATIVE) != negative) return 0;
+    if(q->widthCmp == SR_WIDTH_LESS) return width < q->width;
+    if(q->widthCmp == SR_WIDTH_MORE) return width > q->width;
+    return 1;
+}
+
+static void srEdge(search_t *sr, uint64_t pos, uint8_t falling){
+    const srQuery_t *q = &sr->active;
+    if(q->kind == SR_EDGE && srWants(q, falling, 0)) srAppend(sr, pos, 0, falling);
+    /// A rising edge ends a low pulse and vice versa
+    if(q->kind == SR_PULSE && sr->haveEdge && srWants(q, !falling, pos - sr->lastEdge)){
+        srAppend(sr, sr->lastEdge, pos - sr->lastEdge, !falling);
+    }
+    sr->lastEdge = pos;
+    sr->haveEdge = 1;
+}
+
+static void srRunt(search_t *sr, uint64_t end, uint8_t highSide){
+    const srQuery_t *q = &sr->active;
+    if(q->kind == SR_RUNT && srWants(q, highSide, end - sr->runtStart)) srAppend(sr, sr->runtStart, end - sr->runtStart, highSide);
+    sr->armed = 0;
+}
+
+/// Hysteresis / pulse / runt state machine over one crossing. Call with lock held.
+static void srFeed(search_t *sr, uint64_t x){
+    uint64_t pos = x >> 2;
+    uint8_t  hiLevel = (uint8_t)((x >> 1) & 1), up = (uint8_t)(x & 1);
+    switch(sr->zone){
+        case SR_ZONE_UNKNOWN:
+            if(hiLevel && up)        sr->zone = SR_ZONE_HIGH;
+            else if(!hiLevel && !up) sr->zone = SR_ZONE_LOW;
+            break;
+        case SR_ZONE_LOW:
+            if(!hiLevel){
+                if(up){
+                    sr->armed     = 1;
+                    sr->runtStart = pos;
+                }else if(sr->armed){
+                    srRunt(sr, pos, 0);
+                }
+            }else if(up){
+                sr->zone  = SR_ZONE_HIGH;
+                sr->armed = 0;
+                srEdge(sr, pos, 0);
+            }
+            break;
+        default:
+            if(hiLevel){
+                if(!up){
+                    sr->armed     = 1;
+                    sr->runtStart = pos;
+                }else if(sr->armed){
+                    srRunt(sr, pos, 1);
+                }
+            }else if(!up){
+                sr->zone  = SR_ZONE_LOW;
+                sr->armed = 0;
+                srEdge(sr, pos, 1);
+            }
+            break;
+    }
+}
+
+/// Continuity lost (start, or the producer lapped the scan): restart the state machine
+static void srRestart(search_t *sr){
+    sr->havePrev = 0;
+    sr->zone     = SR_ZONE_UNKNOWN;
+    sr->armed    = 0;
+    sr->haveEdge = 0;
+}
+
+/// API ///////////////////////////////////////////////////////////////////////////////////////////
+
+status_t createSearch(search_t **sr, workerPool_t *wp){
+    __entry("createSearch(%p, %p)", sr, wp);
+    if(__is_null(sr)){
+        __err("[createSearch] Invalid params!");
+        return ERROR_INVALID_PARAMS;
+    }
+    *sr = (search_t *) mpCalloc(1, sizeof(search_t));
+    if(__is_null(*sr)){
+        __err("[createSearch] malloc failed!");
+        return ERROR_UNKNOWN;
+    }
+    search_t *s = *sr;
+    s->wp    = wp;
+    s->nBufs = (wp && wp->nThreads) ? __min(2 * (wp->nThreads + 1), (uint32_t)SR_MAX_BUFS) : 1;
+    if(mpLargeAlloc(&s->crossMem, sizeof(uint64_t) * SR_CROSS_PER_BUF * s->nBufs, MP_NODE_LOCAL) != STATUS_OK){
+        __err("[createSearch] mpLargeAlloc(%u buffers) failed!", s->nBufs);
+        mpFree(s);
+        *sr = NULL;
+        return ERROR_UNKNOWN;
+    }
+    s->cross = (uint64_t *) s->crossMem.p;
+    pthread_mutex_init(&s->lock, NULL);
+    __exit("createSearch()");
+    return STATUS_OK;
+}
+
+void destroySearch(search_t **sr){
+    if(__is_null(sr) || __is_null(*sr)) return;
+    search_t *s = *sr;
+    pthread_mutex_destroy(&s->lock);
+    mpLargeFree(&s->crossMem);
+    mpFree(s->data);
+    mpFree(s->blocks);
+    mpFree(s);
+    *sr = NULL;
+}
+
+void srSetQuery(search_t *sr, const sampleStore_t *ss, const srQuery_t *q){
+    if(__is_null(sr) || __is_null(q)) return;
+    pthread_mutex_lock(&sr->lock);
+    sr->ss    = ss;
+    sr->query = *q;
+    if(sr->query.hi < sr->query.lo) sr->query.hi = sr->query.lo;
+    sr->dirty = 1;
+    pthread_mutex_unlock(&sr->lock);
+}
+
+uint64_t srUpdate(search_t *sr){
+    if(__is_null(sr)) return 0;
+    pthread_mutex_lock(&sr->lock);
+    if(sr->dirty){
+        sr->dirty   = 0;
+        sr->src     = sr->ss;
+        sr->active  = sr->query;
+        sr->next    = 0;
+        sr->scanned = 0;
+        srClear(sr);
+        srRestart(sr);
+    }
+    pthread_mutex_unlock(&sr->lock);
+    if(__is_null(sr->src)) return 0;
+
+    const uint64_t before = sr->count;
+    const uint64_t end    = ssWritten(sr->src);
+    const uint64_t oldest = ssOldest(sr->src);
+    if(sr->next < oldest){
+        sr->next = oldest;
+        srRestart(sr);
+    }
+    pthread_mutex_lock(&sr->lock);
+    srTrim(sr, oldest);
+    pthread_mutex_unlock(&sr->lock);
+    while(sr->next < end){
+        if(!sr->havePrev){
+            float v;
+            if(ssRead(sr->src, sr->next, 1, &v) != 1) break;
+            sr->prevBits = srBits(v, sr->active.lo, sr->active.hi);
+            sr->zone     = (sr->prevBits == 3) ? SR_ZONE_HIGH : (sr->prevBits == 0) ? SR_ZONE_LOW : SR_ZONE_UNKNOWN;
+            sr->havePrev = 1;
+            sr->next++;
+            sr->scanned++;
+            if(sr->next >= end) break;
+        }
+        uint64_t    left   = end - sr->next;
+        uint32_t    chunks = (uint32_t)__min((uint64_t)sr->nBufs, (left + SR_CHUNK - 1) / SR_CHUNK);
+        srScanJob_t job;
+        job.sr       = sr;
+        job.start    = sr->next;
+        job.end      = __min(end, sr->next + (uint64_t)chunks * SR_CHUNK);
+        job.prevBits = sr->prevBits;
+        wpRun(sr->wp, srScanChunk, &job, chunks);
+
+        /// The producer lapped the round: its samples may have been overwritten while
+        /// being read, so drop it and start over, state reset, at the oldest sample
+        const uint64_t lapped = ssOldest(sr->src);
+        if(lapped > job.start){
+            sr->next = lapped;
+            srRestart(sr);
+            pthread_mutex_lock(&sr->lock);
+            srTrim(sr, lapped);
+            pthread_mutex_unlock(&sr->lock);
+            continue;
+        }
+        pthread_mutex_lock(&sr->lock);
+        REPTT(uint32_t, c, 0, chunks){
+            const uint64_t *x = sr->cross + (size_t)c * SR_CROSS_PER_BUF;
+            REPTT(uint32_t, i, 0, job.n[c]) srFeed(sr, x[i]);
+        }
+        pthread_mutex_unlock(&sr->lock);
+        sr->prevBits = job.lastBits[chunks - 1];
+        sr->scanned += job.end - sr->next;
+        sr->next     = job.end;
+    }
+    return sr->count - before;
+}
+
+uint64_t srCount(search_t *sr){
+    if(__is_null(sr)) return 0;
+    pthread_mutex_lock(&sr->lock);
+    uint64_t n = sr->count;
+    pthread_mutex_unlock(&sr->lock);
+    return n;
+}
+
+uint8_t srNext(search_t *sr, uint64_t pos, srEvent_t *ev){
+    if(__is_null(sr) || __is_null(ev)) return 0;
+    srEvent_t buf[SR_BLOCK];
+    uint8_t   found = 0;
+    pthread_mutex_lock(&sr->lock);
+    if(sr->head < sr->nBlocks){
+        int64_t k = __max((int64_t)sr->head, srFindBlock(sr, pos, 1));
+        for(; k < (int64_t)sr->nBlocks && !found; ++k){
+            uint32_t n = srDecode(sr, (uint32_t)k, buf);
+            REPTT(uint32_t, i, 0, n){
+                if(buf[i].pos > pos){
+                    *ev   = buf[i];
+                    found = 1;
+                    break;
+                }
+            }
+        }
+    }
+    pthread_mutex_unlock(&sr->lock);
+    return found;
+}
+
+uint8_t srPrev(search_t *sr, uint64_t pos, srEvent_t *ev){
+    if(__is_null(sr) || __is_null(ev)) return 0;
+    srEvent_t buf[SR_BLOCK];
+    uint8_t   found = 0;
+    pthread_mutex_lock(&sr->lock);
+    int64_t k = srFindBlock(sr, pos, 0);
+    if(k >= (int64_t)sr->head){
+        uint32_t n = srDecode(sr, (uint32_t)k, buf);
+        while(n-- > 0){
+            if(buf[n].pos < pos){
+                *ev   = buf[n];
+                found = 1;
+                break;
+            }
+        }
+    }
+    pthread_mutex_unlock(&sr->lock);
+    return found;
+}
+
+uint32_t srList(search_t *sr, uint64_t first, srEvent_t *out, uint32_t max){
+    if(__is_null(sr) || __is_null(out) || max == 0) return 0;
+    srEvent_t buf[SR_BLOCK];
+    uint32_t  got = 0;
+    pthread_mutex_lock(&sr->lock);
+    first = __max(first, sr->base);
+    for(uint64_t k = sr->head + (first - sr->base) / SR_BLOCK; k < sr->nBlocks && got < max; ++k){
+        uint32_t n = srDecode(sr, (uint32_t)k, buf);
+        REPTT(uint32_t, i, 0, n){
+            if(buf[i].index < first) continue;
+            if(got == max) break;
+            out[got++] = buf[i];
+        }
+    }
+    pthread_mutex_unlock(&sr->lock);
+    return got;
+}
+
+/// PACKETS ///////////////////////////////////////////////////////////////////////////////////////
+
+static uint8_t srPacketMatch(const pdAnnotation_t *a, const srPacketQuery_t *q){
+    return (q->kind < 0 || a->kind == (uint8_t)q->kind) &&
+           (q->row  < 0 || a->row  == (uint8_t)q->row) &&
+           ((a->value ^ q->value) & q->valueMask) == 0;
+}
+
+static void srPacketEvent(const pdDecoder_t *d, uint32_t i, const pdAnnotation_t *a, srEvent_t *ev){
+    ev->index    = d->packets - d->annCount + i;
+    ev->pos      = a->start;
+    ev->width    = a->end - a->start;
+    ev->negative = 0;
+}
+
+/// First retained annotation starting after pos
+static uint32_t srPacketAfter(const pdDecoder_t *d, uint64_t pos){
+    uint32_t lo = 0, hi = d->annCount;
+    while(lo < hi){
+        uint32_t mid = (lo + hi) / 2;
+        if(pdAnnotationAt(d, mid)->start <= pos) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+uint8_t srNextPacket(const pdDecoder_t *d, const srPacketQuery_t *q, uint64_t pos, srEvent_t *ev){
+    if(__is_null(d) || __is_null(q) || __is_null(ev)) return 0;
+    for(uint32_t i = srPacketAfter(d, pos); i < d->annCount; ++i){
+        const pdAnnotation_t *a = pdAnnotationAt(d, i);
+        if(!srPacketMatch(a, q)) continue;
+        srPacketEvent(d, i, a, ev);
+        return 1;
+    }
+    return 0;
+}
+
+uint8_t srPrevPacket(const pdDecoder_t *d, const srPacketQuery_t *q, uint64_t pos, srEvent_t *ev){
+    if(__is_null(d) || __is_null(q) || __is_null(ev)) return 0;
+    /// Everything before the first annotation starting at or after pos
+    for(uint32_t i = (pos > 0) ? srPacketAfter(d, pos - 1) : 0; i-- > 0;){
+        const pdAnnotation_t *a = pdAnnotationAt(d, i);
+        if(!srPacketMatch(a, q)) continue;
+        srPacketEvent(d, i, a, ev);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,207 @@
+#ifndef __SEARCH_H__
+#define __SEARCH_H__
+
+#ifdef LOG_HEADER_INCLUDE
+#pragma message("INCLUDE: search.h")
+#endif
+
+#include <stdint.h>
+#include <pthread.h>
+
+#include "../windowContext/windowContext.h"
+#include "../memPool/memPool.h"
+#include "../sampleStore/sampleStore.h"
+#include "../workerPool/workerPool.h"
+#include "../protoDecode/protoDecode.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SR_CHUNK            32768               /// Samples per scan chunk
+#define SR_MAX_BUFS         64                  /// Chunks scanned per round, at most
+#define SR_BLOCK            64                  /// Events per index block
+
+typedef enum srKind_t {
+    SR_EDGE = 0,                                /// Crossing of hi upwards / lo downwards
+    SR_PULSE,                                   /// Edge to opposite edge, filtered by width
+    SR_RUNT,                                    /// Crosses one threshold and returns without crossing the other
+} srKind_t;
+
+typedef enum srPolarity_t {
+    SR_POSITIVE = 0,                            /// Rising edges, high pulses, low-side runts
+    SR_NEGATIVE,                                /// Falling edges, low pulses, high-side runts
+    SR_EITHER,
+} srPolarity_t;
+
+typedef enum srWidthCmp_t {
+    SR_WIDTH_ANY = 0,
+    SR_WIDTH_LESS,                              /// Narrower than width
+    SR_WIDTH_MORE,                              /// Wider than width
+} srWidthCmp_t;
+
+/**
+ * @brief What to look for. lo / hi are the hysteresis thresholds (lo == hi
+ * for none); the signal is high after crossing hi and low after crossing lo.
+ */
+typedef struct srQuery_t {
+    srKind_t        kind;
+    srPolarity_t    polarity;
+    float           lo;
+    float           hi;
+    srWidthCmp_t    widthCmp;                   /// SR_PULSE and SR_RUNT
+    uint64_t        width;                      /// Samples
+} srQuery_t;
+
+typedef struct srEvent_t {
+    uint64_t        index;                      /// Running number since the last query change
+    uint64_t        pos;                        /// Sample index: the edge, or the start of the pulse / runt
+    uint64_t        width;                      /// Samples, 0 for edges
+    uint8_t         negative;                   /// Falling edge, low pulse or high-side runt
+} srEvent_t;
+
+/**
+ * @brief Match on decoded packets: annotations of a protocol decoder.
+ */
+typedef struct srPacketQuery_t {
+    int8_t          kind;                       /// pdAnnKind_t, -1 = any
+    int8_t          row;                        /// Bar row (e.g. SPI MISO = 1), -1 = any
+    uint16_t        value;                      /// Required value of the bits in valueMask
+    uint16_t        valueMask;                  /// 0 = any value
+} srPacketQuery_t;
+
+typedef struct srBlock_t {
+    uint64_t        first;                      /// Position of the block's first event
+    size_t          offset;                     /// Its byte offset in data
+} srBlock_t;
+
+/**
+ * @brief Event search over a whole sample store, kept up to date incrementally.
+ *
+ * srUpdate() scans the samples written since the last call: the range is cut
+ * into SR_CHUNK pieces that the worker pool scans in parallel, four samples
+ * per SSE compare, for crossings of lo and hi. Only crossings come out of the
+ * parallel pass; one sequential pass over them runs the hysteresis / pulse /
+ * runt state machine, so the result is the same as a sample-by-sample scan.
+ *
+ * Matches go to a sorted index of delta-encoded varints, SR_BLOCK events per
+ * block with the block's absolute position on the side: next / previous is a
+ * binary search plus at most one block decode. Blocks that fall behind the
+ * store's oldest sample are dropped, and a scan round the producer laps is
+ * discarded and restarted, with fresh state, from the oldest sample. The index is guarded by a mutex, so any
+ * thread can navigate while one thread updates.
+ */
+typedef struct search_t {
+    pthread_mutex_t         lock;
+    workerPool_t *          wp;
+    const sampleStore_t *   ss;                 /// Requested source and query (lock)
+    srQuery_t               query;
+    uint8_t                 dirty;              /// Source or query changed (lock)
+
+    /// Index (lock)
+    uint8_t *               data;
+    size_t                  bytes;
+    size_t                  capBytes;
+    srBlock_t *             blocks;
+    uint32_t                head;               /// First live block
+    uint32_t                nBlocks;
+    uint32_t                capBlocks;
+    uint64_t                base;               /// Index of blocks[head]'s first event
+    uint64_t                count;              /// Events found since the last change
+    uint64_t                lastPos;
+
+    /// Scanner (updating thread only)
+    const sampleStore_t *   src;
+    srQuery_t               active;
+    uint64_t                next;               /// Next sample to scan
+    uint8_t                 havePrev;           /// prevBits holds sample next - 1
+    uint8_t                 prevBits;           /// bit 0: >= lo, bit 1: >= hi
+    uint8_t                 zone;               /// srZone_t
+    uint8_t                 armed;              /// Runt candidate open
+    uint8_t                 haveEdge;           /// lastEdge is valid
+    uint64_t                runtStart;
+    uint64_t                lastEdge;
+    uint64_t *              cross;              /// SR_MAX_BUFS x 2 * SR_CHUNK crossings
+    mpLarge_t               crossMem;
+    uint32_t                nBufs;
+    uint64_t                scanned;            /// Samples scanned since the last change
+} search_t;
+
+/**
+ * @brief Create an empty search.
+ *
+ * @param[in] wp   Worker pool to scan with, NULL = calling thread only.
+ *
+ * @return STATUS_OK on success, ERROR_INVALID_PARAMS or ERROR_UNKNOWN on failure.
+ */
+status_t createSearch(search_t **sr, workerPool_t *wp);
+
+/**
+ * @brief Destroy a search and set the pointer to NULL.
+ */
+void destroySearch(search_t **sr);
+
+/**
+ * @brief Search ss for q. The index is cleared and rebuilt by the next srUpdate().
+ *
+ * Any thread. ss may be NULL to stop searching.
+ */
+void srSetQuery(search_t *sr, const sampleStore_t *ss, const srQuery_t *q);
+
+/**
+ * @brief Scan everything written since the last call (one thread only).
+ *
+ * @return Events added.
+ */
+uint64_t srUpdate(search_t *sr);
+
+/**
+ * @brief Events found since the last query change, trimmed ones included.
+ */
+uint64_t srCount(search_t *sr);
+
+/**
+ * @brief First event after pos.
+ *
+ * @return 1 if found.
+ */
+uint8_t srNext(search_t *sr, uint64_t pos, srEvent_t *ev);
+
+/**
+ * @brief Last event before pos.
+ *
+ * @return 1 if found.
+ */
+uint8_t srPrev(search_t *sr, uint64_t pos, srEvent_t *ev);
+
+/**
+ * @brief Copy up to max events starting at running number first (clamped to the oldest kept).
+ *
+ * @return Events copied.
+ */
+uint32_t srList(search_t *sr, uint64_t first, srEvent_t *out, uint32_t max);
+
+/**
+ * @brief First annotation of d starting after pos that matches q.
+ *
+ * Decoders emit annotations in order, so the retained ring is searched in
+ * place: a binary search to pos, then a scan. There is no index to keep up
+ * to date. ev->index is the annotation's running number since pdReset(),
+ * ev->width its length in samples. Call from the thread that feeds d.
+ *
+ * @return 1 if found.
+ */
+uint8_t srNextPacket(const pdDecoder_t *d, const srPacketQuery_t *q, uint64_t pos, srEvent_t *ev);
+
+/**
+ * @brief Last annotation of d starting before pos that matches q, as srNextPacket().
+ *
+ * @return 1 if found.
+ */
+uint8_t srPrevPacket(const pdDecoder_t *d, const srPacketQuery_t *q, uint64_t pos, srEvent_t *ev);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
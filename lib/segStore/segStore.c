@@ -0,0 +1,251 @@
+#include "segStore.h"
+
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+
+#include "../../include/global.h"
+
+#define segSlot(seg, s)     ((seg)->buff + (size_t)(s) * (seg)->segLen)
+
+/// Index of the first sample that completes a crossing of `level`, or n
+static uint32_t segFindCrossing(const float *in, uint32_t n, float prev, float level, uint8_t rising){
+    if(n == 0) return 0;
+    if(rising ? (prev < level && in[0] >= level) : (prev > level && in[0] <= level)) return 0;
+    uint32_t i = 1;
+#if defined(__SSE__)
+    const __m128 vl = _mm_set1_ps(level);
+    for(; i + 4 <= n; i += 4){
+        __m128 cur = _mm_loadu_ps(in + i), old = _mm_loadu_ps(in + i - 1);
+        __m128 hit = rising ? _mm_and_ps(_mm_cmplt_ps(old, vl), _mm_cmpge_ps(cur, vl))
+                            : _mm_and_ps(_mm_cmpgt_ps(old, vl), _mm_cmple_ps(cur, vl));
+        int m = _mm_movemask_ps(hit);
+        if(m) return i + (uint32_t)__builtin_ctz((unsigned)m);
+    }
+#endif
+    for(; i < n; ++i){
+        if(rising ? (in[i - 1] < level && in[i] >= level) : (in[i - 1] > level && in[i] <= level)) return i;
+    }
+    return n;
+}
+
+/// Append to a pre ring, a slot's or preScratch (at most `pre` samples survive)
+static void segPreWrite(segStore_t *seg, float *ring, const float *in, uint32_t n){
+    if(seg->pre == 0 || n == 0) return;
+    if(n > seg->pre){
+        in += n - seg->pre;
+        n   = seg->pre;
+    }
+    uint32_t first = __min(n, seg->pre - seg->preHead);
+    memcpy(ring + seg->preHead, in, sizeof(float) * first);
+    memcpy(ring, in + first, sizeof(float) * (n - first));
+    seg->preHead  = (seg->preHead + n) % seg->pre;
+    seg->preValid = __min(seg->pre, seg->preValid + n);
+}
+
+static uint32_t segNextSlot(const segStore_t *seg){
+    return (seg->slot + 1) % seg->nSegments;
+}
+
+status_t createSegStore(segStore_t **seg, uint32_t nSegments, uint32_t pre, uint32_t post, double dt){
+    __entry("createSegStore(%p, %u, %u, %u, %g)", seg, nSegments, pre, post, dt);
+    if(__is_null(seg) || nSegments == 0 || nSegments > SEG_MAX_SEGMENTS || post == 0 || !(dt > 0.0)){
+        __err("[createSegStore] Invalid params!");
+        return ERROR_INVALID_PARAMS;
+    }
+    *seg = (segStore_t *) mpAlloc(sizeof(segStore_t));
+    if(__is_null(*seg)){
+        __err("[createSegStore] malloc failed!");
+        return ERROR_UNKNOWN;
+    }
+    memset(*seg, 0, sizeof(segStore_t));
+    (*seg)->nSegments = nSegments;
+    (*seg)->pre       = pre;
+    (*seg)->post      = post;
+    (*seg)->segLen    = pre + post;
+    (*seg)->dt        = dt;
+    (*seg)->rising    = 1;
+    (*seg)->info = (segInfo_t *) mpCalloc(nSegments, sizeof(segInfo_t));
+    (*seg)->preScratch = (float *) mpAlloc(sizeof(float) * __max(pre, 1U));
+    if(mpLargeAlloc(&(*seg)->mem, sizeof(float) * (size_t)nSegments * (*seg)->segLen, MP_NODE_LOCAL) == STATUS_OK){
+        (*seg)->buff = (float *) (*seg)->mem.p;
+    }
+    if(__is_null((*seg)->buff) || __is_null((*seg)->info) || __is_null((*seg)->preScratch)){
+        __err("[createSegStore] malloc(%u x %u samples) failed!", nSegments, (*seg)->segLen);
+        destroySegStore(seg);
+        return ERROR_UNKNOWN;
+    }
+    segArm(*seg);
+    __exit("createSegStore()");
+    return STATUS_OK;
+}
+
+void destroySegStore(segStore_t **seg){
+    if(__is_null(seg) || __is_null(*seg)) return;
+    mpLargeFree(&(*seg)->mem);
+    mpFree((*seg)->info);
+    mpFree((*seg)->preScratch);
+    mpFree(*seg);
+    *seg = NULL;
+}
+
+void segSetWrap(segStore_t *seg, uint8_t wrap){
+    if(__is_null(seg)) return;
+    seg->wrap = (wrap && seg->nSegments > 1) ? 1 : 0;
+}
+
+void segSetTrigger(segStore_t *seg, float level, uint8_t rising){
+    if(__is_null(seg)) return;
+    seg->level  = level;
+    seg->rising = rising ? 1 : 0;
+}
+
+void segArm(segStore_t *seg){
+    if(__is_null(seg)) return;
+    seg->state    = SEG_ARMED;
+    seg->slot     = 0;
+    seg->count    = 0;
+    seg->preHead  = 0;
+    seg->preValid = 0;
+    seg->postFill = 0;
+    seg->last     = seg->rising ? INFINITY : -INFINITY;    /// No crossing on the very first sample
+}
+
+uint32_t segFeed(segStore_t *seg, const float *in, uint32_t n){
+    if(__is_null(seg) || __is_null(in)) return 0;
+    uint32_t done = 0;
+
+    while(n > 0 && seg->state != SEG_STOPPED){
+        if(seg->state == SEG_ARMED){
+            uint32_t k = segFindCrossing(in, n, seg->last, seg->level, seg->rising);
+            segPreWrite(seg, segSlot(seg, seg->slot), in, k);
+            if(k == n){
+                seg->last  = in[n - 1];
+                seg->seen += n;
+                return done;
+            }
+            /// Trigger: freeze the pre ring where it is, no samples move
+            float prev = (k > 0) ? in[k - 1] : seg->last;
+            segInfo_t *info = &seg->info[seg->slot];
+            struct timespec ts;
+            clock_gettime(CLOCK_MONOTONIC, &ts);
+            info->trigIndex = seg->seen + k;
+            info->trigFrac  = (in[k] != prev) ? (seg->level - prev) / (in[k] - prev) : 0.0f;
+            info->wallNs    = (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+            info->preHead   = seg->preHead;
+            info->preValid  = seg->preValid;
+
+            seg->state    = SEG_POST;
+            seg->postFill = 0;
+            seg->seen    += k;
+            in += k;
+            n  -= k;
+            /// The next slot starts collecting its own pre-trigger history right away
+            seg->preHead  = 0;
+            seg->preValid = 0;
+            continue;
+        }
+
+        /// SEG_POST
+        uint32_t m = __min(n, seg->post - seg->postFill);
+        memcpy(segSlot(seg, seg->slot) + seg->pre + seg->postFill, in, sizeof(float) * m);
+        /// Wrapping with every other slot retained, the next slot is the oldest segment: collect aside
+        uint8_t aside = seg->wrap && seg->count + 1 == seg->nSegments;
+        if(seg->wrap || seg->count + 1 < seg->nSegments){
+            segPreWrite(seg, aside ? seg->preScratch : segSlot(seg, segNextSlot(seg)), in, m);
+        }
+        seg->postFill += m;
+        seg->seen     += m;
+        seg->last      = in[m - 1];
+        in += m;
+        n  -= m;
+        if(seg->postFill < seg->post) break;
+
+        ++done;
+        ++seg->total;
+        /// When wrapping, the slot being refilled no longer counts as retained
+        if(seg->count < seg->nSegments - (seg->wrap ? 1U : 0U)) ++seg->count;
+        if(!seg->wrap && seg->count == seg->nSegments){
+            seg->state = SEG_STOPPED;
+            __log("[segFeed] %u segments captured, stopped", seg->count);
+            break;
+        }
+        seg->slot  = segNextSlot(seg);
+        seg->state = SEG_ARMED;
+        /// The slot has just dropped out of the retained ones: take over the history, same ring layout
+        if(aside) memcpy(segSlot(seg, seg->slot), seg->preScratch, sizeof(float) * seg->pre);
+    }
+    seg->seen += n;
+    return done;
+}
+
+/// Retained segments are the `count` slots just before the one being filled (or the last one filled)
+static uint32_t segSlotOf(const segStore_t *seg, uint32_t i){
+    uint32_t end = (seg->state == SEG_STOPPED) ? seg->slot + 1 : seg->slot;
+    return (end + seg->nSegments - seg->count + i) % seg->nSegments;
+}
+
+const segInfo_t *segInfoAt(const segStore_t *seg, uint32_t i){
+    if(__is_null(seg) || i >= seg->count) return NULL;
+    return &seg->info[segSlotOf(seg, i)];
+}
+
+double segTimeAt(const segStore_t *seg, uint32_t i){
+    const segInfo_t *info = segInfoAt(seg, i);
+    if(__is_null(info)) return 0.0;
+    return ((double)info->trigIndex - 1.0 + info->trigFrac) * seg->dt;
+}
+
+uint32_t segRead(const segStore_t *seg, uint32_t i, float *dst){
+    const segInfo_t *info = segInfoAt(seg, i);
+    if(__is_null(info) || __is_null(dst)) return 0;
+    const float *slot = segSlot(seg, segSlotOf(seg, i));
+
+    /// Pre ring: oldest valid sample first, zero padded in front when the history was short
+    uint32_t missing = seg->pre - info->preValid;
+    memset(dst, 0, sizeof(float) * missing);
+    uint32_t start = (info->preHead + seg->pre - info->preValid) % __max(seg->pre, 1U);
+    REPTT(uint32_t, k, 0, info->preValid) dst[missing + k] = slot[(start + k) % seg->pre];
+    memcpy(dst + seg->pre, slot + seg->pre, sizeof(float) * seg->post);
+    return seg->segLen;
+}
+
+void segRenderOverlay(rsTarget_t *t, const segStore_t *seg, uint32_t first, uint32_t count, float yMin, float yMax, color_t c){
+    if(__is_null(t) || __is_null(seg) || t->w <= 0 || first >= seg->count) return;
+    count = __min(count, seg->count - first);
+
+    mpArena_t *scratch = mpThreadArena();
+    size_t     mark    = mpArenaMark(scratch);
+    float     *vMin    = (float *) mpArenaAlloc(scratch, sizeof(float) * t->w);
+    float     *vMax    = (float *) mpArenaAlloc(scratch, sizeof(float) * t->w);
+    if(__is_null(vMin) || __is_null(vMax)){
+        mpArenaRelease(scratch, mark);
+        return;
+    }
+
+    REPTT(uint32_t, i, first, first + count){
+        const segInfo_t *info = segInfoAt(seg, i);
+        const float     *slot = segSlot(seg, segSlotOf(seg, i));
+        REPTT(xy_t, x, 0, t->w){
+            uint32_t a = (uint32_t)((uint64_t)seg->segLen * x / t->w);
+            uint32_t b = __max(a + 1, (uint32_t)((uint64_t)seg->segLen * (x + 1) / t->w));
+            vMin[x] = 1.0f;
+            vMax[x] = 0.0f;
+            REPTT(uint32_t, j, a, b){
+                float v;
+                if(j >= seg->pre){
+                    v = slot[j];
+                }else{
+                    uint32_t back = seg->pre - j;               /// 1 = newest pre sample
+                    if(back > info->preValid) continue;
+                    v = slot[(info->preHead + seg->pre - back) % seg->pre];
+                }
+                if(vMin[x] > vMax[x]) vMin[x] = vMax[x] = v;
+                vMin[x] = __min(vMin[x], v);
+                vMax[x] = __max(vMax[x], v);
+            }
+        }
+        rsDrawEnvelope(t, 0, vMin, vMax, t->w, yMin, yMax, c);
+    }
+    mpArenaRelease(scratch, mark);
+}
@@ -0,0 +1,161 @@
+#ifndef __SEG_STORE_H__
+#define __SEG_STORE_H__
+
+#ifdef LOG_HEADER_INCLUDE
+#pragma message("INCLUDE: segStore.h")
+#endif
+
+#include <stdint.h>
+
+#include "../windowContext/windowContext.h"
+#include "../raster/raster.h"
+#include "../memPool/memPool.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SEG_MAX_SEGMENTS    (1U << 20)
+
+typedef enum segState_t {
+    SEG_STOPPED = 0,
+    SEG_ARMED,                                  /// Filling pre-trigger history, looking for a trigger
+    SEG_POST,                                   /// Capturing post-trigger samples
+} segState_t;
+
+/**
+ * @brief Per-segment metadata.
+ */
+typedef struct segInfo_t {
+    uint64_t        trigIndex;                  /// Absolute sample index of the trigger
+    float           trigFrac;                   /// Sub-sample crossing position (0...1) before trigIndex
+    uint64_t        wallNs;                     /// CLOCK_MONOTONIC when the trigger was seen
+    uint32_t        preHead;                    /// Oldest pre-trigger sample in the slot's pre ring
+    uint32_t        preValid;                   /// Pre-trigger samples actually captured (<= pre)
+} segInfo_t;
+
+/**
+ * @brief Segmented acquisition memory.
+ *
+ * The memory is carved once into nSegments fixed slots of pre + post samples.
+ * While armed, the pre-trigger history is written as a ring straight into
+ * the slot that the next trigger will fill, so a trigger costs no copy and
+ * no allocation: only the ring head is recorded. Samples between segments
+ * are never stored.
+ *
+ * When wrapping with all nSegments - 1 segments retained, the slot after the
+ * one being filled is the oldest segment, still readable until this one
+ * completes. Its successor's history goes to preScratch meanwhile and is
+ * copied in (pre samples) only as the slot is reused.
+ */
+typedef struct segStore_t {
+    uint32_t        nSegments;
+    uint32_t        pre;
+    uint32_t        post;
+    uint32_t        segLen;                     /// pre + post
+    uint8_t         wrap;                       /// Overwrite the oldest segment when full, else stop
+    float           level;                      /// Trigger level
+    uint8_t         rising;                     /// Trigger slope
+    double          dt;                         /// Sample interval, for timestamps
+
+    float *         buff;                       /// nSegments * segLen
+    mpLarge_t       mem;                        /// Backing of buff
+    segInfo_t *     info;
+    float *         preScratch;                 /// pre: history for a next slot that is still retained
+
+    segState_t      state;
+    uint32_t        slot;                       /// Slot being filled
+    uint32_t        count;                      /// Completed segments (<= nSegments)
+    uint64_t        total;                      /// Completed segments ever
+    uint32_t        preHead;                    /// Pre ring write position of the current slot
+    uint32_t        preValid;
+    uint32_t        postFill;
+    uint64_t        seen;                       /// Absolute index of the next input sample
+    float           last;                       /// Previous input sample (trigger continuity)
+} segStore_t;
+
+/**
+ * @brief Create a segmented store and preallocate all segments.
+ *
+ * Like the sample store, the slots live on prefaulted huge pages on the
+ * calling thread's NUMA node.
+ *
+ * @param[out] seg        Pointer to a segment store pointer. Will be allocated inside.
+ * @param[in]  nSegments  Number of segments, 1 ... SEG_MAX_SEGMENTS.
+ * @param[in]  pre        Pre-trigger samples per segment.
+ * @param[in]  post       Post-trigger samples per segment (>= 1).
+ * @param[in]  dt         Sample interval in seconds.
+ *
+ * @return STATUS_OK on success, ERROR_INVALID_PARAMS or ERROR_UNKNOWN on failure.
+ */
+status_t createSegStore(segStore_t **seg, uint32_t nSegments, uint32_t pre, uint32_t post, double dt);
+
+/**
+ * @brief Destroy a segmented store and set the pointer to NULL.
+ */
+void destroySegStore(segStore_t **seg);
+
+/**
+ * @brief Choose between stopping when all segments are full and overwriting the oldest.
+ *
+ * When wrapping, one slot is always being refilled, so nSegments - 1 are retained.
+ */
+void segSetWrap(segStore_t *seg, uint8_t wrap);
+
+/**
+ * @brief Set the edge trigger.
+ */
+void segSetTrigger(segStore_t *seg, float level, uint8_t rising);
+
+/**
+ * @brief Clear all segments and arm.
+ */
+void segArm(segStore_t *seg);
+
+/**
+ * @brief Feed acquired samples. Triggers fill segments; everything else only feeds the pre ring.
+ *
+ * @return Number of segments completed by this call.
+ */
+uint32_t segFeed(segStore_t *seg, const float *in, uint32_t n);
+
+/**
+ * @brief Metadata of the i-th retained segment, oldest first.
+ */
+const segInfo_t *segInfoAt(const segStore_t *seg, uint32_t i);
+
+/**
+ * @brief Trigger time of the i-th segment in seconds since the first sample fed.
+ */
+double segTimeAt(const segStore_t *seg, uint32_t i);
+
+/**
+ * @brief Copy the i-th segment in time order (pre then post) into dst.
+ *
+ * Samples missing from a short pre-trigger history are written as 0.
+ *
+ * @return Number of samples written (segLen), 0 if i is out of range.
+ */
+uint32_t segRead(const segStore_t *seg, uint32_t i, float *dst);
+
+/**
+ * @brief Draw `count` segments starting at `first` on top of each other.
+ *
+ * Each segment is reduced to a per-column min/max envelope, straight from
+ * the slot without linearizing it first.
+ *
+ * @param[in,out] t       Target.
+ * @param[in]     seg     Segment store.
+ * @param[in]     first   First segment (oldest = 0).
+ * @param[in]     count   Number of segments (1 to browse a single segment).
+ * @param[in]     yMin    Value at the bottom row.
+ * @param[in]     yMax    Value at the top row.
+ * @param[in]     c       Color.
+ */
+void segRenderOverlay(rsTarget_t *t, const segStore_t *seg, uint32_t first, uint32_t count, float yMin, float yMax, color_t c);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
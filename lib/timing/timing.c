@@ -0,0 +1,446 @@
+#include "timing.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "../../include/global.h"
+
+typedef enum tmZone_t {
+    TM_ZONE_LOW = 0,
+    TM_ZONE_HIGH,
+    TM_ZONE_UNKNOWN,
+} tmZone_t;
+
+typedef enum tmPass_t {
+    TM_PASS_FIT = 0,
+    TM_PASS_SERIES,
+    TM_PASS_HIST,
+} tmPass_t;
+
+/// EDGES /////////////////////////////////////////////////////////////////////////////////////////
+
+typedef struct tmScan_t {
+    float           lo, mid, hi;
+    uint8_t         zone;
+    double          lastUp, lastDown;
+    uint8_t         firstZone;
+    double          firstT;
+    double *        out;
+    uint64_t        n;
+} tmScan_t;
+
+/// Sample at absolute index pos moved from pv to v; the mid crossing comes before the zone change
+static inline void tmStep(tmScan_t *s, uint64_t pos, float pv, float v){
+    if(pv < s->mid && v >= s->mid)      s->lastUp   = (double)(pos - 1) + (s->mid - pv) / (v - pv);
+    else if(pv >= s->mid && v < s->mid) s->lastDown = (double)(pos - 1) + (pv - s->mid) / (pv - v);
+    uint8_t z;
+    if(v >= s->hi)      z = TM_ZONE_HIGH;
+    else if(v < s->lo)  z = TM_ZONE_LOW;
+    else return;
+    if(z == s->zone) return;
+    double t = (z == TM_ZONE_HIGH) ? s->lastUp : s->lastDown;
+    if(s->zone == TM_ZONE_UNKNOWN){
+        s->firstZone = z;
+        s->firstT    = t;
+    }else{
+        s->out[s->n++] = t;
+    }
+    s->zone = z;
+}
+
+/// n contiguous samples from absolute index pos; *prevV holds the sample before p[0]
+static void tmScanRegion(tmScan_t *s, const float *p, uint32_t n, uint64_t pos, float *prevV){
+    float    pv = *prevV;
+    uint32_t i  = 0;
+#if defined(__SSE2__)
+    /// Four samples per compare; only those whose side of lo / mid / hi changed go to tmStep()
+    const __m128 vlo = _mm_set1_ps(s->lo), vmid = _mm_set1_ps(s->mid), vhi = _mm_set1_ps(s->hi);
+    uint32_t last = (uint32_t)(pv >= s->lo) | ((uint32_t)(pv >= s->mid) << 1) | ((uint32_t)(pv >= s->hi) << 2);
+    for(; i + 4 <= n; i += 4){
+        __m128   v  = _mm_loadu_ps(p + i);
+        uint32_t m0 = (uint32_t)_mm_movemask_ps(_mm_cmpge_ps(v, vlo));
+        uint32_t m1 = (uint32_t)_mm_movemask_ps(_mm_cmpge_ps(v, vmid));
+        uint32_t m2 = (uint32_t)_mm_movemask_ps(_mm_cmpge_ps(v, vhi));
+        uint32_t ch = (m0 ^ (((m0 << 1) | (last & 1)) & 15)) |
+                      (m1 ^ (((m1 << 1) | ((last >> 1) & 1)) & 15)) |
+                      (m2 ^ (((m2 << 1) | (last >> 2)) & 15));
+        while(ch){
+            uint32_t j = __builtin_ctz(ch);
+            tmStep(s, pos + i + j, j ? p[i + j - 1] : pv, p[i + j]);
+            ch &= ch - 1;
+        }
+        last = ((m0 >> 3) & 1) | (((m1 >> 3) & 1) << 1) | (((m2 >> 3) & 1) << 2);
+        pv   = p[i + 3];
+    }
+#endif
+    for(; i < n; ++i){
+        tmStep(s, pos + i, pv, p[i]);
+        pv = p[i];
+    }
+    *prevV = pv;
+}
+
+static void tmEdgeChunk(void *ctx, uint32_t d){
+    timing_t  *tm = (timing_t *) ctx;
+    tmChunk_t *c  = &tm->chunk[d];
+    tmScan_t   s  = { tm->lo, 0.5f * (tm->lo + tm->hi), tm->hi, TM_ZONE_UNKNOWN, NAN, NAN,
+                      TM_ZONE_UNKNOWN, NAN, tm->edges + (c->a - tm->start) + d, 0 };
+    ssSpan_t   span;
+    /// The first sample only seeds the previous value: later pieces start one early
+    uint64_t   from = (d == 0) ? c->a : c->a - 1;
+    uint32_t   got  = ssGetSpan(tm->ss, from, (uint32_t)(c->b - from), &span);
+    uint64_t   pos  = c->b - got;
+    uint8_t    seed = 1;
+    float      pv   = NAN;
+    REPTT(uint8_t, k, 0, 2){
+        const float *p = span.p[k];
+        uint32_t     m = span.n[k];
+        if(m == 0) continue;
+        if(seed){
+            seed = 0;
+            pv = p[0];
+            ++p;
+            --m;
+            ++pos;
+            /// Past either threshold the zone is known whatever came before; its crossing is in an earlier piece
+            if(pv >= s.hi || pv < s.lo){
+                s.zone = s.firstZone = (pv >= s.hi) ? TM_ZONE_HIGH : TM_ZONE_LOW;
+            }
+        }
+        tmScanRegion(&s, p, m, pos, &pv);
+        pos += m;
+    }
+    c->n         = s.n;
+    c->firstZone = s.firstZone;
+    c->firstT    = s.firstT;
+    c->endZone   = s.zone;
+    c->lastUp    = s.lastUp;
+    c->lastDown  = s.lastDown;
+}
+
+/// Stitch the pieces: the edge where a piece's first zone differs from the one carried in, then pack
+static void tmJoin(timing_t *tm){
+    uint8_t  zone = TM_ZONE_UNKNOWN, first = TM_ZONE_UNKNOWN;
+    double   up   = NAN, down = NAN;
+    uint64_t dst  = 0;
+    REPTT(uint32_t, d, 0, tm->nChunks){
+        tmChunk_t *c    = &tm->chunk[d];
+        double    *src  = tm->edges + (c->a - tm->start) + d;
+        uint8_t    lead = 0;
+        double     t    = c->firstT;
+        if(c->firstZone != TM_ZONE_UNKNOWN && zone != TM_ZONE_UNKNOWN && c->firstZone != zone){
+            if(isnan(t)) t = (c->firstZone == TM_ZONE_HIGH) ? up : down;
+            lead = !isnan(t);
+        }
+        if(c->n && tm->edges + dst + lead != src) memmove(tm->edges + dst + lead, src, sizeof(double) * c->n);
+        if(lead) tm->edges[dst] = t;
+        if(first == TM_ZONE_UNKNOWN && (lead || c->n)){
+            /// The first edge leads into the piece's first zone, or out of it
+            first = lead ? c->firstZone : (c->firstZone == TM_ZONE_HIGH ? TM_ZONE_LOW : TM_ZONE_HIGH);
+        }
+        dst += lead + c->n;
+        if(c->endZone != TM_ZONE_UNKNOWN) zone = c->endZone;
+        if(!isnan(c->lastUp))   up   = c->lastUp;
+        if(!isnan(c->lastDown)) down = c->lastDown;
+    }
+    tm->nEdges      = dst;
+    tm->firstRising = (first == TM_ZONE_HIGH);
+}
+
+/// SEQUENCES /////////////////////////////////////////////////////////////////////////////////////
+
+/// Rising edge k, and the falling edge after it
+#define tmRise(tm, k)       ((tm)->edges[2 * (k) + !(tm)->firstRising])
+#define tmFall(tm, k)       ((tm)->edges[2 * (k) + !(tm)->firstRising + 1])
+
+static inline void tmRange(uint64_t n, uint32_t nChunks, uint32_t d, uint64_t *a, uint64_t *b){
+    *a = n * d / nChunks;
+    *b = n * (d + 1) / nChunks;
+}
+
+static void tmFitChunk(timing_t *tm, tmChunk_t *c, uint32_t d){
+    const uint64_t n  = tm->nSeries[TM_TIE];
+    const double   kc = -0.5 * (double)(n - 1), t0 = tmRise(tm, 0);
+    double         st = 0.0, skt = 0.0;
+    uint64_t       a, b;
+    tmRange(n, tm->nChunks, d, &a, &b);
+    /// Centred k and t relative to the first edge keep the sums small
+    for(uint64_t k = a; k < b; ++k){
+        double t = tmRise(tm, k) - t0;
+        st  += t;
+        skt += (kc + (double)k) * t;
+    }
+    c->fit[0] = st;
+    c->fit[1] = skt;
+}
+
+static void tmSeriesChunk(timing_t *tm, tmChunk_t *c, uint32_t d){
+    const double t0 = tm->clockT0, period = tm->clockPeriod;
+    REPTT(uint32_t, s, 0, TM_N_SERIES){
+        float   *out = tm->series[s];
+        float    lo  = INFINITY, hi = -INFINITY;
+        double   sum = 0.0, sum2 = 0.0;
+        uint64_t a, b;
+        tmRange(tm->nSeries[s], tm->nChunks, d, &a, &b);
+        for(uint64_t k = a; k < b; ++k){
+            float v;
+            switch(s){
+            case TM_TIE:    v = (float)(tmRise(tm, k) - (t0 + period * (double)k)); break;
+            case TM_PERIOD: v = (float)(tmRise(tm, k + 1) - tmRise(tm, k));         break;
+            default:        v = (float)(tmFall(tm, k) - tmRise(tm, k));             break;
+            }
+            out[k] = v;
+            lo     = __min(lo, v);
+            hi     = __max(hi, v);
+            sum   += v;
+            sum2  += (double)v * v;
+        }
+        c->vMin[s] = lo;
+        c->vMax[s] = hi;
+        c->sum[s]  = sum;
+        c->sum2[s] = sum2;
+    }
+}
+
+static void tmHistChunk(timing_t *tm, uint32_t d){
+    REPTT(uint32_t, s, 0, TM_N_SERIES){
+        uint32_t    *h     = tm->localHist + ((size_t)d * TM_N_SERIES + s) * TM_BINS;
+        const float *v     = tm->series[s];
+        const float  base  = (float)tm->stats[s].min;
+        const double span  = tm->stats[s].max - tm->stats[s].min;
+        const float  scale = (span > 0.0) ? (float)(TM_BINS / span) : 0.0f;
+        uint64_t     a, b, k;
+        memset(h, 0, sizeof(uint32_t) * TM_BINS);
+        tmRange(tm->nSeries[s], tm->nChunks, d, &a, &b);
+        k = a;
+#if defined(__SSE2__)
+        const __m128 vBase = _mm_set1_ps(base), vScale = _mm_set1_ps(scale);
+        const __m128 zero  = _mm_setzero_ps(), top = _mm_set1_ps((float)(TM_BINS - 1));
+        int32_t      bin[4];
+        for(; k + 4 <= b; k += 4){
+            __m128 f = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(v + k), vBase), vScale);
+            /// Operand order sends NaN to bin 0
+            _mm_storeu_si128((__m128i *)bin, _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(f, zero), top)));
+            h[bin[0]]++;
+            h[bin[1]]++;
+            h[bin[2]]++;
+            h[bin[3]]++;
+        }
+#endif
+        for(; k < b; ++k){
+            float f = (v[k] - base) * scale;
+            h[(f >= 0.0f) ? (uint32_t)__min((float)(TM_BINS - 1), f) : 0]++;
+        }
+    }
+}
+
+static void tmSeqChunk(void *ctx, uint32_t d){
+    timing_t  *tm = (timing_t *) ctx;
+    tmChunk_t *c  = &tm->chunk[d];
+    switch(tm->pass){
+    case TM_PASS_FIT:    tmFitChunk(tm, c, d);    break;
+    case TM_PASS_SERIES: tmSeriesChunk(tm, c, d); break;
+    default:             tmHistChunk(tm, d);      break;
+    }
+}
+
+static uint32_t tmChunks(uint64_t n){
+    return (uint32_t)__max(1, __min((uint64_t)TM_MAX_CHUNKS, n / TM_MIN_CHUNK));
+}
+
+static void tmBuildSeries(timing_t *tm){
+    const uint64_t nRise = (tm->nEdges + tm->firstRising) / 2;
+    const uint64_t nFall = tm->nEdges - nRise;
+    tm->nSeries[TM_TIE]    = (nRise >= 2) ? nRise : 0;
+    tm->nSeries[TM_PERIOD] = (nRise >= 2) ? nRise - 1 : 0;
+    tm->nSeries[TM_WIDTH]  = tm->firstRising ? nFall : (nFall ? nFall - 1 : 0);
+    memset(tm->stats, 0, sizeof(tm->stats));
+    memset(tm->hist, 0, sizeof(tm->hist));
+    tm->clockT0     = 0.0;
+    tm->clockPeriod = 0.0;
+    uint64_t most = __max(tm->nSeries[TM_TIE], tm->nSeries[TM_WIDTH]);
+    if(most == 0) return;
+    tm->nChunks = tmChunks(most);
+
+    /// Ideal clock: least squares over the rising edges, t ~ mean + period * (k - (n - 1) / 2)
+    if(tm->nSeries[TM_TIE]){
+        const double n = (double)nRise;
+        double st = 0.0, skt = 0.0;
+        tm->pass = TM_PASS_FIT;
+        wpRun(tm->wp, tmSeqChunk, tm, tm->nChunks);
+        REPTT(uint32_t, d, 0, tm->nChunks){
+            st  += tm->chunk[d].fit[0];
+            skt += tm->chunk[d].fit[1];
+        }
+        tm->clockPeriod = skt / (n * (n * n - 1.0) / 12.0);
+        tm->clockT0     = tmRise(tm, 0) + st / n - tm->clockPeriod * 0.5 * (n - 1.0);
+    }
+
+    tm->pass = TM_PASS_SERIES;
+    wpRun(tm->wp, tmSeqChunk, tm, tm->nChunks);
+    REPTT(uint32_t, s, 0, TM_N_SERIES){
+        tmStats_t *st = &tm->stats[s];
+        double     sum = 0.0, sum2 = 0.0;
+        st->n = tm->nSeries[s];
+        if(st->n == 0) continue;
+        st->min = INFINITY;
+        st->max = -INFINITY;
+        REPTT(uint32_t, d, 0, tm->nChunks){
+            const tmChunk_t *c = &tm->chunk[d];
+            sum  += c->sum[s];
+            sum2 += c->sum2[s];
+            st->min = __min(st->min, (double)c->vMin[s]);
+            st->max = __max(st->max, (double)c->vMax[s]);
+        }
+        st->mean = sum / (double)st->n;
+        st->sdev = sqrt(__max(0.0, sum2 / (double)st->n - st->mean * st->mean));
+    }
+
+    tm->pass = TM_PASS_HIST;
+    wpRun(tm->wp, tmSeqChunk, tm, tm->nChunks);
+    REPTT(uint32_t, d, 0, tm->nChunks){
+        REPTT(uint32_t, s, 0, TM_N_SERIES){
+            const uint32_t *h = tm->localHist + ((size_t)d * TM_N_SERIES + s) * TM_BINS;
+            REPTT(uint32_t, i, 0, TM_BINS) tm->hist[s][i] += h[i];
+        }
+    }
+}
+
+/// API ///////////////////////////////////////////////////////////////////////////////////////////
+
+status_t createTiming(timing_t **tm, uint64_t capSamples, workerPool_t *wp){
+    __entry("createTiming(%p, %llu, %p)", tm, (unsigned long long)capSamples, wp);
+    if(__is_null(tm) || capSamples < 2){
+        __err("[createTiming] Invalid params!");
+        return ERROR_INVALID_PARAMS;
+    }
+    *tm = (timing_t *) mpCalloc(1, sizeof(timing_t));
+    if(__is_null(*tm)){
+        __err("[createTiming] malloc failed!");
+        return ERROR_UNKNOWN;
+    }
+    timing_t *t = *tm;
+    t->wp         = wp;
+    t->capSamples = capSamples;
+    t->localHist  = (uint32_t *) mpAlloc(sizeof(uint32_t) * TM_MAX_CHUNKS * TM_N_SERIES * TM_BINS);
+    /// Every sample can end an edge; a sequence holds one entry per rising edge at most
+    status_t status = __is_null(t->localHist) ? ERROR_UNKNOWN :
+                      mpLargeAlloc(&t->edgeMem, sizeof(double) * (capSamples + TM_MAX_CHUNKS), MP_NODE_LOCAL);
+    REPTT(uint32_t, s, 0, TM_N_SERIES){
+        if(status != STATUS_OK) break;
+        status = mpLargeAlloc(&t->seriesMem[s], sizeof(float) * (capSamples / 2 + TM_MAX_CHUNKS), MP_NODE_LOCAL);
+        t->series[s] = (float *) t->seriesMem[s].p;
+    }
+    if(status != STATUS_OK){
+        __err("[createTiming] mpLargeAlloc(%llu samples) failed!", (unsigned long long)capSamples);
+        destroyTiming(tm);
+        return ERROR_UNKNOWN;
+    }
+    t->edges = (double *) t->edgeMem.p;
+    tmSetLevels(t, -0.1f, 0.1f);
+    __exit("createTiming()");
+    return STATUS_OK;
+}
+
+void destroyTiming(timing_t **tm){
+    if(__is_null(tm) || __is_null(*tm)) return;
+    timing_t *t = *tm;
+    mpLargeFree(&t->edgeMem);
+    REPTT(uint32_t, s, 0, TM_N_SERIES) mpLargeFree(&t->seriesMem[s]);
+    mpFree(t->localHist);
+    mpFree(t);
+    *tm = NULL;
+}
+
+void tmSetLevels(timing_t *tm, float lo, float hi){
+    if(__is_null(tm) || !(lo < hi)) return;
+    tm->lo = lo;
+    tm->hi = hi;
+}
+
+uint64_t tmAnalyze(timing_t *tm, const sampleStore_t *ss, uint64_t start, uint64_t n){
+    if(__is_null(tm) || __is_null(ss)) return 0;
+    uint64_t oldest = ssOldest(ss), end = __min(start + n, ssWritten(ss));
+    start = __max(start, oldest);
+    tm->nEdges = 0;
+    memset(tm->nSeries, 0, sizeof(tm->nSeries));
+    if(end <= start + 1){
+        tmBuildSeries(tm);
+        return 0;
+    }
+    n = __min(end - start, tm->capSamples);
+    start = end - n;
+
+    tm->ss      = ss;
+    tm->start   = start;
+    tm->nChunks = tmChunks(n);
+    REPTT(uint32_t, d, 0, tm->nChunks){
+        tm->chunk[d].a = start + n * d / tm->nChunks;
+        tm->chunk[d].b = start + n * (d + 1) / tm->nChunks;
+    }
+    wpRun(tm->wp, tmEdgeChunk, tm, tm->nChunks);
+    tmJoin(tm);
+    tmBuildSeries(tm);
+    tm->ss = NULL;
+    return tm->nEdges;
+}
+
+const float *tmGetSeries(const timing_t *tm, tmSeries_t s, uint64_t *n){
+    if(__is_null(tm) || (uint32_t)s >= TM_N_SERIES){
+        if(__is_not_null(n)) *n = 0;
+        return NULL;
+    }
+    if(__is_not_null(n)) *n = tm->nSeries[s];
+    return tm->series[s];
+}
+
+void tmGetStats(const timing_t *tm, tmSeries_t s, tmStats_t *st){
+    if(__is_null(st)) return;
+    if(__is_null(tm) || (uint32_t)s >= TM_N_SERIES){
+        memset(st, 0, sizeof(tmStats_t));
+        return;
+    }
+    *st = tm->stats[s];
+}
+
+const uint32_t *tmGetHistogram(const timing_t *tm, tmSeries_t s){
+    if(__is_null(tm) || (uint32_t)s >= TM_N_SERIES) return NULL;
+    return tm->hist[s];
+}
+
+/// RENDER ////////////////////////////////////////////////////////////////////////////////////////
+
+void tmRenderHistogram(const timing_t *tm, tmSeries_t s, rsTarget_t *t, color_t c){
+    if(__is_null(tm) || __is_null(t) || (uint32_t)s >= TM_N_SERIES || t->w <= 0 || t->h <= 0) return;
+    const uint32_t *h   = tm->hist[s];
+    uint32_t        top = 0;
+    REPTT(uint32_t, i, 0, TM_BINS) top = __max(top, h[i]);
+    if(top == 0) return;
+    /// Each column shows the fullest bin it covers
+    REPTT(xy_t, x, 0, t->w){
+        uint32_t a = (uint32_t)((uint64_t)x * TM_BINS / t->w), b = (uint32_t)((uint64_t)(x + 1) * TM_BINS / t->w);
+        uint32_t v = 0;
+        if(b <= a) b = a + 1;
+        for(uint32_t i = a; i < b; ++i) v = __max(v, h[i]);
+        if(v == 0) continue;
+        xy_t bar = (xy_t)((uint64_t)v * (t->h - 1) / top);
+        rsVSpan(t, x, t->h - 1 - bar, t->h - 1, c);
+    }
+}
+
+void tmRenderTrend(const timing_t *tm, tmSeries_t s, rsTarget_t *t, color_t c){
+    if(__is_null(tm) || __is_null(t) || (uint32_t)s >= TM_N_SERIES || t->w <= 0 || t->h <= 0) return;
+    const tmStats_t *st = &tm->stats[s];
+    if(st->n == 0) return;
+    mpArena_t *scratch = mpThreadArena();
+    size_t     mark    = mpArenaMark(scratch);
+    float     *col     = (float *) mpArenaAlloc(scratch, sizeof(float) * 2 * (size_t)t->w);
+    if(__is_not_null(col)){
+        /// A flat sequence sits in the middle
+        float margin = (float)__max(1e-6, 0.05 * (st->max - st->min));
+        rsDecimateMinMax(tm->series[s], st->n, col, col + t->w, t->w);
+        rsDrawEnvelope(t, 0, col, col + t->w, t->w, (float)st->min - margin, (float)st->max + margin, c);
+    }
+    mpArenaRelease(scratch, mark);
+}
@@ -0,0 +1,158 @@
+#ifndef __TIMING_H__
+#define __TIMING_H__
+
+#ifdef LOG_HEADER_INCLUDE
+#pragma message("INCLUDE: timing.h")
+#endif
+
+#include <stdint.h>
+
+#include "../windowContext/windowContext.h"
+#include "../memPool/memPool.h"
+#include "../raster/raster.h"
+#include "../sampleStore/sampleStore.h"
+#include "../workerPool/workerPool.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TM_MAX_CHUNKS       64                  /// Pieces a record or a sequence is cut into
+#define TM_MIN_CHUNK        65536               /// Samples / edges per piece, at least
+#define TM_BINS             256                 /// Histogram bins
+
+typedef enum tmSeries_t {
+    TM_TIE = 0,                                 /// Rising edge vs. the best-fit ideal clock
+    TM_PERIOD,                                  /// Rising edge to rising edge
+    TM_WIDTH,                                   /// Rising edge to falling edge
+    TM_N_SERIES,
+} tmSeries_t;
+
+typedef struct tmStats_t {
+    uint64_t        n;
+    double          mean;                       /// Samples, like every value here
+    double          sdev;
+    double          min;
+    double          max;
+} tmStats_t;
+
+/**
+ * @brief Per-piece state of the edge pass, stitched together afterwards.
+ */
+typedef struct tmChunk_t {
+    uint64_t        a, b;                       /// Samples [a, b)
+    uint64_t        n;                          /// Edges found inside
+    uint8_t         firstZone;                  /// Zone first reached from an unknown one
+    double          firstT;                     /// Mid crossing leading there, NAN = before the piece
+    uint8_t         endZone;
+    double          lastUp, lastDown;           /// Latest mid crossings, NAN = none
+    double          fit[2];                     /// Clock fit: partial sum(t), sum(k * t)
+    double          sum[TM_N_SERIES];           /// Sequence pass: partial statistics
+    double          sum2[TM_N_SERIES];
+    float           vMin[TM_N_SERIES];
+    float           vMax[TM_N_SERIES];
+} tmChunk_t;
+
+/**
+ * @brief Timing analysis over every edge of a record.
+ *
+ * tmAnalyze() runs in passes over preallocated arrays, each one cut into
+ * pieces for the worker pool:
+ *
+ *  1. edges: four samples per SSE compare against lo / mid / hi, a
+ *     hysteresis state machine per piece, every edge timed at its mid
+ *     crossing interpolated between samples. A piece does not know the
+ *     zone it starts in, so it records the first zone it reaches and the
+ *     crossing that led there; one pass over the pieces adds the edges
+ *     that span a boundary and packs the arrays;
+ *  2. the least-squares ideal clock through the rising edges (partial sums);
+ *  3. TIE, period and width sequences, with their statistics;
+ *  4. histograms, one per piece, then summed.
+ *
+ * Values are in samples; the caller scales by the sample interval.
+ */
+typedef struct timing_t {
+    workerPool_t *  wp;
+    float           lo, hi;                     /// Hysteresis thresholds; edges are timed at (lo + hi) / 2
+    uint64_t        capSamples;
+
+    double *        edges;                      /// Edge times, rising and falling alternate
+    mpLarge_t       edgeMem;                    /// capSamples + TM_MAX_CHUNKS
+    uint64_t        nEdges;
+    uint8_t         firstRising;
+    float *         series[TM_N_SERIES];
+    mpLarge_t       seriesMem[TM_N_SERIES];
+    uint64_t        nSeries[TM_N_SERIES];
+    tmStats_t       stats[TM_N_SERIES];
+    uint32_t        hist[TM_N_SERIES][TM_BINS];
+    uint32_t *      localHist;                  /// TM_MAX_CHUNKS x TM_N_SERIES x TM_BINS
+    double          clockT0, clockPeriod;       /// Ideal clock: rising edge k at clockT0 + k * clockPeriod
+
+    /// Current pass
+    const sampleStore_t *   ss;
+    uint64_t        start;
+    uint32_t        nChunks;
+    tmChunk_t       chunk[TM_MAX_CHUNKS];
+    uint8_t         pass;
+} timing_t;
+
+/**
+ * @brief Create a timing analyzer.
+ *
+ * @param[out] tm          Pointer to a timing pointer. Will be allocated inside.
+ * @param[in]  capSamples  Longest record to analyze; the arrays are sized for it.
+ * @param[in]  wp          Worker pool, NULL = calling thread only.
+ *
+ * @return STATUS_OK on success, ERROR_INVALID_PARAMS or ERROR_UNKNOWN on failure.
+ */
+status_t createTiming(timing_t **tm, uint64_t capSamples, workerPool_t *wp);
+
+/**
+ * @brief Destroy a timing analyzer and set the pointer to NULL.
+ */
+void destroyTiming(timing_t **tm);
+
+/**
+ * @brief Hysteresis thresholds, lo < hi.
+ */
+void tmSetLevels(timing_t *tm, float lo, float hi);
+
+/**
+ * @brief Analyze samples [start, start + n) of ss (clipped to capSamples and to what ss holds).
+ *
+ * @return Edges found.
+ */
+uint64_t tmAnalyze(timing_t *tm, const sampleStore_t *ss, uint64_t start, uint64_t n);
+
+/**
+ * @brief A sequence from the last analysis.
+ */
+const float *tmGetSeries(const timing_t *tm, tmSeries_t s, uint64_t *n);
+
+/**
+ * @brief Statistics of a sequence.
+ */
+void tmGetStats(const timing_t *tm, tmSeries_t s, tmStats_t *st);
+
+/**
+ * @brief Histogram of a sequence, TM_BINS bins over [stats.min, stats.max].
+ */
+const uint32_t *tmGetHistogram(const timing_t *tm, tmSeries_t s);
+
+/**
+ * @brief Draw a histogram as bars from the bottom, scaled to the fullest bin.
+ */
+void tmRenderHistogram(const timing_t *tm, tmSeries_t s, rsTarget_t *t, color_t c);
+
+/**
+ * @brief Draw a sequence against edge number, one min/max envelope per column.
+ *
+ * Column scratch comes from the calling thread's arena (mpThreadArena()).
+ */
+void tmRenderTrend(const timing_t *tm, tmSeries_t s, rsTarget_t *t, color_t c);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
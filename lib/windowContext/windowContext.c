@@ -1,4 +1,6 @@
 #include "windowContext.h"
+#include "../memPool/memPool.h"
+#include "../pixelFormat/pixelFormat.h"
 
 status_t wdctCreateWindow(windowContext_t * wdct){
     if(__is_null(wdct)){
@@ -76,9 +78,10 @@ status_t wdctCreateTexture(windowContext_t * wdct){
     }
     if(__is_null(wdct->renderer)) 
         return ERROR_INVALID_PARAMS;
+    wdct->format  = pfNegotiate(wdct->renderer, &wdct->convert);
     wdct->texture = SDL_CreateTexture(
         wdct->renderer,
-        SDL_PIXELFORMAT_RGBA8888,
+        wdct->format,
         SDL_TEXTUREACCESS_STREAMING,
         wdct->w,
         wdct->h
@@ -140,7 +143,7 @@ status_t createWindowContext(
         return ERROR_INVALID_PARAMS;
     }
 
-    *wdct = (windowContext_t*) malloc(sizeof(windowContext_t));
+    *wdct = (windowContext_t*) mpAlloc(sizeof(windowContext_t));
     if (*wdct == NULL) {
         __err("[createWindowContext] malloc failed!");
         return ERROR_INVALID_PARAMS;
@@ -185,7 +188,7 @@ __fail_renderer__:
     wdctDeleteWindow(*wdct);
 
 __fail_window__:
-    free(*wdct);
+    mpFree(*wdct);
     *wdct = NULL;
     __exit("createWindowContext() failed");
     return ERROR_INVALID_PARAMS;
@@ -205,7 +208,7 @@ status_t destroyWindowContext(windowContext_t **wdct)
     wdctDeleteRenderer(*wdct);
     wdctDeleteWindow(*wdct);
 
-    free(*wdct);
+    mpFree(*wdct);
     *wdct = NULL;
     
     __exit("destroyWindowContext()");
@@ -26,6 +26,8 @@ typedef struct windowContext_t{
     SDL_Window          *window;
     SDL_Renderer        *renderer;
     SDL_Texture         *texture;
+    Uint32              format;                 /// Pixel format of texture, see pfNegotiate()
+    uint8_t             convert;                /// format is not color_t's: uploads go through pfConvert()
     TTF_Font            *font;
     xy_t                w;
     xy_t                h;
@@ -87,9 +89,10 @@ status_t wdctDeleteRenderer(windowContext_t * wdct);
 /**
  * @brief Create an SDL texture for the given window context.
  *
- * The texture is created with format SDL_PIXELFORMAT_RGBA8888
- * and access mode SDL_TEXTUREACCESS_STREAMING, sized to match the
- * width and height stored in the context.
+ * The texture is created in the format pfNegotiate() picks for the
+ * renderer (stored in wdct->format) and access mode
+ * SDL_TEXTUREACCESS_STREAMING, sized to match the width and height
+ * stored in the context.
  *
  * @param[in,out] wdct Pointer to a valid window context with a valid renderer.
  *
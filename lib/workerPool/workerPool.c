@@ -0,0 +1,123 @@
+#include "workerPool.h"
+
+#include "../../include/global.h"
+
+typedef struct wpStart_t {
+    workerPool_t *  wp;
+    uint32_t        slot;
+} wpStart_t;
+
+/// Take chunks until none are left
+static void wpDrain(workerPool_t *wp, wpTask_t task, void *ctx, uint32_t nChunks){
+    while(1){
+        uint32_t c = __atomic_fetch_add(&wp->next, 1, __ATOMIC_RELAXED);
+        if(c >= nChunks) break;
+        task(ctx, c);
+    }
+}
+
+static void *wpWorker(void *arg){
+    wpStart_t     start = *(wpStart_t *)arg;
+    workerPool_t *wp    = start.wp;
+    uint64_t      seen  = 0;
+    mpFree(arg);
+    if(__is_not_null(wp->cfg)) cfgPinThread(wp->cfg, start.slot);
+
+    pthread_mutex_lock(&wp->lock);
+    while(1){
+        while(wp->generation == seen && !wp->quit) pthread_cond_wait(&wp->start, &wp->lock);
+        if(wp->quit) break;
+        seen = wp->generation;
+        wpTask_t task    = wp->task;
+        void *   ctx     = wp->ctx;
+        uint32_t nChunks = wp->nChunks;
+        pthread_mutex_unlock(&wp->lock);
+
+        wpDrain(wp, task, ctx, nChunks);
+
+        pthread_mutex_lock(&wp->lock);
+        if(--wp->pending == 0) pthread_cond_signal(&wp->done);
+    }
+    pthread_mutex_unlock(&wp->lock);
+    mpThreadArenaFree();
+    return NULL;
+}
+
+status_t createWorkerPool(workerPool_t **wp, uint32_t threads, const oscConfig_t *cfg){
+    __entry("createWorkerPool(%p, %u, %p)", wp, threads, cfg);
+    if(__is_null(wp)){
+        __err("[createWorkerPool] Invalid params!");
+        return ERROR_INVALID_PARAMS;
+    }
+    if(threads == 0){
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = (online > 1) ? (uint32_t)(online - 1) : 0;
+    }
+    threads = __min(threads, WP_MAX_THREADS);
+
+    *wp = (workerPool_t *) mpCalloc(1, sizeof(workerPool_t));
+    if(__is_null(*wp)){
+        __err("[createWorkerPool] malloc failed!");
+        return ERROR_UNKNOWN;
+    }
+    workerPool_t *p = *wp;
+    p->cfg = cfg;
+    pthread_mutex_init(&p->lock, NULL);
+    pthread_cond_init(&p->start, NULL);
+    pthread_cond_init(&p->done, NULL);
+
+    REPTT(uint32_t, i, 0, threads){
+        wpStart_t *arg = (wpStart_t *) mpAlloc(sizeof(wpStart_t));
+        if(__is_null(arg)) break;
+        arg->wp   = p;
+        arg->slot = i + 1;
+        if(pthread_create(&p->threads[i], NULL, wpWorker, arg) != 0){
+            __err("[createWorkerPool] pthread_create failed after %u workers", i);
+            mpFree(arg);
+            break;
+        }
+        p->nThreads++;
+    }
+    __log("[createWorkerPool] %u workers%s", p->nThreads, (cfg && cfg->nCpus) ? ", pinned" : "");
+    __exit("createWorkerPool()");
+    return STATUS_OK;
+}
+
+void destroyWorkerPool(workerPool_t **wp){
+    if(__is_null(wp) || __is_null(*wp)) return;
+    workerPool_t *p = *wp;
+    pthread_mutex_lock(&p->lock);
+    p->quit = 1;
+    pthread_cond_broadcast(&p->start);
+    pthread_mutex_unlock(&p->lock);
+    REPTT(uint32_t, i, 0, p->nThreads) pthread_join(p->threads[i], NULL);
+    pthread_cond_destroy(&p->start);
+    pthread_cond_destroy(&p->done);
+    pthread_mutex_destroy(&p->lock);
+    mpFree(p);
+    *wp = NULL;
+}
+
+void wpRun(workerPool_t *wp, wpTask_t task, void *ctx, uint32_t nChunks){
+    if(__is_null(task) || nChunks == 0) return;
+    if(__is_null(wp) || wp->nThreads == 0 || nChunks == 1){
+        REPTT(uint32_t, c, 0, nChunks) task(ctx, c);
+        return;
+    }
+    pthread_mutex_lock(&wp->lock);
+    wp->task    = task;
+    wp->ctx     = ctx;
+    wp->nChunks = nChunks;
+    wp->next    = 0;
+    wp->pending = wp->nThreads;
+    wp->generation++;
+    wp->jobs++;
+    pthread_cond_broadcast(&wp->start);
+    pthread_mutex_unlock(&wp->lock);
+
+    wpDrain(wp, task, ctx, nChunks);
+
+    pthread_mutex_lock(&wp->lock);
+    while(wp->pending > 0) pthread_cond_wait(&wp->done, &wp->lock);
+    pthread_mutex_unlock(&wp->lock);
+}
@@ -0,0 +1,78 @@
+#ifndef __WORKER_POOL_H__
+#define __WORKER_POOL_H__
+
+#ifdef LOG_HEADER_INCLUDE
+#pragma message("INCLUDE: workerPool.h")
+#endif
+
+#include <stdint.h>
+#include <pthread.h>
+
+#include "../windowContext/windowContext.h"
+#include "../config/config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define WP_MAX_THREADS      256
+
+/**
+ * @brief Work item: process chunk `chunk` of the current job.
+ */
+typedef void (*wpTask_t)(void *ctx, uint32_t chunk);
+
+/**
+ * @brief Fixed pool of pinned worker threads for data-parallel jobs.
+ *
+ * A job is a task split into chunks. wpRun() wakes the workers, takes chunks
+ * itself too (an atomic counter hands them out) and returns when every
+ * chunk is done, so the caller sees a plain blocking call. Threads are
+ * created once; between jobs they sleep on a condition variable.
+ */
+typedef struct workerPool_t {
+    uint32_t            nThreads;               /// Workers besides the calling thread
+    pthread_t           threads[WP_MAX_THREADS];
+    const oscConfig_t * cfg;                    /// For pinning, may be NULL
+    pthread_mutex_t     lock;
+    pthread_cond_t      start;
+    pthread_cond_t      done;
+    uint64_t            generation;             /// Bumped per job
+    uint8_t             quit;
+    wpTask_t            task;
+    void *              ctx;
+    uint32_t            nChunks;
+    uint32_t            next;                   /// Next chunk to hand out
+    uint32_t            pending;                /// Workers still in the current job
+    uint64_t            jobs;
+} workerPool_t;
+
+/**
+ * @brief Start the workers.
+ *
+ * @param[out] wp       Pointer to a pool pointer. Will be allocated inside.
+ * @param[in]  threads  Workers to start besides the caller; 0 = one per online core minus one.
+ * @param[in]  cfg      Worker i is pinned with cfgPinThread(cfg, i + 1), slot 0 being
+ *                      the caller's; NULL leaves them unpinned.
+ *
+ * @return STATUS_OK on success, ERROR_INVALID_PARAMS or ERROR_UNKNOWN on failure.
+ */
+status_t createWorkerPool(workerPool_t **wp, uint32_t threads, const oscConfig_t *cfg);
+
+/**
+ * @brief Stop and join the workers, set the pointer to NULL.
+ */
+void destroyWorkerPool(workerPool_t **wp);
+
+/**
+ * @brief Run task(ctx, 0 ... nChunks - 1) across the pool and the caller, and wait.
+ *
+ * One job at a time: call from a single thread. A NULL pool runs the chunks inline.
+ */
+void wpRun(workerPool_t *wp, wpTask_t task, void *ctx, uint32_t nChunks);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -2,8 +2,9 @@
 
 /// GLOBAL VARS ///////////////////////////////////////////////////////////////////////////////////
 
-const xy_t       screenW = 640;
-const xy_t       screenH = 480;
+oscConfig_t      oscConf;                                                /// Effective runtime configuration
+xy_t             screenW;
+xy_t             screenH;
 
 windowContext_t* mainWindow;
 pthread_mutex_t  sdlMutex = PTHREAD_MUTEX_INITIALIZER;                   /// Mutex lock for SDL operations (thread-safety)
@@ -19,6 +20,18 @@ volatile flag_t  screenFlag = 0;
 
 int main(int argc, char** args) {
     __entry("main()");
+    /// CONFIGURATION /////////////////////////////////////////////////////////////////////////////
+    cfgDefaults(&oscConf);
+    status_t cfgStatus = cfgParseArgs(&oscConf, argc, args);
+    if(cfgStatus == 1) return 0;
+    if(cfgStatus != STATUS_OK){
+        cfgPrintUsage(args[0]);
+        return 1;
+    }
+    cfgLog(&oscConf);
+    screenW = oscConf.windowW;
+    screenH = oscConf.windowH;
+    cfgPinThread(&oscConf, 0);                  /// Main / render thread takes the first core, workers the rest
     /// SETUP EXIT CALLBACK ///////////////////////////////////////////////////////////////////////
     atexit(oscExit);
     /// CALL INIT /////////////////////////////////////////////////////////////////////////////////
@@ -34,29 +47,56 @@ int main(int argc, char** args) {
 
     /// MAIN THREAD ///////////////////////////////////////////////////////////////////////////////
     __log("[main] Entry mainSloop");
+    mpArena_t *frameArena = mpThreadArena();
+    mpStats_t  memStats;
+    mpGetStats(&memStats);
+    uint64_t   lastHeapAllocs = memStats.heapAllocs;
+    uint64_t   lastStamp = 0;
     while (statusFlag hasFlag (RUNNING)) {
+        mpArenaReset(frameArena);
+        oscApplyRemote();
+        oscApplyLog();
+        oscPollStartup();
+        srUpdate(oscSearch);                    /// Index the new samples once, not per key press
+        oscFeedSegments();
+        oscAcquire();
+        oscFeedLogic();
+        oscApplyJump();
+        REPTT(uint8_t, i, 0, OSC_MAX_CHANNELS){
+            blockStore_t *bc = __atomic_load_n(&oscChannels[i].history, __ATOMIC_ACQUIRE);
+            if(__is_not_null(bc) && __is_not_null(oscChannels[i].ss)) bcFollow(bc, oscChannels[i].ss);
+        }
+        if((screenFlag hasFlag (ROLL)) && oscIngestStamp() != lastStamp) screenFlag setFlag (BUFFER_FLUSH);
         if(screenFlag  hasFlag (BUFFER_FLUSH)){
 
             screenFlag  clrFlag (BUFFER_FLUSH);
 
+            /// Only frames that show new samples count towards ingest latency
+            uint64_t stamp = oscIngestStamp();
+            if(stamp == lastStamp) stamp = 0;
+            else lastStamp = stamp;
+            ltRecordSince(latency, LAT_QUEUE, stamp);
+
             __entryCriticalSection(&sdlMutex);
             
-            SDL_UpdateTexture(mainWindow->texture, NULL, screenBuffer, screenW * sizeof(color_t));
-            
             SDL_SetRenderDrawColor(mainWindow->renderer, 0, 0, 0, 255);
             SDL_RenderClear(mainWindow->renderer);
 
-            SDL_RenderCopy(mainWindow->renderer, mainWindow->texture, NULL, NULL);
+            oscRenderFrame();
+            uint64_t t0 = ltNow();
             SDL_RenderPresent(mainWindow->renderer);
+            ltRecordSince(latency, LAT_PRESENT, t0);
+            ltRecordSince(latency, LAT_TOTAL, stamp);
             
             __exitCriticalSection(&sdlMutex);
         }
-        #if defined(RENDER_FPS)
-            // __log("Delay for %dms!", 1000/RENDER_FPS);
-            SDL_Delay(1000/RENDER_FPS);
-        #else 
-            SDL_Delay(50);
-        #endif
+        /// Steady state must not touch the heap; report any frame that did
+        mpGetStats(&memStats);
+        if(memStats.heapAllocs != lastHeapAllocs){
+            __log("[main] %llu heap allocations during a frame", (unsigned long long)(memStats.heapAllocs - lastHeapAllocs));
+            lastHeapAllocs = memStats.heapAllocs;
+        }
+        SDL_Delay(1000 / oscConf.fps);
     }
     __log("[main] Exit mainSloop");
     
@@ -0,0 +1,76 @@
+/**
+ * Acquisition front end: interleaved blocks from the pool split into their
+ * channel stores, and the pool refusing a block put back twice.
+ *
+ * make test
+ */
+#include "../include/global.h"
+
+#define TEST_FRAMES         1000
+
+static int failures = 0;
+
+#define CHECK(cond, ...) do {                   \
+    if(!(cond)){                                \
+        fprintf(stderr, "FAIL %s:%d: ", __FILE__, __LINE__); \
+        fprintf(stderr, __VA_ARGS__);           \
+        fputc('\n', stderr);                    \
+        ++failures;                             \
+    }                                           \
+} while(0)
+
+int main(){
+    sampleStore_t *ss[3] = {NULL, NULL, NULL};
+    acquire_t     *aq = NULL;
+    createSampleStore(&ss[0], 4096);
+    createSampleStore(&ss[2], 4096);
+    if(__is_null(ss[0]) || __is_null(ss[2]) || createAcquire(&aq, 3, ss, TEST_FRAMES, NULL) != STATUS_OK){
+        fprintf(stderr, "FAIL setup\n");
+        return 1;
+    }
+
+    /// Frame i is {i, -i, 2i}; the middle channel has no store
+    float *block = acqGetBlock(aq);
+    CHECK(__is_not_null(block), "no block");
+    if(__is_not_null(block)){
+        REPTT(uint32_t, i, 0, TEST_FRAMES){
+            block[3 * i]     = (float)i;
+            block[3 * i + 1] = -(float)i;
+            block[3 * i + 2] = 2.0f * i;
+        }
+        acqIngest(aq, block, TEST_FRAMES);
+        acqPutBlock(aq, block);
+    }
+    CHECK(ssWritten(ss[0]) == TEST_FRAMES && ssWritten(ss[2]) == TEST_FRAMES, "written %llu / %llu",
+          (unsigned long long)ssWritten(ss[0]), (unsigned long long)ssWritten(ss[2]));
+    float out[TEST_FRAMES];
+    CHECK(ssRead(ss[2], 0, TEST_FRAMES, out) == TEST_FRAMES, "read");
+    REPTT(uint32_t, i, 0, TEST_FRAMES){
+        if(out[i] != 2.0f * i){
+            CHECK(0, "channel 3 sample %u = %g", i, out[i]);
+            break;
+        }
+    }
+
+    /// A second put of the same block must not make it available twice
+    mpStats_t before, after;
+    mpGetStats(&before);
+    acqPutBlock(aq, block);
+    mpGetStats(&after);
+    CHECK(after.poolBadPuts == before.poolBadPuts + 1, "double put not caught");
+    float *got[ACQ_BLOCKS + 1];
+    uint32_t n = 0;
+    while(n <= ACQ_BLOCKS && __is_not_null(got[n] = acqGetBlock(aq))) ++n;
+    CHECK(n == ACQ_BLOCKS, "%u blocks handed out, pool has %u", n, ACQ_BLOCKS);
+    REPTT(uint32_t, i, 0, n) acqPutBlock(aq, got[i]);
+
+    destroyAcquire(&aq);
+    destroySampleStore(&ss[0]);
+    destroySampleStore(&ss[2]);
+    if(failures){
+        fprintf(stderr, "acquire: %d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("acquire: ok\n");
+    return 0;
+}
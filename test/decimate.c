@@ -0,0 +1,81 @@
+/**
+ * Ingest-path decimation: a tone inside the --decimate passband reaches the
+ * store at unit gain, one above the stored Nyquist rate is rejected.
+ *
+ * make test
+ */
+#include <math.h>
+#include "../include/global.h"
+
+#define TEST_RATIO          8
+#define TEST_FRAMES         4096
+#define TEST_BLOCKS         16
+#define TEST_SETTLE         256                 /// Stored samples skipped while the filter fills
+
+static int failures = 0;
+
+#define CHECK(cond, ...) do {                   \
+    if(!(cond)){                                \
+        fprintf(stderr, "FAIL %s:%d: ", __FILE__, __LINE__); \
+        fprintf(stderr, __VA_ARGS__);           \
+        fputc('\n', stderr);                    \
+        ++failures;                             \
+    }                                           \
+} while(0)
+
+/**
+ * @brief Push a unit sine of f cycles/source sample through a decimating
+ * front end and return the RMS gain seen in the store.
+ */
+static double toneGain(double f){
+    sampleStore_t *ss = NULL;
+    acquire_t     *aq = NULL;
+    decimatorConfig_t dec;
+    memset(&dec, 0, sizeof(dec));
+    dec.ratio    = TEST_RATIO;
+    dec.response = DF_LOWPASS;
+    dec.cutoff   = 0.8f;
+    createSampleStore(&ss, 1U << 16);
+    if(__is_null(ss) || createAcquire(&aq, 1, &ss, TEST_FRAMES, &dec) != STATUS_OK){
+        fprintf(stderr, "FAIL setup\n");
+        destroySampleStore(&ss);
+        return -1.0;
+    }
+
+    uint64_t t = 0;
+    REPTT(uint32_t, b, 0, TEST_BLOCKS){
+        float *block = acqGetBlock(aq);
+        if(__is_null(block)) break;
+        REPTT(uint32_t, i, 0, TEST_FRAMES) block[i] = (float)sin(2.0 * M_PI * f * (double)t++);
+        acqIngest(aq, block, TEST_FRAMES);
+        acqPutBlock(aq, block);
+    }
+
+    uint64_t n = ssWritten(ss);
+    CHECK(n >= (uint64_t)TEST_FRAMES * TEST_BLOCKS / TEST_RATIO - 1, "stored %llu of %u",
+          (unsigned long long)n, TEST_FRAMES * TEST_BLOCKS / TEST_RATIO);
+    double sum = 0.0;
+    uint64_t cnt = 0;
+    for(uint64_t i = TEST_SETTLE; i < n; ++i){
+        float v;
+        if(ssRead(ss, i, 1, &v) != 1) continue;
+        sum += (double)v * v;
+        ++cnt;
+    }
+    destroyAcquire(&aq);
+    destroySampleStore(&ss);
+    return cnt ? sqrt(2.0 * sum / (double)cnt) : 0.0;
+}
+
+int main(){
+    const double nyq = 0.5 / TEST_RATIO;        /// Stored Nyquist rate in cycles/source sample
+
+    double pass = toneGain(0.25 * nyq);
+    CHECK(fabs(20.0 * log10(pass)) < 0.5, "passband gain %.3f dB", 20.0 * log10(pass));
+
+    double stop = toneGain(3.0 * nyq);
+    CHECK(20.0 * log10(stop) < -40.0, "stopband gain %.1f dB", 20.0 * log10(stop));
+
+    if(failures == 0) printf("decimate: ok (pass %.3f dB, stop %.1f dB)\n", 20.0 * log10(pass), 20.0 * log10(stop));
+    return failures ? 1 : 0;
+}
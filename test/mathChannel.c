@@ -0,0 +1,91 @@
+/**
+ * Math slot: expressions evaluated block by block as frames are ingested,
+ * landing in the math store at the index of the source samples they use.
+ *
+ * make test
+ */
+#include <math.h>
+#include "../include/global.h"
+
+#define TEST_FRAMES         1000
+#define TEST_BLOCKS         3
+#define TEST_DT             1e-3f
+
+static int failures = 0;
+
+#define CHECK(cond, ...) do {                   \
+    if(!(cond)){                                \
+        fprintf(stderr, "FAIL %s:%d: ", __FILE__, __LINE__); \
+        fprintf(stderr, __VA_ARGS__);           \
+        fputc('\n', stderr);                    \
+        ++failures;                             \
+    }                                           \
+} while(0)
+
+/// Frame k of channel c, k counted from the first frame ever ingested
+typedef float (*testWave_t)(uint64_t k, uint8_t c);
+
+static float waveRamp(uint64_t k, uint8_t c)  { return c == 0 ? 0.01f * k : 3.0f - 0.002f * k; }
+static float waveConst(uint64_t k, uint8_t c) { return c == 0 ? 2.0f : -1.0f; }
+
+static void ingest(acquire_t *aq, uint64_t *k, testWave_t wave){
+    REPTT(uint32_t, b, 0, TEST_BLOCKS){
+        float *block = acqGetBlock(aq);
+        if(__is_null(block)) return;
+        REPTT(uint32_t, i, 0, TEST_FRAMES){
+            block[2 * i]     = wave(*k, 0);
+            block[2 * i + 1] = wave(*k, 1);
+            ++*k;
+        }
+        acqIngest(aq, block, TEST_FRAMES);
+        acqPutBlock(aq, block);
+    }
+}
+
+int main(){
+    sampleStore_t *ss[2] = {NULL, NULL}, *ms = NULL;
+    acquire_t     *aq = NULL;
+    float          v;
+    uint64_t       k = 0;
+    createSampleStore(&ss[0], 1U << 14);
+    createSampleStore(&ss[1], 1U << 14);
+    createSampleStore(&ms, 1U << 14);
+    if(__is_null(ss[0]) || __is_null(ss[1]) || __is_null(ms)
+    || createAcquire(&aq, 2, ss, TEST_FRAMES, NULL) != STATUS_OK || acqAttachMath(aq, ms) != STATUS_OK){
+        fprintf(stderr, "FAIL setup\n");
+        return 1;
+    }
+
+    CHECK(acqSetMath(aq, "CH3*2", TEST_DT) == ERROR_INVALID_PARAMS, "CH3 has no store, accepted");
+    CHECK(acqSetMath(aq, "(CH1-", TEST_DT) != STATUS_OK, "parse error accepted");
+
+    /// (CH1-CH2)*0.5 over a pair of ramps
+    CHECK(acqSetMath(aq, "(CH1-CH2)*0.5", TEST_DT) == STATUS_OK, "(CH1-CH2)*0.5 rejected");
+    ingest(aq, &k, waveRamp);
+    CHECK(ssWritten(ms) == k, "math store at %llu, sources at %llu", (unsigned long long)ssWritten(ms), (unsigned long long)k);
+    uint64_t bad = 0;
+    REPTT(uint64_t, i, 0, k){
+        float want = 0.5f * (waveRamp(i, 0) - waveRamp(i, 1));
+        if(ssRead(ms, i, 1, &v) != 1 || fabsf(v - want) > 1e-4f * (1.0f + fabsf(want))) ++bad;
+    }
+    CHECK(bad == 0, "(CH1-CH2)*0.5: %llu samples off", (unsigned long long)bad);
+
+    /// integ(CH1) of a constant 2 from the switch on: 2 * (i - first) * dt, carried across blocks
+    const uint64_t first = k;
+    CHECK(acqSetMath(aq, "integ(CH1)", TEST_DT) == STATUS_OK, "integ(CH1) rejected");
+    ingest(aq, &k, waveConst);
+    CHECK(ssWritten(ms) == k, "math store at %llu, sources at %llu", (unsigned long long)ssWritten(ms), (unsigned long long)k);
+    bad = 0;
+    for(uint64_t i = first; i < k; ++i){
+        float want = 2.0f * (float)(i - first) * TEST_DT;
+        if(ssRead(ms, i, 1, &v) != 1 || fabsf(v - want) > 1e-4f * (1.0f + want)) ++bad;
+    }
+    CHECK(bad == 0, "integ(CH1): %llu samples off", (unsigned long long)bad);
+
+    destroyAcquire(&aq);
+    destroySampleStore(&ms);
+    destroySampleStore(&ss[1]);
+    destroySampleStore(&ss[0]);
+    if(failures == 0) printf("mathChannel: ok\n");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,122 @@
+/**
+ * WAVeform:DATA? end to end: a sample store attached to a live server, a
+ * client on the Unix socket, and the min/max frame checked against the ramp
+ * that was written. A detached channel must answer "off".
+ *
+ * make test
+ */
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "../include/global.h"
+
+#define TEST_SAMPLES        1000
+#define TEST_POINTS         10
+
+static int failures = 0;
+
+#define CHECK(cond, ...) do {                   \
+    if(!(cond)){                                \
+        fprintf(stderr, "FAIL %s:%d: ", __FILE__, __LINE__); \
+        fprintf(stderr, __VA_ARGS__);           \
+        fputc('\n', stderr);                    \
+        ++failures;                             \
+    }                                           \
+} while(0)
+
+/// Read exactly n bytes, or fail
+static int readAll(int fd, void *buf, size_t n){
+    uint8_t *p = (uint8_t *) buf;
+    while(n > 0){
+        ssize_t got = read(fd, p, n);
+        if(got <= 0) return -1;
+        p += got;
+        n -= (size_t)got;
+    }
+    return 0;
+}
+
+/// One text line, without the newline
+static int readLine(int fd, char *buf, size_t size){
+    size_t len = 0;
+    while(len + 1 < size){
+        char c;
+        if(read(fd, &c, 1) != 1) return -1;
+        if(c == '\n') break;
+        buf[len++] = c;
+    }
+    buf[len] = '\0';
+    return 0;
+}
+
+static int sendLine(int fd, const char *line){
+    size_t n = strlen(line);
+    return write(fd, line, n) == (ssize_t)n ? 0 : -1;
+}
+
+int main(){
+    char path[108];
+    snprintf(path, sizeof(path), "/tmp/osc-test-%ld.sock", (long)getpid());
+
+    sampleStore_t *ss  = NULL;
+    scpiServer_t  *srv = NULL;
+    float          ramp[TEST_SAMPLES];
+    REPTT(uint32_t, i, 0, TEST_SAMPLES) ramp[i] = (float)i * 0.5f - 100.0f;
+    if(createSampleStore(&ss, 4096) != STATUS_OK || createScpiServer(&srv, path, 1e6, TEST_SAMPLES) != STATUS_OK){
+        fprintf(stderr, "FAIL setup\n");
+        return 1;
+    }
+    ssWrite(ss, ramp, TEST_SAMPLES);
+    scAttach(srv, 0, ss);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+    if(fd < 0 || connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0){
+        fprintf(stderr, "FAIL connect %s: %s\n", path, strerror(errno));
+        destroyScpiServer(&srv);
+        destroySampleStore(&ss);
+        return 1;
+    }
+
+    /// The newest TEST_SAMPLES samples as TEST_POINTS min/max pairs
+    char cmd[64];
+    snprintf(cmd, sizeof(cmd), "WAV:DATA? CH1,%d,%d\n", TEST_SAMPLES, TEST_POINTS);
+    scFrameHeader_t h;
+    float           pairs[2 * TEST_POINTS];
+    CHECK(sendLine(fd, cmd) == 0, "send");
+    CHECK(readAll(fd, &h, sizeof(h)) == 0, "frame header");
+    CHECK(h.magic == SC_FRAME_MAGIC, "magic %#x", h.magic);
+    CHECK(h.type == SC_FRAME_MINMAX, "type %u", h.type);
+    CHECK(h.channel == 0, "channel %u", h.channel);
+    CHECK(h.count == TEST_POINTS, "count %u", h.count);
+    CHECK(h.first == 0, "first %llu", (unsigned long long)h.first);
+    CHECK(h.span == TEST_SAMPLES, "span %llu", (unsigned long long)h.span);
+    CHECK(h.bytes == sizeof(pairs), "bytes %u", h.bytes);
+    if(h.bytes == sizeof(pairs) && readAll(fd, pairs, sizeof(pairs)) == 0){
+        const uint32_t per = TEST_SAMPLES / TEST_POINTS;
+        REPTT(uint32_t, p, 0, TEST_POINTS){
+            CHECK(pairs[2 * p] == ramp[p * per], "pair %u min %g, expected %g", p, pairs[2 * p], ramp[p * per]);
+            CHECK(pairs[2 * p + 1] == ramp[p * per + per - 1], "pair %u max %g, expected %g", p, pairs[2 * p + 1], ramp[p * per + per - 1]);
+        }
+    }else{
+        CHECK(0, "payload");
+    }
+
+    /// Nothing attached as channel 2
+    char line[128];
+    CHECK(sendLine(fd, "WAV:DATA? CH2,100,10\n") == 0, "send");
+    CHECK(readLine(fd, line, sizeof(line)) == 0 && strcmp(line, "ERR channel 2 is off") == 0, "detached channel answered '%s'", line);
+
+    close(fd);
+    destroyScpiServer(&srv);
+    destroySampleStore(&ss);
+    if(failures){
+        fprintf(stderr, "scpiWaveform: %d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("scpiWaveform: ok\n");
+    return 0;
+}